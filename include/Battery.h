@@ -9,6 +9,15 @@
 
 class BatteryProvider {
 public:
+    enum class Type : unsigned {
+        PylontechCan = 0,
+        JkBmsSerial = 1,
+        Mqtt = 2,
+        VictronSmartShunt = 3,
+        PytesCan = 4,
+        SBSCan = 5
+    };
+
     // returns true if the provider is ready for use, false otherwise
     virtual bool init(bool verboseLogging) = 0;
     virtual void deinit() = 0;
@@ -28,6 +37,8 @@ public:
 private:
     void loop();
 
+    float getDischargeCurrentLimit(BatteryStats const& stats) const;
+
     Task _loopTask;
     mutable std::mutex _mutex;
     std::unique_ptr<BatteryProvider> _upProvider = nullptr;
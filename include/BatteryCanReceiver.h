@@ -2,6 +2,7 @@
 #pragma once
 
 #include "Battery.h"
+#include "CanBus.h"
 #include <driver/twai.h>
 #include <Arduino.h>
 
@@ -14,6 +15,10 @@ public:
     virtual void onMessage(twai_message_t rx_message) = 0;
 
 protected:
+    // returns true if onMessage() handles frames with this identifier. all
+    // other frames are dropped right after they were read from the driver.
+    virtual bool isKnownIdentifier(uint32_t identifier) const = 0;
+
     uint8_t readUnsignedInt8(uint8_t *data);
     uint16_t readUnsignedInt16(uint8_t *data);
     int16_t readSignedInt16(uint8_t *data);
@@ -25,5 +30,16 @@ protected:
     bool _verboseLogging = true;
 
 private:
+    void updateBusStats();
+
+    // all supported BMSes use the same bit rate
+    static constexpr uint32_t Bitrate = 500000;
+
+    // number of frames buffered between two loop() calls
+    static constexpr uint32_t RxQueueLength = 32;
+
+    std::shared_ptr<CanBus> _bus;
+    QueueHandle_t _rxQueue = nullptr;
+
     char const* _providerName = "Battery CAN";
 };
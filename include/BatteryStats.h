@@ -9,6 +9,8 @@
 #include "VeDirectShuntController.h"
 #include <cfloat>
 
+struct BatteryTelemetry;
+
 // mandatory interface for all kinds of batteries
 class BatteryStats {
     public:
@@ -36,6 +38,10 @@ class BatteryStats {
 
         void mqttLoop();
 
+        // fills the data shared through the telemetry bus, except
+        // for the effective discharge current limit.
+        void getTelemetry(BatteryTelemetry& telemetry) const;
+
         // the interval at which all battery data will be re-published, even
         // if they did not change. used to calculate Home Assistent expiration.
         virtual uint32_t getMqttFullPublishIntervalMs() const;
@@ -85,6 +91,15 @@ class BatteryStats {
         String _serial = "";
         uint32_t _lastUpdate = 0;
 
+        // statistics of the CAN interface, maintained by CAN based providers
+        bool _canStatsValid = false;
+        uint32_t _canRxFrames = 0;
+        uint32_t _canRxIgnored = 0;
+        uint32_t _canRxMissed = 0;
+        uint32_t _canBusErrors = 0;
+
+        friend class BatteryCanReceiver;
+
     private:
         String _manufacturer = "unknown";
         uint32_t _lastMqttPublish = 0;
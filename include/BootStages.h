@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <TaskSchedulerDeclarations.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define BOOT_STAGES_TASK_STACK_SIZE 8192
+
+// runs the initialization of the subsystems as a dependency graph. stages
+// are run on the main task in the order they were added, unless they are
+// marked concurrent: those are started on a task of their own as soon as
+// their dependencies are done. concurrent stages add their tasks to a
+// private scheduler, the tasks are moved to the main scheduler when the
+// stage is joined. the start and duration of all stages is kept.
+class BootStagesClass {
+public:
+    using StageFunc = std::function<void(Scheduler&)>;
+
+    void add(char const* name, std::vector<char const*> dependencies, StageFunc func, bool concurrent = false);
+
+    // returns after all stages are done
+    void run(Scheduler& scheduler);
+
+    struct Timing {
+        char const* Name;
+        uint32_t StartUs; // since reset
+        uint32_t DurationUs;
+        bool Concurrent;
+    };
+
+    std::vector<Timing> getTimings() const;
+
+    // time from reset until all stages were done, zero during boot
+    uint32_t getSetupDoneUs() const { return _setupDoneUs; }
+
+    // time from reset until the first power limit was sent to an inverter
+    void onLimitCommand();
+    uint32_t getFirstLimitCommandUs() const { return _firstLimitCommandUs; }
+
+private:
+    enum class State {
+        Pending,
+        Running, // concurrent stage which was started but not yet joined
+        Done
+    };
+
+    struct Stage {
+        char const* Name;
+        std::vector<char const*> Dependencies;
+        StageFunc Func;
+        bool Concurrent;
+        State Status = State::Pending;
+        std::unique_ptr<Scheduler> StageScheduler;
+        SemaphoreHandle_t Finished = nullptr;
+    };
+
+    Stage* find(char const* name);
+    bool dependenciesDone(Stage const& stage);
+    void startConcurrentStages();
+    void waitFor(Stage& stage, Scheduler& scheduler);
+    void join(Stage& stage, Scheduler& scheduler);
+    void execute(Stage& stage, Scheduler& scheduler);
+    static void stageTask(void* arg);
+
+    std::vector<Stage> _stages;
+
+    mutable std::mutex _mutex;
+    std::vector<Timing> _timings;
+
+    std::atomic<uint32_t> _setupDoneUs = 0;
+    std::atomic<uint32_t> _firstLimitCommandUs = 0;
+};
+
+extern BootStagesClass BootStages;
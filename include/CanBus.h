@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <Arduino.h>
+#include <driver/twai.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class MCP_CAN;
+class SPIClass;
+
+// A physical CAN bus, which is shared by all consumers attached to it. Each
+// consumer subscribes with an identifier filter and receives the matching
+// frames through its own queue. A single task per bus reads the frames from
+// the controller and also transmits the frames queued by the consumers.
+// Frames are represented as twai_message_t, regardless of the controller.
+class CanBus {
+public:
+    struct Stats {
+        uint32_t RxFrames; // frames read from the controller
+        uint32_t RxUnmatched; // frames no consumer subscribed to
+        uint32_t RxDropped; // frames dropped as a consumer queue was full
+        uint32_t RxMissed; // frames lost by the controller (RX overrun)
+        uint32_t BusErrors;
+        uint32_t TxFrames;
+        uint32_t TxErrors;
+    };
+
+    virtual ~CanBus();
+
+    uint32_t getBitrate() const { return _bitrate; }
+
+    // frames with (identifier & mask) == (filter & mask) and the given frame
+    // format (standard or extended identifier) are copied to the returned
+    // queue of twai_message_t. returns nullptr if the queue cannot be created.
+    QueueHandle_t subscribe(uint32_t filter, uint32_t mask, bool extended, size_t queueLength);
+    void unsubscribe(QueueHandle_t queue);
+
+    // queues the frame for transmission, does not block
+    virtual bool send(twai_message_t const& frame) = 0;
+
+    Stats getStats() const;
+
+protected:
+    explicit CanBus(uint32_t bitrate)
+        : _bitrate(bitrate) { }
+
+    bool startTask(char const* name);
+
+    // must be called by the destructor of derived classes, such
+    // that poll() is not called on a partially destroyed object.
+    void stopTask();
+
+    // called in a loop by the bus task. implementations shall block for
+    // a limited amount of time until a frame was received or is to be sent.
+    virtual void poll() = 0;
+
+    void dispatch(twai_message_t const& frame);
+
+    mutable std::mutex _mutex;
+    Stats _stats = {};
+    TaskHandle_t volatile _task = nullptr;
+
+private:
+    static void taskFunc(void* parameter);
+
+    struct Consumer {
+        uint32_t filter;
+        uint32_t mask;
+        bool extended;
+        QueueHandle_t queue;
+    };
+    std::vector<Consumer> _consumers;
+
+    uint32_t const _bitrate;
+    bool volatile _stopRequested = false;
+};
+
+// the ESP32's built-in CAN controller
+class TwaiCanBus : public CanBus {
+public:
+    TwaiCanBus(int8_t rx, int8_t tx, uint32_t bitrate)
+        : CanBus(bitrate)
+        , _rx(rx)
+        , _tx(tx) { }
+    ~TwaiCanBus();
+
+    bool begin();
+    bool send(twai_message_t const& frame) final;
+
+    bool usesPins(int8_t rx, int8_t tx) const { return _rx == rx && _tx == tx; }
+
+private:
+    void poll() final;
+
+    int8_t const _rx;
+    int8_t const _tx;
+    bool _installed = false;
+};
+
+// a MCP2515 CAN controller connected via SPI
+class Mcp2515CanBus : public CanBus {
+public:
+    explicit Mcp2515CanBus(uint32_t bitrate)
+        : CanBus(bitrate) { }
+    ~Mcp2515CanBus();
+
+    bool begin(int8_t miso, int8_t mosi, int8_t clk, int8_t irq, int8_t cs, uint32_t oscillatorFrequency);
+    bool send(twai_message_t const& frame) final;
+
+    bool usesPins(int8_t irq, int8_t cs) const { return _irq == irq && _cs == cs; }
+
+private:
+    void poll() final;
+    void ARDUINO_ISR_ATTR onInterrupt();
+
+    std::unique_ptr<SPIClass> _spi;
+    std::unique_ptr<MCP_CAN> _can;
+    QueueHandle_t _txQueue = nullptr;
+    int8_t _irq = -1;
+    int8_t _cs = -1;
+};
+
+class CanBusesClass {
+public:
+    // return the bus on the respective controller, which is initialized on
+    // first use and shut down once the last consumer released it. returns
+    // nullptr if the controller is in use with a different configuration.
+    std::shared_ptr<CanBus> getTwai(int8_t rx, int8_t tx, uint32_t bitrate);
+    std::shared_ptr<CanBus> getMcp2515(int8_t miso, int8_t mosi, int8_t clk,
+            int8_t irq, int8_t cs, uint32_t oscillatorFrequency, uint32_t bitrate);
+
+private:
+    std::mutex _mutex;
+    std::weak_ptr<TwaiCanBus> _twai;
+    std::weak_ptr<Mcp2515CanBus> _mcp2515;
+};
+
+extern CanBusesClass CanBuses;
@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <FS.h>
+#include <cstddef>
+#include <cstdint>
+
+#define CONFIG_SNAPSHOT_FILENAME "/config.bin"
+
+// Binary image of the in-memory configuration structs, stored next to the
+// JSON files so that a (watchdog) reboot does not need to parse JSON. The
+// JSON files stay the source of truth: a section is only used if it was
+// written by the very same firmware image and the JSON file it was derived
+// from still has the same size and CRC32. Otherwise the caller falls back to
+// parsing the JSON file and refreshes the section afterwards.
+class ConfigSnapshotClass {
+public:
+    enum class Section : uint32_t {
+        Config = 1,
+        PinMapping = 2
+    };
+
+    bool load(Section section, size_t sourceSize, uint32_t sourceCrc, void* data, size_t len);
+    bool store(Section section, size_t sourceSize, uint32_t sourceCrc, void const* data, size_t len);
+    void invalidate();
+
+    // CRC32 of the whole file, which is rewound afterwards
+    static uint32_t getChecksum(File& source);
+
+private:
+    static constexpr uint32_t Magic = 0x534e4443; // "CDNS"
+    static constexpr uint16_t FormatVersion = 2;
+    static constexpr size_t FirmwareIdLength = 32;
+
+    struct FileHeader {
+        uint32_t magic;
+        uint16_t formatVersion;
+        uint16_t reserved;
+        uint8_t firmwareId[FirmwareIdLength];
+    };
+
+    struct SectionHeader {
+        uint32_t section;
+        uint32_t sourceSize;
+        uint32_t sourceCrc;
+        uint32_t length;
+        uint32_t crc;
+    };
+
+    static void getFileHeader(FileHeader& header);
+};
+
+extern ConfigSnapshotClass ConfigSnapshot;
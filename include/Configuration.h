@@ -266,6 +266,7 @@ struct CONFIG_T {
         bool Enabled;
         bool VerboseLogging;
         bool UpdatesOnly;
+        uint16_t FastPollInterval; // ms, 0 = disabled
     } Vedirect;
 
     struct PowerMeterConfig {
@@ -288,6 +289,7 @@ struct CONFIG_T {
         bool IsInverterBehindPowerMeter;
         bool IsInverterSolarPowered;
         bool UseOverscalingToCompensateShading;
+        bool PredictiveControl;
         uint64_t InverterId;
         uint8_t InverterChannelId;
         int32_t TargetPowerConsumption;
@@ -322,6 +324,9 @@ struct CONFIG_T {
         float Auto_Power_Upper_Power_Limit;
         uint8_t Auto_Power_Stop_BatterySoC_Threshold;
         float Auto_Power_Target_Power_Consumption;
+        float Auto_Power_Kp;
+        float Auto_Power_Ki; // 1/s
+        float Auto_Power_Max_Ramp; // W/s, 0 = unlimited
     } Huawei;
 
 
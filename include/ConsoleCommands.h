@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <Print.h>
+#include <TaskSchedulerDeclarations.h>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#define CONSOLE_COMMAND_MAX_LENGTH 64
+
+// commands entered on the serial console or sent through the web console.
+// they are executed by the loop task, the output is written to all consoles.
+class ConsoleCommandsClass {
+public:
+    ConsoleCommandsClass();
+    void init(Scheduler& scheduler);
+
+    using Handler = std::function<void(Print& out, String const& args)>;
+    void add(char const* name, char const* help, Handler handler);
+
+    // may be called from any task
+    void enqueue(String const& line);
+
+private:
+    void loop();
+    void execute(String line);
+
+    Task _loopTask;
+
+    struct Command {
+        char const* Name;
+        char const* Help;
+        Handler Func;
+    };
+    std::vector<Command> _commands;
+
+    std::mutex _mutex;
+    std::queue<String> _pending;
+
+    String _serialLine;
+};
+
+extern ConsoleCommandsClass ConsoleCommands;
@@ -20,15 +20,36 @@ private:
     void averageLoop();
     void dataPointLoop();
 
+    void addDataPoint(float value);
+    float getMaxDataPoint() const;
+
     uint32_t getSecondsPerDot();
 
     Task _averageTask;
     Task _dataPointTask;
 
     U8G2* _display = nullptr;
+
+    // circular buffer, the value with sequence number s
+    // is stored at index (s % MAX_DATAPOINTS).
     std::array<float, MAX_DATAPOINTS> _graphValues = {};
+    uint32_t _graphValuesSequence = 0; // sequence number of the next value
     uint8_t _graphValuesCount = 0;
 
+    // monotonic deque (as circular buffer) of sequence numbers with
+    // decreasing values. the front always refers to the maximum value.
+    std::array<uint32_t, MAX_DATAPOINTS> _maxSequences = {};
+    uint8_t _maxSequencesHead = 0;
+    uint8_t _maxSequencesCount = 0;
+
+    // scaled y-offsets of the data points, indexed like _graphValues. only
+    // values added since the last redraw need to be scaled unless the
+    // scaling changed.
+    std::array<uint8_t, MAX_DATAPOINTS> _graphPixels = {};
+    uint32_t _scaledSequence = 0;
+    float _scaledMaxWatts = 0;
+    uint8_t _scaledHeight = 0;
+
     uint8_t _chartWidth = MAX_DATAPOINTS;
 
     float _iRunningAverage = 0;
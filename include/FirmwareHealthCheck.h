@@ -0,0 +1,39 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <TaskSchedulerDeclarations.h>
+
+#define FIRMWARE_HEALTH_FILENAME "/firmware_health.json"
+
+// after an OTA update, the new firmware is only marked valid once it ran for
+// a while and the radio, the power meter and the dynamic power limiter work
+// (as far as they worked before the update). otherwise, the bootloader is
+// told to roll back to the previous firmware.
+class FirmwareHealthCheckClass {
+public:
+    FirmwareHealthCheckClass();
+    void init(Scheduler& scheduler);
+
+    // records which subsystems are healthy before restarting into a new firmware
+    void saveBaseline();
+
+    bool isPendingVerify() const { return _pendingVerify; }
+
+private:
+    struct Health {
+        bool radio;
+        bool powerMeter;
+        bool powerLimiter;
+    };
+
+    void loop();
+    Health getHealth() const;
+    void finish(bool valid);
+
+    Task _loopTask;
+
+    bool _pendingVerify = false;
+    Health _baseline = { false, false, false };
+};
+
+extern FirmwareHealthCheckClass FirmwareHealthCheck;
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <TaskSchedulerDeclarations.h>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#define GRID_PROFILE_CACHE_DIR "/gridprofile"
+#define GRID_PROFILE_CACHE_MAGIC 0x46525047 // "GPRF"
+#define GRID_PROFILE_CACHE_VERSION 1
+
+// keeps the last grid profile received from each inverter on LittleFS. the
+// profile is restored into the parser at boot, such that it is not requested
+// (which takes more than ten fragments) after every restart. the file format
+// doubles as compact binary export.
+class GridProfileCacheClass {
+public:
+    GridProfileCacheClass();
+    void init(Scheduler& scheduler);
+
+    struct FileHeader {
+        uint32_t Magic;
+        uint16_t Version;
+        uint16_t Length; // of the raw profile following the header
+        uint64_t Serial;
+    };
+
+    // header followed by the raw profile, empty if no profile is known
+    std::vector<uint8_t> exportBinary(const uint64_t serial) const;
+
+    // discards the stored profile, it is requested from the inverter again
+    void refresh(const uint64_t serial);
+
+private:
+    void loop();
+
+    static String getFilename(const uint64_t serial);
+    static bool load(const uint64_t serial, std::vector<uint8_t>& raw);
+    static void save(const uint64_t serial, const std::vector<uint8_t>& raw);
+
+    Task _loopTask;
+
+    mutable std::mutex _mutex;
+
+    // last update of the parser per inverter which was persisted (or
+    // restored), used to detect new profiles
+    std::map<uint64_t, uint32_t> _lastParserUpdate;
+};
+
+extern GridProfileCacheClass GridProfileCache;
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <TaskSchedulerDeclarations.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// number of live allocations which can be tracked at the same time
+#ifndef HEAP_PROFILER_SLOTS
+#define HEAP_PROFILER_SLOTS 1024
+#endif
+
+#define HEAP_PROFILER_SAMPLE_INTERVAL (10 * TASK_SECOND)
+
+enum class HeapTag : uint8_t {
+    None = 0,
+    Radio,
+    Json,
+    Mqtt,
+    Log,
+    HttpClient,
+    WebServer,
+    Count
+};
+
+// attributes the heap allocations made by the current FreeRTOS task to a
+// tag while the scope exists. scopes may be nested, the innermost wins.
+// allocations without a scope are attributed by the name of the task they
+// are made in, if known, and are not tracked otherwise.
+class HeapTagScope {
+public:
+#ifdef HEAP_PROFILER
+    explicit HeapTagScope(const HeapTag tag);
+    ~HeapTagScope();
+
+private:
+    HeapTag _previous;
+#else
+    explicit HeapTagScope(const HeapTag) { }
+#endif
+};
+
+// opt-in heap allocation profiler, enabled by the build flags of the
+// [heap_profiler] section in platformio.ini. malloc() and friends are
+// wrapped by the linker, such that all allocations are seen, including
+// those of libraries and the C++ runtime.
+class HeapProfilerClass {
+public:
+    HeapProfilerClass();
+    void init(Scheduler& scheduler);
+
+    struct TagStats {
+        char const* Name;
+        uint32_t LiveBytes;
+        uint32_t LiveCount;
+        uint32_t PeakBytes; // high-water mark of LiveBytes
+        uint32_t Allocations; // cumulative
+        uint64_t AllocatedBytes; // cumulative
+        float AllocationRate; // allocations per second
+        float ByteRate; // allocated bytes per second
+    };
+
+    static constexpr bool isEnabled()
+    {
+#ifdef HEAP_PROFILER
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::vector<TagStats> getStats() const;
+
+    // allocations not tracked because all slots were in use
+    uint32_t getDroppedCount() const;
+
+    static char const* getTagName(const HeapTag tag);
+
+private:
+    void loop();
+
+    Task _loopTask;
+
+    mutable std::mutex _mutex;
+    uint32_t _lastSampleMillis = 0;
+    uint32_t _lastAllocations[static_cast<size_t>(HeapTag::Count)] = {};
+    uint64_t _lastAllocatedBytes[static_cast<size_t>(HeapTag::Count)] = {};
+    float _allocationRate[static_cast<size_t>(HeapTag::Count)] = {};
+    float _byteRate[static_cast<size_t>(HeapTag::Count)] = {};
+};
+
+extern HeapProfilerClass HeapProfiler;
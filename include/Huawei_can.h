@@ -2,10 +2,10 @@
 #pragma once
 
 #include <cstdint>
-#include "SPI.h"
-#include <mcp_can.h>
+#include "CanBus.h"
 #include <mutex>
 #include <TaskSchedulerDeclarations.h>
+#include "Configuration.h"
 
 #ifndef HUAWEI_PIN_MISO
 #define HUAWEI_PIN_MISO 12
@@ -31,6 +31,12 @@
 #define HUAWEI_PIN_POWER 33
 #endif
 
+// CAN controller frequency setting which selects the ESP32's built-in
+// controller (on the battery pins) instead of an MCP2515 via SPI
+#define HUAWEI_CAN_CONTROLLER_TWAI 0
+
+#define HUAWEI_CAN_BITRATE 125000
+
 #define HUAWEI_MINIMAL_OFFLINE_VOLTAGE 48
 #define HUAWEI_MINIMAL_ONLINE_VOLTAGE 42
 
@@ -101,10 +107,10 @@ public:
 
 private:
     void sendRequest();
+    static twai_message_t makeMessage(uint32_t identifier, uint8_t const* data);
 
-    SPIClass *SPI;
-    MCP_CAN  *_CAN;
-    uint8_t  _huaweiIrq;                         // IRQ pin
+    std::shared_ptr<CanBus> _bus;
+    QueueHandle_t _rxQueue = nullptr;
     uint32_t _nextRequestMillis = 0;              // When to send next data request to PSU
 
     std::mutex _mutex;
@@ -131,12 +137,15 @@ public:
 
 private:
     void loop();
-    void processReceivedParameters();
+    bool processReceivedParameters();
     void _setValue(float in, uint8_t parameterType);
 
+    void resetAutoPowerController();
+    float calculateAutoPowerSetpoint(const CONFIG_T& config, float error);
+    void trackAutoPowerSetpoint(const CONFIG_T& config);
+
     Task _loopTask;
 
-    TaskHandle_t _HuaweiCanCommunicationTaskHdl = NULL;
     bool    _initialized = false;
     uint8_t _huaweiPower;           // Power pin
     uint8_t _mode = HUAWEI_MODE_AUTO_EXT;
@@ -146,9 +155,14 @@ private:
     uint32_t _lastUpdateReceivedMillis;           // Timestamp for last data seen from the PSU
     uint32_t _outputCurrentOnSinceMillis;         // Timestamp since when the PSU was idle at zero amps
     uint32_t _nextAutoModePeriodicIntMillis;      // When to set the next output voltage in automatic mode
-    uint32_t _lastPowerMeterUpdateReceivedMillis; // Timestamp of last seen power meter value
+    uint32_t _lastPowerMeterUpdateReceivedMillis = 0; // Timestamp of last seen power meter value
     uint32_t _autoModeBlockedTillMillis = 0;      // Timestamp to block running auto mode for some time
 
+    bool _autoPowerControllerActive = false;
+    float _autoPowerSetpoint = 0;                 // Output power requested by the controller
+    float _autoPowerLastError = 0;
+    uint32_t _autoPowerLastStepMillis = 0;
+
     uint8_t _autoPowerEnabledCounter = 0;
     bool _autoPowerEnabled = false;
     bool _batteryEmergencyCharging = false;
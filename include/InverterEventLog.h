@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <TaskSchedulerDeclarations.h>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#define INVERTER_EVENTLOG_DIR "/eventlog"
+#define INVERTER_EVENTLOG_MAX_ENTRIES 200
+
+class InverterAbstract;
+
+// keeps the events reported by each inverter on LittleFS, such that they
+// survive reboots and are not lost when the inverter only reports new events.
+// entries are deduplicated by message id and start time.
+class InverterEventLogClass {
+public:
+    InverterEventLogClass();
+    void init(Scheduler& scheduler);
+
+    struct Entry {
+        uint16_t MessageId;
+        uint32_t StartTime; // UTC
+        uint32_t EndTime; // UTC, 0 while the event is active
+    };
+
+    size_t getEntryCount(const uint64_t serial) const;
+
+    // entries which started today (local time)
+    size_t getTodaysEntryCount(const uint64_t serial) const;
+
+    // newest entries first
+    std::vector<Entry> getEntries(const uint64_t serial, const size_t offset, const size_t count) const;
+
+private:
+    struct InverterLog {
+        std::vector<Entry> Entries; // oldest entries first
+        uint32_t LastParserUpdate = 0;
+    };
+
+    void loop();
+    InverterLog& getLog(const uint64_t serial);
+    bool merge(InverterAbstract& inv, InverterLog& log);
+    void clearOnMidnight();
+
+    static String getFilename(const uint64_t serial);
+    static void load(const uint64_t serial, InverterLog& log);
+    static void save(const uint64_t serial, const InverterLog& log);
+
+    Task _loopTask;
+
+    mutable std::mutex _mutex;
+    std::map<uint64_t, InverterLog> _logs;
+
+    int _lastDay = -1;
+};
+
+extern InverterEventLogClass InverterEventLog;
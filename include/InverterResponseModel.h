@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+// models how the AC output of an inverter follows a new power limit: the
+// output starts to change after a delay and then ramps towards the new limit
+// with a constant rate. both parameters are learned from the inverter's
+// statistics following each acknowledged limit command. all timestamps are
+// millis() values and passed in by the caller.
+class InverterResponseModel {
+public:
+    void reset();
+
+    // the inverter acknowledged a new power limit (AC watts)
+    void onLimitCommand(uint32_t timestamp, float limitWatts);
+
+    // the inverter reported its AC output power
+    void onStatistics(uint32_t timestamp, float outputWatts);
+
+    // the inverter's power state is about to change, which makes
+    // the current step unusable for learning and for predictions
+    void abortStep();
+
+    // expected AC output at the given time, e.g., when the power meter took
+    // its last measurement. falls back to the last reported output if no
+    // limit change is in progress. nullopt if no output was reported yet.
+    std::optional<float> predictOutput(uint32_t timestamp) const;
+
+    uint32_t getDelayMillis() const { return _delayMillis; }
+    float getRampWattsPerSecond() const { return _rampWattsPerSecond; }
+    uint32_t getLearnedSteps() const { return _learnedSteps; }
+
+private:
+    static constexpr float MinStepWatts = 50;
+    static constexpr uint32_t MaxStepMillis = 30 * 1000;
+    static constexpr float SmoothingFactor = 0.3;
+
+    uint32_t getSettledMillis() const;
+    void learn(uint32_t delayMillis, std::optional<float> rampWattsPerSecond);
+
+    // initial guesses, typical for Hoymiles inverters
+    uint32_t _delayMillis = 1500;
+    float _rampWattsPerSecond = 100;
+    uint32_t _learnedSteps = 0;
+
+    std::optional<uint32_t> _oSampleMillis = std::nullopt;
+    float _sampleWatts = 0;
+
+    bool _stepActive = false;
+    bool _stepLearning = false;
+    uint32_t _stepMillis = 0;
+    float _stepFromWatts = 0;
+    float _stepToWatts = 0;
+
+    // the last sample before the output started to move towards the new
+    // limit, and the first sample that showed the movement
+    uint32_t _restMillis = 0;
+    std::optional<uint32_t> _oMovingMillis = std::nullopt;
+    float _movingProgress = 0;
+};
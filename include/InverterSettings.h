@@ -13,10 +13,8 @@ public:
 
 private:
     void settingsLoop();
-    void hoyLoop();
 
     Task _settingsTask;
-    Task _hoyTask;
 };
 
 extern InverterSettingsClass InverterSettings;
@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// extracts a numeric value from an MQTT payload without copying it. plain
+// payloads are parsed as a number. otherwise the payload is scanned in place
+// for the value at the JSON path (same syntax as Utils::getJsonValueByPath),
+// which is split into its keys and array indices once, when constructing the
+// parser. the objects and arrays enclosing the value are validated up to their
+// end, such that truncated payloads are rejected like ArduinoJson does.
+class MqttValueParser {
+public:
+    explicit MqttValueParser(char const* jsonPath);
+
+    // on failure, a description of the problem is written to error
+    std::optional<float> parse(uint8_t const* payload, size_t len,
+            char* error, size_t errorSize) const;
+
+private:
+    struct Step {
+        bool isIndex;
+        size_t index;
+        std::string key;
+    };
+
+    std::string _path;
+    std::vector<Step> _steps;
+};
@@ -2,6 +2,8 @@
 #pragma once
 
 #include "Configuration.h"
+#include "InverterResponseModel.h"
+#include "Telemetry.h"
 #include <espMqttClient.h>
 #include <Arduino.h>
 #include <Hoymiles.h>
@@ -43,6 +45,7 @@ public:
     void init(Scheduler& scheduler);
     uint8_t getInverterUpdateTimeouts() const { return _inverterUpdateTimeouts; }
     uint8_t getPowerLimiterState();
+    Status getStatus() const { return _lastStatus; }
     int32_t getLastRequestedPowerLimit() { return _lastRequestedPowerLimit; }
     bool getFullSolarPassThroughEnabled() const { return _fullSolarPassThroughEnabled; }
 
@@ -66,6 +69,7 @@ private:
     std::optional<uint32_t> _oInverterStatsMillis = std::nullopt;
     std::optional<uint32_t> _oUpdateStartMillis = std::nullopt;
     std::optional<int32_t> _oTargetPowerLimitWatts = std::nullopt;
+    std::optional<uint32_t> _oLimitCommandId = std::nullopt;
     std::optional<bool> _oTargetPowerState = std::nullopt;
     Status _lastStatus = Status::Initializing;
     uint32_t _lastStatusPrinted = 0;
@@ -82,6 +86,12 @@ private:
     bool _verboseLogging = true;
     uint8_t _inverterUpdateTimeouts = 0;
 
+    // the state of all other devices as seen by the current DPL loop
+    TelemetryView _telemetry = {};
+
+    InverterResponseModel _responseModel;
+    uint32_t _responseModelStatsMillis = 0;
+
     frozen::string const& getStatusText(Status status);
     void announceStatus(Status status);
     bool shutdown(Status status);
@@ -92,6 +102,7 @@ private:
     bool canUseDirectSolarPower();
     bool calcPowerLimit(std::shared_ptr<InverterAbstract> inverter, int32_t solarPower, int32_t batteryPowerLimit, bool batteryPower);
     bool updateInverter();
+    void updateResponseModel();
     bool setNewPowerLimit(std::shared_ptr<InverterAbstract> inverter, int32_t newPowerLimit);
     int32_t getSolarPower();
     int32_t getBatteryDischargeLimit();
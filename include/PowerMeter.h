@@ -15,6 +15,7 @@ public:
     float getPowerTotal() const;
     uint32_t getLastUpdate() const;
     bool isDataValid() const;
+    std::vector<PowerMeterProvider::TopicStats> getTopicStats() const;
 
 private:
     void loop();
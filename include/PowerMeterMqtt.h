@@ -3,6 +3,7 @@
 
 #include "Configuration.h"
 #include "PowerMeterProvider.h"
+#include "MqttValueParser.h"
 #include <espMqttClient.h>
 #include <vector>
 #include <mutex>
@@ -18,12 +19,13 @@ public:
     bool init() final;
     void loop() final { }
     float getPowerTotal() const final;
+    std::vector<TopicStats> getTopicStats() const final;
 
 private:
     using MsgProperties = espMqttClientTypes::MessageProperties;
     void onMessage(MsgProperties const& properties, char const* topic,
             uint8_t const* payload, size_t len, size_t index,
-            size_t total, float* targetVariable, PowerMeterMqttValue const* cfg);
+            size_t total, size_t valueIdx);
 
     // we don't need to republish data received from MQTT
     void doMqttPublish() const final { };
@@ -33,6 +35,12 @@ private:
     using power_values_t = std::array<float, POWERMETER_MQTT_MAX_VALUES>;
     power_values_t _powerValues;
 
+    // compiled from the JSON paths once, as the provider is recreated
+    // whenever the configuration changes
+    std::vector<MqttValueParser> _parsers;
+
+    std::array<TopicStats, POWERMETER_MQTT_MAX_VALUES> _stats;
+
     std::vector<String> _mqttSubscriptions;
 
     mutable std::mutex _mutex;
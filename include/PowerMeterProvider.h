@@ -2,6 +2,7 @@
 #pragma once
 
 #include <atomic>
+#include <vector>
 #include "Configuration.h"
 
 class PowerMeterProvider {
@@ -28,6 +29,18 @@ public:
     uint32_t getLastUpdate() const { return _lastUpdate; }
     void mqttLoop() const;
 
+    struct TopicStats {
+        String topic;
+        uint32_t messages;
+        uint32_t errors;
+        uint32_t lastMicros; // time spent parsing the last message
+        uint32_t maxMicros;
+        uint64_t sumMicros;
+    };
+
+    // only implemented by providers receiving values through MQTT
+    virtual std::vector<TopicStats> getTopicStats() const { return {}; }
+
 protected:
     PowerMeterProvider() {
         auto const& config = Configuration.get();
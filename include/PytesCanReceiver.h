@@ -13,6 +13,9 @@ public:
 
     std::shared_ptr<BatteryStats> getStats() const final { return _stats; }
 
+protected:
+    bool isKnownIdentifier(uint32_t identifier) const final;
+
 private:
     std::shared_ptr<PytesBatteryStats> _stats =
         std::make_shared<PytesBatteryStats>();
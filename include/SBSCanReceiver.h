@@ -12,6 +12,9 @@ public:
 
     std::shared_ptr<BatteryStats> getStats() const final { return _stats; }
 
+protected:
+    bool isKnownIdentifier(uint32_t identifier) const final;
+
 private:
     void dummyData();
     std::shared_ptr<SBSBatteryStats> _stats =
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <array>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <driver/spi_master.h>
@@ -50,6 +51,9 @@ private:
     #endif
 
     std::array<std::string, _num_controllers> _ports = { "" };
+
+    // subsystems may be initialized concurrently
+    std::mutex _mutex;
 };
 
 extern SPIPortManagerClass SPIPortManager;
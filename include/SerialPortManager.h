@@ -2,6 +2,7 @@
 #pragma once
 
 #include <array>
+#include <mutex>
 #include <optional>
 #include <string>
 
@@ -16,6 +17,9 @@ private:
     // the amount of hardare UARTs available on supported ESP32 chips
     static size_t constexpr _num_controllers = 3;
     std::array<std::string, _num_controllers> _ports = { "" };
+
+    // subsystems may be initialized concurrently
+    std::mutex _mutex;
 };
 
 extern SerialPortManagerClass SerialPortManager;
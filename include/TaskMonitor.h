@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <Print.h>
+#include <TaskSchedulerDeclarations.h>
+#include <cstdint>
+#include <vector>
+
+// records how long the scheduler tasks run and how late they are started.
+// the callback of a task is wrapped where it is set, e.g.
+//     _loopTask.setCallback(TaskMonitor.wrap("Battery", std::bind(&BatteryClass::loop, this)));
+// wrap() may be used in constructors of global objects.
+class TaskMonitorClass {
+public:
+    struct TaskStats {
+        char const* Name;
+        uint32_t Calls;
+        uint64_t RuntimeUs; // cumulative
+        uint32_t MaxRuntimeUs;
+        uint64_t StartDelayMs; // cumulative, time the task started late
+        uint32_t MaxStartDelayMs;
+        uint32_t Overruns; // next iteration was already due when started
+    };
+
+    struct LoopStats {
+        uint32_t Passes;
+        uint64_t DurationUs; // cumulative
+        uint32_t MaxDurationUs;
+    };
+
+    static TaskCallback wrap(char const* name, TaskCallback callback);
+
+    // to be called with the duration of each scheduler pass
+    static void onLoop(const uint32_t durationUs);
+
+    // sorted by cumulative runtime, descending
+    static std::vector<TaskStats> getTaskStats();
+    static LoopStats getLoopStats();
+
+    static void reset();
+    static void printStats(Print& out);
+};
+
+extern TaskMonitorClass TaskMonitor;
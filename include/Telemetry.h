@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include "Huawei_can.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <cstdint>
+#include <cfloat>
+#include <cstring>
+#include <type_traits>
+
+// timestamps are millis() values of the respective last update
+struct PowerMeterTelemetry {
+    bool valid;
+    float powerTotal; // W
+    uint32_t lastUpdate;
+};
+
+struct BatteryTelemetry {
+    bool socValid;
+    float soc;
+    uint32_t socLastUpdate;
+    bool voltageValid;
+    float voltage;
+    uint32_t voltageLastUpdate;
+    bool currentValid;
+    float chargeCurrent;
+    float chargeCurrentLimitation;
+    float dischargeCurrentLimit; // effective limit, FLT_MAX if not limited
+    bool immediateChargingRequest;
+    uint32_t lastUpdate;
+};
+
+struct MpptTelemetry {
+    bool valid;
+    int32_t powerOutputWatts;
+    int32_t panelPowerWatts;
+    float outputVoltage;
+    float yieldDay;
+    float yieldTotal;
+};
+
+struct HuaweiTelemetry {
+    RectifierParameters_t rp;
+    uint32_t lastUpdate;
+    bool autoPowerEnabled;
+    uint8_t mode;
+};
+
+struct InverterTelemetry {
+    float totalAcPower; // W, inverters with polling enabled
+    float totalDcPower; // W, inverters with polling enabled
+    bool isAtLeastOneProducing;
+    bool isAllEnabledReachable;
+};
+
+// a consistent view of all telemetry at the given generation
+struct TelemetryView {
+    uint32_t generation;
+    PowerMeterTelemetry powerMeter;
+    BatteryTelemetry battery;
+    MpptTelemetry mppt;
+    HuaweiTelemetry huawei;
+    InverterTelemetry inverters;
+};
+
+// holds the latest telemetry of a single producer, protected by a sequence
+// lock: readers never block the producer and retry if the data was updated
+// while copying it. there must be only one producer per snapshot.
+template<typename T>
+class TelemetrySnapshot {
+    static_assert(std::is_trivially_copyable<T>::value, "telemetry must be trivially copyable");
+
+public:
+    TelemetrySnapshot() { memset(&_data, 0, sizeof(_data)); }
+
+    // returns false if the data did not change since it was last published
+    bool publish(T const& data)
+    {
+        uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+        if (sequence > 0 && memcmp(&data, &_data, sizeof(T)) == 0) { return false; }
+
+        _sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&_data, &data, sizeof(T));
+        _sequence.store(sequence + 2, std::memory_order_release);
+        return true;
+    }
+
+    // returns the generation of the data, zero if nothing was published yet
+    uint32_t read(T& data) const
+    {
+        for (uint8_t attempt = 0; ; ++attempt) {
+            uint32_t before = _sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                memcpy(&data, &_data, sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (_sequence.load(std::memory_order_relaxed) == before) {
+                    return before / 2;
+                }
+            }
+
+            // the producer may have been preempted by this (higher
+            // priority) task while publishing. let it finish.
+            if (attempt >= 8) { vTaskDelay(1); }
+        }
+    }
+
+    uint32_t getGeneration() const { return _sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    std::atomic<uint32_t> _sequence = 0;
+    T _data;
+};
+
+class TelemetryClass {
+public:
+    TelemetryClass();
+
+    void publish(PowerMeterTelemetry const& data) { if (_powerMeter.publish(data)) { ++_generation; } }
+    void publish(BatteryTelemetry const& data) { if (_battery.publish(data)) { ++_generation; } }
+    void publish(MpptTelemetry const& data) { if (_mppt.publish(data)) { ++_generation; } }
+    void publish(HuaweiTelemetry const& data) { if (_huawei.publish(data)) { ++_generation; } }
+    void publish(InverterTelemetry const& data) { if (_inverters.publish(data)) { ++_generation; } }
+
+    uint32_t get(PowerMeterTelemetry& data) const { return _powerMeter.read(data); }
+    uint32_t get(BatteryTelemetry& data) const { return _battery.read(data); }
+    uint32_t get(MpptTelemetry& data) const { return _mppt.read(data); }
+    uint32_t get(HuaweiTelemetry& data) const { return _huawei.read(data); }
+    uint32_t get(InverterTelemetry& data) const { return _inverters.read(data); }
+
+    // incremented whenever any producer published new data
+    uint32_t getGeneration() const { return _generation.load(std::memory_order_acquire); }
+
+    // reads the telemetry of all producers, such that no producer published
+    // new data while reading, unless data is published with high frequency.
+    void getView(TelemetryView& view) const;
+
+    static uint32_t getAgeSeconds(uint32_t lastUpdate) { return (millis() - lastUpdate) / 1000; }
+
+private:
+    TelemetrySnapshot<PowerMeterTelemetry> _powerMeter;
+    TelemetrySnapshot<BatteryTelemetry> _battery;
+    TelemetrySnapshot<MpptTelemetry> _mppt;
+    TelemetrySnapshot<HuaweiTelemetry> _huawei;
+    TelemetrySnapshot<InverterTelemetry> _inverters;
+
+    std::atomic<uint32_t> _generation = 0;
+};
+
+extern TelemetryClass Telemetry;
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include <Arduino.h>
+#include <TaskSchedulerDeclarations.h>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#define TIMESERIES_DIRNAME "/ts"
+
+// maximum number of points returned by a single query
+#define TIMESERIES_MAX_POINTS 512
+
+class TimeSeriesClass {
+public:
+    enum class Series : uint8_t {
+        AcPower = 0,
+        DcPower,
+        SolarPower,
+        GridPower,
+        BatterySoC,
+        BatteryVoltage,
+        BatteryCurrent,
+        DplLimit,
+        DplStatus
+    };
+    static constexpr size_t SeriesCount = static_cast<size_t>(Series::DplStatus) + 1;
+
+    enum class Resolution : uint8_t {
+        Raw, // one sample per second, kept in RAM only
+        Minute // one averaged sample per minute, persisted on LittleFS
+    };
+
+    struct Point {
+        uint32_t timestamp;
+        float value;
+    };
+
+    void init(Scheduler& scheduler);
+
+    // collects up to maxPoints (valid) points of the given series within
+    // the inclusive range [from, to] of unix timestamps, oldest first.
+    // returns true if the range holds more points, which are queried by
+    // continuing after the timestamp of the last point.
+    bool query(Series series, Resolution resolution, uint32_t from, uint32_t to, size_t maxPoints, std::vector<Point>& points);
+
+    static char const* getSeriesName(Series series);
+    static std::optional<Series> getSeriesByName(String const& name);
+
+private:
+    void loop();
+
+    void sample(std::array<int32_t, SeriesCount>& values) const;
+    void aggregate(uint32_t now, std::array<int32_t, SeriesCount> const& values);
+    void appendMinute(uint32_t timestamp);
+    void flushBlock();
+    void writePendingBlock();
+
+    void scanFiles();
+    String getFilename(uint32_t sequence) const;
+
+    // returns false if points is full and more points are available
+    using PointCallback = std::function<bool(uint32_t timestamp, int32_t value)>;
+    void queryFile(uint32_t sequence, size_t idx, uint32_t from, uint32_t to, PointCallback const& cb);
+
+    static float toFloat(Series series, int32_t value);
+
+    static constexpr int32_t NoValue = INT32_MIN;
+
+    static constexpr size_t RawSamples = 120;
+    static constexpr size_t BlockSamples = 30;
+    static constexpr uint32_t MinuteInterval = 60;
+    static constexpr size_t MaxFileSize = 4096;
+    static constexpr size_t MaxFileCount = 8;
+
+    struct RawSample {
+        uint32_t millis;
+        std::array<int32_t, SeriesCount> values;
+    };
+
+    struct BlockHeader {
+        uint16_t magic;
+        uint8_t seriesCount;
+        uint8_t count;
+        uint32_t start;
+        uint16_t interval;
+        uint16_t length;
+    };
+    static constexpr uint16_t BlockMagic = 0x5453; // "TS"
+
+    struct Block {
+        uint32_t start = 0;
+        uint8_t count = 0;
+        std::array<std::array<int32_t, BlockSamples>, SeriesCount> values;
+    };
+
+    Task _loopTask;
+
+    // guards the samples held in RAM. never held while accessing LittleFS,
+    // such that queries do not delay the sampling.
+    mutable std::mutex _mutex;
+
+    // guards the files and the sequence numbers. must be locked before
+    // _mutex if both are needed.
+    mutable std::mutex _fileMutex;
+
+    std::array<RawSample, RawSamples> _raw;
+    size_t _rawHead = 0;
+    size_t _rawCount = 0;
+
+    uint32_t _aggMinute = 0;
+    std::array<int64_t, SeriesCount> _aggSum = {};
+    std::array<uint16_t, SeriesCount> _aggCount = {};
+
+    Block _block;
+
+    // completed block, to be written to LittleFS outside of _mutex
+    Block _pendingBlock;
+
+    bool _fsReady = false;
+    uint32_t _firstSequence = 0;
+    uint32_t _lastSequence = 0;
+};
+
+extern TimeSeriesClass TimeSeries;
@@ -6,6 +6,7 @@
 
 #include "VeDirectMpptController.h"
 #include "Configuration.h"
+#include "Telemetry.h"
 #include <TaskSchedulerDeclarations.h>
 
 class VictronMpptClass {
@@ -26,6 +27,11 @@ public:
 
     size_t controllerAmount() const { return _controllers.size(); }
     std::optional<VeDirectMpptController::data_t> getData(size_t idx = 0) const;
+    std::optional<VeDirectMpptController::FastPollStats> getFastPollStats(size_t idx) const;
+
+    // the totals of all MPPT charge controllers with valid data. they are
+    // calculated once per new frame and can be read without locking.
+    MpptTelemetry getAggregate() const;
 
     // total output of all MPPT charge controllers in Watts
     int32_t getPowerOutputWatts() const;
@@ -44,6 +50,7 @@ public:
 
 private:
     void loop();
+    MpptTelemetry calculateAggregate() const;
     VictronMpptClass(VictronMpptClass const& other) = delete;
     VictronMpptClass(VictronMpptClass&& other) = delete;
     VictronMpptClass& operator=(VictronMpptClass const& other) = delete;
@@ -55,6 +62,10 @@ private:
     using controller_t = std::unique_ptr<VeDirectMpptController>;
     std::vector<controller_t> _controllers;
 
+    // per controller: timestamp of the last frame included in the
+    // aggregate, zero if the controller's data is not valid.
+    std::vector<uint32_t> _aggregatedUpdates;
+
     std::vector<String> _serialPortOwners;
     bool initController(int8_t rx, int8_t tx, bool logging,
         uint8_t instance);
@@ -3,9 +3,13 @@
 
 #include <ESPAsyncWebServer.h>
 #include <TaskSchedulerDeclarations.h>
+#include <esp_app_format.h>
+#include <mbedtls/sha256.h>
+#include <array>
 
 class WebApiFirmwareClass {
 public:
+    WebApiFirmwareClass();
     void init(AsyncWebServer& server, Scheduler& scheduler);
 
 private:
@@ -14,4 +18,36 @@ private:
     void onFirmwareUpdateFinish(AsyncWebServerRequest* request);
     void onFirmwareUpdateUpload(AsyncWebServerRequest* request, String filename, size_t index, uint8_t* data, size_t len, bool final);
     void onFirmwareStatus(AsyncWebServerRequest* request);
+
+    bool beginUpdate(AsyncWebServerRequest* request);
+    bool validateImageHeader();
+    bool writeData(const uint8_t* data, size_t len);
+    bool endUpdate();
+    void fail(AsyncWebServerRequest* request, const char* reason);
+
+    void sendProgress(const char* state);
+
+    AsyncWebSocket _ws;
+
+    Task _wsCleanupTask;
+    void wsCleanupTaskCb();
+
+    // the image header, the first segment header and the app description
+    // are collected before anything is written to flash
+    static constexpr size_t ImageHeaderSize = sizeof(esp_image_header_t)
+        + sizeof(esp_image_segment_header_t) + sizeof(esp_app_desc_t);
+    std::array<uint8_t, ImageHeaderSize> _imageHeader;
+    size_t _imageHeaderLen = 0;
+
+    mbedtls_sha256_context _sha256;
+    String _expectedSha256;
+    String _sha256Result;
+
+    bool _failed = false;
+    String _error;
+
+    size_t _totalSize = 0;
+    size_t _received = 0;
+    uint32_t _startMillis = 0;
+    uint32_t _lastProgressMillis = 0;
 };
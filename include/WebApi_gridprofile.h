@@ -11,4 +11,6 @@ public:
 private:
     void onGridProfileStatus(AsyncWebServerRequest* request);
     void onGridProfileRawdata(AsyncWebServerRequest* request);
+    void onGridProfileExport(AsyncWebServerRequest* request);
+    void onGridProfileRefresh(AsyncWebServerRequest* request);
 };
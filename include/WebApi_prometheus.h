@@ -17,6 +17,8 @@ private:
 
     void addPanelInfo(AsyncResponseStream* stream, const String& serial, const uint8_t idx, std::shared_ptr<InverterAbstract> inv, const ChannelType_t type, const ChannelNum_t channel);
 
+    void addRadioLatency(AsyncResponseStream* stream, const char* radioName, const HoymilesRadio* radio);
+
     enum MetricType_t {
         NONE = 0,
         GAUGE,
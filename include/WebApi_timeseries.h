@@ -0,0 +1,30 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include "TimeSeries.h"
+#include <ESPAsyncWebServer.h>
+#include <TaskSchedulerDeclarations.h>
+#include <vector>
+
+class WebApiTimeSeriesClass {
+public:
+    void init(AsyncWebServer& server, Scheduler& scheduler);
+
+private:
+    void onTimeSeriesData(AsyncWebServerRequest* request);
+
+    // renders the JSON response in pieces of at most one point
+    struct ChunkedState {
+        std::vector<TimeSeriesClass::Point> points;
+        String head;
+
+        size_t next = 0; // 0: head, 1..n: points, n + 1: tail
+        char buffer[32];
+        char const* piece = nullptr;
+        size_t pieceLen = 0;
+        size_t pieceOffset = 0;
+
+        bool nextPiece();
+        size_t fill(uint8_t* out, size_t maxLen);
+    };
+};
@@ -3,11 +3,17 @@
 
 #include <ESPAsyncWebServer.h>
 #include <TaskSchedulerDeclarations.h>
+#include <map>
 
 class WebApiWebappClass {
 public:
     void init(AsyncWebServer& server, Scheduler& scheduler);
 
 private:
+    const String& getETag(const uint8_t* content, size_t len);
+
     void responseBinaryDataWithETagCache(AsyncWebServerRequest* request, const String &contentType, const String &contentEncoding, const uint8_t *content, size_t len);
+    void responseImmutableData(AsyncWebServerRequest* request, const String& contentType, const String& contentEncoding, const uint8_t* content, size_t len);
+
+    std::map<const uint8_t*, String> _etags;
 };
@@ -3,6 +3,7 @@
 
 #include <ESPAsyncWebServer.h>
 #include <TaskSchedulerDeclarations.h>
+#include <set>
 
 class WebApiWsConsoleClass {
 public:
@@ -10,8 +11,14 @@ public:
     void init(AsyncWebServer& server, Scheduler& scheduler);
 
 private:
+    void onWebsocketEvent(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+
     AsyncWebSocket _ws;
 
+    // ids of the clients which connected with the admin credentials. only
+    // accessed by the websocket events, which run in the async_tcp task.
+    std::set<uint32_t> _adminClients;
+
     Task _wsCleanupTask;
     void wsCleanupTaskCb();
 };
@@ -116,6 +116,7 @@
 #define VEDIRECT_ENABLED false
 #define VEDIRECT_VERBOSE_LOGGING false
 #define VEDIRECT_UPDATESONLY true
+#define VEDIRECT_FAST_POLL_INTERVAL 0
 
 #define POWERMETER_ENABLED false
 #define POWERMETER_POLLING_INTERVAL 10
@@ -132,6 +133,7 @@
 #define POWERLIMITER_IS_INVERTER_BEHIND_POWER_METER true
 #define POWERLIMITER_IS_INVERTER_SOLAR_POWERED false
 #define POWERLIMITER_USE_OVERSCALING_TO_COMPENSATE_SHADING false
+#define POWERLIMITER_PREDICTIVE_CONTROL false
 #define POWERLIMITER_INVERTER_ID 0ULL
 #define POWERLIMITER_INVERTER_CHANNEL_ID 0
 #define POWERLIMITER_TARGET_POWER_CONSUMPTION 0
@@ -166,5 +168,8 @@
 #define HUAWEI_AUTO_POWER_UPPER_POWER_LIMIT 2000
 #define HUAWEI_AUTO_POWER_STOP_BATTERYSOC_THRESHOLD 95
 #define HUAWEI_AUTO_POWER_TARGET_POWER_CONSUMPTION 0
+#define HUAWEI_AUTO_POWER_KP 0.5
+#define HUAWEI_AUTO_POWER_KI 0.3
+#define HUAWEI_AUTO_POWER_MAX_RAMP 200.0
 
 #define VERBOSE_LOGGING true
@@ -25,6 +25,10 @@ void HoymilesClass::init()
     _pollInterval = 0;
     _radioNrf.reset(new HoymilesRadio_NRF());
     _radioCmt.reset(new HoymilesRadio_CMT());
+#ifdef HOYMILES_RADIO_SIM
+    _radioSim.reset(new HoymilesRadio_SIM());
+    _radioSim->init();
+#endif
 }
 
 void HoymilesClass::initNRF(SPIClass* initialisedSpiBus, const uint8_t pinCE, const uint8_t pinIRQ)
@@ -42,6 +46,9 @@ void HoymilesClass::loop()
     std::lock_guard<std::mutex> lock(_mutex);
     _radioNrf->loop();
     _radioCmt->loop();
+#ifdef HOYMILES_RADIO_SIM
+    _radioSim->loop();
+#endif
 
     if (getNumInverters() == 0) {
         return;
@@ -145,33 +152,83 @@ void HoymilesClass::loop()
     }
 }
 
+void HoymilesClass::startRadioTask(const BaseType_t core)
+{
+    if (_radioTaskHandle != nullptr) {
+        return;
+    }
+
+    xTaskCreatePinnedToCore(HoymilesClass::radioTaskHelper, "HOY_RADIO",
+        HOY_RADIO_TASK_STACK_SIZE, this, HOY_RADIO_TASK_PRIORITY, &_radioTaskHandle, core);
+
+    _radioNrf->setNotifyTask(_radioTaskHandle);
+    _radioCmt->setNotifyTask(_radioTaskHandle);
+#ifdef HOYMILES_RADIO_SIM
+    _radioSim->setNotifyTask(_radioTaskHandle);
+#endif
+}
+
+bool HoymilesClass::isRadioTaskRunning() const
+{
+    return _radioTaskHandle != nullptr;
+}
+
+void HoymilesClass::radioTaskHelper(void* context)
+{
+    static_cast<HoymilesClass*>(context)->radioTask();
+}
+
+void HoymilesClass::radioTask()
+{
+    while (true) {
+        loop();
+
+        // sleep until a radio interrupt or a new command wakes us up. while
+        // a request is in flight, the RX timeouts and retransmits must be
+        // served in time (and the CMT module might not have an IRQ line),
+        // so we only sleep for a single tick in that case.
+        bool idle = isAllRadioIdle() && _radioNrf->isQueueEmpty() && _radioCmt->isQueueEmpty();
+#ifdef HOYMILES_RADIO_SIM
+        idle = idle && _radioSim->isQueueEmpty();
+#endif
+        const TickType_t wait = idle ? pdMS_TO_TICKS(HOY_RADIO_TASK_IDLE_WAIT_MS) : 1;
+        ulTaskNotifyTake(pdTRUE, wait);
+    }
+}
+
 std::shared_ptr<InverterAbstract> HoymilesClass::addInverter(const char* name, const uint64_t serial)
 {
+    HoymilesRadio* radioNrf = _radioNrf.get();
+    HoymilesRadio* radioCmt = _radioCmt.get();
+#ifdef HOYMILES_RADIO_SIM
+    radioNrf = radioCmt = _radioSim.get();
+#endif
+
     std::shared_ptr<InverterAbstract> i = nullptr;
     if (HMT_4CH::isValidSerial(serial)) {
-        i = std::make_shared<HMT_4CH>(_radioCmt.get(), serial);
+        i = std::make_shared<HMT_4CH>(radioCmt, serial);
     } else if (HMT_6CH::isValidSerial(serial)) {
-        i = std::make_shared<HMT_6CH>(_radioCmt.get(), serial);
+        i = std::make_shared<HMT_6CH>(radioCmt, serial);
     } else if (HMS_4CH::isValidSerial(serial)) {
-        i = std::make_shared<HMS_4CH>(_radioCmt.get(), serial);
+        i = std::make_shared<HMS_4CH>(radioCmt, serial);
     } else if (HMS_2CH::isValidSerial(serial)) {
-        i = std::make_shared<HMS_2CH>(_radioCmt.get(), serial);
+        i = std::make_shared<HMS_2CH>(radioCmt, serial);
     } else if (HMS_1CH::isValidSerial(serial)) {
-        i = std::make_shared<HMS_1CH>(_radioCmt.get(), serial);
+        i = std::make_shared<HMS_1CH>(radioCmt, serial);
     } else if (HMS_1CHv2::isValidSerial(serial)) {
-        i = std::make_shared<HMS_1CHv2>(_radioCmt.get(), serial);
+        i = std::make_shared<HMS_1CHv2>(radioCmt, serial);
     } else if (HM_4CH::isValidSerial(serial)) {
-        i = std::make_shared<HM_4CH>(_radioNrf.get(), serial);
+        i = std::make_shared<HM_4CH>(radioNrf, serial);
     } else if (HM_2CH::isValidSerial(serial)) {
-        i = std::make_shared<HM_2CH>(_radioNrf.get(), serial);
+        i = std::make_shared<HM_2CH>(radioNrf, serial);
     } else if (HM_1CH::isValidSerial(serial)) {
-        i = std::make_shared<HM_1CH>(_radioNrf.get(), serial);
+        i = std::make_shared<HM_1CH>(radioNrf, serial);
     } else if (HERF_1CH::isValidSerial(serial)) {
-        i = std::make_shared<HERF_1CH>(_radioNrf.get(), serial);
+        i = std::make_shared<HERF_1CH>(radioNrf, serial);
     } else if (HERF_2CH::isValidSerial(serial)) {
-        i = std::make_shared<HERF_2CH>(_radioNrf.get(), serial);
+        i = std::make_shared<HERF_2CH>(radioNrf, serial);
     } else if (HERF_4CH::isValidSerial(serial)) {
-        i = std::make_shared<HERF_4CH>(_radioNrf.get(), serial);
+        i = std::make_shared<HERF_4CH>(radioNrf, serial);
     }
 
     if (i) {
@@ -250,8 +307,20 @@ HoymilesRadio_CMT* HoymilesClass::getRadioCmt()
     return _radioCmt.get();
 }
 
+#ifdef HOYMILES_RADIO_SIM
+HoymilesRadio_SIM* HoymilesClass::getRadioSim()
+{
+    return _radioSim.get();
+}
+#endif
+
 bool HoymilesClass::isAllRadioIdle() const
 {
+#ifdef HOYMILES_RADIO_SIM
+    if (!_radioSim.get()->isIdle()) {
+        return false;
+    }
+#endif
     return _radioNrf.get()->isIdle() && _radioCmt.get()->isIdle();
 }
 
@@ -3,6 +3,9 @@
 
 #include "HoymilesRadio_CMT.h"
 #include "HoymilesRadio_NRF.h"
+#ifdef HOYMILES_RADIO_SIM
+#include "HoymilesRadio_SIM.h"
+#endif
 #include "inverters/InverterAbstract.h"
 #include "types.h"
 #include <Print.h>
@@ -14,6 +17,10 @@
 #define HOY_SYSTEM_CONFIG_PARA_POLL_INTERVAL (2 * 60 * 1000) // 2 minutes
 #define HOY_SYSTEM_CONFIG_PARA_POLL_MIN_DURATION (4 * 60 * 1000) // at least 4 minutes between sending limit command and read request. Otherwise eventlog entry
 
+#define HOY_RADIO_TASK_STACK_SIZE 4096
+#define HOY_RADIO_TASK_PRIORITY 2 // above the Arduino loop task
+#define HOY_RADIO_TASK_IDLE_WAIT_MS 50 // max sleep while no request is pending
+
 class HoymilesClass {
 public:
     void init();
@@ -21,6 +28,10 @@ public:
     void initCMT(const spi_host_device_t spi_host, const int8_t pin_sdio, const int8_t pin_clk, const int8_t pin_cs, const int8_t pin_fcs, const int8_t pin_gpio2, const int8_t pin_gpio3);
     void loop();
 
+    // runs loop() in a dedicated task instead of the caller's scheduler
+    void startRadioTask(const BaseType_t core);
+    bool isRadioTaskRunning() const;
+
     void setMessageOutput(Print* output);
     Print* getMessageOutput();
     Print* getVerboseMessageOutput();
@@ -34,6 +45,9 @@ public:
 
     HoymilesRadio_NRF* getRadioNrf();
     HoymilesRadio_CMT* getRadioCmt();
+#ifdef HOYMILES_RADIO_SIM
+    HoymilesRadio_SIM* getRadioSim();
+#endif
 
     uint32_t PollInterval() const;
     void setPollInterval(const uint32_t interval);
@@ -42,12 +56,21 @@ public:
     bool isAllRadioIdle() const;
 
 private:
+    static void radioTaskHelper(void* context);
+    void radioTask();
+
     std::vector<std::shared_ptr<InverterAbstract>> _inverters;
     std::unique_ptr<HoymilesRadio_NRF> _radioNrf;
     std::unique_ptr<HoymilesRadio_CMT> _radioCmt;
+#ifdef HOYMILES_RADIO_SIM
+    // all inverters are attached to the simulated radio, see HoymilesRadio_SIM.h
+    std::unique_ptr<HoymilesRadio_SIM> _radioSim;
+#endif
 
     std::mutex _mutex;
 
+    TaskHandle_t _radioTaskHandle = nullptr;
+
     uint32_t _pollInterval = 0;
     bool _verboseLogging = true;
     uint32_t _lastPoll = 0;
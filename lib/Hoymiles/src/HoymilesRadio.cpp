@@ -5,6 +5,8 @@
 #include "HoymilesRadio.h"
 #include "Hoymiles.h"
 #include "crc.h"
+#include <algorithm>
+#include <esp_timer.h>
 
 serial_u HoymilesRadio::DtuSerial() const
 {
@@ -34,6 +36,30 @@ bool HoymilesRadio::checkFragmentCrc(const fragment_t& fragment) const
     return (crc == fragment.fragment[fragment.len - 1]);
 }
 
+void HoymilesRadio::enqueCommand(std::shared_ptr<CommandAbstract> cmd)
+{
+    // the command at the front of the queue is not dropped, even if it was
+    // not yet sent, as the radio loop might be processing it right now.
+    const size_t superseded = _commandQueue.removeQueuedIf(
+        [&cmd](const std::shared_ptr<CommandAbstract>& queued) {
+            return cmd->supersedes(*queued);
+        });
+
+    if (superseded > 0) {
+        Hoymiles.getVerboseMessageOutput()->printf("Dropped %u queued %s command(s), superseded by #%u\r\n",
+            static_cast<unsigned>(superseded), cmd->getCommandName().c_str(), static_cast<unsigned>(cmd->getId()));
+
+        auto inv = Hoymiles.getInverterBySerial(cmd->getTargetAddress());
+        if (nullptr != inv) {
+            // Statistics: Count TX Superseded
+            inv->RadioStats.TxSuperseded += superseded;
+        }
+    }
+
+    _commandQueue.push(cmd);
+    notifyTask();
+}
+
 void HoymilesRadio::sendRetransmitPacket(const uint8_t fragment_id)
 {
     CommandAbstract* cmd = _commandQueue.front().get();
@@ -45,6 +71,15 @@ void HoymilesRadio::sendRetransmitPacket(const uint8_t fragment_id)
     }
 }
 
+void HoymilesRadio::sendRetransmitPackets(const uint8_t fragment_ids[], const uint8_t count)
+{
+    // The protocol only allows to request a single fragment per packet. Send the
+    // requests back to back, such that all answers arrive within one rx period.
+    for (uint8_t i = 0; i < count && i < HOY_RETRANSMIT_BATCH_SIZE; i++) {
+        sendRetransmitPacket(fragment_ids[i]);
+    }
+}
+
 void HoymilesRadio::sendLastPacketAgain()
 {
     CommandAbstract* cmd = _commandQueue.front().get();
@@ -58,6 +93,8 @@ void HoymilesRadio::handleReceivedPackage()
         std::shared_ptr<InverterAbstract> inv = Hoymiles.getInverterBySerial(_commandQueue.front().get()->getTargetAddress());
 
         if (nullptr != inv) {
+            inv->finishLinkRound();
+
             CommandAbstract* cmd = _commandQueue.front().get();
             uint8_t verifyResult = inv->verifyAllFragments(*cmd);
             if (verifyResult == FRAGMENT_ALL_MISSING_RESEND) {
@@ -95,13 +132,24 @@ void HoymilesRadio::handleReceivedPackage()
                 _busyFlag = false;
 
             } else if (verifyResult > 0) {
-                // Perform Retransmit
-                Hoymiles.getMessageOutput()->print("Request retransmit: ");
-                Hoymiles.getMessageOutput()->println(verifyResult);
+                // Perform Retransmit of all missing fragments at once
+                uint8_t missing[MAX_RF_FRAGMENT_COUNT];
+                uint8_t missingCount = inv->getMissingFragments(missing);
+                if (missingCount == 0) {
+                    missing[0] = verifyResult;
+                    missingCount = 1;
+                }
+                missingCount = std::min<uint8_t>(missingCount, HOY_RETRANSMIT_BATCH_SIZE);
+
+                Hoymiles.getMessageOutput()->print("Request retransmit:");
+                for (uint8_t i = 0; i < missingCount; i++) {
+                    Hoymiles.getMessageOutput()->printf(" %d", missing[i]);
+                }
+                Hoymiles.getMessageOutput()->println();
                 // Statistics: Count TX Re-Request Fragment
-                inv->RadioStats.TxReRequestFragment++;
+                inv->RadioStats.TxReRequestFragment += missingCount;
 
-                sendRetransmitPacket(verifyResult);
+                sendRetransmitPackets(missing, missingCount);
 
             } else {
                 // Successful received all packages
@@ -165,3 +213,60 @@ bool HoymilesRadio::isQueueEmpty() const
 {
     return _commandQueue.size() == 0;
 }
+
+void HoymilesRadio::setNotifyTask(TaskHandle_t task)
+{
+    _notifyTask = task;
+}
+
+void HoymilesRadio::notifyTask()
+{
+    if (_notifyTask != nullptr) {
+        xTaskNotifyGive(_notifyTask);
+    }
+}
+
+void ARDUINO_ISR_ATTR HoymilesRadio::notifyTaskFromIsr()
+{
+    _irqMicros = static_cast<uint32_t>(esp_timer_get_time());
+
+    if (_notifyTask == nullptr) {
+        return;
+    }
+
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(_notifyTask, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void HoymilesRadio::recordRxLatency()
+{
+    const uint32_t latency = static_cast<uint32_t>(esp_timer_get_time()) - _irqMicros;
+
+    uint8_t bucket = 0;
+    while (bucket < HOY_RX_LATENCY_BUCKET_COUNT - 1
+        && latency >= (static_cast<uint32_t>(HOY_RX_LATENCY_BUCKET_BASE_US) << bucket)) {
+        bucket++;
+    }
+
+    _rxLatencyHistogram[bucket]++;
+    _rxLatencyCount++;
+    _rxLatencySumUs += latency;
+}
+
+std::array<uint32_t, HOY_RX_LATENCY_BUCKET_COUNT> HoymilesRadio::getRxLatencyHistogram() const
+{
+    return _rxLatencyHistogram;
+}
+
+uint32_t HoymilesRadio::getRxLatencyCount() const
+{
+    return _rxLatencyCount;
+}
+
+uint64_t HoymilesRadio::getRxLatencySumUs() const
+{
+    return _rxLatencySumUs;
+}
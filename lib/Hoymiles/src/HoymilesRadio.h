@@ -3,10 +3,23 @@
 
 #include "commands/CommandAbstract.h"
 #include "types.h"
+#include <Arduino.h>
 #include <ThreadSafeQueue.h>
 #include <TimeoutHelper.h>
+#include <array>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include <memory>
 
+// histogram of the time between the RX interrupt and reading the fragment
+// from the radio module. bucket i counts latencies below
+// (HOY_RX_LATENCY_BUCKET_BASE_US << i), the last one counts all others.
+#define HOY_RX_LATENCY_BUCKET_COUNT 8
+#define HOY_RX_LATENCY_BUCKET_BASE_US 250
+
+// maximum number of missing fragments re-requested within one rx period
+#define HOY_RETRANSMIT_BATCH_SIZE 4
+
 class HoymilesRadio {
 public:
     serial_u DtuSerial() const;
@@ -16,10 +29,8 @@ public:
     bool isQueueEmpty() const;
     bool isInitialized() const;
 
-    void enqueCommand(std::shared_ptr<CommandAbstract> cmd)
-    {
-        _commandQueue.push(cmd);
-    }
+    // queued commands superseded by the new one are dropped
+    void enqueCommand(std::shared_ptr<CommandAbstract> cmd);
 
     template <typename T>
     std::shared_ptr<T> prepareCommand(InverterAbstract* inv)
@@ -27,6 +38,14 @@ public:
         return std::make_shared<T>(inv);
     }
 
+    // the task which runs the radio loop, woken up on
+    // radio interrupts and when a command is enqueued.
+    void setNotifyTask(TaskHandle_t task);
+
+    std::array<uint32_t, HOY_RX_LATENCY_BUCKET_COUNT> getRxLatencyHistogram() const;
+    uint32_t getRxLatencyCount() const;
+    uint64_t getRxLatencySumUs() const;
+
 protected:
     static serial_u convertSerialToRadioId(const serial_u serial);
     static void dumpBuf(const uint8_t buf[], const uint8_t len, const bool appendNewline = true);
@@ -34,13 +53,25 @@ protected:
     bool checkFragmentCrc(const fragment_t& fragment) const;
     virtual void sendEsbPacket(CommandAbstract& cmd) = 0;
     void sendRetransmitPacket(const uint8_t fragment_id);
+    void sendRetransmitPackets(const uint8_t fragment_ids[], const uint8_t count);
     void sendLastPacketAgain();
     void handleReceivedPackage();
 
+    void notifyTask();
+    void ARDUINO_ISR_ATTR notifyTaskFromIsr();
+    void recordRxLatency();
+
     serial_u _dtuSerial;
     ThreadSafeQueue<std::shared_ptr<CommandAbstract>> _commandQueue;
     bool _isInitialized = false;
     bool _busyFlag = false;
 
     TimeoutHelper _rxTimeout;
+
+    TaskHandle_t _notifyTask = nullptr;
+    volatile uint32_t _irqMicros = 0;
+
+    std::array<uint32_t, HOY_RX_LATENCY_BUCKET_COUNT> _rxLatencyHistogram = {};
+    uint32_t _rxLatencyCount = 0;
+    uint64_t _rxLatencySumUs = 0;
 };
@@ -141,6 +141,9 @@ void HoymilesRadio_CMT::loop()
                 }
                 _radio->read(f.fragment, f.len);
                 _rxBuffer.push(f);
+                if (_gpio3_configured) {
+                    recordRxLatency();
+                }
             } else {
                 Hoymiles.getMessageOutput()->println("CMT: Buffer full");
                 _radio->flush_rx();
@@ -151,8 +154,8 @@ void HoymilesRadio_CMT::loop()
 
     } else {
         // Perform package parsing only if no packages are received
-        if (!_rxBuffer.empty()) {
-            fragment_t f = _rxBuffer.back();
+        while (!_rxBuffer.empty()) {
+            fragment_t f = _rxBuffer.front();
             if (checkFragmentCrc(f)) {
 
                 const serial_u dtuId = convertSerialToRadioId(_dtuSerial);
@@ -169,7 +172,7 @@ void HoymilesRadio_CMT::loop()
                         dumpBuf(f.fragment, f.len, false);
                         Hoymiles.getVerboseMessageOutput()->printf("| %d dBm\r\n", f.rssi);
 
-                        inv->addRxFragment(f.fragment, f.len);
+                        inv->addRxFragment(f.fragment, f.len, f.channel, f.rssi);
                     } else {
                         Hoymiles.getMessageOutput()->println("Inverter Not found!");
                     }
@@ -260,6 +263,7 @@ void ARDUINO_ISR_ATTR HoymilesRadio_CMT::handleInt1()
 void ARDUINO_ISR_ATTR HoymilesRadio_CMT::handleInt2()
 {
     _packetReceived = true;
+    notifyTaskFromIsr();
 }
 
 void HoymilesRadio_CMT::sendEsbPacket(CommandAbstract& cmd)
@@ -278,6 +282,11 @@ void HoymilesRadio_CMT::sendEsbPacket(CommandAbstract& cmd)
         cmd.getCommandName().c_str(), getFrequencyFromChannel(_radio->getChannel()) / 1000000.0);
     cmd.dumpDataPayload(Hoymiles.getVerboseMessageOutput());
 
+    auto inv = Hoymiles.getInverterBySerial(cmd.getTargetAddress());
+    if (inv != nullptr) {
+        inv->recordTx(_radio->getChannel());
+    }
+
     if (!_radio->write(cmd.getDataPayload(), cmd.getDataSize())) {
         Hoymiles.getMessageOutput()->println("TX SPI Timeout");
     }
@@ -60,6 +60,7 @@ void HoymilesRadio_NRF::loop()
                     f.len = MAX_RF_PAYLOAD_SIZE;
                 _radio->read(f.fragment, f.len);
                 _rxBuffer.push(f);
+                recordRxLatency();
             } else {
                 Hoymiles.getMessageOutput()->println("NRF: Buffer full");
                 _radio->flush_rx();
@@ -69,8 +70,8 @@ void HoymilesRadio_NRF::loop()
 
     } else {
         // Perform package parsing only if no packages are received
-        if (!_rxBuffer.empty()) {
-            fragment_t f = _rxBuffer.back();
+        while (!_rxBuffer.empty()) {
+            fragment_t f = _rxBuffer.front();
             if (checkFragmentCrc(f)) {
                 std::shared_ptr<InverterAbstract> inv = Hoymiles.getInverterByFragment(f);
 
@@ -80,7 +81,7 @@ void HoymilesRadio_NRF::loop()
                     dumpBuf(f.fragment, f.len, false);
                     Hoymiles.getVerboseMessageOutput()->printf("| %d dBm\r\n", f.rssi);
 
-                    inv->addRxFragment(f.fragment, f.len);
+                    inv->addRxFragment(f.fragment, f.len, f.channel, f.rssi);
                 } else {
                     Hoymiles.getMessageOutput()->println("Inverter Not found!");
                 }
@@ -146,6 +147,7 @@ void HoymilesRadio_NRF::openWritingPipe(const serial_u serial)
 void ARDUINO_ISR_ATTR HoymilesRadio_NRF::handleIntr()
 {
     _packetReceived = true;
+    notifyTaskFromIsr();
 }
 
 uint8_t HoymilesRadio_NRF::getRxNxtChannel()
@@ -155,11 +157,18 @@ uint8_t HoymilesRadio_NRF::getRxNxtChannel()
     return _rxChLst[_rxChIdx];
 }
 
-uint8_t HoymilesRadio_NRF::getTxNxtChannel()
+uint8_t HoymilesRadio_NRF::getTxNxtChannel(const CommandAbstract& cmd)
 {
     if (++_txChIdx >= sizeof(_txChLst))
         _txChIdx = 0;
-    return _txChLst[_txChIdx];
+
+    // Prefer the channel with the best success rate for this inverter,
+    // hopping is used after unanswered requests and to explore other channels
+    auto inv = Hoymiles.getInverterBySerial(cmd.getTargetAddress());
+    if (inv == nullptr) {
+        return _txChLst[_txChIdx];
+    }
+    return inv->selectTxChannel(_txChLst, sizeof(_txChLst), _txChLst[_txChIdx]);
 }
 
 void HoymilesRadio_NRF::switchRxCh()
@@ -176,11 +185,16 @@ void HoymilesRadio_NRF::sendEsbPacket(CommandAbstract& cmd)
     cmd.setRouterAddress(DtuSerial().u64);
 
     _radio->stopListening();
-    _radio->setChannel(getTxNxtChannel());
+    _radio->setChannel(getTxNxtChannel(cmd));
 
     serial_u s;
     s.u64 = cmd.getTargetAddress();
     openWritingPipe(s);
+
+    auto inv = Hoymiles.getInverterBySerial(s.u64);
+    if (inv != nullptr) {
+        inv->recordTx(_radio->getChannel());
+    }
     _radio->setRetries(3, 15);
 
     Hoymiles.getVerboseMessageOutput()->printf("TX %s Channel: %d --> ",
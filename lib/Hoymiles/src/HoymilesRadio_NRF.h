@@ -25,7 +25,7 @@ public:
 private:
     void ARDUINO_ISR_ATTR handleIntr();
     uint8_t getRxNxtChannel();
-    uint8_t getTxNxtChannel();
+    uint8_t getTxNxtChannel(const CommandAbstract& cmd);
     void switchRxCh();
     void openReadingPipe();
     void openWritingPipe(const serial_u serial);
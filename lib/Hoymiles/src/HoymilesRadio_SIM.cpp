@@ -0,0 +1,454 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "HoymilesRadio_SIM.h"
+#include "Hoymiles.h"
+#include "crc.h"
+#include <algorithm>
+#include <cmath>
+#include <esp_system.h>
+
+#define SIM_CHANNEL 0
+#define SIM_RSSI -60
+#define SIM_EFFICIENCY 0.96f
+
+struct SimulatedType_t {
+    const char* prefix;
+    uint8_t dcChannels; // at most
+    uint8_t hwPart[3];
+    uint16_t maxPower;
+};
+
+// largest model of each inverter family, matching the DevInfoParser table
+static const SimulatedType_t simulatedTypes[] = {
+    { "HERF-", 2, { 0xF1, 0x01, 0x14 }, 800 },
+    { "HERF-", 4, { 0xF1, 0x01, 0x24 }, 1600 },
+    { "HMS-", 1, { 0x10, 0x20, 0x41 }, 400 },
+    { "HMS-", 2, { 0x10, 0x21, 0x41 }, 800 },
+    { "HMS-", 4, { 0x10, 0x22, 0x71 }, 2000 },
+    { "HMT-", 4, { 0x10, 0x32, 0x71 }, 2000 },
+    { "HMT-", 6, { 0x10, 0x33, 0x31 }, 2250 },
+    { "HM-", 1, { 0x10, 0x10, 0x40 }, 400 },
+    { "HM-", 2, { 0x10, 0x11, 0x40 }, 800 },
+    { "HM-", 4, { 0x10, 0x12, 0x30 }, 1500 },
+};
+
+static uint8_t getDcChannelCount(const InverterAbstract& inv)
+{
+    uint8_t count = 0;
+    const byteAssign_t* assign = inv.getByteAssignment();
+    for (uint8_t i = 0; i < inv.getByteAssignmentSize(); i++) {
+        if (assign[i].type == TYPE_DC && assign[i].fieldId == FLD_PDC && assign[i].div != CMD_CALC) {
+            count = std::max<uint8_t>(count, assign[i].ch + 1);
+        }
+    }
+    return count;
+}
+
+static const SimulatedType_t& getSimulatedType(const InverterAbstract& inv)
+{
+    const String name = inv.typeName();
+    const uint8_t channels = getDcChannelCount(inv);
+
+    const SimulatedType_t* match = nullptr;
+    for (auto& type : simulatedTypes) {
+        if (!name.startsWith(type.prefix)) {
+            continue;
+        }
+        match = &type;
+        if (type.dcChannels >= channels) {
+            break;
+        }
+    }
+
+    return (match != nullptr) ? *match : simulatedTypes[0];
+}
+
+void HoymilesRadio_SIM::init()
+{
+    _dtuSerial.u64 = 0;
+    setSeed(esp_random());
+
+    Hoymiles.getMessageOutput()->printf("SIM: Simulated radio, %u%% loss, %u ms latency, %u%% corruption\r\n",
+        _packetLoss, static_cast<unsigned>(_latency), _corruption);
+
+    _isInitialized = true;
+}
+
+void HoymilesRadio_SIM::loop()
+{
+    if (!_isInitialized) {
+        return;
+    }
+
+    const uint32_t now = millis();
+
+    while (!_pending.empty() && static_cast<int32_t>(now - _pending.front().due) >= 0) {
+        fragment_t f = _pending.front().fragment;
+        _pending.pop_front();
+
+        if (!checkFragmentCrc(f)) {
+            Hoymiles.getMessageOutput()->println("Frame kaputt"); // ;-)
+            continue;
+        }
+
+        std::shared_ptr<InverterAbstract> inv = Hoymiles.getInverterByFragment(f);
+        if (nullptr == inv) {
+            Hoymiles.getMessageOutput()->println("Inverter Not found!");
+            continue;
+        }
+
+        Hoymiles.getVerboseMessageOutput()->print("RX SIM --> ");
+        dumpBuf(f.fragment, f.len, false);
+        Hoymiles.getVerboseMessageOutput()->printf("| %d dBm\r\n", f.rssi);
+
+        inv->addRxFragment(f.fragment, f.len, f.channel, f.rssi);
+    }
+
+    handleReceivedPackage();
+
+    if (_commandActive && !_busyFlag) {
+        const uint32_t duration = millis() - _commandStart;
+        _stats.Commands++;
+        _stats.CommandMillisSum += duration;
+        _stats.CommandMillisMax = std::max(_stats.CommandMillisMax, duration);
+        _commandActive = false;
+    }
+
+    if (_stats.Commands > 0 && millis() - _lastStatsOutput > HOYMILES_SIM_STATS_INTERVAL_MS) {
+        Hoymiles.getMessageOutput()->printf("SIM: %u requests, %u retransmit requests, %u fragments (%u dropped, %u corrupted), %u commands (avg %u ms, max %u ms)\r\n",
+            static_cast<unsigned>(_stats.Requests), static_cast<unsigned>(_stats.RetransmitRequests),
+            static_cast<unsigned>(_stats.Fragments), static_cast<unsigned>(_stats.Dropped),
+            static_cast<unsigned>(_stats.Corrupted), static_cast<unsigned>(_stats.Commands),
+            static_cast<unsigned>(_stats.CommandMillisSum / _stats.Commands),
+            static_cast<unsigned>(_stats.CommandMillisMax));
+        _lastStatsOutput = millis();
+    }
+}
+
+void HoymilesRadio_SIM::setPacketLoss(const uint8_t percent)
+{
+    _packetLoss = std::min<uint8_t>(percent, 100);
+}
+
+void HoymilesRadio_SIM::setLatency(const uint32_t latency)
+{
+    _latency = latency;
+}
+
+void HoymilesRadio_SIM::setCorruption(const uint8_t percent)
+{
+    _corruption = std::min<uint8_t>(percent, 100);
+}
+
+void HoymilesRadio_SIM::setSeed(const uint32_t seed)
+{
+    _random = (seed != 0) ? seed : 1;
+}
+
+HoymilesRadio_SIM::Stats HoymilesRadio_SIM::getStats() const
+{
+    return _stats;
+}
+
+void HoymilesRadio_SIM::sendEsbPacket(CommandAbstract& cmd)
+{
+    cmd.incrementSendCount();
+
+    cmd.setRouterAddress(DtuSerial().u64);
+
+    Hoymiles.getVerboseMessageOutput()->printf("TX %s SIM --> ", cmd.getCommandName().c_str());
+    cmd.dumpDataPayload(Hoymiles.getVerboseMessageOutput());
+
+    const uint32_t now = millis();
+    if (!_commandActive) {
+        _commandActive = true;
+        _commandStart = now;
+    }
+
+    _busyFlag = true;
+    _rxTimeout.set(cmd.getTimeout());
+    _stats.Requests++;
+
+    auto inv = Hoymiles.getInverterBySerial(cmd.getTargetAddress());
+    if (nullptr == inv) {
+        return;
+    }
+    inv->recordTx(SIM_CHANNEL);
+
+    if (roll(_packetLoss)) {
+        _stats.Dropped++;
+        return;
+    }
+
+    InverterModel& model = _models[cmd.getTargetAddress()];
+    updateModel(model, *inv, now);
+
+    const uint8_t* payload = cmd.getDataPayload();
+    const uint8_t mainCmd = payload[0] | 0x80;
+
+    switch (payload[0]) {
+    case 0x15:
+        if (cmd.getDataSize() <= 11) {
+            // RequestFrame: resend a single fragment of the last response
+            _stats.RetransmitRequests++;
+            const uint8_t frame = payload[9] & 0x7f;
+            if (frame > 0 && frame <= model.lastResponse.size()) {
+                schedule(model.lastResponse[frame - 1], now + _latency);
+            }
+            break;
+        }
+
+        switch (payload[10]) {
+        case 0x0b: // RealTimeRunData
+            buildResponse(model, payload, mainCmd, getRealTimeRunData(model, *inv));
+            break;
+        case 0x05: { // SystemConfigPara
+            std::vector<uint8_t> data(inv->SystemConfigPara()->getExpectedByteCount(), 0);
+            const uint16_t limit = static_cast<uint16_t>(std::lround(model.limitPercent * 10));
+            data[2] = limit >> 8;
+            data[3] = limit;
+            buildResponse(model, payload, mainCmd, data);
+            break;
+        }
+        case 0x11: // AlarmData, no events
+            buildResponse(model, payload, mainCmd, { 0x00, 0x01 });
+            break;
+        case 0x01: // DevInfoAll
+            buildResponse(model, payload, mainCmd,
+                { 0x27, 0x1C, 0x07, 0xE5, 0x04, 0x01, 0x07, 0x2D, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00 });
+            break;
+        case 0x00: // DevInfoSimple
+            buildResponse(model, payload, mainCmd, getDevInfoSimple(*inv));
+            break;
+        case 0x02: // GridOnProFilePara, a profile without sections
+            buildResponse(model, payload, mainCmd, { 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 });
+            break;
+        default:
+            break;
+        }
+        break;
+
+    case 0x51: // DevControl
+        handleDevControl(model, *inv, payload);
+        buildResponse(model, payload, mainCmd, { payload[10], payload[11] });
+        break;
+
+    default:
+        // e.g. ChannelChange, which is never answered
+        break;
+    }
+}
+
+void HoymilesRadio_SIM::updateModel(InverterModel& model, const InverterAbstract& inv, const uint32_t now)
+{
+    const uint32_t elapsed = (model.lastUpdate > 0) ? now - model.lastUpdate : 0;
+    model.lastUpdate = now;
+
+    model.yieldDay += model.acPower * elapsed / 3600000;
+    model.yieldTotal += model.acPower * elapsed / 3600000;
+
+    float target = 0;
+    if (model.producing) {
+        const float available = getDcChannelCount(inv) * HOYMILES_SIM_CHANNEL_POWER * SIM_EFFICIENCY;
+        target = std::min(available, model.limitPercent * getSimulatedType(inv).maxPower / 100);
+    }
+
+    if (now - model.limitMillis < HOYMILES_SIM_RESPONSE_DELAY_MS) {
+        return;
+    }
+
+    const float step = static_cast<float>(HOYMILES_SIM_RAMP_WATTS_PER_SECOND) * elapsed / 1000;
+    if (model.acPower < target) {
+        model.acPower = std::min(target, model.acPower + step);
+    } else {
+        model.acPower = std::max(target, model.acPower - step);
+    }
+}
+
+std::vector<uint8_t> HoymilesRadio_SIM::getRealTimeRunData(const InverterModel& model, const InverterAbstract& inv) const
+{
+    const byteAssign_t* assign = inv.getByteAssignment();
+    const uint8_t count = inv.getByteAssignmentSize();
+
+    uint8_t size = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (assign[i].div != CMD_CALC) {
+            size = std::max<uint8_t>(size, assign[i].start + assign[i].num);
+        }
+    }
+
+    std::vector<uint8_t> data(size, 0);
+    data[1] = 0x01;
+
+    const uint8_t channels = std::max<uint8_t>(getDcChannelCount(inv), 1);
+    const float dcPower = model.acPower / SIM_EFFICIENCY / channels;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const byteAssign_t& b = assign[i];
+        if (b.div == CMD_CALC) {
+            continue;
+        }
+
+        float value = 0;
+        switch (b.fieldId) {
+        case FLD_UDC:
+            value = 35;
+            break;
+        case FLD_IDC:
+            value = dcPower / 35;
+            break;
+        case FLD_PDC:
+            value = dcPower;
+            break;
+        case FLD_YD:
+            value = model.yieldDay / channels;
+            break;
+        case FLD_YT:
+            value = model.yieldTotal / channels / 1000;
+            break;
+        case FLD_UAC:
+        case FLD_UAC_1N:
+        case FLD_UAC_2N:
+        case FLD_UAC_3N:
+            value = 230;
+            break;
+        case FLD_UAC_12:
+        case FLD_UAC_23:
+        case FLD_UAC_31:
+            value = 400;
+            break;
+        case FLD_IAC:
+            value = model.acPower / 230;
+            break;
+        case FLD_IAC_1:
+        case FLD_IAC_2:
+        case FLD_IAC_3:
+            value = model.acPower / 230 / 3;
+            break;
+        case FLD_PAC:
+            value = model.acPower;
+            break;
+        case FLD_F:
+            value = 50;
+            break;
+        case FLD_PF:
+            value = 1;
+            break;
+        case FLD_T:
+            value = 35;
+            break;
+        default:
+            break;
+        }
+
+        const int32_t raw = std::lround(value * b.div);
+        for (uint8_t j = 0; j < b.num; j++) {
+            data[b.start + j] = static_cast<uint8_t>(raw >> (8 * (b.num - 1 - j)));
+        }
+    }
+
+    return data;
+}
+
+std::vector<uint8_t> HoymilesRadio_SIM::getDevInfoSimple(const InverterAbstract& inv) const
+{
+    const SimulatedType_t& type = getSimulatedType(inv);
+
+    std::vector<uint8_t> data(14, 0);
+    data[2] = type.hwPart[0];
+    data[3] = type.hwPart[1];
+    data[4] = type.hwPart[2];
+    data[7] = 0x01; // hw version 00.01
+    return data;
+}
+
+void HoymilesRadio_SIM::handleDevControl(InverterModel& model, const InverterAbstract& inv, const uint8_t payload[])
+{
+    switch (payload[10]) {
+    case 0x00: // TurnOn
+        model.producing = true;
+        break;
+    case 0x01: // TurnOff
+        model.producing = false;
+        break;
+    case 0x02: // Restart
+        model.producing = true;
+        model.acPower = 0;
+        break;
+    case 0x0b: { // ActivePowerControl
+        const float limit = ((static_cast<uint16_t>(payload[12]) << 8) | payload[13]) / 10.0f;
+        const bool relative = (payload[15] & 0x01) != 0;
+        model.limitPercent = relative ? limit : limit * 100 / getSimulatedType(inv).maxPower;
+        model.limitPercent = std::min(model.limitPercent, 100.0f);
+        break;
+    }
+    default:
+        return;
+    }
+
+    model.limitMillis = millis();
+}
+
+void HoymilesRadio_SIM::buildResponse(InverterModel& model, const uint8_t request[], const uint8_t mainCmd, const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> buf(data);
+    const uint16_t crc = crc16(data.data(), data.size());
+    buf.push_back(crc >> 8);
+    buf.push_back(crc);
+
+    const size_t fragmentCount = (buf.size() + 15) / 16;
+    const uint32_t now = millis();
+
+    model.lastResponse.clear();
+    for (size_t i = 0; i < fragmentCount; i++) {
+        const size_t offset = i * 16;
+        const uint8_t len = std::min<size_t>(16, buf.size() - offset);
+
+        fragment_t f = {};
+        f.fragment[0] = mainCmd;
+        memcpy(&f.fragment[1], &request[1], 8); // inverter and dtu address
+        f.fragment[9] = (i + 1) | ((i + 1 == fragmentCount) ? 0x80 : 0x00);
+        memcpy(&f.fragment[10], &buf[offset], len);
+        f.fragment[10 + len] = crc8(f.fragment, 10 + len);
+        f.len = 10 + len + 1;
+        f.channel = SIM_CHANNEL;
+        f.rssi = SIM_RSSI;
+
+        model.lastResponse.push_back(f);
+        schedule(f, now + _latency + i);
+    }
+}
+
+void HoymilesRadio_SIM::schedule(const fragment_t& fragment, const uint32_t due)
+{
+    _stats.Fragments++;
+
+    if (roll(_packetLoss)) {
+        _stats.Dropped++;
+        return;
+    }
+
+    PendingFragment pending = { due, fragment };
+    if (roll(_corruption)) {
+        const uint32_t pos = random() % pending.fragment.len;
+        pending.fragment.fragment[pos] ^= 1 << (random() % 8);
+        _stats.Corrupted++;
+    }
+
+    _pending.push_back(pending);
+}
+
+bool HoymilesRadio_SIM::roll(const uint8_t percent)
+{
+    return percent > 0 && (random() % 100) < percent;
+}
+
+uint32_t HoymilesRadio_SIM::random()
+{
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return _random;
+}
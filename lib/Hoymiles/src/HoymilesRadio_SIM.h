@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+#include "HoymilesRadio.h"
+#include "commands/CommandAbstract.h"
+#include <deque>
+#include <map>
+#include <vector>
+
+// Simulated radio, used instead of the NRF24 and CMT2300A modules if the
+// firmware is built with -DHOYMILES_RADIO_SIM. Every inverter is attached to
+// this radio and answered by a scripted inverter model, such that the
+// request/retransmit state machine and everything built on top of it can be
+// exercised without inverters. The link drops, delays and corrupts fragments
+// as configured below.
+
+#ifndef HOYMILES_SIM_PACKET_LOSS_PERCENT
+#define HOYMILES_SIM_PACKET_LOSS_PERCENT 0
+#endif
+
+#ifndef HOYMILES_SIM_LATENCY_MS
+#define HOYMILES_SIM_LATENCY_MS 15
+#endif
+
+#ifndef HOYMILES_SIM_CORRUPTION_PERCENT
+#define HOYMILES_SIM_CORRUPTION_PERCENT 0
+#endif
+
+// available DC power of each simulated input
+#ifndef HOYMILES_SIM_CHANNEL_POWER
+#define HOYMILES_SIM_CHANNEL_POWER 300
+#endif
+
+// the AC output follows a new limit after a delay with a constant rate
+#ifndef HOYMILES_SIM_RESPONSE_DELAY_MS
+#define HOYMILES_SIM_RESPONSE_DELAY_MS 1500
+#endif
+
+#ifndef HOYMILES_SIM_RAMP_WATTS_PER_SECOND
+#define HOYMILES_SIM_RAMP_WATTS_PER_SECOND 100
+#endif
+
+#define HOYMILES_SIM_STATS_INTERVAL_MS (60 * 1000)
+
+class HoymilesRadio_SIM : public HoymilesRadio {
+public:
+    struct Stats {
+        uint32_t Requests; // including resends
+        uint32_t RetransmitRequests;
+        uint32_t Fragments; // generated response fragments
+        uint32_t Dropped; // requests and fragments
+        uint32_t Corrupted;
+        uint32_t Commands; // completed commands
+        uint32_t CommandMillisSum; // first transmission until idle
+        uint32_t CommandMillisMax;
+    };
+
+    void init();
+    void loop();
+
+    void setPacketLoss(const uint8_t percent);
+    void setLatency(const uint32_t latency);
+    void setCorruption(const uint8_t percent);
+
+    // losses and corruptions are drawn from a pseudo random sequence, which
+    // is seeded from the hardware random number generator by init(). a fixed
+    // seed makes runs reproducible.
+    void setSeed(const uint32_t seed);
+
+    Stats getStats() const;
+
+private:
+    struct InverterModel {
+        bool producing = true;
+        float limitPercent = 100;
+        uint32_t limitMillis = 0;
+        float acPower = 0;
+        uint32_t lastUpdate = 0;
+        float yieldDay = 0; // Wh
+        float yieldTotal = 0; // Wh
+        std::vector<fragment_t> lastResponse;
+    };
+
+    struct PendingFragment {
+        uint32_t due;
+        fragment_t fragment;
+    };
+
+    void sendEsbPacket(CommandAbstract& cmd);
+
+    void updateModel(InverterModel& model, const InverterAbstract& inv, const uint32_t now);
+    std::vector<uint8_t> getRealTimeRunData(const InverterModel& model, const InverterAbstract& inv) const;
+    std::vector<uint8_t> getDevInfoSimple(const InverterAbstract& inv) const;
+    void handleDevControl(InverterModel& model, const InverterAbstract& inv, const uint8_t payload[]);
+
+    void buildResponse(InverterModel& model, const uint8_t request[], const uint8_t mainCmd, const std::vector<uint8_t>& data);
+    void schedule(const fragment_t& fragment, const uint32_t due);
+    bool roll(const uint8_t percent);
+    uint32_t random();
+
+    std::map<uint64_t, InverterModel> _models;
+    std::deque<PendingFragment> _pending;
+
+    uint8_t _packetLoss = HOYMILES_SIM_PACKET_LOSS_PERCENT;
+    uint32_t _latency = HOYMILES_SIM_LATENCY_MS;
+    uint8_t _corruption = HOYMILES_SIM_CORRUPTION_PERCENT;
+    uint32_t _random = 1; // xorshift32 state, never 0
+
+    Stats _stats = {};
+    bool _commandActive = false;
+    uint32_t _commandStart = 0;
+    uint32_t _lastStatsOutput = 0;
+};
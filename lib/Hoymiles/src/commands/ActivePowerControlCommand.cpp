@@ -47,6 +47,11 @@ String ActivePowerControlCommand::getCommandName() const
     return "ActivePowerControl";
 }
 
+CommandSupersedeGroup ActivePowerControlCommand::getSupersedeGroup() const
+{
+    return CommandSupersedeGroup::PowerLimit;
+}
+
 void ActivePowerControlCommand::setActivePowerLimit(const float limit, const PowerLimitControlType type)
 {
     const uint16_t l = limit * 10;
@@ -79,7 +84,7 @@ bool ActivePowerControlCommand::handleResponse(const fragment_t fragment[], cons
         }
     }
     _inv->SystemConfigPara()->setLastUpdateCommand(millis());
-    _inv->SystemConfigPara()->setLastLimitCommandSuccess(CMD_OK);
+    _inv->SystemConfigPara()->setLastLimitCommandSuccess(CMD_OK, getId());
     return true;
 }
 
@@ -96,5 +101,5 @@ PowerLimitControlType ActivePowerControlCommand::getType()
 
 void ActivePowerControlCommand::gotTimeout()
 {
-    _inv->SystemConfigPara()->setLastLimitCommandSuccess(CMD_NOK);
+    _inv->SystemConfigPara()->setLastLimitCommandSuccess(CMD_NOK, getId());
 }
@@ -11,7 +11,7 @@ Derives from MultiDataCommand
 Command structure:
 * DT: this specific command uses 0x11
 * AlarmId: The last event id received from the inverter or zero in case that no events
-  has been received yet. --> Not Implemented yet
+  has been received yet.
 
 00   01 02 03 04   05 06 07 08   09   10   11   12 13 14 15   16 17   18 19   20 21 22 23   24 25   26   27 28 29 30 31
 -----------------------------------------------------------------------------------------------------------------------
@@ -36,6 +36,18 @@ String AlarmDataCommand::getCommandName() const
     return "AlarmData";
 }
 
+void AlarmDataCommand::setAlarmId(const uint16_t alarmId)
+{
+    _payload[18] = (uint8_t)(alarmId >> 8);
+    _payload[19] = (uint8_t)(alarmId);
+    udpateCRC();
+}
+
+uint16_t AlarmDataCommand::getAlarmId() const
+{
+    return (uint16_t)(_payload[18] << 8) | _payload[19];
+}
+
 bool AlarmDataCommand::handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id)
 {
     // Check CRC of whole payload
@@ -52,6 +64,15 @@ bool AlarmDataCommand::handleResponse(const fragment_t fragment[], const uint8_t
         offs += (fragment[i].len);
     }
     _inv->EventLog()->endAppendFragment();
+
+    // the event counter announced new events, but none were returned after
+    // the requested one. request all events next time.
+    if (getAlarmId() > 0 && _inv->EventLog()->getEntryCount() == 0) {
+        _inv->EventLog()->setLastAlarmRequestSuccess(CMD_NOK);
+        _inv->EventLog()->setLastUpdate(millis());
+        return true;
+    }
+
     _inv->EventLog()->setLastAlarmRequestSuccess(CMD_OK);
     _inv->EventLog()->setLastUpdate(millis());
     return true;
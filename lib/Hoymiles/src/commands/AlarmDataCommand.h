@@ -9,6 +9,10 @@ public:
 
     virtual String getCommandName() const;
 
+    // only events following the given one are returned, 0 fetches all events
+    void setAlarmId(const uint16_t alarmId);
+    uint16_t getAlarmId() const;
+
     virtual bool handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id);
     virtual void gotTimeout();
 };
@@ -28,11 +28,16 @@ Source Address: 80 12 23 04
 */
 #include "CommandAbstract.h"
 #include "crc.h"
+#include <atomic>
 #include <string.h>
 #include "../inverters/InverterAbstract.h"
 
+static std::atomic<uint32_t> nextCommandId = 1;
+
 CommandAbstract::CommandAbstract(InverterAbstract* inv, const uint64_t router_address)
 {
+    _id = nextCommandId++;
+
     memset(_payload, 0, RF_LEN);
     _payload_size = 0;
 
@@ -74,6 +79,23 @@ uint64_t CommandAbstract::getTargetAddress() const
     return _targetAddress;
 }
 
+uint32_t CommandAbstract::getId() const
+{
+    return _id;
+}
+
+CommandSupersedeGroup CommandAbstract::getSupersedeGroup() const
+{
+    return CommandSupersedeGroup::None;
+}
+
+bool CommandAbstract::supersedes(const CommandAbstract& other) const
+{
+    return getSupersedeGroup() != CommandSupersedeGroup::None
+        && getSupersedeGroup() == other.getSupersedeGroup()
+        && getTargetAddress() == other.getTargetAddress();
+}
+
 void CommandAbstract::setRouterAddress(const uint64_t address)
 {
     convertSerialToPacketId(&_payload[5], address);
@@ -11,6 +11,14 @@
 
 class InverterAbstract;
 
+// commands of the same group which target the same inverter supersede each
+// other: only the most recently enqueued one is transmitted.
+enum class CommandSupersedeGroup {
+    None,
+    PowerLimit,
+    PowerState,
+};
+
 class CommandAbstract {
 public:
     explicit CommandAbstract(InverterAbstract* inv, const uint64_t router_address = 0);
@@ -23,6 +31,12 @@ public:
 
     uint64_t getTargetAddress() const;
 
+    // unique (until wrapping around) and increasing with every new command
+    uint32_t getId() const;
+
+    virtual CommandSupersedeGroup getSupersedeGroup() const;
+    bool supersedes(const CommandAbstract& other) const;
+
     void setRouterAddress(const uint64_t address);
     uint64_t getRouterAddress() const;
 
@@ -51,6 +65,7 @@ protected:
     uint8_t _payload_size;
     uint32_t _timeout;
     uint8_t _sendCount;
+    uint32_t _id;
 
     uint64_t _targetAddress;
     uint64_t _routerAddress;
@@ -44,6 +44,16 @@ String PowerControlCommand::getCommandName() const
     return "PowerControl";
 }
 
+CommandSupersedeGroup PowerControlCommand::getSupersedeGroup() const
+{
+    // a restart is not a power state, it neither supersedes nor
+    // is superseded by turning the inverter on or off
+    if (_payload[10] == 0x02) {
+        return CommandSupersedeGroup::None;
+    }
+    return CommandSupersedeGroup::PowerState;
+}
+
 bool PowerControlCommand::handleResponse(const fragment_t fragment[], const uint8_t max_fragment_id)
 {
     if (!DevControlCommand::handleResponse(fragment, max_fragment_id)) {
@@ -51,13 +61,13 @@ bool PowerControlCommand::handleResponse(const fragment_t fragment[], const uint
     }
 
     _inv->PowerCommand()->setLastUpdateCommand(millis());
-    _inv->PowerCommand()->setLastPowerCommandSuccess(CMD_OK);
+    _inv->PowerCommand()->setLastPowerCommandSuccess(CMD_OK, getId());
     return true;
 }
 
 void PowerControlCommand::gotTimeout()
 {
-    _inv->PowerCommand()->setLastPowerCommandSuccess(CMD_NOK);
+    _inv->PowerCommand()->setLastPowerCommandSuccess(CMD_NOK, getId());
 }
 
 void PowerControlCommand::setPowerOn(const bool state)
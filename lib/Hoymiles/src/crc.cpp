@@ -3,33 +3,136 @@
  * Copyright (C) 2022 Thomas Basler and others
  */
 #include "crc.h"
+#include <array>
+#include <cstddef>
+
+#if HOY_CRC_IMPL != HOY_CRC_BITWISE
+
+// the first table processes a single byte. table k processes a byte
+// followed by k zero bytes, which allows to process k + 1 bytes at once.
+template <size_t N>
+static constexpr std::array<std::array<uint8_t, 256>, N> makeCrc8Tables()
+{
+    std::array<std::array<uint8_t, 256>, N> t = {};
+    for (uint16_t i = 0; i < 256; i++) {
+        uint8_t crc = i;
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc << 1) ^ ((crc & 0x80) ? CRC8_POLY : 0x00);
+        }
+        t[0][i] = crc;
+    }
+    for (size_t k = 1; k < N; k++) {
+        for (uint16_t i = 0; i < 256; i++) {
+            t[k][i] = t[0][t[k - 1][i]];
+        }
+    }
+    return t;
+}
+
+template <size_t N>
+static constexpr std::array<std::array<uint16_t, 256>, N> makeCrc16Tables()
+{
+    std::array<std::array<uint16_t, 256>, N> t = {};
+    for (uint16_t i = 0; i < 256; i++) {
+        uint16_t crc = i;
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x0001) ? ((crc >> 1) ^ CRC16_MODBUS_POLYNOM) : (crc >> 1);
+        }
+        t[0][i] = crc;
+    }
+    for (size_t k = 1; k < N; k++) {
+        for (uint16_t i = 0; i < 256; i++) {
+            t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+        }
+    }
+    return t;
+}
+
+static constexpr std::array<uint16_t, 256> makeCrc16Nrf24Table()
+{
+    std::array<uint16_t, 256> t = {};
+    for (uint16_t i = 0; i < 256; i++) {
+        uint16_t crc = i << 8;
+        for (uint8_t b = 0; b < 8; b++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ CRC16_NRF24_POLYNOM) : (crc << 1);
+        }
+        t[i] = crc;
+    }
+    return t;
+}
+
+#if HOY_CRC_IMPL == HOY_CRC_SLICE_BY_4
+#define HOY_CRC_TABLE_COUNT 4
+#else
+#define HOY_CRC_TABLE_COUNT 1
+#endif
+
+static constexpr auto crc8Table = makeCrc8Tables<HOY_CRC_TABLE_COUNT>();
+static constexpr auto crc16Table = makeCrc16Tables<HOY_CRC_TABLE_COUNT>();
+static constexpr auto crc16Nrf24Table = makeCrc16Nrf24Table();
+
+#endif
 
 uint8_t crc8(const uint8_t buf[], const uint8_t len)
 {
     uint8_t crc = CRC8_INIT;
-    for (uint8_t i = 0; i < len; i++) {
+    uint8_t i = 0;
+
+#if HOY_CRC_IMPL == HOY_CRC_SLICE_BY_4
+    for (; i + 4 <= len; i += 4) {
+        crc = crc8Table[3][crc ^ buf[i]]
+            ^ crc8Table[2][buf[i + 1]]
+            ^ crc8Table[1][buf[i + 2]]
+            ^ crc8Table[0][buf[i + 3]];
+    }
+#endif
+
+#if HOY_CRC_IMPL == HOY_CRC_BITWISE
+    for (; i < len; i++) {
         crc ^= buf[i];
         for (uint8_t b = 0; b < 8; b++) {
             crc = (crc << 1) ^ ((crc & 0x80) ? CRC8_POLY : 0x00);
         }
     }
+#else
+    for (; i < len; i++) {
+        crc = crc8Table[0][crc ^ buf[i]];
+    }
+#endif
     return crc;
 }
 
 uint16_t crc16(const uint8_t buf[], const uint8_t len, const uint16_t start)
 {
     uint16_t crc = start;
+    uint8_t i = 0;
+
+#if HOY_CRC_IMPL == HOY_CRC_SLICE_BY_4
+    for (; i + 4 <= len; i += 4) {
+        crc = crc16Table[3][(crc ^ buf[i]) & 0xff]
+            ^ crc16Table[2][(crc >> 8) ^ buf[i + 1]]
+            ^ crc16Table[1][buf[i + 2]]
+            ^ crc16Table[0][buf[i + 3]];
+    }
+#endif
+
+#if HOY_CRC_IMPL == HOY_CRC_BITWISE
     uint8_t shift = 0;
 
-    for (uint8_t i = 0; i < len; i++) {
+    for (; i < len; i++) {
         crc = crc ^ buf[i];
         for (uint8_t bit = 0; bit < 8; bit++) {
             shift = (crc & 0x0001);
             crc = crc >> 1;
             if (shift != 0)
-                crc = crc ^ 0xA001;
+                crc = crc ^ CRC16_MODBUS_POLYNOM;
         }
     }
+#else
+    for (; i < len; i++) {
+        crc = (crc >> 8) ^ crc16Table[0][(crc ^ buf[i]) & 0xff];
+    }
+#endif
     return crc;
 }
 
@@ -40,11 +143,23 @@ uint16_t crc16nrf24(const uint8_t buf[], const uint16_t lenBits, const uint16_t
 
     for (uint16_t bit = startBit; bit < lenBits; bit++) {
         idx = bit & 0x07;
-        if (0 == idx)
+        if (0 == idx) {
+#if HOY_CRC_IMPL != HOY_CRC_BITWISE
+            // process whole bytes at once, the packet is not byte aligned
+            // on air, hence the bitwise processing of leading and trailing bits
+            while (bit + 8 <= lenBits) {
+                crc = (crc << 8) ^ crc16Nrf24Table[(crc >> 8) ^ buf[bit >> 3]];
+                bit += 8;
+            }
+            if (bit >= lenBits) {
+                break;
+            }
+#endif
             val = buf[(bit >> 3)];
+        }
         crc ^= 0x8000 & (val << (8 + idx));
         crc = (crc & 0x8000) ? ((crc << 1) ^ CRC16_NRF24_POLYNOM) : (crc << 1);
     }
 
     return crc;
-}
\ No newline at end of file
+}
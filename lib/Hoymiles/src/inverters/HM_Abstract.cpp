@@ -56,6 +56,7 @@ bool HM_Abstract::sendAlarmLogRequest(const bool force)
         }
     }
 
+    const uint8_t lastAlarmLogCnt = _lastAlarmLogCnt;
     _lastAlarmLogCnt = (uint8_t)Statistics()->getChannelFieldValue(TYPE_INV, CH0, FLD_EVT_LOG);
 
     time_t now;
@@ -63,6 +64,12 @@ bool HM_Abstract::sendAlarmLogRequest(const bool force)
 
     auto cmd = _radio->prepareCommand<AlarmDataCommand>(this);
     cmd->setTime(now);
+
+    // only fetch the events added since the previous request, if that one
+    // succeeded. otherwise lastAlarmLogCnt may not have been received.
+    if (!force && EventLog()->getLastAlarmRequestSuccess() == CMD_OK) {
+        cmd->setAlarmId(lastAlarmLogCnt);
+    }
     EventLog()->setLastAlarmRequestSuccess(CMD_PENDING);
     _radio->enqueCommand(cmd);
 
@@ -122,10 +129,6 @@ bool HM_Abstract::sendActivePowerControlRequest(float limit, const PowerLimitCon
         return false;
     }
 
-    if (CMD_PENDING == SystemConfigPara()->getLastLimitCommandSuccess()) {
-        return false;
-    }
-
     if (type == PowerLimitControlType::RelativNonPersistent || type == PowerLimitControlType::RelativPersistent) {
         limit = min<float>(100, limit);
     }
@@ -135,7 +138,7 @@ bool HM_Abstract::sendActivePowerControlRequest(float limit, const PowerLimitCon
 
     auto cmd = _radio->prepareCommand<ActivePowerControlCommand>(this);
     cmd->setActivePowerLimit(limit, type);
-    SystemConfigPara()->setLastLimitCommandSuccess(CMD_PENDING);
+    SystemConfigPara()->setLastLimitCommandSuccess(CMD_PENDING, cmd->getId());
     _radio->enqueCommand(cmd);
 
     return true;
@@ -152,10 +155,6 @@ bool HM_Abstract::sendPowerControlRequest(const bool turnOn)
         return false;
     }
 
-    if (CMD_PENDING == PowerCommand()->getLastPowerCommandSuccess()) {
-        return false;
-    }
-
     if (turnOn) {
         _powerState = 1;
     } else {
@@ -164,7 +163,7 @@ bool HM_Abstract::sendPowerControlRequest(const bool turnOn)
 
     auto cmd = _radio->prepareCommand<PowerControlCommand>(this);
     cmd->setPowerOn(turnOn);
-    PowerCommand()->setLastPowerCommandSuccess(CMD_PENDING);
+    PowerCommand()->setLastPowerCommandSuccess(CMD_PENDING, cmd->getId());
     _radio->enqueCommand(cmd);
 
     return true;
@@ -180,7 +179,7 @@ bool HM_Abstract::sendRestartControlRequest()
 
     auto cmd = _radio->prepareCommand<PowerControlCommand>(this);
     cmd->setRestart();
-    PowerCommand()->setLastPowerCommandSuccess(CMD_PENDING);
+    PowerCommand()->setLastPowerCommandSuccess(CMD_PENDING, cmd->getId());
     _radio->enqueCommand(cmd);
 
     return true;
@@ -185,8 +185,24 @@ void InverterAbstract::clearRxFragmentBuffer()
     _rxFragmentRetransmitCnt = 0;
 }
 
-void InverterAbstract::addRxFragment(const uint8_t fragment[], const uint8_t len)
+void InverterAbstract::addRxFragment(const uint8_t fragment[], const uint8_t len, const uint8_t channel, const int8_t rssi)
 {
+    _linkRoundRxFragments++;
+
+    LinkQualityChannel_t* lq = getLinkQualityChannel(channel, true);
+    if (lq != nullptr) {
+        lq->RxFragments++;
+        lq->RssiSum += rssi;
+    }
+
+    uint8_t bucket = 0;
+    while (bucket < HOY_LINK_RSSI_BUCKET_COUNT - 1
+        && rssi >= HOY_LINK_RSSI_BUCKET_BASE_DBM + bucket * HOY_LINK_RSSI_BUCKET_WIDTH_DBM) {
+        bucket++;
+    }
+    LinkQuality.RssiHistogram[bucket]++;
+    LinkQuality.LastRssi = rssi;
+
     if (len < 11) {
         Hoymiles.getMessageOutput()->printf("FATAL: (%s, %d) fragment too short\r\n", __FILE__, __LINE__);
         return;
@@ -273,6 +289,105 @@ uint8_t InverterAbstract::verifyAllFragments(CommandAbstract& cmd)
     return FRAGMENT_OK;
 }
 
+uint8_t InverterAbstract::getMissingFragments(uint8_t ids[MAX_RF_FRAGMENT_COUNT]) const
+{
+    uint8_t count = 0;
+
+    // If the last fragment is known, all fragments before it have to be present.
+    // Otherwise all fragments up to the highest one received and the one after it.
+    const uint8_t checkCount = _rxFragmentMaxPacketId > 0 ? _rxFragmentMaxPacketId - 1 : _rxFragmentLastPacketId;
+    for (uint8_t i = 0; i < checkCount; i++) {
+        if (!_rxFragmentBuffer[i].wasReceived) {
+            ids[count++] = i + 1;
+        }
+    }
+
+    if (_rxFragmentMaxPacketId == 0 && _rxFragmentLastPacketId + 1 < MAX_RF_FRAGMENT_COUNT) {
+        ids[count++] = _rxFragmentLastPacketId + 1;
+    }
+
+    return count;
+}
+
+InverterAbstract::LinkQualityChannel_t* InverterAbstract::getLinkQualityChannel(const uint8_t channel, const bool create)
+{
+    for (uint8_t i = 0; i < LinkQuality.ChannelCount; i++) {
+        if (LinkQuality.Channels[i].Channel == channel) {
+            return &LinkQuality.Channels[i];
+        }
+    }
+
+    if (!create || LinkQuality.ChannelCount >= HOY_LINK_CHANNEL_COUNT) {
+        return nullptr;
+    }
+
+    LinkQualityChannel_t& lq = LinkQuality.Channels[LinkQuality.ChannelCount++];
+    lq = {};
+    lq.Channel = channel;
+    lq.SuccessRate = 0.5;
+    return &lq;
+}
+
+void InverterAbstract::recordTx(const uint8_t channel)
+{
+    static_assert(HOY_LINK_CHANNEL_COUNT <= 8, "_linkRoundChannels is a bit mask of 8 channels");
+
+    LinkQualityChannel_t* lq = getLinkQualityChannel(channel, true);
+    if (lq == nullptr) {
+        return;
+    }
+
+    lq->TxCount++;
+    _linkRoundChannels |= 1 << (lq - LinkQuality.Channels.data());
+}
+
+void InverterAbstract::finishLinkRound()
+{
+    if (_linkRoundChannels == 0) {
+        return;
+    }
+
+    const bool answered = _linkRoundRxFragments > 0;
+
+    for (uint8_t i = 0; i < LinkQuality.ChannelCount; i++) {
+        if (!(_linkRoundChannels & (1 << i))) {
+            continue;
+        }
+
+        LinkQualityChannel_t& lq = LinkQuality.Channels[i];
+        if (answered) {
+            lq.TxAnswered++;
+        }
+        lq.SuccessRate += ((answered ? 1.0f : 0.0f) - lq.SuccessRate) / 8;
+    }
+
+    _linkLastRoundAnswered = answered;
+    _linkRoundChannels = 0;
+    _linkRoundRxFragments = 0;
+}
+
+uint8_t InverterAbstract::selectTxChannel(const uint8_t channels[], const uint8_t count, const uint8_t fallback)
+{
+    if (!_linkLastRoundAnswered || ++_linkExploreCounter >= HOY_LINK_EXPLORE_INTERVAL) {
+        _linkExploreCounter = 0;
+        return fallback;
+    }
+
+    const LinkQualityChannel_t* fallbackLq = getLinkQualityChannel(fallback, false);
+    uint8_t best = fallback;
+    float bestRate = fallbackLq != nullptr ? fallbackLq->SuccessRate : 0.5;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const LinkQualityChannel_t* lq = getLinkQualityChannel(channels[i], false);
+        if (lq != nullptr && lq->SuccessRate > bestRate) {
+            best = channels[i];
+            bestRate = lq->SuccessRate;
+        }
+    }
+
+    return best;
+}
+
 void InverterAbstract::performDailyTask()
 {
     // Have to reset the offets first, otherwise it will
@@ -290,4 +405,8 @@ void InverterAbstract::performDailyTask()
 void InverterAbstract::resetRadioStats()
 {
     RadioStats = {};
+    LinkQuality = {};
+    _linkRoundChannels = 0;
+    _linkRoundRxFragments = 0;
+    _linkLastRoundAnswered = true;
 }
@@ -11,6 +11,7 @@
 #include "HoymilesRadio.h"
 #include "types.h"
 #include <Arduino.h>
+#include <array>
 #include <cstdint>
 #include <list>
 
@@ -26,6 +27,19 @@ enum {
 
 #define MAX_RF_FRAGMENT_COUNT 13
 
+// number of distinct radio channels for which link statistics are kept
+#define HOY_LINK_CHANNEL_COUNT 8
+
+// histogram of the RSSI of received fragments. bucket i counts fragments below
+// (HOY_LINK_RSSI_BUCKET_BASE_DBM + i * HOY_LINK_RSSI_BUCKET_WIDTH_DBM), the last one counts all others.
+#define HOY_LINK_RSSI_BUCKET_COUNT 6
+#define HOY_LINK_RSSI_BUCKET_BASE_DBM -90
+#define HOY_LINK_RSSI_BUCKET_WIDTH_DBM 10
+
+// every n-th request is sent on the next channel of the hopping sequence
+// instead of the best one, such that the stats of all channels stay current
+#define HOY_LINK_EXPLORE_INTERVAL 8
+
 class CommandAbstract;
 
 class InverterAbstract {
@@ -62,9 +76,20 @@ public:
     bool getClearEventlogOnMidnight() const;
 
     void clearRxFragmentBuffer();
-    void addRxFragment(const uint8_t fragment[], const uint8_t len);
+    void addRxFragment(const uint8_t fragment[], const uint8_t len, const uint8_t channel, const int8_t rssi);
     uint8_t verifyAllFragments(CommandAbstract& cmd);
 
+    // Fills ids with all fragment ids which have to be re-requested, returns their count
+    uint8_t getMissingFragments(uint8_t ids[MAX_RF_FRAGMENT_COUNT]) const;
+
+    // Link quality: record a request sent on the given channel
+    void recordTx(const uint8_t channel);
+    // Link quality: called at the end of each rx period, rates the channels used since the last call
+    void finishLinkRound();
+    // Returns the channel out of channels with the best success rate or the fallback
+    // channel if the previous request was not answered or it is time to explore
+    uint8_t selectTxChannel(const uint8_t channels[], const uint8_t count, const uint8_t fallback);
+
     void performDailyTask();
 
     void resetRadioStats();
@@ -87,8 +112,38 @@ public:
 
         // RX Fail Corrupt Data
         uint32_t RxFailCorruptData;
+
+        // TX Superseded (queued commands dropped in favour of a newer one)
+        uint32_t TxSuperseded;
     } RadioStats = {};
 
+    struct LinkQualityChannel_t {
+        uint8_t Channel;
+
+        // Requests sent on this channel
+        uint32_t TxCount;
+
+        // Requests sent on this channel which got at least one fragment as answer
+        uint32_t TxAnswered;
+
+        // Fragments received on this channel
+        uint32_t RxFragments;
+
+        // Sum of the RSSI of all fragments received on this channel
+        int32_t RssiSum;
+
+        // Exponentially weighted success rate of the requests (0..1)
+        float SuccessRate;
+    };
+
+    struct {
+        std::array<LinkQualityChannel_t, HOY_LINK_CHANNEL_COUNT> Channels;
+        uint8_t ChannelCount;
+
+        std::array<uint32_t, HOY_LINK_RSSI_BUCKET_COUNT> RssiHistogram;
+        int8_t LastRssi;
+    } LinkQuality = {};
+
     virtual bool sendStatsRequest() = 0;
     virtual bool sendAlarmLogRequest(const bool force = false) = 0;
     virtual bool sendDevInfoRequest() = 0;
@@ -114,6 +169,8 @@ protected:
     HoymilesRadio* _radio;
 
 private:
+    LinkQualityChannel_t* getLinkQualityChannel(const uint8_t channel, const bool create);
+
     serial_u _serial;
     String _serialString;
     char _name[MAX_NAME_LENGTH] = "";
@@ -122,6 +179,12 @@ private:
     uint8_t _rxFragmentLastPacketId = 0;
     uint8_t _rxFragmentRetransmitCnt = 0;
 
+    // bit i is set if a request was sent on LinkQuality.Channels[i] during the current round
+    uint8_t _linkRoundChannels = 0;
+    uint8_t _linkRoundRxFragments = 0;
+    bool _linkLastRoundAnswered = true;
+    uint8_t _linkExploreCounter = 0;
+
     bool _enablePolling = true;
     bool _enableCommands = true;
 
@@ -264,30 +264,38 @@ void AlarmLogParser::getLogEntry(const uint8_t entryId, AlarmLogEntry_t& entry,
         entry.EndTime += (endTimeOffset + timezoneOffset);
     }
 
+    entry.Message = getMessageText(entry.MessageId, locale);
+}
+
+const char* AlarmLogParser::getMessageText(const uint16_t messageId, const AlarmMessageLocale_t locale) const
+{
+    const char* message;
     switch (locale) {
     case AlarmMessageLocale_t::DE:
-        entry.Message = "Unbekannt";
+        message = "Unbekannt";
         break;
     case AlarmMessageLocale_t::FR:
-        entry.Message = "Inconnu";
+        message = "Inconnu";
         break;
     default:
-        entry.Message = "Unknown";
+        message = "Unknown";
     }
 
     for (auto& msg : _alarmMessages) {
-        if (msg.MessageId == entry.MessageId) {
+        if (msg.MessageId == messageId) {
             if (msg.InverterType == _messageType) {
-                entry.Message = getLocaleMessage(&msg, locale);
+                message = getLocaleMessage(&msg, locale);
                 break;
             } else if (msg.InverterType == AlarmMessageType_t::ALL) {
-                entry.Message = getLocaleMessage(&msg, locale);
+                message = getLocaleMessage(&msg, locale);
             }
         }
     }
+
+    return message;
 }
 
-String AlarmLogParser::getLocaleMessage(const AlarmMessage_t* msg, const AlarmMessageLocale_t locale) const
+const char* AlarmLogParser::getLocaleMessage(const AlarmMessage_t* msg, const AlarmMessageLocale_t locale) const
 {
     if (locale == AlarmMessageLocale_t::DE) {
         return msg->Message_de[0] != '\0' ? msg->Message_de : msg->Message_en;
@@ -45,14 +45,18 @@ public:
     uint8_t getEntryCount() const;
     void getLogEntry(const uint8_t entryId, AlarmLogEntry_t& entry, const AlarmMessageLocale_t locale = AlarmMessageLocale_t::EN);
 
+    // returns the message from the (flash resident) message table
+    const char* getMessageText(const uint16_t messageId, const AlarmMessageLocale_t locale = AlarmMessageLocale_t::EN) const;
+
     void setLastAlarmRequestSuccess(const LastCommandSuccess status);
     LastCommandSuccess getLastAlarmRequestSuccess() const;
 
     void setMessageType(const AlarmMessageType_t type);
 
-private:
     static int getTimezoneOffset();
-    String getLocaleMessage(const AlarmMessage_t* msg, const AlarmMessageLocale_t locale) const;
+
+private:
+    const char* getLocaleMessage(const AlarmMessage_t* msg, const AlarmMessageLocale_t locale) const;
 
     uint8_t _payloadAlarmLog[ALARM_LOG_PAYLOAD_SIZE];
     uint8_t _alarmLogLength = 0;
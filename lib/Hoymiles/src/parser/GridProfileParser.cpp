@@ -21,6 +21,7 @@ The number of values depends on the respective section and its version. After th
 */
 #include "GridProfileParser.h"
 #include "../Hoymiles.h"
+#include "../crc.h"
 #include <cstring>
 #include <frozen/map.h>
 #include <frozen/string.h>
@@ -372,6 +373,7 @@ void GridProfileParser::clearBuffer()
 {
     memset(_payloadGridProfile, 0, GRID_PROFILE_SIZE);
     _gridProfileLength = 0;
+    _profile.reset();
 }
 
 void GridProfileParser::appendFragment(const uint8_t offset, const uint8_t* payload, const uint8_t len)
@@ -382,6 +384,17 @@ void GridProfileParser::appendFragment(const uint8_t offset, const uint8_t* payl
     }
     memcpy(&_payloadGridProfile[offset], payload, len);
     _gridProfileLength += len;
+    _profile.reset();
+}
+
+void GridProfileParser::setRawData(const uint8_t* data, const uint8_t len)
+{
+    beginAppendFragment();
+    clearBuffer();
+    if (len > 0) {
+        appendFragment(0, data, len);
+    }
+    endAppendFragment();
 }
 
 String GridProfileParser::getProfileName() const
@@ -414,9 +427,33 @@ std::vector<uint8_t> GridProfileParser::getRawData() const
     return ret;
 }
 
-std::list<GridProfileSection_t> GridProfileParser::getProfile() const
+uint16_t GridProfileParser::getProfileId() const
+{
+    return (_payloadGridProfile[0] << 8) | _payloadGridProfile[1];
+}
+
+uint16_t GridProfileParser::getChecksum() const
+{
+    HOY_SEMAPHORE_TAKE();
+    const uint16_t checksum = crc16(_payloadGridProfile, _gridProfileLength);
+    HOY_SEMAPHORE_GIVE();
+    return checksum;
+}
+
+std::shared_ptr<const GridProfileSections_t> GridProfileParser::getProfile() const
+{
+    HOY_SEMAPHORE_TAKE();
+    if (!_profile) {
+        _profile = decode();
+    }
+    auto profile = _profile;
+    HOY_SEMAPHORE_GIVE();
+    return profile;
+}
+
+std::shared_ptr<const GridProfileSections_t> GridProfileParser::decode() const
 {
-    std::list<GridProfileSection_t> l;
+    auto l = std::make_shared<GridProfileSections_t>();
 
     if (_gridProfileLength > 4) {
         uint16_t pos = 4;
@@ -428,6 +465,8 @@ std::list<GridProfileSection_t> GridProfileParser::getProfile() const
             pos += 2;
 
             GridProfileSection_t section;
+            section.SectionId = section_id;
+            section.SectionVersion = section_version;
             try {
                 section.SectionName = profileSection.at(section_id).data();
             } catch (const std::out_of_range&) {
@@ -435,12 +474,12 @@ std::list<GridProfileSection_t> GridProfileParser::getProfile() const
                 break;
             }
 
-            if (section_start == -1) {
+            if (section_start == -1 || section_size == 0) {
                 section.SectionName = "Unknown";
                 break;
             }
 
-            for (uint8_t val_id = 0; val_id < section_size; val_id++) {
+            for (uint8_t val_id = 0; val_id < section_size && pos + 1 < _gridProfileLength; val_id++) {
                 auto itemDefinition = itemDefinitions.at(_profileValues[section_start + val_id].ItemDefinition);
 
                 float value = (int16_t)((_payloadGridProfile[pos] << 8) | _payloadGridProfile[pos + 1]);
@@ -455,9 +494,9 @@ std::list<GridProfileSection_t> GridProfileParser::getProfile() const
                 pos += 2;
             }
 
-            l.push_back(section);
+            l->push_back(section);
 
-        } while (pos < _gridProfileLength);
+        } while (pos + 1 < _gridProfileLength);
     }
 
     return l;
@@ -2,6 +2,7 @@
 #pragma once
 #include "Parser.h"
 #include <list>
+#include <memory>
 
 #define GRID_PROFILE_SIZE 141
 #define PROFILE_TYPE_COUNT 10
@@ -19,39 +20,55 @@ struct GridProfileValue_t {
     uint8_t ItemDefinition;
 };
 
+// names and units point to the (flash resident) definition tables
 struct GridProfileItem_t {
-    String Name;
-    String Unit;
+    const char* Name;
+    const char* Unit;
     float Value;
 };
 
 struct GridProfileSection_t {
-    String SectionName;
+    uint8_t SectionId;
+    uint8_t SectionVersion;
+    const char* SectionName;
     std::list<GridProfileItem_t> items;
 };
 
+typedef std::list<GridProfileSection_t> GridProfileSections_t;
+
 class GridProfileParser : public Parser {
 public:
     GridProfileParser();
     void clearBuffer();
     void appendFragment(const uint8_t offset, const uint8_t* payload, const uint8_t len);
 
+    // replaces the profile, e.g. by one restored from a previous session
+    void setRawData(const uint8_t* data, const uint8_t len);
+
     String getProfileName() const;
     String getProfileVersion() const;
+    uint16_t getProfileId() const;
 
     std::vector<uint8_t> getRawData() const;
 
-    std::list<GridProfileSection_t> getProfile() const;
+    // crc16 of the raw profile, equal for identical profiles
+    uint16_t getChecksum() const;
+
+    // the profile is decoded on first use and cached until it changes
+    std::shared_ptr<const GridProfileSections_t> getProfile() const;
 
     bool containsValidData() const;
 
 private:
     static uint8_t getSectionSize(const uint8_t section_id, const uint8_t section_version);
     static int16_t getSectionStart(const uint8_t section_id, const uint8_t section_version);
+    std::shared_ptr<const GridProfileSections_t> decode() const;
 
     uint8_t _payloadGridProfile[GRID_PROFILE_SIZE] = {};
     uint8_t _gridProfileLength = 0;
 
+    mutable std::shared_ptr<const GridProfileSections_t> _profile;
+
     static const std::array<const ProfileType_t, PROFILE_TYPE_COUNT> _profileTypes;
     static const std::array<const GridProfileValue_t, SECTION_VALUE_COUNT> _profileValues;
 };
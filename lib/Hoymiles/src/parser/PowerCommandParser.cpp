@@ -4,9 +4,14 @@
  */
 #include "PowerCommandParser.h"
 
-void PowerCommandParser::setLastPowerCommandSuccess(const LastCommandSuccess status)
+void PowerCommandParser::setLastPowerCommandSuccess(const LastCommandSuccess status, const uint32_t commandId)
 {
+    if (static_cast<int32_t>(commandId - _lastPowerCommandId) < 0) {
+        return;
+    }
+
     _lastLimitCommandSuccess = status;
+    _lastPowerCommandId = commandId;
 }
 
 LastCommandSuccess PowerCommandParser::getLastPowerCommandSuccess() const
@@ -14,6 +19,11 @@ LastCommandSuccess PowerCommandParser::getLastPowerCommandSuccess() const
     return _lastLimitCommandSuccess;
 }
 
+uint32_t PowerCommandParser::getLastPowerCommandId() const
+{
+    return _lastPowerCommandId;
+}
+
 uint32_t PowerCommandParser::getLastUpdateCommand() const
 {
     return _lastUpdateCommand;
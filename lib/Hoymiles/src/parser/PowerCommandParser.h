@@ -4,13 +4,17 @@
 
 class PowerCommandParser : public Parser {
 public:
-    void setLastPowerCommandSuccess(const LastCommandSuccess status);
+    // the status refers to the command with the given id. the status of
+    // commands which were superseded by a newer command is ignored.
+    void setLastPowerCommandSuccess(const LastCommandSuccess status, const uint32_t commandId);
     LastCommandSuccess getLastPowerCommandSuccess() const;
+    uint32_t getLastPowerCommandId() const;
     uint32_t getLastUpdateCommand() const;
     void setLastUpdateCommand(const uint32_t lastUpdate);
 
 private:
     LastCommandSuccess _lastLimitCommandSuccess = CMD_OK; // Set to OK because we have to assume nothing is done at startup
+    uint32_t _lastPowerCommandId = 0;
 
     uint32_t _lastUpdateCommand = 0;
 };
\ No newline at end of file
@@ -58,9 +58,14 @@ void SystemConfigParaParser::setLimitPercent(const float value)
     HOY_SEMAPHORE_GIVE();
 }
 
-void SystemConfigParaParser::setLastLimitCommandSuccess(const LastCommandSuccess status)
+void SystemConfigParaParser::setLastLimitCommandSuccess(const LastCommandSuccess status, const uint32_t commandId)
 {
+    if (static_cast<int32_t>(commandId - _lastLimitCommandId) < 0) {
+        return;
+    }
+
     _lastLimitCommandSuccess = status;
+    _lastLimitCommandId = commandId;
 }
 
 LastCommandSuccess SystemConfigParaParser::getLastLimitCommandSuccess() const
@@ -68,6 +73,11 @@ LastCommandSuccess SystemConfigParaParser::getLastLimitCommandSuccess() const
     return _lastLimitCommandSuccess;
 }
 
+uint32_t SystemConfigParaParser::getLastLimitCommandId() const
+{
+    return _lastLimitCommandId;
+}
+
 uint32_t SystemConfigParaParser::getLastUpdateCommand() const
 {
     return _lastUpdateCommand;
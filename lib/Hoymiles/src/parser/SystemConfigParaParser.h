@@ -13,8 +13,11 @@ public:
     float getLimitPercent() const;
     void setLimitPercent(const float value);
 
-    void setLastLimitCommandSuccess(const LastCommandSuccess status);
+    // the status refers to the command with the given id. the status of
+    // commands which were superseded by a newer command is ignored.
+    void setLastLimitCommandSuccess(const LastCommandSuccess status, const uint32_t commandId);
     LastCommandSuccess getLastLimitCommandSuccess() const;
+    uint32_t getLastLimitCommandId() const;
     uint32_t getLastUpdateCommand() const;
     void setLastUpdateCommand(const uint32_t lastUpdate);
 
@@ -31,6 +34,7 @@ private:
     uint8_t _payloadLength;
 
     LastCommandSuccess _lastLimitCommandSuccess = CMD_OK; // Set to OK because we have to assume nothing is done at startup
+    uint32_t _lastLimitCommandId = 0;
     LastCommandSuccess _lastLimitRequestSuccess = CMD_NOK; // Set to NOK to fetch at startup
 
     uint32_t _lastUpdateCommand = 0;
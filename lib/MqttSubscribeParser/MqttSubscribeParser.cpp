@@ -3,169 +3,231 @@
  * Copyright (C) 2022 Thomas Basler and others
  */
 #include "MqttSubscribeParser.h"
+#include <algorithm>
+#include <cstring>
 
 void MqttSubscribeParser::register_callback(const std::string& topic, uint8_t qos, const espMqttClientTypes::OnMessageCallback& cb)
 {
-    cb_filter_t cbf;
-    cbf.topic = topic;
-    cbf.qos = qos;
-    cbf.cb = cb;
-    _callbacks.push_back(cbf);
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    Subscription sub;
+    sub.filter.topic = topic;
+    sub.filter.qos = qos;
+    sub.filter.cb = cb;
+    sub.sequence = _nextSequence++;
+    _subscriptions.push_back(sub);
+
+    // invalid subscriptions are still forwarded to the broker, but never match
+    if (!is_valid_subscription(topic)) {
+        return;
+    }
+
+    const Subscription* subscription = &_subscriptions.back();
+    TopicNode* node = &_root;
+    std::string_view rest(topic);
+
+    while (true) {
+        const size_t pos = rest.find('/');
+        const std::string_view level = rest.substr(0, pos);
+
+        if (level == "#") {
+            node->hash.push_back(subscription);
+            return;
+        }
+
+        if (level == "+") {
+            if (!node->plus) {
+                node->plus = std::make_unique<TopicNode>();
+            }
+            node = node->plus.get();
+        } else {
+            auto it = node->children.find(level);
+            if (it == node->children.end()) {
+                it = node->children.emplace(std::string(level), std::make_unique<TopicNode>()).first;
+            }
+            node = it->second.get();
+        }
+
+        if (pos == std::string_view::npos) {
+            node->exact.push_back(subscription);
+            return;
+        }
+
+        rest = rest.substr(pos + 1);
+    }
 }
 
 void MqttSubscribeParser::unregister_callback(const std::string& topic)
 {
-    for (auto it = _callbacks.begin(); it != _callbacks.end();) {
-        if ((*it).topic == topic) {
-            it = _callbacks.erase(it);
-        } else {
-            ++it;
-        }
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (is_valid_subscription(topic)) {
+        remove(_root, topic, topic);
     }
+
+    _subscriptions.remove_if([&topic](const Subscription& sub) {
+        return sub.filter.topic == topic;
+    });
 }
 
 void MqttSubscribeParser::handle_message(const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, size_t len, size_t index, size_t total)
 {
-    bool result = false;
-    for (const auto& cb : _callbacks) {
-        if (mosquitto_topic_matches_sub(cb.topic.c_str(), topic, &result) == MOSQ_ERR_SUCCESS) {
-            if (result) {
-                cb.cb(properties, topic, payload, len, index, total);
-            }
+    // topics must not be empty or contain wildcards
+    if (topic == nullptr || topic[0] == 0 || strpbrk(topic, "+#") != nullptr) {
+        return;
+    }
+
+    std::vector<espMqttClientTypes::OnMessageCallback> callbacks;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::vector<const Subscription*> matches;
+        match(_root, topic, true, matches);
+
+        std::sort(matches.begin(), matches.end(), [](const Subscription* a, const Subscription* b) {
+            return a->sequence < b->sequence;
+        });
+
+        // the callbacks may (un)subscribe, hence they are called without
+        // holding the lock and must not reference the subscriptions.
+        callbacks.reserve(matches.size());
+        for (auto sub : matches) {
+            callbacks.push_back(sub->filter.cb);
         }
     }
+
+    for (const auto& cb : callbacks) {
+        cb(properties, topic, payload, len, index, total);
+    }
+}
+
+void MqttSubscribeParser::for_each_subscription(const std::function<void(const std::string& topic, uint8_t qos)>& fn)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (const auto& sub : _subscriptions) {
+        fn(sub.filter.topic, sub.filter.qos);
+    }
 }
 
-std::vector<cb_filter_t> MqttSubscribeParser::get_callbacks()
+bool MqttSubscribeParser::TopicNode::empty() const
 {
-    return _callbacks;
+    return children.empty() && !plus && hash.empty() && exact.empty();
 }
 
-/* Does a topic match a subscription? */
-int MqttSubscribeParser::mosquitto_topic_matches_sub(const char* sub, const char* topic, bool* result)
+bool MqttSubscribeParser::is_valid_subscription(std::string_view topic)
 {
-    size_t spos;
+    if (topic.empty()) {
+        return false;
+    }
+
+    while (true) {
+        const size_t pos = topic.find('/');
+        const std::string_view level = topic.substr(0, pos);
 
-    if (!result)
-        return MOSQ_ERR_INVAL;
-    *result = false;
+        // wildcards must occupy a whole level, '#' must be the last one
+        if (level != "+" && level != "#" && level.find_first_of("+#") != std::string_view::npos) {
+            return false;
+        }
+
+        if (pos == std::string_view::npos) {
+            return true;
+        }
 
-    if (!sub || !topic || sub[0] == 0 || topic[0] == 0) {
-        return MOSQ_ERR_INVAL;
+        if (level == "#") {
+            return false;
+        }
+
+        topic = topic.substr(pos + 1);
     }
+}
 
-    if ((sub[0] == '$' && topic[0] != '$')
-        || (topic[0] == '$' && sub[0] != '$')) {
+void MqttSubscribeParser::remove_subscription(std::vector<const Subscription*>& subscriptions, const std::string& topic)
+{
+    subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+                            [&topic](const Subscription* sub) { return sub->filter.topic == topic; }),
+        subscriptions.end());
+}
+
+void MqttSubscribeParser::match(const TopicNode& node, std::string_view topic, bool first, std::vector<const Subscription*>& matches) const
+{
+    // wildcards on the first level do not match topics starting with '$'
+    const bool wildcards = !first || topic[0] != '$';
 
-        return MOSQ_ERR_SUCCESS;
+    if (wildcards) {
+        matches.insert(matches.end(), node.hash.begin(), node.hash.end());
     }
 
-    spos = 0;
+    const size_t pos = topic.find('/');
+    const std::string_view level = topic.substr(0, pos);
+
+    const TopicNode* next[2] = { nullptr, nullptr };
 
-    while (sub[0] != 0) {
-        if (topic[0] == '+' || topic[0] == '#') {
-            return MOSQ_ERR_INVAL;
+    auto it = node.children.find(level);
+    if (it != node.children.end()) {
+        next[0] = it->second.get();
+    }
+    if (wildcards) {
+        next[1] = node.plus.get();
+    }
+
+    for (auto n : next) {
+        if (n == nullptr) {
+            continue;
         }
-        if (sub[0] != topic[0] || topic[0] == 0) { /* Check for wildcard matches */
-            if (sub[0] == '+') {
-                /* Check for bad "+foo" or "a/+foo" subscription */
-                if (spos > 0 && sub[-1] != '/') {
-                    return MOSQ_ERR_INVAL;
-                }
-                /* Check for bad "foo+" or "foo+/a" subscription */
-                if (sub[1] != 0 && sub[1] != '/') {
-                    return MOSQ_ERR_INVAL;
-                }
-                spos++;
-                sub++;
-                while (topic[0] != 0 && topic[0] != '/') {
-                    if (topic[0] == '+' || topic[0] == '#') {
-                        return MOSQ_ERR_INVAL;
-                    }
-                    topic++;
-                }
-                if (topic[0] == 0 && sub[0] == 0) {
-                    *result = true;
-                    return MOSQ_ERR_SUCCESS;
-                }
-            } else if (sub[0] == '#') {
-                /* Check for bad "foo#" subscription */
-                if (spos > 0 && sub[-1] != '/') {
-                    return MOSQ_ERR_INVAL;
-                }
-                /* Check for # not the final character of the sub, e.g. "#foo" */
-                if (sub[1] != 0) {
-                    return MOSQ_ERR_INVAL;
-                } else {
-                    while (topic[0] != 0) {
-                        if (topic[0] == '+' || topic[0] == '#') {
-                            return MOSQ_ERR_INVAL;
-                        }
-                        topic++;
-                    }
-                    *result = true;
-                    return MOSQ_ERR_SUCCESS;
-                }
-            } else {
-                /* Check for e.g. foo/bar matching foo/+/# */
-                if (topic[0] == 0
-                    && spos > 0
-                    && sub[-1] == '+'
-                    && sub[0] == '/'
-                    && sub[1] == '#') {
-                    *result = true;
-                    return MOSQ_ERR_SUCCESS;
-                }
-
-                /* There is no match at this point, but is the sub invalid? */
-                while (sub[0] != 0) {
-                    if (sub[0] == '#' && sub[1] != 0) {
-                        return MOSQ_ERR_INVAL;
-                    }
-                    spos++;
-                    sub++;
-                }
-
-                /* Valid input, but no match */
-                return MOSQ_ERR_SUCCESS;
-            }
+
+        if (pos == std::string_view::npos) {
+            // "foo/#" also matches "foo"
+            matches.insert(matches.end(), n->exact.begin(), n->exact.end());
+            matches.insert(matches.end(), n->hash.begin(), n->hash.end());
         } else {
-            /* sub[spos] == topic[tpos] */
-            if (topic[1] == 0) {
-                /* Check for e.g. foo matching foo/# */
-                if (sub[1] == '/'
-                    && sub[2] == '#'
-                    && sub[3] == 0) {
-                    *result = true;
-                    return MOSQ_ERR_SUCCESS;
-                }
-            }
-            spos++;
-            sub++;
-            topic++;
-            if (sub[0] == 0 && topic[0] == 0) {
-                *result = true;
-                return MOSQ_ERR_SUCCESS;
-            } else if (topic[0] == 0 && sub[0] == '+' && sub[1] == 0) {
-                if (spos > 0 && sub[-1] != '/') {
-                    return MOSQ_ERR_INVAL;
-                }
-                spos++;
-                sub++;
-                *result = true;
-                return MOSQ_ERR_SUCCESS;
-            }
+            match(*n, topic.substr(pos + 1), false, matches);
         }
     }
-    if ((topic[0] != 0 || sub[0] != 0)) {
-        *result = false;
+}
+
+bool MqttSubscribeParser::remove(TopicNode& node, std::string_view topic, const std::string& subscription)
+{
+    const size_t pos = topic.find('/');
+    const std::string_view level = topic.substr(0, pos);
+
+    if (level == "#") {
+        remove_subscription(node.hash, subscription);
+        return node.empty();
     }
-    while (topic[0] != 0) {
-        if (topic[0] == '+' || topic[0] == '#') {
-            return MOSQ_ERR_INVAL;
+
+    std::unique_ptr<TopicNode>* next = nullptr;
+    auto it = node.children.end();
+
+    if (level == "+") {
+        next = &node.plus;
+    } else {
+        it = node.children.find(level);
+        if (it != node.children.end()) {
+            next = &it->second;
+        }
+    }
+
+    if (next == nullptr || !*next) {
+        return node.empty();
+    }
+
+    bool empty;
+    if (pos == std::string_view::npos) {
+        remove_subscription((*next)->exact, subscription);
+        empty = (*next)->empty();
+    } else {
+        empty = remove(**next, topic.substr(pos + 1), subscription);
+    }
+
+    if (empty) {
+        if (it != node.children.end()) {
+            node.children.erase(it);
+        } else {
+            next->reset();
         }
-        topic++;
     }
 
-    return MOSQ_ERR_SUCCESS;
+    return node.empty();
 }
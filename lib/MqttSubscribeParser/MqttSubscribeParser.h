@@ -3,7 +3,13 @@
 
 #include <cstdint>
 #include <espMqttClient.h>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 struct cb_filter_t {
@@ -12,20 +18,44 @@ struct cb_filter_t {
     espMqttClientTypes::OnMessageCallback cb;
 };
 
+// dispatches incoming messages to the callbacks of all matching subscriptions.
+// the subscriptions are stored in a tree with one level per topic level, such
+// that a message is matched in O(topic depth) instead of matching it against
+// every subscription. matching follows the MQTT specification: '+' matches a
+// single level, '#' the parent and all child levels, and wildcards in the
+// first level do not match topics starting with '$'.
 class MqttSubscribeParser {
 public:
     void register_callback(const std::string& topic, uint8_t qos, const espMqttClientTypes::OnMessageCallback& cb);
     void unregister_callback(const std::string& topic);
     void handle_message(const espMqttClientTypes::MessageProperties& properties, const char* topic, const uint8_t* payload, size_t len, size_t index, size_t total);
-    std::vector<cb_filter_t> get_callbacks();
+
+    // calls fn for every registered subscription, in order of registration
+    void for_each_subscription(const std::function<void(const std::string& topic, uint8_t qos)>& fn);
 
 private:
-    int mosquitto_topic_matches_sub(const char* sub, const char* topic, bool* result);
+    struct Subscription {
+        cb_filter_t filter;
+        uint32_t sequence; // order of registration
+    };
 
-    std::vector<cb_filter_t> _callbacks;
+    struct TopicNode {
+        std::map<std::string, std::unique_ptr<TopicNode>, std::less<>> children;
+        std::unique_ptr<TopicNode> plus; // '+' level
+        std::vector<const Subscription*> hash; // subscriptions with a '#' level following this one
+        std::vector<const Subscription*> exact; // subscriptions ending on this level
 
-    enum mosq_err_t {
-        MOSQ_ERR_SUCCESS = 0,
-        MOSQ_ERR_INVAL = 3,
+        bool empty() const;
     };
-};
\ No newline at end of file
+
+    static bool is_valid_subscription(std::string_view topic);
+    static void remove_subscription(std::vector<const Subscription*>& subscriptions, const std::string& topic);
+
+    void match(const TopicNode& node, std::string_view topic, bool first, std::vector<const Subscription*>& matches) const;
+    bool remove(TopicNode& node, std::string_view topic, const std::string& subscription);
+
+    std::list<Subscription> _subscriptions; // stable addresses, referenced by the tree
+    TopicNode _root;
+    uint32_t _nextSequence = 0;
+    std::mutex _mutex;
+};
@@ -3,7 +3,7 @@
 
 #include <mutex>
 #include <optional>
-#include <queue>
+#include <deque>
 
 template <typename T>
 class ThreadSafeQueue {
@@ -33,14 +33,37 @@ public:
             return {};
         }
         T tmp = _queue.front();
-        _queue.pop();
+        _queue.pop_front();
         return tmp;
     }
 
     void push(const T& item)
     {
         std::lock_guard<std::mutex> lock(_mutex);
-        _queue.push(item);
+        _queue.push_back(item);
+    }
+
+    // removes all elements for which the predicate returns true, except for
+    // the front element, which might be in use by the consumer. returns the
+    // number of removed elements.
+    template <typename Predicate>
+    size_t removeQueuedIf(Predicate pred)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_queue.empty()) {
+            return 0;
+        }
+
+        size_t removed = 0;
+        for (auto it = _queue.begin() + 1; it != _queue.end();) {
+            if (pred(*it)) {
+                it = _queue.erase(it);
+                removed++;
+            } else {
+                ++it;
+            }
+        }
+        return removed;
     }
 
     T front()
@@ -57,6 +80,6 @@ private:
         return _queue.empty();
     }
 
-    std::queue<T> _queue;
+    std::deque<T> _queue;
     mutable std::mutex _mutex;
 };
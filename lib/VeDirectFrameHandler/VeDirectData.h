@@ -49,6 +49,12 @@ struct veMpptStruct : veStruct {
     std::pair<uint32_t, uint8_t> NetworkMode;
     std::pair<uint32_t, uint8_t> NetworkStatus;
 
+    // values polled with high frequency through the HEX protocol, if enabled.
+    // they supersede the respective values from the text protocol.
+    std::pair<uint32_t, uint32_t> PanelPowerMilliWatts;
+    std::pair<uint32_t, uint32_t> ChargerCurrentMilliAmps;
+    std::pair<uint32_t, uint8_t> DeviceState;
+
     frozen::string const& getMpptAsString() const; // state of mppt as string
     frozen::string const& getCsAsString() const;   // current state as string
     frozen::string const& getErrAsString() const;  // error state as string
@@ -121,7 +127,9 @@ enum class VeDirectHexRegister : uint16_t {
     DeviceState = 0x0201,
     RemoteControlUsed = 0x0202,
     PanelVoltage = 0xEDBB,
+    PanelPower = 0xEDBC,
     ChargerVoltage = 0xEDD5,
+    ChargerCurrent = 0xEDD7,
     NetworkTotalDcInputPower = 0x2027,
     ChargeControllerTemperature = 0xEDDB,
     SmartBatterySenseTemperature = 0xEDEC,
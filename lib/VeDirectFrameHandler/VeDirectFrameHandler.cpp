@@ -34,6 +34,8 @@
  */
 
 #include <Arduino.h>
+#include <algorithm>
+#include <frozen/unordered_map.h>
 #include "VeDirectFrameHandler.h"
 
 // The name of the record that contains the checksum.
@@ -57,7 +59,9 @@ VeDirectFrameHandler<T>::VeDirectFrameHandler() :
 	_name(""),
 	_value(""),
 	_debugIn(0),
-	_lastByteMillis(0)
+	_lastByteMillis(0),
+	_textDataLen(0),
+	_textDataOverflow(false)
 {
 }
 
@@ -96,7 +100,8 @@ void VeDirectFrameHandler<T>::reset()
 {
 	_checksum = 0;
 	_state = State::IDLE;
-	_textData.clear();
+	_textDataLen = 0;
+	_textDataOverflow = false;
 }
 
 template<typename T>
@@ -191,7 +196,17 @@ void VeDirectFrameHandler<T>::rxData(uint8_t inbyte)
 		case '\n':
 			if ( _textPointer < (_value + sizeof(_value)) ) {
 				*_textPointer = 0; // make zero ended
-				_textData.push_back({_name, _value});
+				size_t nameLen = strnlen(_name, sizeof(_name));
+				size_t valueLen = _textPointer - _value;
+				if (_textDataLen + nameLen + valueLen + 2 <= _textData.size()) {
+					memcpy(&_textData[_textDataLen], _name, nameLen);
+					_textDataLen += nameLen;
+					_textData[_textDataLen++] = 0;
+					memcpy(&_textData[_textDataLen], _value, valueLen + 1);
+					_textDataLen += valueLen + 1;
+				} else {
+					_textDataOverflow = true;
+				}
 			}
 			_state = State::RECORD_BEGIN;
 			break;
@@ -207,9 +222,17 @@ void VeDirectFrameHandler<T>::rxData(uint8_t inbyte)
 	case State::CHECKSUM:
 	{
 		if (_verboseLogging) { dumpDebugBuffer(); }
-		if (_checksum == 0) {
-			for (auto const& event : _textData) {
-				processTextData(event.first, event.second);
+		if (_textDataOverflow) {
+			_msgOut->printf("%s text data exceeds %d Bytes, frame ignored\r\n", _logId, VE_MAX_TEXT_DATA_LEN);
+		}
+		else if (_checksum == 0) {
+			size_t pos = 0;
+			while (pos < _textDataLen) {
+				std::string_view name(&_textData[pos]);
+				pos += name.size() + 1;
+				std::string_view value(&_textData[pos]);
+				pos += value.size() + 1;
+				processTextData(name, value);
 			}
 			_lastUpdate = millis();
 			frameValidEvent();
@@ -230,41 +253,97 @@ void VeDirectFrameHandler<T>::rxData(uint8_t inbyte)
  * This function is called every time a new name/value is successfully parsed.  It writes the values to the temporary buffer.
  */
 template<typename T>
-void VeDirectFrameHandler<T>::processTextData(std::string const& name, std::string const& value) {
+void VeDirectFrameHandler<T>::processTextData(std::string_view name, std::string_view value) {
 	if (_verboseLogging) {
-		_msgOut->printf("%s Text Data '%s' = '%s'\r\n",
-				_logId, name.c_str(), value.c_str());
+		_msgOut->printf("%s Text Data '%.*s' = '%.*s'\r\n", _logId,
+				static_cast<int>(name.size()), name.data(),
+				static_cast<int>(value.size()), value.data());
 	}
 
 	if (processTextDataDerived(name, value)) { return; }
 
-	if (name == "PID") {
-		_tmpFrame.productID_PID = strtol(value.c_str(), nullptr, 0);
+	enum class Field { PID, SER, FW, V, I };
+
+	static constexpr frozen::unordered_map<frozen::string, Field, 5> fields = {
+		{ "PID", Field::PID },
+		{ "SER", Field::SER },
+		{ "FW", Field::FW },
+		{ "V", Field::V },
+		{ "I", Field::I }
+	};
+
+	auto pos = fields.find(frozen::string(name.data(), name.size()));
+	if (pos == fields.end()) {
+		_msgOut->printf("%s Unknown text data '%.*s' (value '%.*s')\r\n", _logId,
+				static_cast<int>(name.size()), name.data(),
+				static_cast<int>(value.size()), value.data());
 		return;
 	}
 
-	if (name == "SER") {
-		strncpy(_tmpFrame.serialNr_SER, value.c_str(), sizeof(_tmpFrame.serialNr_SER));
-		return;
+	switch (pos->second) {
+		case Field::PID:
+			_tmpFrame.productID_PID = parseInt(value);
+			break;
+		case Field::SER:
+			copyText(_tmpFrame.serialNr_SER, sizeof(_tmpFrame.serialNr_SER), value);
+			break;
+		case Field::FW:
+			copyText(_tmpFrame.firmwareVer_FW, sizeof(_tmpFrame.firmwareVer_FW), value);
+			break;
+		case Field::V:
+			_tmpFrame.batteryVoltage_V_mV = parseInt(value);
+			break;
+		case Field::I:
+			_tmpFrame.batteryCurrent_I_mA = parseInt(value);
+			break;
 	}
+}
 
-	if (name == "FW") {
-		strncpy(_tmpFrame.firmwareVer_FW, value.c_str(), sizeof(_tmpFrame.firmwareVer_FW));
-		return;
+/*
+ * parseInt
+ * Behaves like atol(), but also accepts hex values prefixed with "0x" like strtol(..., 0).
+ */
+template<typename T>
+int32_t VeDirectFrameHandler<T>::parseInt(std::string_view value)
+{
+	size_t pos = 0;
+	bool negative = false;
+	if (pos < value.size() && (value[pos] == '-' || value[pos] == '+')) {
+		negative = (value[pos] == '-');
+		++pos;
 	}
 
-	if (name == "V") {
-		_tmpFrame.batteryVoltage_V_mV = atol(value.c_str());
-		return;
+	uint32_t base = 10;
+	if (value.size() - pos > 2 && value[pos] == '0' && (value[pos + 1] == 'X' || value[pos + 1] == 'x')) {
+		base = 16;
+		pos += 2;
 	}
 
-	if (name == "I") {
-		_tmpFrame.batteryCurrent_I_mA = atol(value.c_str());
-		return;
+	uint32_t result = 0;
+	for (; pos < value.size(); ++pos) {
+		char c = value[pos];
+		uint32_t digit;
+		if (c >= '0' && c <= '9') {
+			digit = c - '0';
+		} else if (base == 16 && c >= 'A' && c <= 'F') {
+			digit = c - 'A' + 10;
+		} else if (base == 16 && c >= 'a' && c <= 'f') {
+			digit = c - 'a' + 10;
+		} else {
+			break;
+		}
+		result = result * base + digit;
 	}
 
-	_msgOut->printf("%s Unknown text data '%s' (value '%s')\r\n",
-			_logId, name.c_str(), value.c_str());
+	return negative ? -static_cast<int32_t>(result) : static_cast<int32_t>(result);
+}
+
+template<typename T>
+void VeDirectFrameHandler<T>::copyText(char* dst, size_t dstLen, std::string_view value)
+{
+	size_t len = std::min(value.size(), dstLen - 1);
+	memcpy(dst, value.data(), len);
+	dst[len] = 0;
 }
 
 /*
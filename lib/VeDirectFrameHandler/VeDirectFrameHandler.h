@@ -15,10 +15,12 @@
 #include <Arduino.h>
 #include <array>
 #include <memory>
+#include <string_view>
 #include <utility>
-#include <deque>
 #include "VeDirectData.h"
 
+#define VE_MAX_TEXT_DATA_LEN 512 // buffer for the text records of a single frame
+
 template<typename T>
 class VeDirectFrameHandler {
 public:
@@ -34,6 +36,13 @@ protected:
         bool verboseLogging, uint8_t hwSerialPort);
     virtual bool hexDataHandler(VeDirectHexData const &data) { return false; } // handles the disassembeled hex response
 
+    // parse text record values in place, without creating a zero-terminated copy
+    static int32_t parseInt(std::string_view value);
+    static void copyText(char* dst, size_t dstLen, std::string_view value);
+
+    // true while a text or hex frame is being received
+    bool isReceiving() const { return _state != State::IDLE; }
+
     bool _verboseLogging;
     Print* _msgOut;
     uint32_t _lastUpdate;
@@ -47,8 +56,8 @@ private:
     void reset();
     void dumpDebugBuffer();
     void rxData(uint8_t inbyte);              // byte of serial data
-    void processTextData(std::string const& name, std::string const& value);
-    virtual bool processTextDataDerived(std::string const& name, std::string const& value) = 0;
+    void processTextData(std::string_view name, std::string_view value);
+    virtual bool processTextDataDerived(std::string_view name, std::string_view value) = 0;
     virtual void frameValidEvent() { }
     bool disassembleHexData(VeDirectHexData &data);     //return true if disassembling was possible
 
@@ -81,12 +90,15 @@ private:
      * not every frame contains every value the device is communicating, i.e.,
      * a set of values can be fragmented across multiple frames. frames can be
      * invalid. in order to only process data from valid frames, we add data
-     * to this queue and only process it once the frame was found to be valid.
+     * to this buffer and only process it once the frame was found to be valid.
      * this also handles fragmentation nicely, since there is no need to reset
-     * our data buffer. we simply update the interpreted data from this event
-     * queue, which is fine as we know the source frame was valid.
+     * our data buffer. we simply update the interpreted data from this buffer,
+     * which is fine as we know the source frame was valid. the records are
+     * stored as consecutive pairs of zero-terminated name and value strings.
      */
-    std::deque<std::pair<std::string, std::string>> _textData;
+    std::array<char, VE_MAX_TEXT_DATA_LEN> _textData;
+    size_t _textDataLen;
+    bool _textDataOverflow;
 };
 
 template class VeDirectFrameHandler<veMpptStruct>;
@@ -8,10 +8,22 @@
  */
 
 #include <Arduino.h>
+#include <frozen/unordered_map.h>
 #include "VeDirectMpptController.h"
 
 //#define PROCESS_NETWORK_STATE
 
+// panel power and charger current change quickly, the device state does not
+static constexpr std::array<VeDirectHexRegister, 5> fastPollSequence = {
+	VeDirectHexRegister::PanelPower,
+	VeDirectHexRegister::ChargerCurrent,
+	VeDirectHexRegister::PanelPower,
+	VeDirectHexRegister::ChargerCurrent,
+	VeDirectHexRegister::DeviceState
+};
+
+static constexpr uint32_t fastPollTimeoutMs = 500;
+
 void VeDirectMpptController::init(int8_t rx, int8_t tx, Print* msgOut,
 		bool verboseLogging, uint8_t hwSerialPort)
 {
@@ -19,66 +31,76 @@ void VeDirectMpptController::init(int8_t rx, int8_t tx, Print* msgOut,
 			verboseLogging, hwSerialPort);
 }
 
-bool VeDirectMpptController::processTextDataDerived(std::string const& name, std::string const& value)
+bool VeDirectMpptController::processTextDataDerived(std::string_view name, std::string_view value)
 {
-	if (name == "IL") {
-		_tmpFrame.loadCurrent_IL_mA = atol(value.c_str());
-		return true;
-	}
-	if (name == "LOAD") {
-		_tmpFrame.loadOutputState_LOAD = (value == "ON");
-		return true;
-	}
-	if (name == "CS") {
-		_tmpFrame.currentState_CS = atoi(value.c_str());
-		return true;
-	}
-	if (name == "ERR") {
-		_tmpFrame.errorCode_ERR = atoi(value.c_str());
-		return true;
-	}
-	if (name == "OR") {
-		_tmpFrame.offReason_OR = strtol(value.c_str(), nullptr, 0);
-		return true;
-	}
-	if (name == "MPPT") {
-		_tmpFrame.stateOfTracker_MPPT = atoi(value.c_str());
-		return true;
-	}
-	if (name == "HSDS") {
-		_tmpFrame.daySequenceNr_HSDS = atoi(value.c_str());
-		return true;
-	}
-	if (name == "VPV") {
-		_tmpFrame.panelVoltage_VPV_mV = atol(value.c_str());
-		return true;
-	}
-	if (name == "PPV") {
-		_tmpFrame.panelPower_PPV_W = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H19") {
-		_tmpFrame.yieldTotal_H19_Wh = atol(value.c_str()) * 10;
-		return true;
-	}
-	if (name == "H20") {
-		_tmpFrame.yieldToday_H20_Wh = atol(value.c_str()) * 10;
-		return true;
-	}
-	if (name == "H21") {
-		_tmpFrame.maxPowerToday_H21_W = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H22") {
-		_tmpFrame.yieldYesterday_H22_Wh = atol(value.c_str()) * 10;
-		return true;
-	}
-	if (name == "H23") {
-		_tmpFrame.maxPowerYesterday_H23_W = atoi(value.c_str());
-		return true;
+	enum class Field { IL, LOAD, CS, ERR, OR, MPPT, HSDS, VPV, PPV, H19, H20, H21, H22, H23 };
+
+	static constexpr frozen::unordered_map<frozen::string, Field, 14> fields = {
+		{ "IL", Field::IL },
+		{ "LOAD", Field::LOAD },
+		{ "CS", Field::CS },
+		{ "ERR", Field::ERR },
+		{ "OR", Field::OR },
+		{ "MPPT", Field::MPPT },
+		{ "HSDS", Field::HSDS },
+		{ "VPV", Field::VPV },
+		{ "PPV", Field::PPV },
+		{ "H19", Field::H19 },
+		{ "H20", Field::H20 },
+		{ "H21", Field::H21 },
+		{ "H22", Field::H22 },
+		{ "H23", Field::H23 }
+	};
+
+	auto pos = fields.find(frozen::string(name.data(), name.size()));
+	if (pos == fields.end()) { return false; }
+
+	switch (pos->second) {
+		case Field::IL:
+			_tmpFrame.loadCurrent_IL_mA = parseInt(value);
+			break;
+		case Field::LOAD:
+			_tmpFrame.loadOutputState_LOAD = (value == "ON");
+			break;
+		case Field::CS:
+			_tmpFrame.currentState_CS = parseInt(value);
+			break;
+		case Field::ERR:
+			_tmpFrame.errorCode_ERR = parseInt(value);
+			break;
+		case Field::OR:
+			_tmpFrame.offReason_OR = parseInt(value);
+			break;
+		case Field::MPPT:
+			_tmpFrame.stateOfTracker_MPPT = parseInt(value);
+			break;
+		case Field::HSDS:
+			_tmpFrame.daySequenceNr_HSDS = parseInt(value);
+			break;
+		case Field::VPV:
+			_tmpFrame.panelVoltage_VPV_mV = parseInt(value);
+			break;
+		case Field::PPV:
+			_tmpFrame.panelPower_PPV_W = parseInt(value);
+			break;
+		case Field::H19:
+			_tmpFrame.yieldTotal_H19_Wh = parseInt(value) * 10;
+			break;
+		case Field::H20:
+			_tmpFrame.yieldToday_H20_Wh = parseInt(value) * 10;
+			break;
+		case Field::H21:
+			_tmpFrame.maxPowerToday_H21_W = parseInt(value);
+			break;
+		case Field::H22:
+			_tmpFrame.yieldYesterday_H22_Wh = parseInt(value) * 10;
+			break;
+		case Field::H23:
+			_tmpFrame.maxPowerYesterday_H23_W = parseInt(value);
+			break;
 	}
 
-	return false;
+	return true;
 }
 
 /*
@@ -105,6 +127,9 @@ void VeDirectMpptController::frameValidEvent() {
 		_tmpFrame.mpptEfficiency_Percent = 0.0f;
 	}
 
+	// the text frame carries values which are older than the fast-polled ones
+	applyFastPollData();
+
 	if (!_canSend) { return; }
 
 	// Copy from the "VE.Direct Protocol" documentation
@@ -133,6 +158,8 @@ void VeDirectMpptController::loop()
 {
 	VeDirectFrameHandler::loop();
 
+	fastPollLoop();
+
 	auto resetTimestamp = [this](auto& pair) {
 		if (pair.first > 0 && (millis() - pair.first) > (10 * 1000)) {
 			pair.first = 0;
@@ -142,6 +169,9 @@ void VeDirectMpptController::loop()
 	resetTimestamp(_tmpFrame.MpptTemperatureMilliCelsius);
 	resetTimestamp(_tmpFrame.SmartBatterySenseTemperatureMilliCelsius);
 	resetTimestamp(_tmpFrame.NetworkTotalDcInputPowerMilliWatts);
+	resetTimestamp(_tmpFrame.PanelPowerMilliWatts);
+	resetTimestamp(_tmpFrame.ChargerCurrentMilliAmps);
+	resetTimestamp(_tmpFrame.DeviceState);
 
 #ifdef PROCESS_NETWORK_STATE
 	resetTimestamp(_tmpFrame.NetworkInfo);
@@ -151,6 +181,88 @@ void VeDirectMpptController::loop()
 }
 
 
+/*
+ * fastPollLoop()
+ * requests one of the fast-polled registers per interval. a new request is
+ * only sent once the previous one was answered or timed out, and only in
+ * between frames, such that the text protocol is not disturbed.
+ */
+void VeDirectMpptController::fastPollLoop()
+{
+	if (_fastPollIntervalMs == 0 || !_canSend) { return; }
+
+	// see frameValidEvent(): older firmware stops sending text frames
+	if (_tmpFrame.getFwVersionAsInteger() < 153) { return; }
+
+	uint32_t now = millis();
+
+	if (_fastPollPending) {
+		if ((now - _fastPollLastRequest) < fastPollTimeoutMs) { return; }
+		_fastPollPending = false;
+		++_fastPollStats.timeouts;
+	}
+
+	if ((now - _fastPollLastRequest) < _fastPollIntervalMs) { return; }
+
+	if (isReceiving()) { return; }
+
+	auto addr = fastPollSequence[_fastPollIndex];
+	_fastPollIndex = (_fastPollIndex + 1) % fastPollSequence.size();
+
+	if (!sendHexCommand(VeDirectHexCommand::GET, addr)) { return; }
+
+	_fastPollPending = true;
+	_fastPollPendingRegister = addr;
+	_fastPollLastRequest = now;
+	++_fastPollStats.requests;
+}
+
+/*
+ * fastPollResponse()
+ * measures the round-trip time of a fast-poll request and makes the new
+ * value available immediately, without waiting for the next text frame.
+ */
+void VeDirectMpptController::fastPollResponse(VeDirectHexRegister addr)
+{
+	if (_fastPollPending && addr == _fastPollPendingRegister) {
+		_fastPollPending = false;
+		++_fastPollStats.responses;
+
+		uint32_t latency = millis() - _fastPollLastRequest;
+		_fastPollStats.lastLatencyMs = latency;
+		if (_fastPollStats.responses == 1) {
+			_fastPollStats.avgLatencyMs = latency;
+		} else {
+			_fastPollStats.avgLatencyMs += (latency - _fastPollStats.avgLatencyMs) / 8;
+		}
+	}
+
+	applyFastPollData();
+	_lastUpdate = millis();
+}
+
+/*
+ * applyFastPollData()
+ * overrides the text protocol values with fresh fast-polled values
+ */
+void VeDirectMpptController::applyFastPollData()
+{
+	if (_tmpFrame.PanelPowerMilliWatts.first > 0) {
+		_tmpFrame.panelPower_PPV_W = _tmpFrame.PanelPowerMilliWatts.second / 1000;
+	}
+
+	if (_tmpFrame.ChargerCurrentMilliAmps.first > 0) {
+		// the charger current includes the current of the load output
+		int32_t batteryCurrent_mA = static_cast<int32_t>(_tmpFrame.ChargerCurrentMilliAmps.second)
+			- static_cast<int32_t>(_tmpFrame.loadCurrent_IL_mA);
+		_tmpFrame.batteryOutputPower_W = static_cast<int16_t>((_tmpFrame.batteryVoltage_V_mV / 1000.0f) * (batteryCurrent_mA / 1000.0f));
+	}
+
+	if (_tmpFrame.DeviceState.first > 0) {
+		_tmpFrame.currentState_CS = _tmpFrame.DeviceState.second;
+	}
+}
+
 /*
  * hexDataHandler()
  * analyse the content of VE.Direct hex messages
@@ -215,6 +327,41 @@ bool VeDirectMpptController::hexDataHandler(VeDirectHexData const &data) {
 			return true;
 			break;
 
+		case VeDirectHexRegister::PanelPower:
+			_tmpFrame.PanelPowerMilliWatts = { millis(), data.value * 10 };
+			fastPollResponse(data.addr);
+
+			if (_verboseLogging) {
+				_msgOut->printf("%s Hex Data: Panel Power (0x%04X): %.2fW\r\n",
+						_logId, regLog,
+						_tmpFrame.PanelPowerMilliWatts.second / 1000.0);
+			}
+			return true;
+			break;
+
+		case VeDirectHexRegister::ChargerCurrent:
+			_tmpFrame.ChargerCurrentMilliAmps = { millis(), data.value * 100 };
+			fastPollResponse(data.addr);
+
+			if (_verboseLogging) {
+				_msgOut->printf("%s Hex Data: Charger Current (0x%04X): %.1fA\r\n",
+						_logId, regLog,
+						_tmpFrame.ChargerCurrentMilliAmps.second / 1000.0);
+			}
+			return true;
+			break;
+
+		case VeDirectHexRegister::DeviceState:
+			_tmpFrame.DeviceState = { millis(), static_cast<uint8_t>(data.value) };
+			fastPollResponse(data.addr);
+
+			if (_verboseLogging) {
+				_msgOut->printf("%s Hex Data: Device State (0x%04X): %d\r\n",
+						_logId, regLog, _tmpFrame.DeviceState.second);
+			}
+			return true;
+			break;
+
 #ifdef PROCESS_NETWORK_STATE
 		case VeDirectHexRegister::NetworkInfo:
 			_tmpFrame.NetworkInfo =
@@ -47,9 +47,32 @@ public:
 
     void loop() final;
 
+    // polls panel power, charger current and device state through the HEX
+    // protocol, one register every intervalMs milliseconds. zero disables it.
+    void setFastPollInterval(uint16_t intervalMs) { _fastPollIntervalMs = intervalMs; }
+
+    struct FastPollStats {
+        uint32_t requests;
+        uint32_t responses;
+        uint32_t timeouts;
+        uint32_t lastLatencyMs; // round-trip time of the last response
+        float avgLatencyMs;
+    };
+    FastPollStats const& getFastPollStats() const { return _fastPollStats; }
+
 private:
     bool hexDataHandler(VeDirectHexData const &data) final;
-    bool processTextDataDerived(std::string const& name, std::string const& value) final;
+    bool processTextDataDerived(std::string_view name, std::string_view value) final;
     void frameValidEvent() final;
+    void fastPollLoop();
+    void fastPollResponse(VeDirectHexRegister addr);
+    void applyFastPollData();
     MovingAverage<float, 5> _efficiency;
+
+    uint16_t _fastPollIntervalMs = 0;
+    uint8_t _fastPollIndex = 0;
+    uint32_t _fastPollLastRequest = 0;
+    bool _fastPollPending = false;
+    VeDirectHexRegister _fastPollPendingRegister;
+    FastPollStats _fastPollStats = {};
 };
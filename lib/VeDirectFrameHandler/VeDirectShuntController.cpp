@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include <frozen/unordered_map.h>
 #include "VeDirectShuntController.h"
 
 VeDirectShuntController VeDirectShunt;
@@ -10,125 +11,139 @@ void VeDirectShuntController::init(int8_t rx, int8_t tx, Print* msgOut,
 			verboseLogging, hwSerialPort);
 }
 
-bool VeDirectShuntController::processTextDataDerived(std::string const& name, std::string const& value)
+bool VeDirectShuntController::processTextDataDerived(std::string_view name, std::string_view value)
 {
-	if (name == "T") {
-		_tmpFrame.T = atoi(value.c_str());
-		_tmpFrame.tempPresent = true;
-		return true;
-	}
-	if (name == "P") {
-		_tmpFrame.P = atoi(value.c_str());
-		return true;
-	}
-	if (name == "CE") {
-		_tmpFrame.CE = atoi(value.c_str());
-		return true;
-	}
-	if (name == "SOC") {
-		_tmpFrame.SOC = atoi(value.c_str());
-		return true;
-	}
-	if (name == "TTG") {
-		_tmpFrame.TTG = atoi(value.c_str());
-		return true;
-	}
-	if (name == "ALARM") {
-		_tmpFrame.ALARM = (value == "ON");
-		return true;
-	}
-	if (name == "AR") {
-		_tmpFrame.alarmReason_AR = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H1") {
-		_tmpFrame.H1 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H2") {
-		_tmpFrame.H2 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H3") {
-		_tmpFrame.H3 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H4") {
-		_tmpFrame.H4 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H5") {
-		_tmpFrame.H5 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H6") {
-		_tmpFrame.H6 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H7") {
-		_tmpFrame.H7 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H8") {
-		_tmpFrame.H8 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H9") {
-		_tmpFrame.H9 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H10") {
-		_tmpFrame.H10 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H11") {
-		_tmpFrame.H11 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H12") {
-		_tmpFrame.H12 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H13") {
-		_tmpFrame.H13 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H14") {
-		_tmpFrame.H14 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H15") {
-		_tmpFrame.H15 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H16") {
-		_tmpFrame.H16 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H17") {
-		_tmpFrame.H17 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "VM") {
-		_tmpFrame.VM = atoi(value.c_str());
-		return true;
-	}
-	if (name == "DM") {
-		_tmpFrame.DM = atoi(value.c_str());
-		return true;
-	}
-	if (name == "H18") {
-		_tmpFrame.H18 = atoi(value.c_str());
-		return true;
-	}
-	if (name == "BMV") {
-		// This field contains a textual description of the BMV model,
-		// for example 602S or 702. It is deprecated, refer to the field PID instead.
-		return true;
-	}
-	if (name == "MON") {
-		_tmpFrame.dcMonitorMode_MON = static_cast<int8_t>(atoi(value.c_str()));
-		return true;
+	enum class Field {
+		T, P, CE, SOC, TTG, ALARM, AR, H1, H2, H3, H4, H5, H6, H7, H8,
+		H9, H10, H11, H12, H13, H14, H15, H16, H17, VM, DM, H18, BMV, MON
+	};
+
+	static constexpr frozen::unordered_map<frozen::string, Field, 29> fields = {
+		{ "T", Field::T },
+		{ "P", Field::P },
+		{ "CE", Field::CE },
+		{ "SOC", Field::SOC },
+		{ "TTG", Field::TTG },
+		{ "ALARM", Field::ALARM },
+		{ "AR", Field::AR },
+		{ "H1", Field::H1 },
+		{ "H2", Field::H2 },
+		{ "H3", Field::H3 },
+		{ "H4", Field::H4 },
+		{ "H5", Field::H5 },
+		{ "H6", Field::H6 },
+		{ "H7", Field::H7 },
+		{ "H8", Field::H8 },
+		{ "H9", Field::H9 },
+		{ "H10", Field::H10 },
+		{ "H11", Field::H11 },
+		{ "H12", Field::H12 },
+		{ "H13", Field::H13 },
+		{ "H14", Field::H14 },
+		{ "H15", Field::H15 },
+		{ "H16", Field::H16 },
+		{ "H17", Field::H17 },
+		{ "VM", Field::VM },
+		{ "DM", Field::DM },
+		{ "H18", Field::H18 },
+		{ "BMV", Field::BMV },
+		{ "MON", Field::MON }
+	};
+
+	auto pos = fields.find(frozen::string(name.data(), name.size()));
+	if (pos == fields.end()) { return false; }
+
+	switch (pos->second) {
+		case Field::T:
+			_tmpFrame.T = parseInt(value);
+			_tmpFrame.tempPresent = true;
+			break;
+		case Field::P:
+			_tmpFrame.P = parseInt(value);
+			break;
+		case Field::CE:
+			_tmpFrame.CE = parseInt(value);
+			break;
+		case Field::SOC:
+			_tmpFrame.SOC = parseInt(value);
+			break;
+		case Field::TTG:
+			_tmpFrame.TTG = parseInt(value);
+			break;
+		case Field::ALARM:
+			_tmpFrame.ALARM = (value == "ON");
+			break;
+		case Field::AR:
+			_tmpFrame.alarmReason_AR = parseInt(value);
+			break;
+		case Field::H1:
+			_tmpFrame.H1 = parseInt(value);
+			break;
+		case Field::H2:
+			_tmpFrame.H2 = parseInt(value);
+			break;
+		case Field::H3:
+			_tmpFrame.H3 = parseInt(value);
+			break;
+		case Field::H4:
+			_tmpFrame.H4 = parseInt(value);
+			break;
+		case Field::H5:
+			_tmpFrame.H5 = parseInt(value);
+			break;
+		case Field::H6:
+			_tmpFrame.H6 = parseInt(value);
+			break;
+		case Field::H7:
+			_tmpFrame.H7 = parseInt(value);
+			break;
+		case Field::H8:
+			_tmpFrame.H8 = parseInt(value);
+			break;
+		case Field::H9:
+			_tmpFrame.H9 = parseInt(value);
+			break;
+		case Field::H10:
+			_tmpFrame.H10 = parseInt(value);
+			break;
+		case Field::H11:
+			_tmpFrame.H11 = parseInt(value);
+			break;
+		case Field::H12:
+			_tmpFrame.H12 = parseInt(value);
+			break;
+		case Field::H13:
+			_tmpFrame.H13 = parseInt(value);
+			break;
+		case Field::H14:
+			_tmpFrame.H14 = parseInt(value);
+			break;
+		case Field::H15:
+			_tmpFrame.H15 = parseInt(value);
+			break;
+		case Field::H16:
+			_tmpFrame.H16 = parseInt(value);
+			break;
+		case Field::H17:
+			_tmpFrame.H17 = parseInt(value);
+			break;
+		case Field::VM:
+			_tmpFrame.VM = parseInt(value);
+			break;
+		case Field::DM:
+			_tmpFrame.DM = parseInt(value);
+			break;
+		case Field::H18:
+			_tmpFrame.H18 = parseInt(value);
+			break;
+		case Field::BMV:
+			// This field contains a textual description of the BMV model,
+			// for example 602S or 702. It is deprecated, refer to the field PID instead.
+			break;
+		case Field::MON:
+			_tmpFrame.dcMonitorMode_MON = static_cast<int8_t>(parseInt(value));
+			break;
 	}
-	return false;
+
+	return true;
 }
@@ -14,7 +14,7 @@ public:
     using data_t = veShuntStruct;
 
 private:
-    bool processTextDataDerived(std::string const& name, std::string const& value) final;
+    bool processTextDataDerived(std::string_view name, std::string_view value) final;
 };
 
 extern VeDirectShuntController VeDirectShunt;
@@ -4,9 +4,11 @@
 #include "PylontechCanReceiver.h"
 #include "SBSCanReceiver.h"
 #include "JkBmsController.h"
+#include "TaskMonitor.h"
 #include "VictronSmartShunt.h"
 #include "MqttBattery.h"
 #include "PytesCanReceiver.h"
+#include "Telemetry.h"
 
 BatteryClass Battery;
 
@@ -25,7 +27,7 @@ std::shared_ptr<BatteryStats const> BatteryClass::getStats() const
 void BatteryClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&BatteryClass::loop, this));
+    _loopTask.setCallback(TaskMonitor.wrap("Battery", std::bind(&BatteryClass::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 
@@ -46,23 +48,23 @@ void BatteryClass::updateSettings()
 
     bool verboseLogging = config.Battery.VerboseLogging;
 
-    switch (config.Battery.Provider) {
-        case 0:
+    switch (static_cast<BatteryProvider::Type>(config.Battery.Provider)) {
+        case BatteryProvider::Type::PylontechCan:
             _upProvider = std::make_unique<PylontechCanReceiver>();
             break;
-        case 1:
+        case BatteryProvider::Type::JkBmsSerial:
             _upProvider = std::make_unique<JkBms::Controller>();
             break;
-        case 2:
+        case BatteryProvider::Type::Mqtt:
             _upProvider = std::make_unique<MqttBattery>();
             break;
-        case 3:
+        case BatteryProvider::Type::VictronSmartShunt:
             _upProvider = std::make_unique<VictronSmartShunt>();
             break;
-        case 4:
+        case BatteryProvider::Type::PytesCan:
             _upProvider = std::make_unique<PytesCanReceiver>();
             break;
-        case 5:
+        case BatteryProvider::Type::SBSCan:
             _upProvider = std::make_unique<SBSCanReceiver>();
             break;
         default:
@@ -77,14 +79,31 @@ void BatteryClass::loop()
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    if (!_upProvider) { return; }
+    BatteryTelemetry telemetry = {};
+
+    if (!_upProvider) {
+        telemetry.chargeCurrentLimitation = FLT_MAX;
+        telemetry.dischargeCurrentLimit = FLT_MAX;
+        Telemetry.publish(telemetry);
+        return;
+    }
 
     _upProvider->loop();
 
-    _upProvider->getStats()->mqttLoop();
+    auto spStats = _upProvider->getStats();
+    spStats->mqttLoop();
+
+    spStats->getTelemetry(telemetry);
+    telemetry.dischargeCurrentLimit = getDischargeCurrentLimit(*spStats);
+    Telemetry.publish(telemetry);
 }
 
 float BatteryClass::getDischargeCurrentLimit()
+{
+    return getDischargeCurrentLimit(*getStats());
+}
+
+float BatteryClass::getDischargeCurrentLimit(BatteryStats const& stats) const
 {
     CONFIG_T& config = Configuration.get();
 
@@ -93,10 +112,10 @@ float BatteryClass::getDischargeCurrentLimit()
     auto dischargeCurrentLimit = config.Battery.DischargeCurrentLimit;
     auto dischargeCurrentValid = dischargeCurrentLimit > 0.0f;
 
-    auto statsCurrentLimit = getStats()->getDischargeCurrentLimit();
+    auto statsCurrentLimit = stats.getDischargeCurrentLimit();
     auto statsLimitValid = config.Battery.UseBatteryReportedDischargeCurrentLimit
         && statsCurrentLimit >= 0.0f
-        && getStats()->getDischargeCurrentLimitAgeSeconds() <= 60;
+        && stats.getDischargeCurrentLimitAgeSeconds() <= 60;
 
     if (statsLimitValid && dischargeCurrentValid) {
         // take the lowest limit
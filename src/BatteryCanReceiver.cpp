@@ -2,7 +2,6 @@
 #include "BatteryCanReceiver.h"
 #include "MessageOutput.h"
 #include "PinMapping.h"
-#include <driver/twai.h>
 
 bool BatteryCanReceiver::init(bool verboseLogging, char const* providerName)
 {
@@ -13,68 +12,20 @@ bool BatteryCanReceiver::init(bool verboseLogging, char const* providerName)
             _providerName);
 
     const PinMapping_t& pin = PinMapping.get();
-    MessageOutput.printf("[%s] Interface rx = %d, tx = %d\r\n",
-            _providerName, pin.battery_rx, pin.battery_tx);
-
-    if (pin.battery_rx < 0 || pin.battery_tx < 0) {
-        MessageOutput.printf("[%s] Invalid pin config\r\n",
+    _bus = CanBuses.getTwai(pin.battery_rx, pin.battery_tx, Bitrate);
+    if (!_bus) {
+        MessageOutput.printf("[%s] CAN bus not available\r\n",
                 _providerName);
         return false;
     }
 
-    auto tx = static_cast<gpio_num_t>(pin.battery_tx);
-    auto rx = static_cast<gpio_num_t>(pin.battery_rx);
-    twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(tx, rx, TWAI_MODE_NORMAL);
-
-    // interrupts at level 1 are in high demand, at least on ESP32-S3 boards,
-    // but only a limited amount can be allocated. failing to allocate an
-    // interrupt in the TWAI driver will cause a bootloop. we therefore
-    // register the TWAI driver's interrupt at level 2. level 2 interrupts
-    // should be available -- we don't really know. we would love to have the
-    // esp_intr_dump() function, but that's not available yet in our version
-    // of the underlying esp-idf.
-    g_config.intr_flags = ESP_INTR_FLAG_LEVEL2;
-
-    // Initialize configuration structures using macro initializers
-    twai_timing_config_t t_config = TWAI_TIMING_CONFIG_500KBITS();
-    twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
-
-    // Install TWAI driver
-    esp_err_t twaiLastResult = twai_driver_install(&g_config, &t_config, &f_config);
-    switch (twaiLastResult) {
-        case ESP_OK:
-            MessageOutput.printf("[%s] Twai driver installed\r\n",
-                    _providerName);
-            break;
-        case ESP_ERR_INVALID_ARG:
-            MessageOutput.printf("[%s] Twai driver install - invalid arg\r\n",
-                    _providerName);
-            return false;
-            break;
-        case ESP_ERR_NO_MEM:
-            MessageOutput.printf("[%s] Twai driver install - no memory\r\n",
-                    _providerName);
-            return false;
-            break;
-        case ESP_ERR_INVALID_STATE:
-            MessageOutput.printf("[%s] Twai driver install - invalid state\r\n",
-                    _providerName);
-            return false;
-            break;
-    }
-
-    // Start TWAI driver
-    twaiLastResult = twai_start();
-    switch (twaiLastResult) {
-        case ESP_OK:
-            MessageOutput.printf("[%s] Twai driver started\r\n",
-                    _providerName);
-            break;
-        case ESP_ERR_INVALID_STATE:
-            MessageOutput.printf("[%s] Twai driver start - invalid state\r\n",
-                    _providerName);
-            return false;
-            break;
+    // all standard frames, the identifiers are checked in loop()
+    _rxQueue = _bus->subscribe(0, 0, false, RxQueueLength);
+    if (_rxQueue == nullptr) {
+        MessageOutput.printf("[%s] Failed to allocate receive queue\r\n",
+                _providerName);
+        _bus = nullptr;
+        return false;
     }
 
     return true;
@@ -82,75 +33,65 @@ bool BatteryCanReceiver::init(bool verboseLogging, char const* providerName)
 
 void BatteryCanReceiver::deinit()
 {
-    // Stop TWAI driver
-    esp_err_t twaiLastResult = twai_stop();
-    switch (twaiLastResult) {
-        case ESP_OK:
-            MessageOutput.printf("[%s] Twai driver stopped\r\n",
-                    _providerName);
-            break;
-        case ESP_ERR_INVALID_STATE:
-            MessageOutput.printf("[%s] Twai driver stop - invalid state\r\n",
-                    _providerName);
-            break;
-    }
+    if (!_bus) { return; }
 
-    // Uninstall TWAI driver
-    twaiLastResult = twai_driver_uninstall();
-    switch (twaiLastResult) {
-        case ESP_OK:
-            MessageOutput.printf("[%s] Twai driver uninstalled\r\n",
-                    _providerName);
-            break;
-        case ESP_ERR_INVALID_STATE:
-            MessageOutput.printf("[%s] Twai driver uninstall - invalid state\r\n",
-                    _providerName);
-            break;
-    }
+    _bus->unsubscribe(_rxQueue);
+    _rxQueue = nullptr;
+
+    // the bus is shut down if no other consumer uses it
+    _bus = nullptr;
 }
 
 void BatteryCanReceiver::loop()
 {
-    // Check for messages. twai_receive is blocking when there is no data so we return if there are no frames in the buffer
-    twai_status_info_t status_info;
-    esp_err_t twaiLastResult = twai_get_status_info(&status_info);
-    if (twaiLastResult != ESP_OK) {
-        switch (twaiLastResult) {
-            case ESP_ERR_INVALID_ARG:
-                MessageOutput.printf("[%s] Twai driver get status - invalid arg\r\n",
-                        _providerName);
-                break;
-            case ESP_ERR_INVALID_STATE:
-                MessageOutput.printf("[%s] Twai driver get status - invalid state\r\n",
-                        _providerName);
-                break;
-        }
-        return;
-    }
-    if (status_info.msgs_to_rx == 0) {
-        return;
-    }
+    if (!_bus) { return; }
 
-    // Wait for message to be received, function is blocking
+    // drain all frames which are pending in the receive queue. the number
+    // of frames processed per call is limited as new frames might arrive
+    // in the meantime.
+    auto stats = getStats();
     twai_message_t rx_message;
-    if (twai_receive(&rx_message, pdMS_TO_TICKS(100)) != ESP_OK) {
-        MessageOutput.printf("[%s] Failed to receive message",
-                _providerName);
-        return;
-    }
+    for (uint32_t frames = 0; frames < RxQueueLength; ++frames) {
+        if (xQueueReceive(_rxQueue, &rx_message, 0) != pdTRUE) { break; }
+
+        stats->_canRxFrames++;
+
+        if (!isKnownIdentifier(rx_message.identifier)) {
+            stats->_canRxIgnored++;
+            continue;
+        }
+
+        if (_verboseLogging) {
+            MessageOutput.printf("[%s] Received CAN message: 0x%04X -",
+                    _providerName, rx_message.identifier);
 
-    if (_verboseLogging) {
-        MessageOutput.printf("[%s] Received CAN message: 0x%04X -",
-                _providerName, rx_message.identifier);
+            for (int i = 0; i < rx_message.data_length_code; i++) {
+                MessageOutput.printf(" %02X", rx_message.data[i]);
+            }
 
-        for (int i = 0; i < rx_message.data_length_code; i++) {
-            MessageOutput.printf(" %02X", rx_message.data[i]);
+            MessageOutput.printf("\r\n");
         }
 
-        MessageOutput.printf("\r\n");
+        onMessage(rx_message);
+    }
+
+    updateBusStats();
+}
+
+void BatteryCanReceiver::updateBusStats()
+{
+    auto busStats = _bus->getStats();
+    auto stats = getStats();
+
+    uint32_t missed = busStats.RxMissed + busStats.RxDropped;
+    if (_verboseLogging && missed != stats->_canRxMissed) {
+        MessageOutput.printf("[%s] %d frame(s) lost due to full RX queue\r\n",
+                _providerName, missed - stats->_canRxMissed);
     }
 
-    onMessage(rx_message);
+    stats->_canRxMissed = missed;
+    stats->_canBusErrors = busStats.BusErrors;
+    stats->_canStatsValid = true;
 }
 
 uint8_t BatteryCanReceiver::readUnsignedInt8(uint8_t *data)
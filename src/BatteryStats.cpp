@@ -5,6 +5,7 @@
 #include "Configuration.h"
 #include "MqttSettings.h"
 #include "JkBmsDataPoints.h"
+#include "Telemetry.h"
 #include "MqttSettings.h"
 
 template<typename T>
@@ -67,6 +68,21 @@ void BatteryStats::setManufacturer(const String& m)
     _manufacturer = std::move(sanitized);
 }
 
+void BatteryStats::getTelemetry(BatteryTelemetry& telemetry) const
+{
+    telemetry.socValid = isSoCValid();
+    telemetry.soc = _soc;
+    telemetry.socLastUpdate = _lastUpdateSoC;
+    telemetry.voltageValid = isVoltageValid();
+    telemetry.voltage = _voltage;
+    telemetry.voltageLastUpdate = _lastUpdateVoltage;
+    telemetry.currentValid = isCurrentValid();
+    telemetry.chargeCurrent = _current;
+    telemetry.chargeCurrentLimitation = getChargeCurrentLimitation();
+    telemetry.immediateChargingRequest = getImmediateChargingRequest();
+    telemetry.lastUpdate = _lastUpdate;
+}
+
 bool BatteryStats::updateAvailable(uint32_t since) const
 {
     if (_lastUpdate == 0) { return false; } // no data at all processed yet
@@ -105,6 +121,13 @@ void BatteryStats::getLiveViewData(JsonVariant& root) const
         addLiveViewValue(root, "dischargeCurrentLimitation", _dischargeCurrentLimit, "A", 1);
     }
 
+    if (_canStatsValid) {
+        addLiveViewInSection(root, "can", "canRxFrames", _canRxFrames, "", 0);
+        addLiveViewInSection(root, "can", "canRxIgnored", _canRxIgnored, "", 0);
+        addLiveViewInSection(root, "can", "canRxMissed", _canRxMissed, "", 0);
+        addLiveViewInSection(root, "can", "canBusErrors", _canBusErrors, "", 0);
+    }
+
     root["showIssues"] = supportsAlarmsAndWarnings();
 }
 
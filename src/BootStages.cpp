@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "BootStages.h"
+#include "MessageOutput.h"
+#include <esp_timer.h>
+#include <cstring>
+
+BootStagesClass BootStages;
+
+void BootStagesClass::add(char const* name, std::vector<char const*> dependencies, StageFunc func, bool concurrent)
+{
+    Stage stage;
+    stage.Name = name;
+    stage.Dependencies = std::move(dependencies);
+    stage.Func = std::move(func);
+    stage.Concurrent = concurrent;
+    _stages.push_back(std::move(stage));
+}
+
+void BootStagesClass::run(Scheduler& scheduler)
+{
+    for (auto const& stage : _stages) {
+        for (auto dependency : stage.Dependencies) {
+            if (find(dependency) == nullptr) {
+                MessageOutput.printf("[BootStages] Unknown dependency '%s' of stage '%s'\r\n",
+                    dependency, stage.Name);
+            }
+        }
+    }
+
+    for (auto& stage : _stages) {
+        startConcurrentStages();
+
+        if (stage.Concurrent || stage.Status == State::Done) {
+            continue;
+        }
+
+        for (auto dependency : stage.Dependencies) {
+            auto dep = find(dependency);
+            if (dep != nullptr) {
+                waitFor(*dep, scheduler);
+            }
+        }
+
+        execute(stage, scheduler);
+        stage.Status = State::Done;
+    }
+
+    // concurrent stages may depend on each other, hence they are joined
+    // in the order they were added, which starts the dependent ones
+    for (auto& stage : _stages) {
+        startConcurrentStages();
+        waitFor(stage, scheduler);
+    }
+
+    _setupDoneUs = esp_timer_get_time();
+    MessageOutput.printf("[BootStages] Setup done after %u ms\r\n", _setupDoneUs.load() / 1000);
+
+    // the timings are kept, the stages are not needed anymore
+    _stages.clear();
+    _stages.shrink_to_fit();
+}
+
+BootStagesClass::Stage* BootStagesClass::find(char const* name)
+{
+    for (auto& stage : _stages) {
+        if (strcmp(stage.Name, name) == 0) {
+            return &stage;
+        }
+    }
+
+    return nullptr;
+}
+
+bool BootStagesClass::dependenciesDone(Stage const& stage)
+{
+    for (auto dependency : stage.Dependencies) {
+        auto dep = find(dependency);
+        if (dep != nullptr && dep->Status != State::Done) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BootStagesClass::startConcurrentStages()
+{
+    for (auto& stage : _stages) {
+        if (!stage.Concurrent || stage.Status != State::Pending || !dependenciesDone(stage)) {
+            continue;
+        }
+
+        stage.StageScheduler = std::make_unique<Scheduler>();
+        stage.Finished = xSemaphoreCreateBinary();
+        stage.Status = State::Running;
+
+        if (xTaskCreate(stageTask, stage.Name, BOOT_STAGES_TASK_STACK_SIZE,
+                &stage, uxTaskPriorityGet(nullptr), nullptr) != pdPASS) {
+            // run it on the main task instead, waitFor() joins it
+            MessageOutput.printf("[BootStages] Failed to start task for stage '%s'\r\n", stage.Name);
+            execute(stage, *stage.StageScheduler);
+            xSemaphoreGive(stage.Finished);
+        }
+    }
+}
+
+void BootStagesClass::waitFor(Stage& stage, Scheduler& scheduler)
+{
+    switch (stage.Status) {
+    case State::Done:
+        return;
+    case State::Running:
+        join(stage, scheduler);
+        return;
+    case State::Pending:
+        // a stage added later or a concurrent stage waiting for one, the
+        // dependency graph does not match the order of the stages
+        for (auto dependency : stage.Dependencies) {
+            auto dep = find(dependency);
+            if (dep != nullptr) {
+                waitFor(*dep, scheduler);
+            }
+        }
+        execute(stage, scheduler);
+        stage.Status = State::Done;
+        return;
+    }
+}
+
+void BootStagesClass::join(Stage& stage, Scheduler& scheduler)
+{
+    xSemaphoreTake(stage.Finished, portMAX_DELAY);
+    vSemaphoreDelete(stage.Finished);
+    stage.Finished = nullptr;
+
+    // tasks keep their state (e.g. enabled) when moved
+    while (Task* task = stage.StageScheduler->getFirstTask()) {
+        stage.StageScheduler->deleteTask(*task);
+        scheduler.addTask(*task);
+    }
+    stage.StageScheduler.reset();
+
+    stage.Status = State::Done;
+}
+
+void BootStagesClass::execute(Stage& stage, Scheduler& scheduler)
+{
+    Timing timing;
+    timing.Name = stage.Name;
+    timing.Concurrent = stage.Concurrent;
+    timing.StartUs = esp_timer_get_time();
+
+    stage.Func(scheduler);
+
+    timing.DurationUs = esp_timer_get_time() - timing.StartUs;
+
+    MessageOutput.printf("[BootStages] Stage '%s' took %u ms%s\r\n", stage.Name,
+        timing.DurationUs / 1000, stage.Concurrent ? " (concurrent)" : "");
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _timings.push_back(timing);
+}
+
+void BootStagesClass::stageTask(void* arg)
+{
+    auto stage = static_cast<Stage*>(arg);
+    BootStages.execute(*stage, *stage->StageScheduler);
+    xSemaphoreGive(stage->Finished);
+    vTaskDelete(nullptr);
+}
+
+std::vector<BootStagesClass::Timing> BootStagesClass::getTimings() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _timings;
+}
+
+void BootStagesClass::onLimitCommand()
+{
+    uint32_t expected = 0;
+    _firstLimitCommandUs.compare_exchange_strong(expected, esp_timer_get_time());
+}
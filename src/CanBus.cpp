@@ -0,0 +1,447 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "CanBus.h"
+#include "MessageOutput.h"
+#include "SPIPortManager.h"
+#include <FunctionalInterrupt.h>
+#include <algorithm>
+#include <SPI.h>
+#include <mcp_can.h>
+
+CanBusesClass CanBuses;
+
+#define CAN_BUS_TASK_STACK_SIZE 3072
+#define CAN_BUS_TASK_PRIORITY 1
+#define CAN_BUS_POLL_TIMEOUT_MS 50
+#define CAN_BUS_TX_QUEUE_LENGTH 8
+
+static constexpr char const spiOwner[] = "CAN MCP2515";
+
+CanBus::~CanBus()
+{
+    stopTask();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto const& consumer : _consumers) {
+        vQueueDelete(consumer.queue);
+    }
+    _consumers.clear();
+}
+
+QueueHandle_t CanBus::subscribe(uint32_t filter, uint32_t mask, bool extended, size_t queueLength)
+{
+    QueueHandle_t queue = xQueueCreate(queueLength, sizeof(twai_message_t));
+    if (queue == nullptr) { return nullptr; }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _consumers.push_back({ filter, mask, extended, queue });
+    return queue;
+}
+
+void CanBus::unsubscribe(QueueHandle_t queue)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto it = _consumers.begin(); it != _consumers.end(); ++it) {
+        if (it->queue != queue) { continue; }
+        vQueueDelete(queue);
+        _consumers.erase(it);
+        return;
+    }
+}
+
+CanBus::Stats CanBus::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+void CanBus::dispatch(twai_message_t const& frame)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    _stats.RxFrames++;
+
+    bool matched = false;
+    for (auto const& consumer : _consumers) {
+        if (static_cast<bool>(frame.extd) != consumer.extended) { continue; }
+        if ((frame.identifier & consumer.mask) != (consumer.filter & consumer.mask)) { continue; }
+
+        matched = true;
+        if (xQueueSend(consumer.queue, &frame, 0) != pdTRUE) {
+            _stats.RxDropped++;
+        }
+    }
+
+    if (!matched) { _stats.RxUnmatched++; }
+}
+
+bool CanBus::startTask(char const* name)
+{
+    _stopRequested = false;
+
+    TaskHandle_t task = nullptr;
+    if (xTaskCreate(CanBus::taskFunc, name, CAN_BUS_TASK_STACK_SIZE,
+            this, CAN_BUS_TASK_PRIORITY, &task) != pdPASS) {
+        MessageOutput.printf("[CanBus] Failed to create task %s\r\n", name);
+        return false;
+    }
+
+    _task = task;
+    return true;
+}
+
+void CanBus::stopTask()
+{
+    if (_task == nullptr) { return; }
+
+    _stopRequested = true;
+    xTaskNotifyGive(_task);
+
+    while (_task != nullptr) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+void CanBus::taskFunc(void* parameter)
+{
+    auto bus = static_cast<CanBus*>(parameter);
+
+    while (!bus->_stopRequested) {
+        bus->poll();
+    }
+
+    bus->_task = nullptr;
+    vTaskDelete(nullptr);
+}
+
+// *******************************************************
+// TWAI
+// *******************************************************
+
+TwaiCanBus::~TwaiCanBus()
+{
+    stopTask();
+
+    if (!_installed) { return; }
+
+    if (twai_stop() != ESP_OK) {
+        MessageOutput.println("[CanBus] Twai driver stop - invalid state");
+    }
+
+    if (twai_driver_uninstall() != ESP_OK) {
+        MessageOutput.println("[CanBus] Twai driver uninstall - invalid state");
+        return;
+    }
+
+    MessageOutput.println("[CanBus] Twai driver uninstalled");
+}
+
+bool TwaiCanBus::begin()
+{
+    MessageOutput.printf("[CanBus] Twai interface rx = %d, tx = %d, %u bit/s\r\n",
+            _rx, _tx, getBitrate());
+
+    if (_rx < 0 || _tx < 0) {
+        MessageOutput.println("[CanBus] Invalid Twai pin config");
+        return false;
+    }
+
+    twai_timing_config_t t_config;
+    switch (getBitrate()) {
+        case 125000:
+            t_config = TWAI_TIMING_CONFIG_125KBITS();
+            break;
+        case 250000:
+            t_config = TWAI_TIMING_CONFIG_250KBITS();
+            break;
+        case 500000:
+            t_config = TWAI_TIMING_CONFIG_500KBITS();
+            break;
+        case 1000000:
+            t_config = TWAI_TIMING_CONFIG_1MBITS();
+            break;
+        default:
+            MessageOutput.printf("[CanBus] Unsupported bit rate %u\r\n", getBitrate());
+            return false;
+    }
+
+    auto tx = static_cast<gpio_num_t>(_tx);
+    auto rx = static_cast<gpio_num_t>(_rx);
+    twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(tx, rx, TWAI_MODE_NORMAL);
+
+    // interrupts at level 1 are in high demand, at least on ESP32-S3 boards,
+    // but only a limited amount can be allocated. failing to allocate an
+    // interrupt in the TWAI driver will cause a bootloop. we therefore
+    // register the TWAI driver's interrupt at level 2. level 2 interrupts
+    // should be available -- we don't really know. we would love to have the
+    // esp_intr_dump() function, but that's not available yet in our version
+    // of the underlying esp-idf.
+    g_config.intr_flags = ESP_INTR_FLAG_LEVEL2;
+
+    // devices send their data in bursts. the driver queue must hold a
+    // burst until the bus task distributed it to the consumer queues.
+    g_config.rx_queue_len = 32;
+    g_config.tx_queue_len = CAN_BUS_TX_QUEUE_LENGTH;
+
+    // consumers filter by identifier in software
+    twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+
+    switch (twai_driver_install(&g_config, &t_config, &f_config)) {
+        case ESP_OK:
+            MessageOutput.println("[CanBus] Twai driver installed");
+            break;
+        case ESP_ERR_INVALID_ARG:
+            MessageOutput.println("[CanBus] Twai driver install - invalid arg");
+            return false;
+        case ESP_ERR_NO_MEM:
+            MessageOutput.println("[CanBus] Twai driver install - no memory");
+            return false;
+        case ESP_ERR_INVALID_STATE:
+            MessageOutput.println("[CanBus] Twai driver install - invalid state");
+            return false;
+        default:
+            return false;
+    }
+    _installed = true;
+
+    if (twai_start() != ESP_OK) {
+        MessageOutput.println("[CanBus] Twai driver start - invalid state");
+        return false;
+    }
+    MessageOutput.println("[CanBus] Twai driver started");
+
+    return startTask("CAN_TWAI");
+}
+
+bool TwaiCanBus::send(twai_message_t const& frame)
+{
+    // the driver's TX queue is thread-safe and arbitrates between consumers
+    bool success = twai_transmit(&frame, 0) == ESP_OK;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (success) {
+        _stats.TxFrames++;
+    } else {
+        _stats.TxErrors++;
+    }
+    return success;
+}
+
+void TwaiCanBus::poll()
+{
+    twai_message_t frame;
+    if (twai_receive(&frame, pdMS_TO_TICKS(CAN_BUS_POLL_TIMEOUT_MS)) == ESP_OK) {
+        do {
+            dispatch(frame);
+        } while (twai_receive(&frame, 0) == ESP_OK);
+    }
+
+    twai_status_info_t status_info;
+    if (twai_get_status_info(&status_info) != ESP_OK) { return; }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.RxMissed = status_info.rx_missed_count;
+    _stats.BusErrors = status_info.bus_error_count;
+}
+
+// *******************************************************
+// MCP2515
+// *******************************************************
+
+Mcp2515CanBus::~Mcp2515CanBus()
+{
+    if (_irq >= 0) {
+        detachInterrupt(digitalPinToInterrupt(_irq));
+    }
+
+    stopTask();
+
+    if (_txQueue != nullptr) {
+        vQueueDelete(_txQueue);
+    }
+
+    _can.reset();
+
+    if (_spi) {
+        _spi->end();
+        _spi.reset();
+        SPIPortManager.freePort(spiOwner);
+    }
+}
+
+bool Mcp2515CanBus::begin(int8_t miso, int8_t mosi, int8_t clk, int8_t irq, int8_t cs, uint32_t oscillatorFrequency)
+{
+    uint8_t mcp_bitrate;
+    switch (getBitrate()) {
+        case 125000:
+            mcp_bitrate = CAN_125KBPS;
+            break;
+        case 250000:
+            mcp_bitrate = CAN_250KBPS;
+            break;
+        case 500000:
+            mcp_bitrate = CAN_500KBPS;
+            break;
+        case 1000000:
+            mcp_bitrate = CAN_1000KBPS;
+            break;
+        default:
+            MessageOutput.printf("[CanBus] Unsupported bit rate %u\r\n", getBitrate());
+            return false;
+    }
+
+    auto oSPInum = SPIPortManager.allocatePort(spiOwner);
+    if (!oSPInum) { return false; }
+
+    _spi = std::make_unique<SPIClass>(*oSPInum);
+    _spi->begin(clk, miso, mosi, cs);
+    pinMode(cs, OUTPUT);
+    digitalWrite(cs, HIGH);
+    _cs = cs;
+
+    pinMode(irq, INPUT_PULLUP);
+
+    auto mcp_frequency = MCP_8MHZ;
+    if (16000000UL == oscillatorFrequency) { mcp_frequency = MCP_16MHZ; }
+    else if (8000000UL != oscillatorFrequency) {
+        MessageOutput.printf("[CanBus] MCP2515: unknown frequency %u Hz, using 8 MHz\r\n", oscillatorFrequency);
+    }
+
+    _can = std::make_unique<MCP_CAN>(_spi.get(), cs);
+    if (_can->begin(MCP_STDEXT, mcp_bitrate, mcp_frequency) != CAN_OK) {
+        MessageOutput.println("[CanBus] MCP2515 initialization failed");
+        return false;
+    }
+
+    // consumers filter by identifier in software, accept all frames
+    _can->init_Mask(0, 1, 0);
+    _can->init_Mask(1, 1, 0);
+
+    // Change to normal mode to allow messages to be transmitted
+    _can->setMode(MCP_NORMAL);
+
+    _txQueue = xQueueCreate(CAN_BUS_TX_QUEUE_LENGTH, sizeof(twai_message_t));
+    if (_txQueue == nullptr) { return false; }
+
+    // the bus task reads the INT pin as soon as it runs. the interrupt
+    // handler ignores edges until the task exists.
+    _irq = irq;
+    attachInterrupt(digitalPinToInterrupt(irq), std::bind(&Mcp2515CanBus::onInterrupt, this), FALLING);
+
+    if (!startTask("CAN_MCP2515")) {
+        detachInterrupt(digitalPinToInterrupt(irq));
+        return false;
+    }
+
+    MessageOutput.println("[CanBus] MCP2515 initialized successfully");
+    return true;
+}
+
+void ARDUINO_ISR_ATTR Mcp2515CanBus::onInterrupt()
+{
+    if (_task == nullptr) { return; }
+
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(_task, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+bool Mcp2515CanBus::send(twai_message_t const& frame)
+{
+    if (xQueueSend(_txQueue, &frame, 0) != pdTRUE) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats.TxErrors++;
+        return false;
+    }
+
+    // the SPI bus is only accessed by the bus task
+    if (_task != nullptr) { xTaskNotifyGive(_task); }
+    return true;
+}
+
+void Mcp2515CanBus::poll()
+{
+    // the INT pin stays low as long as frames are pending. the timeout
+    // is a safety net in case a falling edge was missed.
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CAN_BUS_POLL_TIMEOUT_MS));
+
+    while (!digitalRead(_irq)) {
+        INT32U rxId;
+        INT8U len = 0;
+        twai_message_t frame = {};
+        if (_can->readMsgBuf(&rxId, &len, frame.data) != CAN_OK) { break; }
+
+        // the library flags extended identifiers with bit 31 and remote frames with bit 30
+        frame.extd = (rxId & 0x80000000) ? 1 : 0;
+        frame.rtr = (rxId & 0x40000000) ? 1 : 0;
+        frame.identifier = rxId & (frame.extd ? 0x1FFFFFFF : 0x7FF);
+        frame.data_length_code = std::min<INT8U>(len, 8);
+
+        dispatch(frame);
+    }
+
+    twai_message_t frame;
+    while (xQueueReceive(_txQueue, &frame, 0) == pdTRUE) {
+        bool success = _can->sendMsgBuf(frame.identifier, frame.extd, frame.data_length_code, frame.data) == CAN_OK;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (success) {
+            _stats.TxFrames++;
+        } else {
+            _stats.TxErrors++;
+        }
+    }
+}
+
+// *******************************************************
+// Bus registry
+// *******************************************************
+
+std::shared_ptr<CanBus> CanBusesClass::getTwai(int8_t rx, int8_t tx, uint32_t bitrate)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto bus = _twai.lock();
+    if (bus) {
+        if (!bus->usesPins(rx, tx) || bus->getBitrate() != bitrate) {
+            MessageOutput.printf("[CanBus] Twai controller already in use at %u bit/s "
+                    "and cannot be shared with a device using %u bit/s or other pins\r\n",
+                    bus->getBitrate(), bitrate);
+            return nullptr;
+        }
+        return bus;
+    }
+
+    bus = std::make_shared<TwaiCanBus>(rx, tx, bitrate);
+    if (!bus->begin()) { return nullptr; }
+
+    _twai = bus;
+    return bus;
+}
+
+std::shared_ptr<CanBus> CanBusesClass::getMcp2515(int8_t miso, int8_t mosi, int8_t clk,
+        int8_t irq, int8_t cs, uint32_t oscillatorFrequency, uint32_t bitrate)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto bus = _mcp2515.lock();
+    if (bus) {
+        if (!bus->usesPins(irq, cs) || bus->getBitrate() != bitrate) {
+            MessageOutput.printf("[CanBus] MCP2515 already in use at %u bit/s "
+                    "and cannot be shared with a device using %u bit/s or other pins\r\n",
+                    bus->getBitrate(), bitrate);
+            return nullptr;
+        }
+        return bus;
+    }
+
+    bus = std::make_shared<Mcp2515CanBus>(bitrate);
+    if (!bus->begin(miso, mosi, clk, irq, cs, oscillatorFrequency)) { return nullptr; }
+
+    _mcp2515 = bus;
+    return bus;
+}
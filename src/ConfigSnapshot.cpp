@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "ConfigSnapshot.h"
+#include "MessageOutput.h"
+#include <LittleFS.h>
+#include <esp_ota_ops.h>
+#include <esp_rom_crc.h>
+#include <string.h>
+
+ConfigSnapshotClass ConfigSnapshot;
+
+void ConfigSnapshotClass::getFileHeader(FileHeader& header)
+{
+    memset(&header, 0, sizeof(header));
+    header.magic = Magic;
+    header.formatVersion = FormatVersion;
+
+    // the struct layout may change with every build, even if the config
+    // version stays the same. hence the snapshot is bound to the image.
+    const esp_app_desc_t* desc = esp_ota_get_app_description();
+    memcpy(header.firmwareId, desc->app_elf_sha256, FirmwareIdLength);
+}
+
+bool ConfigSnapshotClass::load(Section section, size_t sourceSize, uint32_t sourceCrc, void* data, size_t len)
+{
+    if (!LittleFS.exists(CONFIG_SNAPSHOT_FILENAME)) {
+        return false;
+    }
+
+    File f = LittleFS.open(CONFIG_SNAPSHOT_FILENAME, "r", false);
+    if (!f) {
+        return false;
+    }
+
+    FileHeader expected;
+    getFileHeader(expected);
+
+    FileHeader header;
+    if (f.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header)
+        || memcmp(&header, &expected, sizeof(header)) != 0) {
+        f.close();
+        return false;
+    }
+
+    SectionHeader sh;
+    while (f.read(reinterpret_cast<uint8_t*>(&sh), sizeof(sh)) == sizeof(sh)) {
+        if (sh.section != static_cast<uint32_t>(section)) {
+            if (!f.seek(sh.length, SeekCur)) {
+                break;
+            }
+            continue;
+        }
+
+        bool valid = sh.length == len
+            && sh.sourceSize == sourceSize
+            && sh.sourceCrc == sourceCrc
+            && f.read(static_cast<uint8_t*>(data), len) == len
+            && esp_rom_crc32_le(0, static_cast<uint8_t const*>(data), len) == sh.crc;
+
+        if (!valid) {
+            // do not leave a partially read struct behind
+            memset(data, 0, len);
+        }
+
+        f.close();
+        return valid;
+    }
+
+    f.close();
+    return false;
+}
+
+bool ConfigSnapshotClass::store(Section section, size_t sourceSize, uint32_t sourceCrc, void const* data, size_t len)
+{
+    FileHeader expected;
+    getFileHeader(expected);
+
+    SectionHeader sh;
+    sh.section = static_cast<uint32_t>(section);
+    sh.sourceSize = sourceSize;
+    sh.sourceCrc = sourceCrc;
+    sh.length = len;
+    sh.crc = esp_rom_crc32_le(0, static_cast<uint8_t const*>(data), len);
+
+    // try to update the section in place, keeping the other sections intact
+    File f;
+    if (LittleFS.exists(CONFIG_SNAPSHOT_FILENAME)) {
+        f = LittleFS.open(CONFIG_SNAPSHOT_FILENAME, "r+", false);
+    }
+    if (f) {
+        FileHeader header;
+        bool headerValid = f.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header)
+            && memcmp(&header, &expected, sizeof(header)) == 0;
+
+        size_t offset = sizeof(header);
+        SectionHeader existing;
+        while (headerValid && f.read(reinterpret_cast<uint8_t*>(&existing), sizeof(existing)) == sizeof(existing)) {
+            if (existing.section != sh.section) {
+                offset += sizeof(existing) + existing.length;
+                if (!f.seek(offset, SeekSet)) {
+                    headerValid = false;
+                }
+                continue;
+            }
+
+            if (existing.length != len) {
+                // layout changed, start over with a fresh file
+                headerValid = false;
+            }
+            break;
+        }
+
+        if (headerValid && f.seek(offset, SeekSet)) {
+            bool success = f.write(reinterpret_cast<uint8_t const*>(&sh), sizeof(sh)) == sizeof(sh)
+                && f.write(static_cast<uint8_t const*>(data), len) == len;
+            f.close();
+            return success;
+        }
+
+        f.close();
+    }
+
+    f = LittleFS.open(CONFIG_SNAPSHOT_FILENAME, "w");
+    if (!f) {
+        return false;
+    }
+
+    bool success = f.write(reinterpret_cast<uint8_t const*>(&expected), sizeof(expected)) == sizeof(expected)
+        && f.write(reinterpret_cast<uint8_t const*>(&sh), sizeof(sh)) == sizeof(sh)
+        && f.write(static_cast<uint8_t const*>(data), len) == len;
+    f.close();
+
+    if (!success) {
+        MessageOutput.println("Failed to write config snapshot");
+        invalidate();
+    }
+
+    return success;
+}
+
+void ConfigSnapshotClass::invalidate()
+{
+    if (LittleFS.exists(CONFIG_SNAPSHOT_FILENAME)) {
+        LittleFS.remove(CONFIG_SNAPSHOT_FILENAME);
+    }
+}
+
+uint32_t ConfigSnapshotClass::getChecksum(File& source)
+{
+    uint32_t crc = 0;
+    uint8_t buf[256];
+
+    source.seek(0, SeekSet);
+    size_t read;
+    while ((read = source.read(buf, sizeof(buf))) > 0) {
+        crc = esp_rom_crc32_le(crc, buf, read);
+    }
+    source.seek(0, SeekSet);
+
+    return crc;
+}
@@ -3,6 +3,7 @@
  * Copyright (C) 2022-2024 Thomas Basler and others
  */
 #include "Configuration.h"
+#include "ConfigSnapshot.h"
 #include "MessageOutput.h"
 #include "NetworkSettings.h"
 #include "Utils.h"
@@ -229,6 +230,7 @@ bool ConfigurationClass::write()
     vedirect["enabled"] = config.Vedirect.Enabled;
     vedirect["verbose_logging"] = config.Vedirect.VerboseLogging;
     vedirect["updates_only"] = config.Vedirect.UpdatesOnly;
+    vedirect["fast_poll_interval"] = config.Vedirect.FastPollInterval;
 
     JsonObject powermeter = doc["powermeter"].to<JsonObject>();
     powermeter["enabled"] = config.PowerMeter.Enabled;
@@ -257,6 +259,7 @@ bool ConfigurationClass::write()
     powerlimiter["is_inverter_behind_powermeter"] = config.PowerLimiter.IsInverterBehindPowerMeter;
     powerlimiter["is_inverter_solar_powered"] = config.PowerLimiter.IsInverterSolarPowered;
     powerlimiter["use_overscaling_to_compensate_shading"] = config.PowerLimiter.UseOverscalingToCompensateShading;
+    powerlimiter["predictive_control"] = config.PowerLimiter.PredictiveControl;
     powerlimiter["inverter_id"] = config.PowerLimiter.InverterId;
     powerlimiter["inverter_channel_id"] = config.PowerLimiter.InverterChannelId;
     powerlimiter["target_power_consumption"] = config.PowerLimiter.TargetPowerConsumption;
@@ -291,18 +294,32 @@ bool ConfigurationClass::write()
     huawei["upper_power_limit"] = config.Huawei.Auto_Power_Upper_Power_Limit;
     huawei["stop_batterysoc_threshold"] = config.Huawei.Auto_Power_Stop_BatterySoC_Threshold;
     huawei["target_power_consumption"] = config.Huawei.Auto_Power_Target_Power_Consumption;
+    huawei["auto_power_kp"] = config.Huawei.Auto_Power_Kp;
+    huawei["auto_power_ki"] = config.Huawei.Auto_Power_Ki;
+    huawei["auto_power_max_ramp"] = config.Huawei.Auto_Power_Max_Ramp;
 
     if (!Utils::checkJsonAlloc(doc, __FUNCTION__, __LINE__)) {
         return false;
     }
 
     // Serialize JSON to file
-    if (serializeJson(doc, f) == 0) {
+    const size_t written = serializeJson(doc, f);
+    if (written == 0) {
         MessageOutput.println("Failed to write file");
+        ConfigSnapshot.invalidate();
         return false;
     }
 
     f.close();
+
+    // the snapshot is bound to the checksum of the file as written
+    f = LittleFS.open(CONFIG_FILENAME, "r", false);
+    if (f) {
+        ConfigSnapshot.store(ConfigSnapshotClass::Section::Config, f.size(), ConfigSnapshotClass::getChecksum(f), &config, sizeof(config));
+        f.close();
+    } else {
+        ConfigSnapshot.invalidate();
+    }
     return true;
 }
 
@@ -393,6 +410,14 @@ bool ConfigurationClass::read()
 {
     File f = LittleFS.open(CONFIG_FILENAME, "r", false);
 
+    // Skip parsing the JSON file if it was not changed since the
+    // binary snapshot of the configuration was taken.
+    const uint32_t sourceCrc = f ? ConfigSnapshotClass::getChecksum(f) : 0;
+    if (f && ConfigSnapshot.load(ConfigSnapshotClass::Section::Config, f.size(), sourceCrc, &config, sizeof(config))) {
+        f.close();
+        return true;
+    }
+
     JsonDocument doc;
 
     // Deserialize the JSON document
@@ -561,6 +586,7 @@ bool ConfigurationClass::read()
     config.Vedirect.Enabled = vedirect["enabled"] | VEDIRECT_ENABLED;
     config.Vedirect.VerboseLogging = vedirect["verbose_logging"] | VEDIRECT_VERBOSE_LOGGING;
     config.Vedirect.UpdatesOnly = vedirect["updates_only"] | VEDIRECT_UPDATESONLY;
+    config.Vedirect.FastPollInterval = vedirect["fast_poll_interval"] | VEDIRECT_FAST_POLL_INTERVAL;
 
     JsonObject powermeter = doc["powermeter"];
     config.PowerMeter.Enabled = powermeter["enabled"] | POWERMETER_ENABLED;
@@ -623,6 +649,7 @@ bool ConfigurationClass::read()
     config.PowerLimiter.IsInverterBehindPowerMeter = powerlimiter["is_inverter_behind_powermeter"] | POWERLIMITER_IS_INVERTER_BEHIND_POWER_METER;
     config.PowerLimiter.IsInverterSolarPowered = powerlimiter["is_inverter_solar_powered"] | POWERLIMITER_IS_INVERTER_SOLAR_POWERED;
     config.PowerLimiter.UseOverscalingToCompensateShading = powerlimiter["use_overscaling_to_compensate_shading"] | POWERLIMITER_USE_OVERSCALING_TO_COMPENSATE_SHADING;
+    config.PowerLimiter.PredictiveControl = powerlimiter["predictive_control"] | POWERLIMITER_PREDICTIVE_CONTROL;
     config.PowerLimiter.InverterId = powerlimiter["inverter_id"] | POWERLIMITER_INVERTER_ID;
     config.PowerLimiter.InverterChannelId = powerlimiter["inverter_channel_id"] | POWERLIMITER_INVERTER_CHANNEL_ID;
     config.PowerLimiter.TargetPowerConsumption = powerlimiter["target_power_consumption"] | POWERLIMITER_TARGET_POWER_CONSUMPTION;
@@ -656,6 +683,13 @@ bool ConfigurationClass::read()
     config.Huawei.Auto_Power_Upper_Power_Limit = huawei["upper_power_limit"] | HUAWEI_AUTO_POWER_UPPER_POWER_LIMIT;
     config.Huawei.Auto_Power_Stop_BatterySoC_Threshold = huawei["stop_batterysoc_threshold"] | HUAWEI_AUTO_POWER_STOP_BATTERYSOC_THRESHOLD;
     config.Huawei.Auto_Power_Target_Power_Consumption = huawei["target_power_consumption"] | HUAWEI_AUTO_POWER_TARGET_POWER_CONSUMPTION;
+    config.Huawei.Auto_Power_Kp = huawei["auto_power_kp"] | HUAWEI_AUTO_POWER_KP;
+    config.Huawei.Auto_Power_Ki = huawei["auto_power_ki"] | HUAWEI_AUTO_POWER_KI;
+    config.Huawei.Auto_Power_Max_Ramp = huawei["auto_power_max_ramp"] | HUAWEI_AUTO_POWER_MAX_RAMP;
+
+    if (f && !error) {
+        ConfigSnapshot.store(ConfigSnapshotClass::Section::Config, f.size(), sourceCrc, &config, sizeof(config));
+    }
 
     f.close();
     return true;
@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "ConsoleCommands.h"
+#include "MessageOutput.h"
+#include "TaskMonitor.h"
+#include <HardwareSerial.h>
+
+ConsoleCommandsClass ConsoleCommands;
+
+ConsoleCommandsClass::ConsoleCommandsClass()
+    : _loopTask(50 * TASK_MILLISECOND, TASK_FOREVER, TaskMonitor.wrap("Console commands", std::bind(&ConsoleCommandsClass::loop, this)))
+{
+}
+
+void ConsoleCommandsClass::init(Scheduler& scheduler)
+{
+    add("help", "list the available commands", [this](Print& out, String const&) {
+        for (auto const& command : _commands) {
+            out.printf("%-10s %s\r\n", command.Name, command.Help);
+        }
+    });
+
+    add("tasks", "scheduler task statistics, \"tasks reset\" clears them", [](Print& out, String const& args) {
+        if (args == "reset") {
+            TaskMonitor.reset();
+            out.println("Task statistics cleared");
+            return;
+        }
+        TaskMonitor.printStats(out);
+    });
+
+    scheduler.addTask(_loopTask);
+    _loopTask.enable();
+}
+
+void ConsoleCommandsClass::add(char const* name, char const* help, Handler handler)
+{
+    _commands.push_back({ name, help, std::move(handler) });
+}
+
+void ConsoleCommandsClass::enqueue(String const& line)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _pending.push(line);
+}
+
+void ConsoleCommandsClass::loop()
+{
+    while (Serial.available() > 0) {
+        const char c = Serial.read();
+        if (c == '\r' || c == '\n') {
+            if (_serialLine.length() > 0) {
+                execute(_serialLine);
+                _serialLine = "";
+            }
+            continue;
+        }
+
+        if (_serialLine.length() < CONSOLE_COMMAND_MAX_LENGTH) {
+            _serialLine += c;
+        }
+    }
+
+    std::queue<String> pending;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::swap(pending, _pending);
+    }
+
+    while (!pending.empty()) {
+        execute(pending.front());
+        pending.pop();
+    }
+}
+
+void ConsoleCommandsClass::execute(String line)
+{
+    line.trim();
+    if (line.length() == 0) {
+        return;
+    }
+
+    String name = line;
+    String args;
+    const int space = line.indexOf(' ');
+    if (space >= 0) {
+        name = line.substring(0, space);
+        args = line.substring(space + 1);
+        args.trim();
+    }
+
+    MessageOutput.printf("> %s\r\n", line.c_str());
+
+    for (auto const& command : _commands) {
+        if (name == command.Name) {
+            command.Func(MessageOutput, args);
+            return;
+        }
+    }
+
+    MessageOutput.printf("Unknown command '%s', see \"help\"\r\n", name.c_str());
+}
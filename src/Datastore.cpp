@@ -4,12 +4,14 @@
  */
 #include "Datastore.h"
 #include "Configuration.h"
+#include "TaskMonitor.h"
+#include "Telemetry.h"
 #include <Hoymiles.h>
 
 DatastoreClass Datastore;
 
 DatastoreClass::DatastoreClass()
-    : _loopTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&DatastoreClass::loop, this))
+    : _loopTask(1 * TASK_SECOND, TASK_FOREVER, TaskMonitor.wrap("Datastore", std::bind(&DatastoreClass::loop, this)))
 {
 }
 
@@ -116,6 +118,13 @@ void DatastoreClass::loop()
     _isAtLeastOnePollEnabled = pollEnabledCount > 0;
 
     _totalDcIrradiation = _totalDcIrradiationInstalled > 0 ? _totalDcPowerIrradiation / _totalDcIrradiationInstalled * 100.0f : 0;
+
+    InverterTelemetry telemetry = {};
+    telemetry.totalAcPower = _totalAcPowerEnabled;
+    telemetry.totalDcPower = _totalDcPowerEnabled;
+    telemetry.isAtLeastOneProducing = _isAtLeastOneProducing;
+    telemetry.isAllEnabledReachable = _isAllEnabledReachable;
+    Telemetry.publish(telemetry);
 }
 
 float DatastoreClass::getTotalAcYieldTotalEnabled()
@@ -6,6 +6,7 @@
 #include "Datastore.h"
 #include "PowerMeter.h"
 #include "Configuration.h"
+#include "TaskMonitor.h"
 #include <NetworkSettings.h>
 #include <map>
 #include <time.h>
@@ -47,7 +48,7 @@ static const char* const i18n_yield_total_mwh[] = { "total: %.0f kWh", "Ges.: %.
 static const char* const i18n_date_format[] = { "%m/%d/%Y %H:%M", "%d.%m.%Y %H:%M", "%d/%m/%Y %H:%M" };
 
 DisplayGraphicClass::DisplayGraphicClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&DisplayGraphicClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, TaskMonitor.wrap("Display", std::bind(&DisplayGraphicClass::loop, this)))
 {
 }
 
@@ -5,11 +5,12 @@
 #include "Display_Graphic_Diagram.h"
 #include "Configuration.h"
 #include "Datastore.h"
+#include "TaskMonitor.h"
 #include <algorithm>
 
 DisplayGraphicDiagramClass::DisplayGraphicDiagramClass()
-    : _averageTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&DisplayGraphicDiagramClass::averageLoop, this))
-    , _dataPointTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&DisplayGraphicDiagramClass::dataPointLoop, this))
+    : _averageTask(1 * TASK_SECOND, TASK_FOREVER, TaskMonitor.wrap("Display diagram average", std::bind(&DisplayGraphicDiagramClass::averageLoop, this)))
+    , _dataPointTask(TASK_IMMEDIATE, TASK_FOREVER, TaskMonitor.wrap("Display diagram", std::bind(&DisplayGraphicDiagramClass::dataPointLoop, this)))
 {
 }
 
@@ -34,19 +35,50 @@ void DisplayGraphicDiagramClass::averageLoop()
 
 void DisplayGraphicDiagramClass::dataPointLoop()
 {
-    if (_graphValuesCount >= std::size(_graphValues)) {
-        for (uint8_t i = 0; i < std::size(_graphValues) - 1; i++) {
-            _graphValues[i] = _graphValues[i + 1];
-        }
-        _graphValuesCount = std::size(_graphValues) - 1;
-    }
     if (_iRunningAverageCnt != 0) {
-        _graphValues[_graphValuesCount++] = _iRunningAverage / _iRunningAverageCnt;
+        addDataPoint(_iRunningAverage / _iRunningAverageCnt);
         _iRunningAverage = 0;
         _iRunningAverageCnt = 0;
     }
 }
 
+void DisplayGraphicDiagramClass::addDataPoint(float value)
+{
+    if (_graphValuesCount >= MAX_DATAPOINTS) {
+        // the oldest value is overwritten below, drop it from the deque
+        const uint32_t oldest = _graphValuesSequence - MAX_DATAPOINTS;
+        if (_maxSequencesCount > 0 && _maxSequences[_maxSequencesHead] == oldest) {
+            _maxSequencesHead = (_maxSequencesHead + 1) % MAX_DATAPOINTS;
+            _maxSequencesCount--;
+        }
+        _graphValuesCount--;
+    }
+
+    _graphValues[_graphValuesSequence % MAX_DATAPOINTS] = value;
+
+    // values smaller than the new one can never become the maximum again
+    while (_maxSequencesCount > 0) {
+        const uint8_t back = (_maxSequencesHead + _maxSequencesCount - 1) % MAX_DATAPOINTS;
+        if (_graphValues[_maxSequences[back] % MAX_DATAPOINTS] > value) {
+            break;
+        }
+        _maxSequencesCount--;
+    }
+    _maxSequences[(_maxSequencesHead + _maxSequencesCount) % MAX_DATAPOINTS] = _graphValuesSequence;
+    _maxSequencesCount++;
+
+    _graphValuesSequence++;
+    _graphValuesCount++;
+}
+
+float DisplayGraphicDiagramClass::getMaxDataPoint() const
+{
+    if (_maxSequencesCount == 0) {
+        return 0;
+    }
+    return std::max(0.0f, _graphValues[_maxSequences[_maxSequencesHead] % MAX_DATAPOINTS]);
+}
+
 uint32_t DisplayGraphicDiagramClass::getSecondsPerDot()
 {
     return Configuration.get().Display.Diagram.Duration / _chartWidth;
@@ -83,7 +115,7 @@ void DisplayGraphicDiagramClass::redraw(uint8_t screenSaverOffsetX, uint8_t xPos
 
     // draw AC value
     char fmtText[7];
-    const float maxWatts = *std::max_element(_graphValues.begin(), _graphValues.end());
+    const float maxWatts = getMaxDataPoint();
     if (maxWatts > 999) {
         snprintf(fmtText, sizeof(fmtText), "%2.1fkW", maxWatts / 1000);
     } else {
@@ -117,6 +149,21 @@ void DisplayGraphicDiagramClass::redraw(uint8_t screenSaverOffsetX, uint8_t xPos
         }
     }
 
+    // rescale all data points only if the scaling changed,
+    // otherwise only the ones added since the last redraw.
+    const uint32_t oldestSequence = _graphValuesSequence - _graphValuesCount;
+    uint32_t firstSequence = oldestSequence;
+    if (maxWatts != _scaledMaxWatts || height != _scaledHeight) {
+        _scaledMaxWatts = maxWatts;
+        _scaledHeight = height;
+    } else if (_graphValuesSequence - _scaledSequence < _graphValuesCount) {
+        firstSequence = _scaledSequence;
+    }
+    for (uint32_t seq = firstSequence; seq != _graphValuesSequence && scaleFactorY != 0; seq++) {
+        _graphPixels[seq % MAX_DATAPOINTS] = std::max<int16_t>(0, _graphValues[seq % MAX_DATAPOINTS] / scaleFactorY - 0.5);
+    }
+    _scaledSequence = _graphValuesSequence;
+
     uint8_t xAxisTicks = 1;
     for (uint8_t i = 1; i < _graphValuesCount; i++) {
         // draw one tick per hour to the x-axis
@@ -130,7 +177,7 @@ void DisplayGraphicDiagramClass::redraw(uint8_t screenSaverOffsetX, uint8_t xPos
         }
 
         _display->drawLine(
-            graphPosX + (i - 1) / scaleFactorX, horizontal_line_y - std::max<int16_t>(0, _graphValues[i - 1] / scaleFactorY - 0.5),
-            graphPosX + i / scaleFactorX, horizontal_line_y - std::max<int16_t>(0, _graphValues[i] / scaleFactorY - 0.5));
+            graphPosX + (i - 1) / scaleFactorX, horizontal_line_y - _graphPixels[(oldestSequence + i - 1) % MAX_DATAPOINTS],
+            graphPosX + i / scaleFactorX, horizontal_line_y - _graphPixels[(oldestSequence + i) % MAX_DATAPOINTS]);
     }
 }
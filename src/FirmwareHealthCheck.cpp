@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "FirmwareHealthCheck.h"
+#include "Configuration.h"
+#include "MessageOutput.h"
+#include "PinMapping.h"
+#include "PowerLimiter.h"
+#include "PowerMeter.h"
+#include "TaskMonitor.h"
+#include <ArduinoJson.h>
+#include <Hoymiles.h>
+#include <LittleFS.h>
+#include <esp_ota_ops.h>
+
+// the checks must pass after this time at the earliest, such that a
+// firmware which crashes shortly after booting is not marked valid
+#define FIRMWARE_HEALTH_MIN_UPTIME_MS (60 * 1000)
+
+#define FIRMWARE_HEALTH_TIMEOUT_MS (10 * 60 * 1000)
+
+FirmwareHealthCheckClass FirmwareHealthCheck;
+
+#ifdef CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+// the Arduino core marks a pending image valid before setup() is called,
+// unless this function returns true
+extern "C" bool verifyRollbackLater()
+{
+    return true;
+}
+#endif
+
+FirmwareHealthCheckClass::FirmwareHealthCheckClass()
+    : _loopTask(5 * TASK_SECOND, TASK_FOREVER, TaskMonitor.wrap("Firmware health check", std::bind(&FirmwareHealthCheckClass::loop, this)))
+{
+}
+
+void FirmwareHealthCheckClass::init(Scheduler& scheduler)
+{
+#ifdef CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+    esp_ota_img_states_t state;
+    if (esp_ota_get_state_partition(esp_ota_get_running_partition(), &state) == ESP_OK) {
+        _pendingVerify = (state == ESP_OTA_IMG_PENDING_VERIFY);
+    }
+#endif
+
+    if (!_pendingVerify) {
+        if (LittleFS.exists(FIRMWARE_HEALTH_FILENAME)) {
+            LittleFS.remove(FIRMWARE_HEALTH_FILENAME);
+        }
+        return;
+    }
+
+    // without a baseline (update from a firmware without this check),
+    // only the minimum uptime is required
+    File f = LittleFS.open(FIRMWARE_HEALTH_FILENAME, "r", false);
+    if (f) {
+        JsonDocument doc;
+        if (!deserializeJson(doc, f)) {
+            _baseline.radio = doc["radio"] | false;
+            _baseline.powerMeter = doc["powermeter"] | false;
+            _baseline.powerLimiter = doc["powerlimiter"] | false;
+        }
+        f.close();
+    }
+
+    MessageOutput.printf("[FirmwareHealthCheck] New firmware pending verification "
+        "(radio: %d, power meter: %d, DPL: %d)\r\n",
+        _baseline.radio, _baseline.powerMeter, _baseline.powerLimiter);
+
+    scheduler.addTask(_loopTask);
+    _loopTask.enable();
+}
+
+void FirmwareHealthCheckClass::saveBaseline()
+{
+    auto health = getHealth();
+
+    JsonDocument doc;
+    doc["radio"] = health.radio;
+    doc["powermeter"] = health.powerMeter;
+    doc["powerlimiter"] = health.powerLimiter;
+
+    File f = LittleFS.open(FIRMWARE_HEALTH_FILENAME, "w");
+    if (!f) {
+        MessageOutput.println("[FirmwareHealthCheck] Failed to save baseline");
+        return;
+    }
+
+    serializeJson(doc, f);
+    f.close();
+}
+
+FirmwareHealthCheckClass::Health FirmwareHealthCheckClass::getHealth() const
+{
+    auto const& config = Configuration.get();
+
+    Health health;
+
+    health.radio = true;
+    if (PinMapping.isValidNrf24Config()) {
+        health.radio &= Hoymiles.getRadioNrf()->isConnected();
+    }
+    if (PinMapping.isValidCmt2300Config()) {
+        health.radio &= Hoymiles.getRadioCmt()->isConnected();
+    }
+
+    health.powerMeter = !config.PowerMeter.Enabled || PowerMeter.isDataValid();
+
+    // the limiter evaluated its inputs at least once
+    health.powerLimiter = !config.PowerLimiter.Enabled
+        || PowerLimiter.getStatus() != PowerLimiterClass::Status::Initializing;
+
+    return health;
+}
+
+void FirmwareHealthCheckClass::loop()
+{
+    uint32_t uptime = millis();
+    if (uptime < FIRMWARE_HEALTH_MIN_UPTIME_MS) {
+        return;
+    }
+
+    auto health = getHealth();
+    bool healthy = (health.radio || !_baseline.radio)
+        && (health.powerMeter || !_baseline.powerMeter)
+        && (health.powerLimiter || !_baseline.powerLimiter);
+
+    if (healthy) {
+        return finish(true);
+    }
+
+    if (uptime < FIRMWARE_HEALTH_TIMEOUT_MS) {
+        return;
+    }
+
+    MessageOutput.printf("[FirmwareHealthCheck] Health check failed (radio: %d, "
+        "power meter: %d, DPL: %d)\r\n",
+        health.radio, health.powerMeter, health.powerLimiter);
+
+    finish(false);
+}
+
+void FirmwareHealthCheckClass::finish(bool valid)
+{
+    _loopTask.disable();
+    _pendingVerify = false;
+    LittleFS.remove(FIRMWARE_HEALTH_FILENAME);
+
+    if (valid) {
+        MessageOutput.println("[FirmwareHealthCheck] New firmware marked valid");
+#ifdef CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+        esp_ota_mark_app_valid_cancel_rollback();
+#endif
+        return;
+    }
+
+    MessageOutput.println("[FirmwareHealthCheck] Rolling back to previous firmware");
+#ifdef CONFIG_BOOTLOADER_APP_ROLLBACK_ENABLE
+    esp_ota_mark_app_invalid_rollback_and_reboot();
+#endif
+}
@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "GridProfileCache.h"
+#include "MessageOutput.h"
+#include "TaskMonitor.h"
+#include <Hoymiles.h>
+#include <LittleFS.h>
+#include <algorithm>
+
+GridProfileCacheClass GridProfileCache;
+
+GridProfileCacheClass::GridProfileCacheClass()
+    : _loopTask(TASK_SECOND, TASK_FOREVER, TaskMonitor.wrap("Grid profile cache", std::bind(&GridProfileCacheClass::loop, this)))
+{
+}
+
+void GridProfileCacheClass::init(Scheduler& scheduler)
+{
+    if (!LittleFS.exists(GRID_PROFILE_CACHE_DIR)) {
+        LittleFS.mkdir(GRID_PROFILE_CACHE_DIR);
+    }
+
+    scheduler.addTask(_loopTask);
+    _loopTask.enable();
+}
+
+void GridProfileCacheClass::loop()
+{
+    for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
+        auto inv = Hoymiles.getInverterByPos(i);
+        if (inv == nullptr) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto parser = inv->GridProfile();
+        auto it = _lastParserUpdate.find(inv->serial());
+
+        // first time this inverter is seen (at boot or when it was added)
+        if (it == _lastParserUpdate.end()) {
+            std::vector<uint8_t> raw;
+            if (parser->getLastUpdate() == 0 && load(inv->serial(), raw)) {
+                parser->setRawData(raw.data(), raw.size());
+                parser->setLastUpdate(std::max<uint32_t>(millis(), 1));
+
+                MessageOutput.printf("[GridProfileCache] Restored grid profile %s (%s) of inverter %s\r\n",
+                    parser->getProfileName().c_str(), parser->getProfileVersion().c_str(), inv->serialString().c_str());
+            }
+
+            _lastParserUpdate[inv->serial()] = parser->getLastUpdate();
+            continue;
+        }
+
+        const uint32_t lastUpdate = parser->getLastUpdate();
+        if (lastUpdate == it->second) {
+            continue;
+        }
+        it->second = lastUpdate;
+
+        if (!parser->containsValidData()) {
+            continue;
+        }
+
+        // the profile is requested after each refresh, only write it if
+        // it actually changed to spare the flash
+        auto raw = parser->getRawData();
+        std::vector<uint8_t> stored;
+        if (load(inv->serial(), stored) && stored == raw) {
+            continue;
+        }
+
+        save(inv->serial(), raw);
+    }
+}
+
+std::vector<uint8_t> GridProfileCacheClass::exportBinary(const uint64_t serial) const
+{
+    std::vector<uint8_t> res;
+
+    auto inv = Hoymiles.getInverterBySerial(serial);
+    if (inv == nullptr || !inv->GridProfile()->containsValidData()) {
+        return res;
+    }
+
+    auto raw = inv->GridProfile()->getRawData();
+
+    FileHeader header;
+    header.Magic = GRID_PROFILE_CACHE_MAGIC;
+    header.Version = GRID_PROFILE_CACHE_VERSION;
+    header.Length = raw.size();
+    header.Serial = serial;
+
+    auto headerBytes = reinterpret_cast<const uint8_t*>(&header);
+    res.insert(res.end(), headerBytes, headerBytes + sizeof(header));
+    res.insert(res.end(), raw.begin(), raw.end());
+
+    return res;
+}
+
+void GridProfileCacheClass::refresh(const uint64_t serial)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    const String filename = getFilename(serial);
+    if (LittleFS.exists(filename)) {
+        LittleFS.remove(filename);
+    }
+
+    auto inv = Hoymiles.getInverterBySerial(serial);
+    if (inv == nullptr) {
+        return;
+    }
+
+    // the inverter loop requests the profile again if none is available
+    inv->GridProfile()->setRawData(nullptr, 0);
+    inv->GridProfile()->setLastUpdate(0);
+    _lastParserUpdate[serial] = 0;
+}
+
+String GridProfileCacheClass::getFilename(const uint64_t serial)
+{
+    char filename[40];
+    snprintf(filename, sizeof(filename), GRID_PROFILE_CACHE_DIR "/%0x%08x.bin",
+        static_cast<uint32_t>((serial >> 32) & 0xFFFFFFFF),
+        static_cast<uint32_t>(serial & 0xFFFFFFFF));
+    return filename;
+}
+
+bool GridProfileCacheClass::load(const uint64_t serial, std::vector<uint8_t>& raw)
+{
+    const String filename = getFilename(serial);
+    if (!LittleFS.exists(filename)) {
+        return false;
+    }
+
+    File f = LittleFS.open(filename, "r", false);
+    if (!f) {
+        return false;
+    }
+
+    FileHeader header;
+    if (f.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header)
+        || header.Magic != GRID_PROFILE_CACHE_MAGIC
+        || header.Version != GRID_PROFILE_CACHE_VERSION
+        || header.Length > GRID_PROFILE_SIZE
+        || header.Serial != serial) {
+        MessageOutput.printf("[GridProfileCache] Ignoring invalid file %s\r\n", filename.c_str());
+        f.close();
+        return false;
+    }
+
+    raw.resize(header.Length);
+    const bool success = f.read(raw.data(), header.Length) == header.Length;
+    f.close();
+
+    return success;
+}
+
+void GridProfileCacheClass::save(const uint64_t serial, const std::vector<uint8_t>& raw)
+{
+    const String filename = getFilename(serial);
+
+    File f = LittleFS.open(filename, "w");
+    if (!f) {
+        MessageOutput.printf("[GridProfileCache] Failed to write %s\r\n", filename.c_str());
+        return;
+    }
+
+    FileHeader header;
+    header.Magic = GRID_PROFILE_CACHE_MAGIC;
+    header.Version = GRID_PROFILE_CACHE_VERSION;
+    header.Length = raw.size();
+    header.Serial = serial;
+
+    f.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    f.write(raw.data(), raw.size());
+    f.close();
+}
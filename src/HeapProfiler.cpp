@@ -0,0 +1,338 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "HeapProfiler.h"
+#include "MessageOutput.h"
+#include "TaskMonitor.h"
+#include <Arduino.h>
+#include <cstring>
+
+HeapProfilerClass HeapProfiler;
+
+namespace {
+constexpr size_t TagCount = static_cast<size_t>(HeapTag::Count);
+
+const char* const TagNames[TagCount] = {
+    "none",
+    "radio",
+    "json",
+    "mqtt",
+    "log",
+    "http_client",
+    "web_server",
+};
+
+#ifdef HEAP_PROFILER
+// allocations made without a scope are attributed by the name of the task
+const struct {
+    const char* TaskName;
+    HeapTag Tag;
+} TaskTags[] = {
+    { "HOY_RADIO", HeapTag::Radio },
+    { "async_tcp", HeapTag::WebServer },
+    { "PM:HTTP+JSON", HeapTag::HttpClient },
+    { "PM:HTTP+SML", HeapTag::HttpClient },
+};
+
+struct Slot {
+    void* Ptr;
+    uint32_t Size : 24;
+    uint32_t Tag : 8;
+};
+
+struct Counters {
+    uint32_t LiveBytes;
+    uint32_t LiveCount;
+    uint32_t PeakBytes;
+    uint32_t Allocations;
+    uint64_t AllocatedBytes;
+};
+
+static_assert((HEAP_PROFILER_SLOTS & (HEAP_PROFILER_SLOTS - 1)) == 0, "HEAP_PROFILER_SLOTS must be a power of two");
+
+// the hooks must not allocate themselves, hence all state is static
+// and zero initialized, such that it is valid before any constructor ran.
+portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+bool s_active = false;
+Slot s_slots[HEAP_PROFILER_SLOTS];
+size_t s_used = 0;
+uint32_t s_dropped = 0;
+Counters s_counters[TagCount];
+
+thread_local HeapTag t_scopeTag = HeapTag::None;
+thread_local HeapTag t_taskTag = HeapTag::None;
+thread_local bool t_taskTagResolved = false;
+
+size_t slotIndex(const void* ptr)
+{
+    return ((reinterpret_cast<uintptr_t>(ptr) >> 3) * 2654435761u) & (HEAP_PROFILER_SLOTS - 1);
+}
+
+HeapTag currentTag()
+{
+    if (!s_active || xPortInIsrContext()) {
+        return HeapTag::None;
+    }
+
+    if (t_scopeTag != HeapTag::None) {
+        return t_scopeTag;
+    }
+
+    if (!t_taskTagResolved) {
+        const char* name = pcTaskGetTaskName(nullptr);
+        for (auto const& entry : TaskTags) {
+            if (strcmp(name, entry.TaskName) == 0) {
+                t_taskTag = entry.Tag;
+                break;
+            }
+        }
+        t_taskTagResolved = true;
+    }
+
+    return t_taskTag;
+}
+
+void track(void* ptr, const size_t size, const HeapTag tag)
+{
+    if (ptr == nullptr || tag == HeapTag::None) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+
+    auto& counters = s_counters[static_cast<size_t>(tag)];
+    counters.Allocations++;
+    counters.AllocatedBytes += size;
+
+    // keep the table sparse such that probe sequences stay short
+    if (s_used >= HEAP_PROFILER_SLOTS * 3 / 4) {
+        s_dropped++;
+        portEXIT_CRITICAL(&s_lock);
+        return;
+    }
+
+    size_t i = slotIndex(ptr);
+    while (s_slots[i].Ptr != nullptr) {
+        i = (i + 1) & (HEAP_PROFILER_SLOTS - 1);
+    }
+    s_slots[i].Ptr = ptr;
+    s_slots[i].Size = size;
+    s_slots[i].Tag = static_cast<uint8_t>(tag);
+    s_used++;
+
+    counters.LiveBytes += size;
+    counters.LiveCount++;
+    if (counters.LiveBytes > counters.PeakBytes) {
+        counters.PeakBytes = counters.LiveBytes;
+    }
+
+    portEXIT_CRITICAL(&s_lock);
+}
+
+// returns the tag the allocation was attributed to, if it was tracked
+HeapTag untrack(void* ptr, size_t* size = nullptr)
+{
+    if (ptr == nullptr || !s_active) {
+        return HeapTag::None;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+
+    size_t i = slotIndex(ptr);
+    while (s_slots[i].Ptr != nullptr && s_slots[i].Ptr != ptr) {
+        i = (i + 1) & (HEAP_PROFILER_SLOTS - 1);
+    }
+
+    // not allocated while tracking, or dropped
+    if (s_slots[i].Ptr == nullptr) {
+        portEXIT_CRITICAL(&s_lock);
+        return HeapTag::None;
+    }
+
+    const HeapTag tag = static_cast<HeapTag>(s_slots[i].Tag);
+    if (size != nullptr) {
+        *size = s_slots[i].Size;
+    }
+
+    auto& counters = s_counters[s_slots[i].Tag];
+    counters.LiveBytes -= s_slots[i].Size;
+    counters.LiveCount--;
+    s_used--;
+
+    // backward shift deletion, keeps the probe sequences intact
+    size_t j = i;
+    while (true) {
+        j = (j + 1) & (HEAP_PROFILER_SLOTS - 1);
+        if (s_slots[j].Ptr == nullptr) {
+            break;
+        }
+
+        const size_t k = slotIndex(s_slots[j].Ptr);
+        const bool movable = (i <= j) ? (k <= i || k > j) : (k <= i && k > j);
+        if (movable) {
+            s_slots[i] = s_slots[j];
+            i = j;
+        }
+    }
+    s_slots[i].Ptr = nullptr;
+
+    portEXIT_CRITICAL(&s_lock);
+
+    return tag;
+}
+#endif
+}
+
+#ifdef HEAP_PROFILER
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size)
+{
+    void* ptr = __real_malloc(size);
+    track(ptr, size, currentTag());
+    return ptr;
+}
+
+void* __wrap_calloc(size_t n, size_t size)
+{
+    void* ptr = __real_calloc(n, size);
+    track(ptr, n * size, currentTag());
+    return ptr;
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+    // untrack before the block may be released and handed out again
+    size_t previousSize = 0;
+    const HeapTag previousTag = untrack(ptr, &previousSize);
+
+    void* res = __real_realloc(ptr, size);
+    if (res == nullptr && size > 0) {
+        // the original block is still valid
+        track(ptr, previousSize, previousTag);
+        return res;
+    }
+
+    track(res, size, currentTag());
+    return res;
+}
+
+void __wrap_free(void* ptr)
+{
+    untrack(ptr);
+    __real_free(ptr);
+}
+}
+
+HeapTagScope::HeapTagScope(const HeapTag tag)
+    : _previous(t_scopeTag)
+{
+    t_scopeTag = tag;
+}
+
+HeapTagScope::~HeapTagScope()
+{
+    t_scopeTag = _previous;
+}
+#endif
+
+HeapProfilerClass::HeapProfilerClass()
+    : _loopTask(HEAP_PROFILER_SAMPLE_INTERVAL, TASK_FOREVER, TaskMonitor.wrap("Heap profiler", std::bind(&HeapProfilerClass::loop, this)))
+{
+}
+
+void HeapProfilerClass::init(Scheduler& scheduler)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+#ifdef HEAP_PROFILER
+    s_active = true;
+#endif
+    _lastSampleMillis = millis();
+
+    MessageOutput.printf("[HeapProfiler] Tracking up to %d allocations\r\n", HEAP_PROFILER_SLOTS);
+
+    scheduler.addTask(_loopTask);
+    _loopTask.enable();
+}
+
+void HeapProfilerClass::loop()
+{
+#ifdef HEAP_PROFILER
+    const uint32_t now = millis();
+    const float seconds = (now - _lastSampleMillis) / 1000.0f;
+    if (seconds <= 0) {
+        return;
+    }
+
+    Counters counters[TagCount];
+    portENTER_CRITICAL(&s_lock);
+    memcpy(counters, s_counters, sizeof(counters));
+    portEXIT_CRITICAL(&s_lock);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    for (size_t i = 0; i < TagCount; i++) {
+        _allocationRate[i] = (counters[i].Allocations - _lastAllocations[i]) / seconds;
+        _byteRate[i] = (counters[i].AllocatedBytes - _lastAllocatedBytes[i]) / seconds;
+        _lastAllocations[i] = counters[i].Allocations;
+        _lastAllocatedBytes[i] = counters[i].AllocatedBytes;
+    }
+
+    _lastSampleMillis = now;
+#endif
+}
+
+std::vector<HeapProfilerClass::TagStats> HeapProfilerClass::getStats() const
+{
+    std::vector<TagStats> res;
+
+#ifdef HEAP_PROFILER
+    Counters counters[TagCount];
+    portENTER_CRITICAL(&s_lock);
+    memcpy(counters, s_counters, sizeof(counters));
+    portEXIT_CRITICAL(&s_lock);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // HeapTag::None is never tracked
+    for (size_t i = 1; i < TagCount; i++) {
+        TagStats stats;
+        stats.Name = TagNames[i];
+        stats.LiveBytes = counters[i].LiveBytes;
+        stats.LiveCount = counters[i].LiveCount;
+        stats.PeakBytes = counters[i].PeakBytes;
+        stats.Allocations = counters[i].Allocations;
+        stats.AllocatedBytes = counters[i].AllocatedBytes;
+        stats.AllocationRate = _allocationRate[i];
+        stats.ByteRate = _byteRate[i];
+        res.push_back(stats);
+    }
+#endif
+
+    return res;
+}
+
+uint32_t HeapProfilerClass::getDroppedCount() const
+{
+#ifdef HEAP_PROFILER
+    portENTER_CRITICAL(&s_lock);
+    uint32_t dropped = s_dropped;
+    portEXIT_CRITICAL(&s_lock);
+    return dropped;
+#else
+    return 0;
+#endif
+}
+
+char const* HeapProfilerClass::getTagName(const HeapTag tag)
+{
+    return TagNames[static_cast<size_t>(tag)];
+}
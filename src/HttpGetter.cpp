@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 #include "HttpGetter.h"
+#include "HeapProfiler.h"
 #include <WiFiClientSecure.h>
 #include "mbedtls/sha256.h"
 #include "mbedtls/md5.h"
@@ -78,6 +79,8 @@ bool HttpGetter::init()
 
 HttpRequestResult HttpGetter::performGetRequest()
 {
+    HeapTagScope heapTag(HeapTag::HttpClient);
+
     // hostByName in WiFiGeneric fails to resolve local names. issue described at
     // https://github.com/espressif/arduino-esp32/issues/3822 and in analyzed in
     // depth at https://github.com/espressif/esp-idf/issues/2507#issuecomment-761836300
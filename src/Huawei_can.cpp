@@ -2,16 +2,13 @@
 /*
  * Copyright (C) 2023 Malte Schmidt and others
  */
-#include "Battery.h"
 #include "Huawei_can.h"
 #include "MessageOutput.h"
-#include "PowerMeter.h"
 #include "PowerLimiter.h"
 #include "Configuration.h"
-#include "Battery.h"
-#include "SPIPortManager.h"
-#include <SPI.h>
-#include <mcp_can.h>
+#include "PinMapping.h"
+#include "TaskMonitor.h"
+#include "Telemetry.h"
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
@@ -26,48 +23,26 @@ HuaweiCanCommClass HuaweiCanComm;
 // Huawei CAN Communication
 // *******************************************************
 
-// Using a C function to avoid static C++ member
-void HuaweiCanCommunicationTask(void* parameter) {
-  for( ;; ) {
-    HuaweiCanComm.loop();
-    yield();
-  }
-}
-
 bool HuaweiCanCommClass::init(uint8_t huawei_miso, uint8_t huawei_mosi, uint8_t huawei_clk,
         uint8_t huawei_irq, uint8_t huawei_cs, uint32_t frequency) {
 
-    auto oSPInum = SPIPortManager.allocatePort("Huawei CAN");
-    if (!oSPInum) { return false; }
-
-    SPI = new SPIClass(*oSPInum);
-    SPI->begin(huawei_clk, huawei_miso, huawei_mosi, huawei_cs);
-    pinMode(huawei_cs, OUTPUT);
-    digitalWrite(huawei_cs, HIGH);
-
-    pinMode(huawei_irq, INPUT_PULLUP);
-    _huaweiIrq = huawei_irq;
-
-    auto mcp_frequency = MCP_8MHZ;
-    if (16000000UL == frequency) { mcp_frequency = MCP_16MHZ; }
-    else if (8000000UL != frequency) {
-        MessageOutput.printf("Huawei CAN: unknown frequency %d Hz, using 8 MHz\r\n", mcp_frequency);
+    if (HUAWEI_CAN_CONTROLLER_TWAI == frequency) {
+        const PinMapping_t& pin = PinMapping.get();
+        _bus = CanBuses.getTwai(pin.battery_rx, pin.battery_tx, HUAWEI_CAN_BITRATE);
+    } else {
+        _bus = CanBuses.getMcp2515(huawei_miso, huawei_mosi, huawei_clk,
+                huawei_irq, huawei_cs, frequency, HUAWEI_CAN_BITRATE);
     }
 
-    _CAN = new MCP_CAN(SPI, huawei_cs);
-    if (!_CAN->begin(MCP_STDEXT, CAN_125KBPS, mcp_frequency) == CAN_OK) {
+    if (!_bus) { return false; }
+
+    // only the responses to our requests are processed
+    _rxQueue = _bus->subscribe(0x1081407F, 0x1FFFFFFF, true/*extended*/, 16);
+    if (_rxQueue == nullptr) {
+        _bus = nullptr;
         return false;
     }
 
-    const uint32_t myMask = 0xFFFFFFFF;         // Look at all incoming bits and...
-    const uint32_t myFilter = 0x1081407F;       // filter for this message only
-    _CAN->init_Mask(0, 1, myMask);
-    _CAN->init_Filt(0, 1, myFilter);
-    _CAN->init_Mask(1, 1, myMask);
-
-    // Change to normal mode to allow messages to be transmitted
-    _CAN->setMode(MCP_NORMAL);
-
     return true;
 }
 
@@ -77,50 +52,44 @@ void HuaweiCanCommClass::loop()
 {
   std::lock_guard<std::mutex> lock(_mutex);
 
-  INT32U rxId;
-  unsigned char len = 0;
-  unsigned char rxBuf[8];
+  twai_message_t rx_message;
   uint8_t i;
 
-  if (!digitalRead(_huaweiIrq)) {
-    // If CAN_INT pin is low, read receive buffer
-    _CAN->readMsgBuf(&rxId, &len, rxBuf);      // Read data: len = data length, buf = data byte(s)
-    if((rxId & 0x80000000) == 0x80000000) {   // Determine if ID is standard (11 bits) or extended (29 bits)
-      if ((rxId & 0x1FFFFFFF) == 0x1081407F && len == 8) {
+  while (xQueueReceive(_rxQueue, &rx_message, 0) == pdTRUE) {
+    if (rx_message.data_length_code != 8) { continue; }
 
-        uint32_t value = __bswap32(* reinterpret_cast<uint32_t*> (rxBuf + 4));
+    uint8_t* rxBuf = rx_message.data;
+    uint32_t value = __bswap32(* reinterpret_cast<uint32_t*> (rxBuf + 4));
 
-        // Input power 0x70, Input frequency 0x71, Input current 0x72
-        // Output power 0x73, Efficiency 0x74, Output Voltage 0x75 and Output Current 0x76
-        if(rxBuf[1] >= 0x70 && rxBuf[1] <= 0x76 ) {
-          _recValues[rxBuf[1] - 0x70] = value;
-        }
+    // Input power 0x70, Input frequency 0x71, Input current 0x72
+    // Output power 0x73, Efficiency 0x74, Output Voltage 0x75 and Output Current 0x76
+    if(rxBuf[1] >= 0x70 && rxBuf[1] <= 0x76 ) {
+      _recValues[rxBuf[1] - 0x70] = value;
+    }
 
-        // Input voltage
-        if(rxBuf[1] == 0x78 ) {
-          _recValues[HUAWEI_INPUT_VOLTAGE_IDX] = value;
-        }
+    // Input voltage
+    if(rxBuf[1] == 0x78 ) {
+      _recValues[HUAWEI_INPUT_VOLTAGE_IDX] = value;
+    }
 
-        // Output Temperature
-        if(rxBuf[1] == 0x7F ) {
-          _recValues[HUAWEI_OUTPUT_TEMPERATURE_IDX] = value;
-        }
+    // Output Temperature
+    if(rxBuf[1] == 0x7F ) {
+      _recValues[HUAWEI_OUTPUT_TEMPERATURE_IDX] = value;
+    }
 
-        // Input Temperature 0x80, Output Current 1 0x81 and Output Current 2 0x82
-        if(rxBuf[1] >= 0x80 && rxBuf[1] <= 0x82 ) {
-          _recValues[rxBuf[1] - 0x80 + HUAWEI_INPUT_TEMPERATURE_IDX] = value;
-        }
+    // Input Temperature 0x80, Output Current 1 0x81 and Output Current 2 0x82
+    if(rxBuf[1] >= 0x80 && rxBuf[1] <= 0x82 ) {
+      _recValues[rxBuf[1] - 0x80 + HUAWEI_INPUT_TEMPERATURE_IDX] = value;
+    }
 
-        // This is the last value that is send
-        if(rxBuf[1] == 0x81) {
-          _completeUpdateReceived = true;
-        }
-      }
+    // This is the last value that is send
+    if(rxBuf[1] == 0x81) {
+      _completeUpdateReceived = true;
     }
-    // Other emitted codes not handled here are: 0x1081407E (Ack), 0x1081807E (Ack Frame), 0x1081D27F (Description), 0x1001117E (Whr meter), 0x100011FE (unclear), 0x108111FE (output enabled), 0x108081FE (unclear). See:
-    // https://github.com/craigpeacock/Huawei_R4850G2_CAN/blob/main/r4850.c
-    // https://www.beyondlogic.org/review-huawei-r4850g2-power-supply-53-5vdc-3kw/
   }
+  // Other emitted codes not handled here are: 0x1081407E (Ack), 0x1081807E (Ack Frame), 0x1081D27F (Description), 0x1001117E (Whr meter), 0x100011FE (unclear), 0x108111FE (output enabled), 0x108081FE (unclear). See:
+  // https://github.com/craigpeacock/Huawei_R4850G2_CAN/blob/main/r4850.c
+  // https://www.beyondlogic.org/review-huawei-r4850g2-power-supply-53-5vdc-3kw/
 
   // Transmit values
   for (i = 0; i < HUAWEI_OFFLINE_CURRENT; i++) {
@@ -128,8 +97,7 @@ void HuaweiCanCommClass::loop()
       uint8_t data[8] = {0x01, i, 0x00, 0x00, 0x00, 0x00, (uint8_t)((_txValues[i] & 0xFF00) >> 8), (uint8_t)(_txValues[i] & 0xFF)};
 
       // Send extended message
-      byte sndStat = _CAN->sendMsgBuf(0x108180FE, 1, 8, data);
-      if (sndStat == CAN_OK) {
+      if (_bus->send(makeMessage(0x108180FE, data))) {
         _hasNewTxValue[i] = false;
       } else {
         _errorCode |= HUAWEI_ERROR_CODE_TX;
@@ -191,12 +159,21 @@ void HuaweiCanCommClass::sendRequest()
 {
     uint8_t data[8] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
     //Send extended message
-    byte sndStat = _CAN->sendMsgBuf(0x108040FE, 1, 8, data);
-    if(sndStat != CAN_OK) {
+    if (!_bus->send(makeMessage(0x108040FE, data))) {
         _errorCode |= HUAWEI_ERROR_CODE_RX;
     }
 }
 
+twai_message_t HuaweiCanCommClass::makeMessage(uint32_t identifier, uint8_t const* data)
+{
+    twai_message_t message = {};
+    message.extd = 1;
+    message.identifier = identifier;
+    message.data_length_code = 8;
+    memcpy(message.data, data, 8);
+    return message;
+}
+
 // *******************************************************
 // Huawei CAN Controller
 // *******************************************************
@@ -204,7 +181,7 @@ void HuaweiCanCommClass::sendRequest()
 void HuaweiCanClass::init(Scheduler& scheduler, uint8_t huawei_miso, uint8_t huawei_mosi, uint8_t huawei_clk, uint8_t huawei_irq, uint8_t huawei_cs, uint8_t huawei_power)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&HuaweiCanClass::loop, this));
+    _loopTask.setCallback(TaskMonitor.wrap("Huawei", std::bind(&HuaweiCanClass::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 
@@ -236,10 +213,7 @@ void HuaweiCanClass::updateSettings(uint8_t huawei_miso, uint8_t huawei_mosi, ui
       _mode = HUAWEI_MODE_AUTO_INT;
     }
 
-    xTaskCreate(HuaweiCanCommunicationTask, "HUAWEI_CAN_0", 2048/*stack size*/,
-        NULL/*params*/, 0/*prio*/, &_HuaweiCanCommunicationTaskHdl);
-
-    MessageOutput.println("[HuaweiCanClass::init] MCP2515 Initialized Successfully!");
+    MessageOutput.println("[HuaweiCanClass::init] CAN bus initialized successfully!");
     _initialized = true;
 }
 
@@ -249,7 +223,7 @@ RectifierParameters_t * HuaweiCanClass::get()
 }
 
 
-void HuaweiCanClass::processReceivedParameters()
+bool HuaweiCanClass::processReceivedParameters()
 {
     _rp.input_power = HuaweiCanComm.getParameterValue(HUAWEI_INPUT_POWER_IDX) / 1024.0;
     _rp.input_frequency = HuaweiCanComm.getParameterValue(HUAWEI_INPUT_FREQ_IDX) / 1024.0;
@@ -263,9 +237,12 @@ void HuaweiCanClass::processReceivedParameters()
     _rp.input_temp = HuaweiCanComm.getParameterValue(HUAWEI_INPUT_TEMPERATURE_IDX) / 1024.0;
     _rp.output_current = HuaweiCanComm.getParameterValue(HUAWEI_OUTPUT_CURRENT_IDX) / 1024.0;
 
-    if (HuaweiCanComm.gotNewRxDataFrame(true)) {
-      _lastUpdateReceivedMillis = millis();
+    if (!HuaweiCanComm.gotNewRxDataFrame(true)) {
+      return false;
     }
+
+    _lastUpdateReceivedMillis = millis();
+    return true;
 }
 
 
@@ -279,7 +256,15 @@ void HuaweiCanClass::loop()
 
   bool verboseLogging = config.Huawei.VerboseLogging;
 
-  processReceivedParameters();
+  HuaweiCanComm.loop();
+  bool newRectifierData = processReceivedParameters();
+
+  HuaweiTelemetry telemetry = {};
+  telemetry.rp = _rp;
+  telemetry.lastUpdate = _lastUpdateReceivedMillis;
+  telemetry.autoPowerEnabled = _autoPowerEnabled;
+  telemetry.mode = _mode;
+  Telemetry.publish(telemetry);
 
   uint8_t com_error = HuaweiCanComm.getErrorCode(true);
   if (com_error & HUAWEI_ERROR_CODE_RX) {
@@ -290,7 +275,7 @@ void HuaweiCanClass::loop()
   }
 
   // Print updated data
-  if (HuaweiCanComm.gotNewRxDataFrame(false) && verboseLogging) {
+  if (newRectifierData && verboseLogging) {
     MessageOutput.printf("[HuaweiCanClass::loop] In:  %.02fV, %.02fA, %.02fW\n", _rp.input_voltage, _rp.input_current, _rp.input_power);
     MessageOutput.printf("[HuaweiCanClass::loop] Out: %.02fV, %.02fA of %.02fA, %.02fW\n", _rp.output_voltage, _rp.output_current, _rp.max_output_current, _rp.output_power);
     MessageOutput.printf("[HuaweiCanClass::loop] Eff : %.01f%%, Temp in: %.01fC, Temp out: %.01fC\n", _rp.efficiency * 100, _rp.input_temp, _rp.output_temp);
@@ -310,7 +295,9 @@ void HuaweiCanClass::loop()
 
     // Set voltage limit in periodic intervals if we're in auto mode or if emergency battery charge is requested.
     if ( _nextAutoModePeriodicIntMillis < millis()) {
-      MessageOutput.printf("[HuaweiCanClass::loop] Periodically setting voltage limit: %f \r\n", config.Huawei.Auto_Power_Voltage_Limit);
+      if (verboseLogging) {
+        MessageOutput.printf("[HuaweiCanClass::loop] Periodically setting voltage limit: %f \r\n", config.Huawei.Auto_Power_Voltage_Limit);
+      }
       _setValue(config.Huawei.Auto_Power_Voltage_Limit, HUAWEI_ONLINE_VOLTAGE);
       _nextAutoModePeriodicIntMillis = millis() + 60000;
     }
@@ -318,19 +305,26 @@ void HuaweiCanClass::loop()
   // ***********************
   // Emergency charge
   // ***********************
-  auto stats = Battery.getStats();
-  if (config.Huawei.Emergency_Charge_Enabled && stats->getImmediateChargingRequest()) {
+  BatteryTelemetry battery;
+  Telemetry.get(battery);
+  if (config.Huawei.Emergency_Charge_Enabled && battery.immediateChargingRequest) {
+    if (!_batteryEmergencyCharging) {
+      MessageOutput.println("[HuaweiCanClass::loop] Emergency charge requested by the battery");
+    }
     _batteryEmergencyCharging = true;
+    resetAutoPowerController();
 
     // Set output current
     float efficiency =  (_rp.efficiency > 0.5 ? _rp.efficiency : 1.0);
     float outputCurrent = efficiency * (config.Huawei.Auto_Power_Upper_Power_Limit / _rp.output_voltage);
-    MessageOutput.printf("[HuaweiCanClass::loop] Emergency Charge Output current %f \r\n", outputCurrent);
+    if (newRectifierData && verboseLogging) {
+      MessageOutput.printf("[HuaweiCanClass::loop] Emergency Charge Output current %f \r\n", outputCurrent);
+    }
     _setValue(outputCurrent, HUAWEI_ONLINE_CURRENT);
     return;
   }
 
-  if (_batteryEmergencyCharging && !stats->getImmediateChargingRequest()) {
+  if (_batteryEmergencyCharging && !battery.immediateChargingRequest) {
     // Battery request has changed. Set current to 0, wait for PSU to respond and then clear state
     _setValue(0, HUAWEI_ONLINE_CURRENT);
     if (_rp.output_current < 1) {
@@ -370,92 +364,166 @@ void HuaweiCanClass::loop()
     if (inverter != nullptr) {
         if(inverter->isProducing()) {
           _setValue(0.0, HUAWEI_ONLINE_CURRENT);
+          resetAutoPowerController();
           // Don't run auto mode for a second now. Otherwise we may send too much over the CAN bus
           _autoModeBlockedTillMillis = millis() + 1000;
-          MessageOutput.printf("[HuaweiCanClass::loop] Inverter is active, disable\r\n");
+          if (verboseLogging) {
+            MessageOutput.printf("[HuaweiCanClass::loop] Inverter is active, disable\r\n");
+          }
           return;
         }
     }
 
-    if (PowerMeter.getLastUpdate() > _lastPowerMeterUpdateReceivedMillis &&
-        _autoPowerEnabledCounter > 0) {
-        // We have received a new PowerMeter value. Also we're _autoPowerEnabled
-        // So we're good to calculate a new limit
+    PowerMeterTelemetry powerMeter;
+    Telemetry.get(powerMeter);
+    bool newPowerMeterData = powerMeter.lastUpdate != _lastPowerMeterUpdateReceivedMillis;
 
-      _lastPowerMeterUpdateReceivedMillis = PowerMeter.getLastUpdate();
+    if (newRectifierData && !newPowerMeterData) {
+      trackAutoPowerSetpoint(config);
+      return;
+    }
 
-      // Calculate new power limit
-      float newPowerLimit = -1 * round(PowerMeter.getPowerTotal());
-      float efficiency =  (_rp.efficiency > 0.5 ? _rp.efficiency : 1.0);
+    if (!newPowerMeterData) {
+      return;
+    }
 
-      // Powerlimit is the requested output power + permissable Grid consumption factoring in the efficiency factor
-      newPowerLimit += _rp.output_power + config.Huawei.Auto_Power_Target_Power_Consumption / efficiency;
+    // Consume the value even while automatic power control is disabled, such
+    // that the first cycle after re-enabling it uses a current value
+    _lastPowerMeterUpdateReceivedMillis = powerMeter.lastUpdate;
 
-      if (verboseLogging){
-        MessageOutput.printf("[HuaweiCanClass::loop] newPowerLimit: %f, output_power: %f \r\n", newPowerLimit, _rp.output_power);
-      }
+    if (_autoPowerEnabledCounter == 0) {
+      return;
+    }
 
-      // Check whether the battery SoC limit setting is enabled
-      if (config.Battery.Enabled && config.Huawei.Auto_Power_BatterySoC_Limits_Enabled) {
-        uint8_t _batterySoC = Battery.getStats()->getSoC();
-        // Sets power limit to 0 if the BMS reported SoC reaches or exceeds the user configured value
-        if (_batterySoC >= config.Huawei.Auto_Power_Stop_BatterySoC_Threshold) {
-          newPowerLimit = 0;
-          if (verboseLogging) {
-            MessageOutput.printf("[HuaweiCanClass::loop] Current battery SoC %i reached "
-                    "stop threshold %i, set newPowerLimit to %f \r\n", _batterySoC,
-                    config.Huawei.Auto_Power_Stop_BatterySoC_Threshold, newPowerLimit);
-          }
+    // We have received a new PowerMeter value. Also we're _autoPowerEnabled
+    // So we're good to calculate a new limit
+
+    float efficiency =  (_rp.efficiency > 0.5 ? _rp.efficiency : 1.0);
+
+    // The deviation from the permissable grid consumption, factoring in the efficiency factor
+    float error = config.Huawei.Auto_Power_Target_Power_Consumption / efficiency - round(powerMeter.powerTotal);
+    float newPowerLimit = calculateAutoPowerSetpoint(config, error);
+
+    if (verboseLogging){
+      MessageOutput.printf("[HuaweiCanClass::loop] error: %f, newPowerLimit: %f, output_power: %f \r\n", error, newPowerLimit, _rp.output_power);
+    }
+
+    // Check whether the battery SoC limit setting is enabled
+    if (config.Battery.Enabled && config.Huawei.Auto_Power_BatterySoC_Limits_Enabled) {
+      uint8_t _batterySoC = battery.soc;
+      // Sets power limit to 0 if the BMS reported SoC reaches or exceeds the user configured value
+      if (_batterySoC >= config.Huawei.Auto_Power_Stop_BatterySoC_Threshold) {
+        newPowerLimit = 0;
+        resetAutoPowerController();
+        if (verboseLogging) {
+          MessageOutput.printf("[HuaweiCanClass::loop] Current battery SoC %i reached "
+                  "stop threshold %i, set newPowerLimit to %f \r\n", _batterySoC,
+                  config.Huawei.Auto_Power_Stop_BatterySoC_Threshold, newPowerLimit);
         }
       }
+    }
 
-      if (newPowerLimit > config.Huawei.Auto_Power_Lower_Power_Limit) {
+    if (newPowerLimit > config.Huawei.Auto_Power_Lower_Power_Limit) {
 
-        // Check if the output power has dropped below the lower limit (i.e. the battery is full)
-        // and if the PSU should be turned off. Also we use a simple counter mechanism here to be able
-        // to ramp up from zero output power when starting up
-        if (_rp.output_power < config.Huawei.Auto_Power_Lower_Power_Limit) {
+      // Check if the output power has dropped below the lower limit (i.e. the battery is full)
+      // and if the PSU should be turned off. Also we use a simple counter mechanism here to be able
+      // to ramp up from zero output power when starting up
+      if (_rp.output_power < config.Huawei.Auto_Power_Lower_Power_Limit) {
+        if (verboseLogging) {
           MessageOutput.printf("[HuaweiCanClass::loop] Power and voltage limit reached. Disabling automatic power control .... \r\n");
-          _autoPowerEnabledCounter--;
-          if (_autoPowerEnabledCounter == 0) {
-            _autoPowerEnabled = false;
-            _setValue(0, HUAWEI_ONLINE_CURRENT);
-            return;
-          }
-        } else {
-          _autoPowerEnabledCounter = 10;
         }
-
-        // Limit power to maximum
-        if (newPowerLimit > config.Huawei.Auto_Power_Upper_Power_Limit) {
-          newPowerLimit = config.Huawei.Auto_Power_Upper_Power_Limit;
+        _autoPowerEnabledCounter--;
+        if (_autoPowerEnabledCounter == 0) {
+          _autoPowerEnabled = false;
+          resetAutoPowerController();
+          _setValue(0, HUAWEI_ONLINE_CURRENT);
+          return;
         }
+      } else {
+        _autoPowerEnabledCounter = 10;
+      }
 
-        // Calculate output current
-        float calculatedCurrent = efficiency * (newPowerLimit / _rp.output_voltage);
+      // Calculate output current
+      float calculatedCurrent = efficiency * (newPowerLimit / _rp.output_voltage);
 
-        // Limit output current to value requested by BMS
-        float permissableCurrent = stats->getChargeCurrentLimitation() - (stats->getChargeCurrent() - _rp.output_current); // BMS current limit - current from other sources, e.g. Victron MPPT charger
-        float outputCurrent = std::min(calculatedCurrent, permissableCurrent);
-        outputCurrent= outputCurrent > 0 ? outputCurrent : 0;
+      // Limit output current to value requested by BMS
+      float permissableCurrent = battery.chargeCurrentLimitation - (battery.chargeCurrent - _rp.output_current); // BMS current limit - current from other sources, e.g. Victron MPPT charger
+      float outputCurrent = std::min(calculatedCurrent, permissableCurrent);
+      outputCurrent= outputCurrent > 0 ? outputCurrent : 0;
 
-        if (verboseLogging) {
-            MessageOutput.printf("[HuaweiCanClass::loop] Setting output current to %.2fA. This is the lower value of calculated %.2fA and BMS permissable %.2fA currents\r\n", outputCurrent, calculatedCurrent, permissableCurrent);
-        }
-        _autoPowerEnabled = true;
-        _setValue(outputCurrent, HUAWEI_ONLINE_CURRENT);
+      if (outputCurrent < calculatedCurrent) {
+        // do not let the controller wind up while the BMS limits the current
+        _autoPowerSetpoint = outputCurrent * _rp.output_voltage / efficiency;
+      }
 
-        // Don't run auto mode some time to allow for output stabilization after issuing a new value
-        _autoModeBlockedTillMillis = millis() + 2 * HUAWEI_DATA_REQUEST_INTERVAL_MS;
-      } else {
-        // requested PL is below minium. Set current to 0
-        _autoPowerEnabled = false;
-        _setValue(0.0, HUAWEI_ONLINE_CURRENT);
+      if (verboseLogging) {
+          MessageOutput.printf("[HuaweiCanClass::loop] Setting output current to %.2fA. This is the lower value of calculated %.2fA and BMS permissable %.2fA currents\r\n", outputCurrent, calculatedCurrent, permissableCurrent);
       }
+      _autoPowerEnabled = true;
+      _setValue(outputCurrent, HUAWEI_ONLINE_CURRENT);
+    } else {
+      // requested PL is below minium. Set current to 0
+      _autoPowerEnabled = false;
+      _setValue(0.0, HUAWEI_ONLINE_CURRENT);
     }
   }
 }
 
+void HuaweiCanClass::resetAutoPowerController()
+{
+    _autoPowerControllerActive = false;
+}
+
+// PI controller in velocity form: the change of the output power setpoint
+// is calculated from the change of the error (proportional part) and the
+// error itself (integral part). as the setpoint is clamped to its limits,
+// the controller cannot wind up while saturated.
+float HuaweiCanClass::calculateAutoPowerSetpoint(const CONFIG_T& config, float error)
+{
+    uint32_t now = millis();
+
+    if (!_autoPowerControllerActive) {
+        // bumpless start from the actual output power
+        _autoPowerSetpoint = _rp.output_power;
+        _autoPowerLastError = error;
+        _autoPowerLastStepMillis = now - HUAWEI_DATA_REQUEST_INTERVAL_MS;
+        _autoPowerControllerActive = true;
+    }
+
+    float dt = (now - _autoPowerLastStepMillis) / 1000.0;
+    _autoPowerLastStepMillis = now;
+
+    // a single step shall never do more than correcting the whole error,
+    // otherwise infrequent power meter updates would cause oscillation.
+    float integralFactor = std::min(config.Huawei.Auto_Power_Ki * dt, 1.0f);
+    float delta = config.Huawei.Auto_Power_Kp * (error - _autoPowerLastError) + integralFactor * error;
+    _autoPowerLastError = error;
+
+    if (config.Huawei.Auto_Power_Max_Ramp > 0) {
+        float maxDelta = config.Huawei.Auto_Power_Max_Ramp * dt;
+        delta = std::clamp(delta, -maxDelta, maxDelta);
+    }
+
+    _autoPowerSetpoint = std::clamp(_autoPowerSetpoint + delta, 0.0f,
+            config.Huawei.Auto_Power_Upper_Power_Limit);
+
+    return _autoPowerSetpoint;
+}
+
+// called on new rectifier telemetry. the rectifier may not deliver the
+// requested power, e.g., as its voltage limit was reached. the setpoint
+// must then follow the actual output power, such that the controller does
+// not wind up and overshoot once the rectifier is able to deliver again.
+void HuaweiCanClass::trackAutoPowerSetpoint(const CONFIG_T& config)
+{
+    if (!_autoPowerControllerActive || config.Huawei.Auto_Power_Max_Ramp <= 0) {
+        return;
+    }
+
+    float margin = config.Huawei.Auto_Power_Max_Ramp * HUAWEI_DATA_REQUEST_INTERVAL_MS / 1000.0;
+    _autoPowerSetpoint = std::min(_autoPowerSetpoint, _rp.output_power + margin);
+}
+
 void HuaweiCanClass::setValue(float in, uint8_t parameterType)
 {
   if (_mode != HUAWEI_MODE_AUTO_INT) {
@@ -520,6 +588,7 @@ void HuaweiCanClass::setMode(uint8_t mode) {
 
   if (_mode == HUAWEI_MODE_AUTO_INT && mode != HUAWEI_MODE_AUTO_INT) {
     _autoPowerEnabled = false;
+    resetAutoPowerController();
     _setValue(0, HUAWEI_ONLINE_CURRENT);
   }
 
@@ -0,0 +1,309 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "InverterEventLog.h"
+#include "MessageOutput.h"
+#include "TaskMonitor.h"
+#include <Hoymiles.h>
+#include <LittleFS.h>
+#include <algorithm>
+
+#define INVERTER_EVENTLOG_MAGIC 0x4C564545 // "EEVL"
+#define INVERTER_EVENTLOG_VERSION 1
+
+InverterEventLogClass InverterEventLog;
+
+namespace {
+struct FileHeader {
+    uint32_t Magic;
+    uint16_t Version;
+    uint16_t Count;
+};
+}
+
+InverterEventLogClass::InverterEventLogClass()
+    : _loopTask(TASK_SECOND, TASK_FOREVER, TaskMonitor.wrap("Inverter event log", std::bind(&InverterEventLogClass::loop, this)))
+{
+}
+
+void InverterEventLogClass::init(Scheduler& scheduler)
+{
+    if (!LittleFS.exists(INVERTER_EVENTLOG_DIR)) {
+        LittleFS.mkdir(INVERTER_EVENTLOG_DIR);
+    }
+
+    scheduler.addTask(_loopTask);
+    _loopTask.enable();
+}
+
+size_t InverterEventLogClass::getEntryCount(const uint64_t serial) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _logs.find(serial);
+    if (it == _logs.end()) {
+        return 0;
+    }
+
+    return it->second.Entries.size();
+}
+
+size_t InverterEventLogClass::getTodaysEntryCount(const uint64_t serial) const
+{
+    struct tm timeinfo;
+    if (!getLocalTime(&timeinfo, 5)) {
+        // entries are only merged once the time is known
+        return getEntryCount(serial);
+    }
+
+    timeinfo.tm_hour = 0;
+    timeinfo.tm_min = 0;
+    timeinfo.tm_sec = 0;
+    const uint32_t midnight = mktime(&timeinfo);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _logs.find(serial);
+    if (it == _logs.end()) {
+        return 0;
+    }
+
+    // sorted by start time
+    auto const& entries = it->second.Entries;
+    auto first = std::lower_bound(entries.begin(), entries.end(), midnight, [](const Entry& e, const uint32_t time) {
+        return e.StartTime < time;
+    });
+    return entries.end() - first;
+}
+
+std::vector<InverterEventLogClass::Entry> InverterEventLogClass::getEntries(const uint64_t serial, const size_t offset, const size_t count) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<Entry> res;
+
+    auto it = _logs.find(serial);
+    if (it == _logs.end()) {
+        return res;
+    }
+
+    auto const& entries = it->second.Entries;
+    for (size_t i = offset; i < entries.size() && res.size() < count; ++i) {
+        res.push_back(entries[entries.size() - 1 - i]);
+    }
+
+    return res;
+}
+
+void InverterEventLogClass::loop()
+{
+    clearOnMidnight();
+
+    for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
+        auto inv = Hoymiles.getInverterByPos(i);
+        if (inv == nullptr) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto& log = getLog(inv->serial());
+
+        const uint32_t lastUpdate = inv->EventLog()->getLastUpdate();
+        if (lastUpdate == 0 || lastUpdate == log.LastParserUpdate) {
+            continue;
+        }
+        log.LastParserUpdate = lastUpdate;
+
+        if (merge(*inv, log)) {
+            save(inv->serial(), log);
+        }
+    }
+}
+
+InverterEventLogClass::InverterLog& InverterEventLogClass::getLog(const uint64_t serial)
+{
+    auto it = _logs.find(serial);
+    if (it != _logs.end()) {
+        return it->second;
+    }
+
+    auto& log = _logs[serial];
+    load(serial, log);
+    return log;
+}
+
+bool InverterEventLogClass::merge(InverterAbstract& inv, InverterLog& log)
+{
+    struct tm timeinfo;
+    if (!getLocalTime(&timeinfo, 5)) {
+        return false;
+    }
+
+    time_t now;
+    time(&now);
+
+    // the inverter only reports the (UTC) time of day. events are never
+    // reported before they occurred, hence times in the future belong to
+    // the previous day.
+    const int timezoneOffset = AlarmLogParser::getTimezoneOffset();
+    const uint32_t midnight = now - (now % 86400);
+    auto toTimestamp = [&](time_t localTime) -> uint32_t {
+        int32_t timeOfDay = (static_cast<int32_t>(localTime) - timezoneOffset) % 86400;
+        if (timeOfDay < 0) {
+            timeOfDay += 86400;
+        }
+
+        uint32_t timestamp = midnight + timeOfDay;
+        if (timestamp > static_cast<uint32_t>(now) + 600) {
+            timestamp -= 86400;
+        }
+        return timestamp;
+    };
+
+    bool changed = false;
+
+    const uint8_t count = inv.EventLog()->getEntryCount();
+    for (uint8_t i = 0; i < count; i++) {
+        AlarmLogEntry_t raw;
+        inv.EventLog()->getLogEntry(i, raw);
+
+        Entry entry;
+        entry.MessageId = raw.MessageId;
+        entry.StartTime = toTimestamp(raw.StartTime);
+        entry.EndTime = 0;
+        if (raw.EndTime > 0) {
+            entry.EndTime = toTimestamp(raw.EndTime);
+            if (entry.EndTime < entry.StartTime) {
+                entry.EndTime += 86400;
+            }
+        }
+
+        auto it = std::find_if(log.Entries.begin(), log.Entries.end(), [&entry](const Entry& e) {
+            return e.MessageId == entry.MessageId && e.StartTime == entry.StartTime;
+        });
+
+        if (it == log.Entries.end()) {
+            log.Entries.push_back(entry);
+            changed = true;
+            continue;
+        }
+
+        // the event ended since it was last reported
+        if (entry.EndTime != 0 && it->EndTime != entry.EndTime) {
+            it->EndTime = entry.EndTime;
+            changed = true;
+        }
+    }
+
+    if (!changed) {
+        return false;
+    }
+
+    std::stable_sort(log.Entries.begin(), log.Entries.end(), [](const Entry& a, const Entry& b) {
+        return a.StartTime < b.StartTime;
+    });
+
+    if (log.Entries.size() > INVERTER_EVENTLOG_MAX_ENTRIES) {
+        log.Entries.erase(log.Entries.begin(), log.Entries.end() - INVERTER_EVENTLOG_MAX_ENTRIES);
+    }
+
+    return true;
+}
+
+void InverterEventLogClass::clearOnMidnight()
+{
+    struct tm timeinfo;
+    if (!getLocalTime(&timeinfo, 5)) {
+        return;
+    }
+
+    if (_lastDay == timeinfo.tm_yday) {
+        return;
+    }
+
+    const bool dayChanged = _lastDay >= 0;
+    _lastDay = timeinfo.tm_yday;
+
+    if (!dayChanged) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
+        auto inv = Hoymiles.getInverterByPos(i);
+        if (inv == nullptr || !inv->getClearEventlogOnMidnight()) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto& log = getLog(inv->serial());
+        if (log.Entries.empty()) {
+            continue;
+        }
+
+        log.Entries.clear();
+        save(inv->serial(), log);
+    }
+}
+
+String InverterEventLogClass::getFilename(const uint64_t serial)
+{
+    char filename[40];
+    snprintf(filename, sizeof(filename), INVERTER_EVENTLOG_DIR "/%0x%08x.bin",
+        static_cast<uint32_t>((serial >> 32) & 0xFFFFFFFF),
+        static_cast<uint32_t>(serial & 0xFFFFFFFF));
+    return filename;
+}
+
+void InverterEventLogClass::load(const uint64_t serial, InverterLog& log)
+{
+    const String filename = getFilename(serial);
+    if (!LittleFS.exists(filename)) {
+        return;
+    }
+
+    File f = LittleFS.open(filename, "r", false);
+    if (!f) {
+        return;
+    }
+
+    FileHeader header;
+    if (f.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) != sizeof(header)
+        || header.Magic != INVERTER_EVENTLOG_MAGIC
+        || header.Version != INVERTER_EVENTLOG_VERSION
+        || header.Count > INVERTER_EVENTLOG_MAX_ENTRIES) {
+        MessageOutput.printf("[InverterEventLog] Ignoring invalid file %s\r\n", filename.c_str());
+        f.close();
+        return;
+    }
+
+    log.Entries.resize(header.Count);
+    const size_t size = header.Count * sizeof(Entry);
+    if (f.read(reinterpret_cast<uint8_t*>(log.Entries.data()), size) != size) {
+        log.Entries.clear();
+    }
+
+    f.close();
+}
+
+void InverterEventLogClass::save(const uint64_t serial, const InverterLog& log)
+{
+    const String filename = getFilename(serial);
+
+    File f = LittleFS.open(filename, "w");
+    if (!f) {
+        MessageOutput.printf("[InverterEventLog] Failed to write %s\r\n", filename.c_str());
+        return;
+    }
+
+    FileHeader header;
+    header.Magic = INVERTER_EVENTLOG_MAGIC;
+    header.Version = INVERTER_EVENTLOG_VERSION;
+    header.Count = log.Entries.size();
+
+    f.write(reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    f.write(reinterpret_cast<const uint8_t*>(log.Entries.data()), log.Entries.size() * sizeof(Entry));
+    f.close();
+}
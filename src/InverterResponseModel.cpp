@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "InverterResponseModel.h"
+#include <algorithm>
+#include <cmath>
+
+void InverterResponseModel::reset()
+{
+    *this = InverterResponseModel();
+}
+
+void InverterResponseModel::onLimitCommand(uint32_t timestamp, float limitWatts)
+{
+    // we need to know the output before the limit changed
+    _stepActive = _oSampleMillis.has_value();
+    if (!_stepActive) { return; }
+
+    _stepMillis = timestamp;
+    _stepFromWatts = _sampleWatts;
+    _stepToWatts = limitWatts;
+    _stepLearning = std::abs(_stepToWatts - _stepFromWatts) >= MinStepWatts;
+    _restMillis = timestamp;
+    _oMovingMillis = std::nullopt;
+}
+
+void InverterResponseModel::abortStep()
+{
+    _stepActive = false;
+    _stepLearning = false;
+}
+
+void InverterResponseModel::onStatistics(uint32_t timestamp, float outputWatts)
+{
+    _oSampleMillis = timestamp;
+    _sampleWatts = outputWatts;
+
+    if (!_stepActive) { return; }
+
+    auto elapsed = static_cast<int32_t>(timestamp - _stepMillis);
+
+    // the statistics were measured before the limit changed, hence
+    // they are a better reference than the previous sample.
+    if (elapsed < 0) {
+        _stepFromWatts = outputWatts;
+        return;
+    }
+
+    if (!_stepLearning) { return; }
+
+    auto delta = _stepToWatts - _stepFromWatts;
+    auto progress = (outputWatts - _stepFromWatts) / delta;
+
+    // the output does not follow the limit, e.g., because the inverter
+    // lacks DC power. such steps tell nothing about the response.
+    auto giveUp = [this, elapsed]() {
+        if (elapsed > static_cast<int32_t>(MaxStepMillis)) { _stepLearning = false; }
+    };
+
+    if (!_oMovingMillis.has_value()) {
+        if (progress < 0.1) {
+            _restMillis = timestamp;
+            return giveUp();
+        }
+
+        _oMovingMillis = timestamp;
+        _movingProgress = progress;
+        if (progress < 0.9) { return; }
+
+        // the output settled between two samples. only the delay can be
+        // estimated, which is assumed to be half way between the samples.
+        _stepLearning = false;
+        return learn(((_restMillis - _stepMillis) + (timestamp - _stepMillis)) / 2, std::nullopt);
+    }
+
+    if (progress <= _movingProgress || timestamp == *_oMovingMillis) { return giveUp(); }
+
+    float ramp = (progress - _movingProgress) * std::abs(delta) * 1000 / (timestamp - *_oMovingMillis);
+
+    // the output may have settled before this sample was taken, in which
+    // case the actual ramp rate is higher than the one calculated.
+    if (progress >= 0.9) { ramp = std::max(ramp, _rampWattsPerSecond); }
+
+    // extrapolate back to the point in time when the output started moving
+    float rampMillis = _movingProgress * std::abs(delta) * 1000 / ramp;
+    float delay = std::max(0.0f, (*_oMovingMillis - _stepMillis) - rampMillis);
+
+    _stepLearning = false;
+    learn(static_cast<uint32_t>(delay), ramp);
+}
+
+void InverterResponseModel::learn(uint32_t delayMillis, std::optional<float> rampWattsPerSecond)
+{
+    delayMillis = std::min<uint32_t>(delayMillis, 20 * 1000);
+    float alpha = (_learnedSteps == 0) ? 1.0 : SmoothingFactor;
+
+    _delayMillis = static_cast<uint32_t>(_delayMillis + alpha * (static_cast<float>(delayMillis) - _delayMillis));
+
+    if (rampWattsPerSecond.has_value()) {
+        float ramp = std::clamp(*rampWattsPerSecond, 5.0f, 5000.0f);
+        _rampWattsPerSecond += alpha * (ramp - _rampWattsPerSecond);
+    }
+
+    ++_learnedSteps;
+}
+
+uint32_t InverterResponseModel::getSettledMillis() const
+{
+    auto rampMillis = std::abs(_stepToWatts - _stepFromWatts) * 1000 / _rampWattsPerSecond;
+    return _stepMillis + _delayMillis + static_cast<uint32_t>(rampMillis);
+}
+
+std::optional<float> InverterResponseModel::predictOutput(uint32_t timestamp) const
+{
+    if (!_oSampleMillis.has_value()) { return std::nullopt; }
+
+    if (!_stepActive) { return _sampleWatts; }
+
+    // the inverter had enough time to reach the new limit. if it did not,
+    // its output is limited otherwise, e.g., by the available DC power.
+    if (static_cast<int32_t>(*_oSampleMillis - getSettledMillis()) >= 0) {
+        return _sampleWatts;
+    }
+
+    auto remaining = _stepToWatts - _sampleWatts;
+    if (remaining * (_stepToWatts - _stepFromWatts) <= 0) { return _sampleWatts; }
+
+    // continue the ramp from the last sample
+    uint32_t rampStart = _stepMillis + _delayMillis;
+    if (static_cast<int32_t>(*_oSampleMillis - rampStart) > 0) { rampStart = *_oSampleMillis; }
+
+    auto elapsed = static_cast<int32_t>(timestamp - rampStart);
+    if (elapsed <= 0) { return _sampleWatts; }
+
+    float moved = std::min(std::abs(remaining), _rampWattsPerSecond * elapsed / 1000);
+    return _sampleWatts + std::copysign(moved, remaining);
+}
@@ -8,13 +8,13 @@
 #include "PinMapping.h"
 #include "SunPosition.h"
 #include "SPIPortManager.h"
+#include "TaskMonitor.h"
 #include <Hoymiles.h>
 
 InverterSettingsClass InverterSettings;
 
 InverterSettingsClass::InverterSettingsClass()
-    : _settingsTask(INVERTER_UPDATE_SETTINGS_INTERVAL, TASK_FOREVER, std::bind(&InverterSettingsClass::settingsLoop, this))
-    , _hoyTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&InverterSettingsClass::hoyLoop, this))
+    : _settingsTask(INVERTER_UPDATE_SETTINGS_INTERVAL, TASK_FOREVER, TaskMonitor.wrap("Inverter settings", std::bind(&InverterSettingsClass::settingsLoop, this)))
 {
 }
 
@@ -29,7 +29,14 @@ void InverterSettingsClass::init(Scheduler& scheduler)
     Hoymiles.setMessageOutput(&MessageOutput);
     Hoymiles.init();
 
-    if (PinMapping.isValidNrf24Config() || PinMapping.isValidCmt2300Config()) {
+#ifdef HOYMILES_RADIO_SIM
+    // inverters are answered by the simulated radio, no modules required
+    const bool isSimulatedRadio = true;
+#else
+    const bool isSimulatedRadio = false;
+#endif
+
+    if (isSimulatedRadio || PinMapping.isValidNrf24Config() || PinMapping.isValidCmt2300Config()) {
         if (PinMapping.isValidNrf24Config()) {
             auto oSPInum = SPIPortManager.allocatePort("NRF24");
 
@@ -59,6 +66,9 @@ void InverterSettingsClass::init(Scheduler& scheduler)
         MessageOutput.println("  Setting DTU serial... ");
         Hoymiles.getRadioNrf()->setDtuSerial(config.Dtu.Serial);
         Hoymiles.getRadioCmt()->setDtuSerial(config.Dtu.Serial);
+#ifdef HOYMILES_RADIO_SIM
+        Hoymiles.getRadioSim()->setDtuSerial(config.Dtu.Serial);
+#endif
 
         MessageOutput.println("  Setting poll interval... ");
         Hoymiles.setPollInterval(config.Dtu.PollInterval);
@@ -95,8 +105,10 @@ void InverterSettingsClass::init(Scheduler& scheduler)
         MessageOutput.println("Invalid pin config");
     }
 
-    scheduler.addTask(_hoyTask);
-    _hoyTask.enable();
+    // the radio state machines run in their own task, pinned to the core
+    // of the Arduino loop but with a higher priority, such that slow
+    // scheduler tasks do not delay fragment reception and retransmits.
+    Hoymiles.startRadioTask(ARDUINO_RUNNING_CORE);
 
     scheduler.addTask(_settingsTask);
     _settingsTask.enable();
@@ -121,8 +133,3 @@ void InverterSettingsClass::settingsLoop()
         inv->setEnableCommands(inv_cfg.Command_Enable && (isDayPeriod || inv_cfg.Command_Enable_Night));
     }
 }
-
-void InverterSettingsClass::hoyLoop()
-{
-    Hoymiles.loop();
-}
@@ -8,6 +8,7 @@
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
 #include "PinMapping.h"
+#include "TaskMonitor.h"
 #include <Hoymiles.h>
 
 LedSingleClass LedSingle;
@@ -38,8 +39,8 @@ const uint8_t pwmTable[] = {
 #define LED_OFF 0
 
 LedSingleClass::LedSingleClass()
-    : _setTask(LEDSINGLE_UPDATE_INTERVAL * TASK_MILLISECOND, TASK_FOREVER, std::bind(&LedSingleClass::setLoop, this))
-    , _outputTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&LedSingleClass::outputLoop, this))
+    : _setTask(LEDSINGLE_UPDATE_INTERVAL * TASK_MILLISECOND, TASK_FOREVER, TaskMonitor.wrap("LED set", std::bind(&LedSingleClass::setLoop, this)))
+    , _outputTask(TASK_IMMEDIATE, TASK_FOREVER, TaskMonitor.wrap("LED output", std::bind(&LedSingleClass::outputLoop, this)))
 {
 }
 
@@ -4,12 +4,14 @@
  */
 #include <HardwareSerial.h>
 #include "MessageOutput.h"
+#include "HeapProfiler.h"
 #include "SyslogLogger.h"
+#include "TaskMonitor.h"
 
 MessageOutputClass MessageOutput;
 
 MessageOutputClass::MessageOutputClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&MessageOutputClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, TaskMonitor.wrap("Message output", std::bind(&MessageOutputClass::loop, this)))
 {
 }
 
@@ -41,6 +43,8 @@ void MessageOutputClass::serialWrite(MessageOutputClass::message_t const& m)
 
 size_t MessageOutputClass::write(uint8_t c)
 {
+    HeapTagScope heapTag(HeapTag::Log);
+
     std::lock_guard<std::mutex> lock(_msgLock);
 
     auto res = _task_messages.emplace(xTaskGetCurrentTaskHandle(), message_t());
@@ -60,6 +64,8 @@ size_t MessageOutputClass::write(uint8_t c)
 
 size_t MessageOutputClass::write(const uint8_t *buffer, size_t size)
 {
+    HeapTagScope heapTag(HeapTag::Log);
+
     std::lock_guard<std::mutex> lock(_msgLock);
 
     auto res = _task_messages.emplace(xTaskGetCurrentTaskHandle(), message_t());
@@ -88,6 +94,8 @@ size_t MessageOutputClass::write(const uint8_t *buffer, size_t size)
 
 void MessageOutputClass::loop()
 {
+    HeapTagScope heapTag(HeapTag::Log);
+
     std::lock_guard<std::mutex> lock(_msgLock);
 
     // clean up (possibly filled) buffers of deleted tasks
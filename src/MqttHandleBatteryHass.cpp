@@ -6,6 +6,7 @@
 #include "Configuration.h"
 #include "MqttSettings.h"
 #include "MqttHandleHass.h"
+#include "TaskMonitor.h"
 #include "Utils.h"
 #include "__compiled_constants.h"
 
@@ -14,7 +15,7 @@ MqttHandleBatteryHassClass MqttHandleBatteryHass;
 void MqttHandleBatteryHassClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&MqttHandleBatteryHassClass::loop, this));
+    _loopTask.setCallback(TaskMonitor.wrap("MQTT battery HASS", std::bind(&MqttHandleBatteryHassClass::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 }
@@ -6,13 +6,14 @@
 #include "Configuration.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
+#include "TaskMonitor.h"
 #include <Hoymiles.h>
 #include <CpuTemperature.h>
 
 MqttHandleDtuClass MqttHandleDtu;
 
 MqttHandleDtuClass::MqttHandleDtuClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&MqttHandleDtuClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, TaskMonitor.wrap("MQTT DTU", std::bind(&MqttHandleDtuClass::loop, this)))
 {
 }
 
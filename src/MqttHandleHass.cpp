@@ -3,9 +3,11 @@
  * Copyright (C) 2022-2024 Thomas Basler and others
  */
 #include "MqttHandleHass.h"
+#include "HeapProfiler.h"
 #include "MqttHandleInverter.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
+#include "TaskMonitor.h"
 #include "Utils.h"
 #include "__compiled_constants.h"
 #include "defaults.h"
@@ -13,7 +15,7 @@
 MqttHandleHassClass MqttHandleHass;
 
 MqttHandleHassClass::MqttHandleHassClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&MqttHandleHassClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, TaskMonitor.wrap("MQTT HASS", std::bind(&MqttHandleHassClass::loop, this)))
 {
 }
 
@@ -47,6 +49,8 @@ void MqttHandleHassClass::forceUpdate()
 
 void MqttHandleHassClass::publishConfig()
 {
+    HeapTagScope heapTag(HeapTag::Json);
+
     if (!Configuration.get().Mqtt.Hass.Enabled) {
         return;
     }
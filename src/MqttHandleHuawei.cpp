@@ -6,6 +6,7 @@
 #include "MessageOutput.h"
 #include "MqttSettings.h"
 #include "Huawei_can.h"
+#include "TaskMonitor.h"
 #include "WebApi_Huawei.h"
 #include <ctime>
 
@@ -14,7 +15,7 @@ MqttHandleHuaweiClass MqttHandleHuawei;
 void MqttHandleHuaweiClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&MqttHandleHuaweiClass::loop, this));
+    _loopTask.setCallback(TaskMonitor.wrap("MQTT Huawei", std::bind(&MqttHandleHuaweiClass::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 
@@ -5,6 +5,7 @@
 #include "MqttHandleInverter.h"
 #include "MessageOutput.h"
 #include "MqttSettings.h"
+#include "TaskMonitor.h"
 #include <ctime>
 
 #define PUBLISH_MAX_INTERVAL 60000
@@ -12,7 +13,7 @@
 MqttHandleInverterClass MqttHandleInverter;
 
 MqttHandleInverterClass::MqttHandleInverterClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&MqttHandleInverterClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, TaskMonitor.wrap("MQTT inverter", std::bind(&MqttHandleInverterClass::loop, this)))
 {
 }
 
@@ -50,6 +51,7 @@ void MqttHandleInverterClass::loop()
         MqttSettings.publish(subtopic + "/radio/rx_fail_nothing", String(inv->RadioStats.RxFailNoAnswer));
         MqttSettings.publish(subtopic + "/radio/rx_fail_partial", String(inv->RadioStats.RxFailPartialAnswer));
         MqttSettings.publish(subtopic + "/radio/rx_fail_corrupt", String(inv->RadioStats.RxFailCorruptData));
+        MqttSettings.publish(subtopic + "/radio/tx_superseded", String(inv->RadioStats.TxSuperseded));
 
         if (inv->DevInfo()->getLastUpdate() > 0) {
             // Bootloader Version
@@ -6,12 +6,13 @@
 #include "Configuration.h"
 #include "Datastore.h"
 #include "MqttSettings.h"
+#include "TaskMonitor.h"
 #include <Hoymiles.h>
 
 MqttHandleInverterTotalClass MqttHandleInverterTotal;
 
 MqttHandleInverterTotalClass::MqttHandleInverterTotalClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&MqttHandleInverterTotalClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, TaskMonitor.wrap("MQTT inverter total", std::bind(&MqttHandleInverterTotalClass::loop, this)))
 {
 }
 
@@ -6,6 +6,7 @@
 #include "MqttSettings.h"
 #include "MqttHandlePowerLimiter.h"
 #include "PowerLimiter.h"
+#include "TaskMonitor.h"
 #include <ctime>
 #include <string>
 
@@ -14,7 +15,7 @@ MqttHandlePowerLimiterClass MqttHandlePowerLimiter;
 void MqttHandlePowerLimiterClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&MqttHandlePowerLimiterClass::loop, this));
+    _loopTask.setCallback(TaskMonitor.wrap("MQTT DPL", std::bind(&MqttHandlePowerLimiterClass::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 
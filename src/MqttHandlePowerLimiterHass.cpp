@@ -8,6 +8,7 @@
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
 #include "MessageOutput.h"
+#include "TaskMonitor.h"
 #include "Utils.h"
 #include "__compiled_constants.h"
 
@@ -16,7 +17,7 @@ MqttHandlePowerLimiterHassClass MqttHandlePowerLimiterHass;
 void MqttHandlePowerLimiterHassClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&MqttHandlePowerLimiterHassClass::loop, this));
+    _loopTask.setCallback(TaskMonitor.wrap("MQTT DPL HASS", std::bind(&MqttHandlePowerLimiterHassClass::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 }
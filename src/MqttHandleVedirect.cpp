@@ -6,6 +6,7 @@
 #include "MqttHandleVedirect.h"
 #include "MqttSettings.h"
 #include "MessageOutput.h"
+#include "TaskMonitor.h"
 
 
 
@@ -17,7 +18,7 @@ MqttHandleVedirectClass MqttHandleVedirect;
 void MqttHandleVedirectClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback([this] { loop(); });
+    _loopTask.setCallback(TaskMonitor.wrap("MQTT VE.Direct", [this] { loop(); }));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 
@@ -8,6 +8,7 @@
 #include "MqttHandleHass.h"
 #include "NetworkSettings.h"
 #include "MessageOutput.h"
+#include "TaskMonitor.h"
 #include "VictronMppt.h"
 #include "Utils.h"
 #include "__compiled_constants.h"
@@ -17,7 +18,7 @@ MqttHandleVedirectHassClass MqttHandleVedirectHass;
 void MqttHandleVedirectHassClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback([this] { loop(); });
+    _loopTask.setCallback(TaskMonitor.wrap("MQTT VE.Direct HASS", [this] { loop(); }));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 }
@@ -4,6 +4,7 @@
  */
 #include "MqttSettings.h"
 #include "Configuration.h"
+#include "HeapProfiler.h"
 #include "MessageOutput.h"
 
 MqttSettingsClass::MqttSettingsClass()
@@ -34,9 +35,9 @@ void MqttSettingsClass::onMqttConnect(const bool sessionPresent)
 
     std::lock_guard<std::mutex> lock(_clientLock);
     if (_mqttClient != nullptr) {
-        for (const auto& cb : _mqttSubscribeParser.get_callbacks()) {
-            _mqttClient->subscribe(cb.topic.c_str(), cb.qos);
-        }
+        _mqttSubscribeParser.for_each_subscription([this](const std::string& topic, uint8_t qos) {
+            _mqttClient->subscribe(topic.c_str(), qos);
+        });
     }
 }
 
@@ -194,6 +195,8 @@ String MqttSettingsClass::getClientId()
 
 void MqttSettingsClass::publish(const String& subtopic, const String& payload)
 {
+    HeapTagScope heapTag(HeapTag::Mqtt);
+
     String topic = getPrefix();
     topic += subtopic;
 
@@ -205,6 +208,8 @@ void MqttSettingsClass::publish(const String& subtopic, const String& payload)
 
 void MqttSettingsClass::publishGeneric(const String& topic, const String& payload, const bool retain, const uint8_t qos)
 {
+    HeapTagScope heapTag(HeapTag::Mqtt);
+
     std::lock_guard<std::mutex> lock(_clientLock);
     if (_mqttClient == nullptr) {
         return;
@@ -0,0 +1,345 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#include "MqttValueParser.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// numbers and strings containing numbers are copied into a buffer of this
+// size for conversion, longer ones are truncated.
+constexpr size_t kNumberBufferSize = 48;
+
+constexpr uint8_t kMaxDepth = 32;
+
+// same semantics as std::stof(): leading whitespace is skipped and trailing
+// characters are ignored, but at least one character must be converted.
+// JSON numbers must be converted as a whole, like ArduinoJson does.
+std::optional<float> toFloat(char const* buf, bool whole = false)
+{
+    char* end = nullptr;
+    errno = 0;
+    float res = strtof(buf, &end);
+    if (end == buf || errno == ERANGE) { return std::nullopt; }
+    if (whole && *end != '\0') { return std::nullopt; }
+    return res;
+}
+
+class Scanner {
+public:
+    Scanner(char const* begin, char const* end)
+        : _pos(begin), _end(end) { }
+
+    bool atEnd() const { return _pos >= _end; }
+    char peek() const { return atEnd() ? '\0' : *_pos; }
+
+    void skipWhitespace()
+    {
+        while (!atEnd() && (*_pos == ' ' || *_pos == '\t' || *_pos == '\n' || *_pos == '\r')) { ++_pos; }
+    }
+
+    bool consume(char c)
+    {
+        skipWhitespace();
+        if (peek() != c) { return false; }
+        ++_pos;
+        return true;
+    }
+
+    // reads a (quoted) string and decodes escape sequences. the decoded
+    // string is written to buf if not null. returns false if the string is
+    // malformed or does not fit into buf.
+    bool readString(char* buf, size_t bufSize)
+    {
+        skipWhitespace();
+        char quote = peek();
+        if (quote != '"' && quote != '\'') { return false; }
+        ++_pos;
+
+        size_t len = 0;
+        while (!atEnd() && *_pos != quote) {
+            char c = *_pos++;
+            if (c == '\\') {
+                if (atEnd()) { return false; }
+                c = *_pos++;
+                switch (c) {
+                    case 'b': c = '\b'; break;
+                    case 'f': c = '\f'; break;
+                    case 'n': c = '\n'; break;
+                    case 'r': c = '\r'; break;
+                    case 't': c = '\t'; break;
+                    case 'u': {
+                        if (_end - _pos < 4) { return false; }
+                        char hex[5] = { _pos[0], _pos[1], _pos[2], _pos[3], '\0' };
+                        _pos += 4;
+                        long code = strtol(hex, nullptr, 16);
+                        // non-ASCII characters never match an ASCII key
+                        c = (code > 0 && code < 0x80) ? static_cast<char>(code) : '\x7f';
+                        break;
+                    }
+                    default: break; // '"', '\\', '/' and others are kept as is
+                }
+            }
+
+            if (buf != nullptr) {
+                if (len + 1 >= bufSize) { return false; }
+                buf[len] = c;
+            }
+            ++len;
+        }
+
+        if (atEnd()) { return false; }
+        ++_pos; // closing quote
+
+        if (buf != nullptr) { buf[len] = '\0'; }
+        return true;
+    }
+
+    // compares the (quoted) string at the current position with key
+    bool readKey(std::string const& key, bool& matches)
+    {
+        char buf[64];
+        char const* start = _pos;
+        if (readString(buf, sizeof(buf))) {
+            matches = (key == buf);
+            return true;
+        }
+
+        // keys longer than the buffer never match our (shorter) keys
+        _pos = start;
+        matches = false;
+        return readString(nullptr, 0);
+    }
+
+    // copies a number or literal token into buf (truncated if necessary)
+    bool readToken(char* buf, size_t bufSize)
+    {
+        skipWhitespace();
+        size_t len = 0;
+        while (!atEnd() && strchr(",]} \t\r\n", *_pos) == nullptr) {
+            if (len + 1 < bufSize) { buf[len++] = *_pos; }
+            ++_pos;
+        }
+        buf[len] = '\0';
+        return len > 0;
+    }
+
+    bool skipValue(uint8_t depth = 0)
+    {
+        if (depth > kMaxDepth) { return false; }
+
+        skipWhitespace();
+        switch (peek()) {
+            case '"':
+            case '\'':
+                return readString(nullptr, 0);
+
+            case '{':
+                ++_pos;
+                if (consume('}')) { return true; }
+                do {
+                    if (!readString(nullptr, 0) || !consume(':') || !skipValue(depth + 1)) { return false; }
+                } while (consume(','));
+                return consume('}');
+
+            case '[':
+                ++_pos;
+                if (consume(']')) { return true; }
+                do {
+                    if (!skipValue(depth + 1)) { return false; }
+                } while (consume(','));
+                return consume(']');
+
+            default: {
+                char token[kNumberBufferSize];
+                return readToken(token, sizeof(token));
+            }
+        }
+    }
+
+    // positions the scanner at the value of the given key of the object
+    // at the current position. returns false if there is no such key.
+    bool findKey(std::string const& key)
+    {
+        if (!consume('{')) { return false; }
+        if (consume('}')) { return false; }
+
+        do {
+            bool matches = false;
+            if (!readKey(key, matches) || !consume(':')) { return false; }
+            if (matches) { skipWhitespace(); return true; }
+            if (!skipValue()) { return false; }
+        } while (consume(','));
+
+        return false;
+    }
+
+    // positions the scanner at the given element of the array
+    // at the current position. returns false if there is no such element.
+    bool findIndex(size_t index)
+    {
+        if (!consume('[')) { return false; }
+        if (consume(']')) { return false; }
+
+        for (size_t i = 0; i < index; ++i) {
+            if (!skipValue() || !consume(',')) { return false; }
+        }
+
+        skipWhitespace();
+        return true;
+    }
+
+    // skips the remaining members of the object the scanner is positioned
+    // in, including the closing brace.
+    bool finishObject()
+    {
+        while (consume(',')) {
+            if (!readString(nullptr, 0) || !consume(':') || !skipValue()) { return false; }
+        }
+        return consume('}');
+    }
+
+    // skips the remaining elements of the array the scanner is positioned
+    // in, including the closing bracket.
+    bool finishArray()
+    {
+        while (consume(',')) {
+            if (!skipValue()) { return false; }
+        }
+        return consume(']');
+    }
+
+private:
+    char const* _pos;
+    char const* _end;
+};
+
+} // namespace
+
+MqttValueParser::MqttValueParser(char const* jsonPath)
+    : _path(jsonPath)
+{
+    size_t start = 0;
+    while (start <= _path.length()) {
+        size_t end = _path.find('/', start);
+        if (end == std::string::npos) { end = _path.length(); }
+
+        std::string key = _path.substr(start, end - start);
+        start = end + 1;
+
+        // handle double forward slashes and paths starting or ending with a slash
+        if (key.empty()) { continue; }
+
+        if (key.front() == '[' && key.back() == ']') {
+            long idx = atol(key.c_str() + 1);
+            // negative indices never match, like in Utils::getJsonValueByPath
+            _steps.push_back({ true, (idx < 0) ? SIZE_MAX : static_cast<size_t>(idx), key });
+            continue;
+        }
+
+        _steps.push_back({ false, 0, std::move(key) });
+    }
+}
+
+std::optional<float> MqttValueParser::parse(uint8_t const* payload, size_t len,
+        char* error, size_t errorSize) const
+{
+    char const* begin = reinterpret_cast<char const*>(payload);
+    char buf[kNumberBufferSize];
+
+    if (_path.empty()) {
+        size_t n = std::min(len, sizeof(buf) - 1);
+        memcpy(buf, begin, n);
+        buf[n] = '\0';
+
+        auto res = toFloat(buf);
+        if (!res.has_value()) {
+            snprintf(error, errorSize, "cannot parse payload '%s' as float", buf);
+        }
+        return res;
+    }
+
+    Scanner scanner(begin, begin + len);
+
+    for (auto const& step : _steps) {
+        scanner.skipWhitespace();
+        if (step.isIndex) {
+            if (scanner.peek() != '[') {
+                snprintf(error, errorSize, "Cannot access non-array JSON node "
+                        "using array index '%s' (JSON path '%s')",
+                        step.key.c_str(), _path.c_str());
+                return std::nullopt;
+            }
+
+            if (!scanner.findIndex(step.index)) {
+                snprintf(error, errorSize, "Unable to access JSON array index "
+                        "%s (JSON path '%s')", step.key.c_str(), _path.c_str());
+                return std::nullopt;
+            }
+            continue;
+        }
+
+        if (!scanner.findKey(step.key)) {
+            snprintf(error, errorSize, "Unable to access JSON key '%s' "
+                    "(JSON path '%s')", step.key.c_str(), _path.c_str());
+            return std::nullopt;
+        }
+    }
+
+    char c = scanner.peek();
+    bool isString = (c == '"' || c == '\'');
+    if (isString && !scanner.readString(buf, sizeof(buf))) {
+        snprintf(error, errorSize, "String at JSON path '%s' is malformed "
+                "or too long", _path.c_str());
+        return std::nullopt;
+    }
+
+    if (!isString && (c == '{' || c == '[' || !scanner.readToken(buf, sizeof(buf)))) {
+        snprintf(error, errorSize, "Value at JSON path '%s' is neither a "
+                "string nor of type float", _path.c_str());
+        return std::nullopt;
+    }
+
+    // ArduinoJson rejects truncated documents, so the enclosing objects
+    // and arrays are validated up to their end as well.
+    for (auto step = _steps.rbegin(); step != _steps.rend(); ++step) {
+        if (!(step->isIndex ? scanner.finishArray() : scanner.finishObject())) {
+            snprintf(error, errorSize, "Payload is not valid JSON "
+                    "(JSON path '%s')", _path.c_str());
+            return std::nullopt;
+        }
+    }
+
+    if (isString) {
+        auto res = toFloat(buf);
+        if (!res.has_value()) {
+            snprintf(error, errorSize, "String '%s' at JSON path '%s' cannot "
+                    "be converted to float", buf, _path.c_str());
+        }
+        return res;
+    }
+
+    if (strcmp(buf, "null") == 0) {
+        snprintf(error, errorSize, "Unable to access JSON path '%s'", _path.c_str());
+        return std::nullopt;
+    }
+
+    // JSON numbers must start with a digit or a minus sign. this rejects
+    // literals like true and false, which strtof() does not accept anyway,
+    // as well as inf and nan, which it does.
+    if ((buf[0] < '0' || buf[0] > '9') && buf[0] != '-') {
+        snprintf(error, errorSize, "Value '%s' at JSON path '%s' is neither "
+                "a string nor of type float", buf, _path.c_str());
+        return std::nullopt;
+    }
+
+    // strtof() also accepts hexadecimal numbers, JSON does not
+    auto res = (strspn(buf, "0123456789+-.eE") == strlen(buf)) ? toFloat(buf, true) : std::nullopt;
+    if (!res.has_value()) {
+        snprintf(error, errorSize, "Value '%s' at JSON path '%s' is not a "
+                "valid number", buf, _path.c_str());
+    }
+    return res;
+}
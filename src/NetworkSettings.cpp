@@ -7,6 +7,7 @@
 #include "MessageOutput.h"
 #include "SyslogLogger.h"
 #include "PinMapping.h"
+#include "TaskMonitor.h"
 #include "Utils.h"
 #include "SPIPortManager.h"
 #include "defaults.h"
@@ -16,7 +17,7 @@
 #include "__compiled_constants.h"
 
 NetworkSettingsClass::NetworkSettingsClass()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&NetworkSettingsClass::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, TaskMonitor.wrap("Network", std::bind(&NetworkSettingsClass::loop, this)))
     , _apIp(192, 168, 4, 1)
     , _apNetmask(255, 255, 255, 0)
 {
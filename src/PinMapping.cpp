@@ -3,6 +3,10 @@
  * Copyright (C) 2022 - 2023 Thomas Basler and others
  */
 #include "PinMapping.h"
+#include "Battery.h"
+#include "ConfigSnapshot.h"
+#include "Configuration.h"
+#include "Huawei_can.h"
 #include "MessageOutput.h"
 #include <ArduinoJson.h>
 #include <LittleFS.h>
@@ -292,6 +296,16 @@ bool PinMappingClass::init(const String& deviceMapping)
         return false;
     }
 
+    const uint32_t sourceCrc = ConfigSnapshotClass::getChecksum(f);
+
+    PinMapping_t snapshot;
+    if (ConfigSnapshot.load(ConfigSnapshotClass::Section::PinMapping, f.size(), sourceCrc, &snapshot, sizeof(snapshot))
+        && deviceMapping == snapshot.name) {
+        _pinMapping = snapshot;
+        f.close();
+        return true;
+    }
+
     JsonDocument doc;
     // Deserialize the JSON document
     DeserializationError error = deserializeJson(doc, f);
@@ -372,6 +386,10 @@ bool PinMappingClass::init(const String& deviceMapping)
             _pinMapping.powermeter_rxen = doc[i]["powermeter"]["rxen"] | POWERMETER_PIN_RXEN;
             _pinMapping.powermeter_txen = doc[i]["powermeter"]["txen"] | POWERMETER_PIN_TXEN;
 
+            if (!error) {
+                ConfigSnapshot.store(ConfigSnapshotClass::Section::PinMapping, f.size(), sourceCrc, &_pinMapping, sizeof(_pinMapping));
+            }
+
             return true;
         }
     }
@@ -414,10 +432,29 @@ bool PinMappingClass::isValidEthConfig() const
 
 bool PinMappingClass::isValidHuaweiConfig() const
 {
-    return _pinMapping.huawei_miso >= 0
-        && _pinMapping.huawei_mosi >= 0
-        && _pinMapping.huawei_clk >= 0
-        && _pinMapping.huawei_irq >= 0
-        && _pinMapping.huawei_cs >= 0
-        && _pinMapping.huawei_power >= 0;
+    if (_pinMapping.huawei_power < 0) {
+        return false;
+    }
+
+    auto const& config = Configuration.get();
+
+    if (config.Huawei.CAN_Controller_Frequency != HUAWEI_CAN_CONTROLLER_TWAI) {
+        return _pinMapping.huawei_miso >= 0
+            && _pinMapping.huawei_mosi >= 0
+            && _pinMapping.huawei_clk >= 0
+            && _pinMapping.huawei_irq >= 0
+            && _pinMapping.huawei_cs >= 0;
+    }
+
+    // the charger shares the built-in CAN controller with the battery,
+    // which is impossible if a battery provider uses the pins as UART.
+    auto const& battery = config.Battery;
+    auto const provider = static_cast<BatteryProvider::Type>(battery.Provider);
+    if (battery.Enabled && (provider == BatteryProvider::Type::JkBmsSerial
+            || provider == BatteryProvider::Type::VictronSmartShunt)) {
+        return false;
+    }
+
+    return _pinMapping.battery_rx >= 0
+        && _pinMapping.battery_tx >= 0;
 }
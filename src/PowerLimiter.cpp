@@ -4,15 +4,13 @@
  */
 
 #include "RestartHelper.h"
-#include "Battery.h"
-#include "PowerMeter.h"
 #include "PowerLimiter.h"
+#include "BootStages.h"
 #include "Configuration.h"
 #include "MqttSettings.h"
 #include "NetworkSettings.h"
-#include "Huawei_can.h"
-#include <VictronMppt.h>
 #include "MessageOutput.h"
+#include "TaskMonitor.h"
 #include "inverters/HMS_4CH.h"
 #include <ctime>
 #include <cmath>
@@ -24,7 +22,7 @@ PowerLimiterClass PowerLimiter;
 void PowerLimiterClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&PowerLimiterClass::loop, this));
+    _loopTask.setCallback(TaskMonitor.wrap("DPL", std::bind(&PowerLimiterClass::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 }
@@ -100,6 +98,8 @@ void PowerLimiterClass::loop()
     CONFIG_T const& config = Configuration.get();
     _verboseLogging = config.PowerLimiter.VerboseLogging;
 
+    Telemetry.getView(_telemetry);
+
     // we know that the Hoymiles library refuses to send any message to any
     // inverter until the system has valid time information. until then we can
     // do nothing, not even shutdown the inverter.
@@ -150,9 +150,14 @@ void PowerLimiterClass::loop()
         return;
     }
 
+    // the response model is specific to the inverter
+    if (_inverter == nullptr) { _responseModel.reset(); }
+
     // update our pointer as the configuration might have changed
     _inverter = currentInverter;
 
+    updateResponseModel();
+
     // data polling is disabled or the inverter is deemed offline
     if (!_inverter->isReachable()) {
         return announceStatus(Status::InverterOffline);
@@ -202,7 +207,7 @@ void PowerLimiterClass::loop()
     // arrives. this can be the case for readings provided by networked meter
     // readers, where a packet needs to travel through the network for some
     // time after the actual measurement was done by the reader.
-    if (PowerMeter.isDataValid() && PowerMeter.getLastUpdate() <= (*_oInverterStatsMillis + 2000)) {
+    if (_telemetry.powerMeter.valid && _telemetry.powerMeter.lastUpdate <= (*_oInverterStatsMillis + 2000)) {
         return announceStatus(Status::PowerMeterPending);
     }
 
@@ -268,10 +273,10 @@ void PowerLimiterClass::loop()
     if (_verboseLogging && !config.PowerLimiter.IsInverterSolarPowered) {
         MessageOutput.printf("[DPL::loop] battery interface %s, SoC: %f %%, StartTH: %d %%, StopTH: %d %%, SoC age: %d s, ignore: %s\r\n",
                 (config.Battery.Enabled?"enabled":"disabled"),
-                Battery.getStats()->getSoC(),
+                _telemetry.battery.soc,
                 config.PowerLimiter.BatterySocStartThreshold,
                 config.PowerLimiter.BatterySocStopThreshold,
-                Battery.getStats()->getSoCAgeSeconds(),
+                Telemetry.getAgeSeconds(_telemetry.battery.socLastUpdate),
                 (config.PowerLimiter.IgnoreSoc?"yes":"no"));
 
         auto dcVoltage = getBatteryVoltage(true/*log voltages only once per DPL loop*/);
@@ -321,16 +326,16 @@ float PowerLimiterClass::getBatteryVoltage(bool log) {
     float res = inverterVoltage;
 
     float chargeControllerVoltage = -1;
-    if (VictronMppt.isDataValid()) {
-        res = chargeControllerVoltage = static_cast<float>(VictronMppt.getOutputVoltage());
+    if (_telemetry.mppt.valid) {
+        res = chargeControllerVoltage = _telemetry.mppt.outputVoltage;
     }
 
     float bmsVoltage = -1;
-    auto stats = Battery.getStats();
+    auto const& battery = _telemetry.battery;
     if (config.Battery.Enabled
-            && stats->isVoltageValid()
-            && stats->getVoltageAgeSeconds() < 60) {
-        res = bmsVoltage = stats->getVoltage();
+            && battery.voltageValid
+            && Telemetry.getAgeSeconds(battery.voltageLastUpdate) < 60) {
+        res = bmsVoltage = battery.voltage;
     }
 
     if (log) {
@@ -391,13 +396,13 @@ void PowerLimiterClass::unconditionalSolarPassthrough(std::shared_ptr<InverterAb
         return;
     }
 
-    if (!VictronMppt.isDataValid()) {
+    if (!_telemetry.mppt.valid) {
         shutdown(Status::NoVeDirect);
         return;
     }
 
     _calculationBackoffMs = 1 * 1000;
-    int32_t solarPower = VictronMppt.getPowerOutputWatts();
+    int32_t solarPower = _telemetry.mppt.powerOutputWatts;
     setNewPowerLimit(inverter, inverterPowerDcToAc(inverter, solarPower));
     announceStatus(Status::UnconditionalSolarPassthrough);
 }
@@ -446,13 +451,13 @@ bool PowerLimiterClass::calcPowerLimit(std::shared_ptr<InverterAbstract> inverte
     // kicks in. The only case where this is not desired is if the battery is
     // over the Full Solar Passthrough Threshold. In this case the Power
     // Limiter should run and the PSU will shut down as a consequence.
-    if (!useFullSolarPassthrough() && HuaweiCan.getAutoPowerStatus()) {
+    if (!useFullSolarPassthrough() && _telemetry.huawei.autoPowerEnabled) {
         return shutdown(Status::HuaweiPsu);
     }
 
-    auto meterValid = PowerMeter.isDataValid();
+    auto meterValid = _telemetry.powerMeter.valid;
 
-    auto meterValue = static_cast<int32_t>(PowerMeter.getPowerTotal());
+    auto meterValue = static_cast<int32_t>(_telemetry.powerMeter.powerTotal);
 
     // We don't use FLD_PAC from the statistics, because that data might be too
     // old and unreliable. TODO(schlimmchen): is this comment outdated?
@@ -462,6 +467,26 @@ bool PowerLimiterClass::calcPowerLimit(std::shared_ptr<InverterAbstract> inverte
     auto solarPowerAC = inverterPowerDcToAc(inverter, solarPowerDC);
 
     auto const& config = Configuration.get();
+
+    // the inverter statistics are usually older than the power meter reading.
+    // while the inverter is still ramping towards the last limit, its output
+    // changed in the meantime, which causes overshooting if not accounted for.
+    // use the output the inverter is expected to have had at the time the
+    // power meter reading was taken instead.
+    if (config.PowerLimiter.PredictiveControl && meterValid) {
+        auto oPredicted = _responseModel.predictOutput(_telemetry.powerMeter.lastUpdate);
+        if (oPredicted.has_value()) {
+            if (_verboseLogging) {
+                MessageOutput.printf("[DPL::calcPowerLimit] inverter output: %d W (reported), "
+                        "%.0f W (predicted), response delay: %u ms, ramp: %.0f W/s\r\n",
+                        inverterOutput, *oPredicted,
+                        _responseModel.getDelayMillis(),
+                        _responseModel.getRampWattsPerSecond());
+            }
+
+            inverterOutput = static_cast<int32_t>(*oPredicted);
+        }
+    }
     auto targetConsumption = config.PowerLimiter.TargetPowerConsumption;
     auto baseLoad = config.PowerLimiter.BaseLoadLimit;
     bool meterIncludesInv = config.PowerLimiter.IsInverterBehindPowerMeter;
@@ -553,6 +578,7 @@ bool PowerLimiterClass::updateInverter()
         _oTargetPowerState = std::nullopt;
         _oTargetPowerLimitWatts = std::nullopt;
         _oUpdateStartMillis = std::nullopt;
+        _oLimitCommandId = std::nullopt;
         return false;
     };
 
@@ -619,6 +645,7 @@ bool PowerLimiterClass::updateInverter()
         if (_inverter->isProducing() != *_oTargetPowerState) {
             MessageOutput.printf("[DPL::updateInverter] %s inverter...\r\n",
                     ((*_oTargetPowerState)?"Starting":"Stopping"));
+            _responseModel.abortStep();
             _inverter->sendPowerControlRequest(*_oTargetPowerState);
             return true;
         }
@@ -648,12 +675,13 @@ bool PowerLimiterClass::updateInverter()
         // the canonical source that updates the known current limit.
         auto currentRelativeLimit = _inverter->SystemConfigPara()->getLimitPercent();
 
-        // we assume having exclusive control over the inverter. if the last
-        // limit command was successful and sent after we started the last
-        // update cycle, we should assume *our* requested limit was set.
+        // we assume having exclusive control over the inverter. if the
+        // command we sent in this update cycle, or a command which superseded
+        // it, was successful, we should assume *our* requested limit was set.
         uint32_t lastLimitCommandMillis = _inverter->SystemConfigPara()->getLastUpdateCommand();
-        if ((lastLimitCommandMillis - *_oUpdateStartMillis) < halfOfAllMillis &&
-                CMD_OK == lastLimitCommandState) {
+        auto lastLimitCommandId = _inverter->SystemConfigPara()->getLastLimitCommandId();
+        if (_oLimitCommandId.has_value() && CMD_OK == lastLimitCommandState &&
+                static_cast<int32_t>(lastLimitCommandId - *_oLimitCommandId) >= 0) {
             MessageOutput.printf("[DPL::updateInverter] actual limit is %.1f %% "
                     "(%.0f W respectively), effective %d ms after update started, "
                     "requested were %.1f %%\r\n",
@@ -669,6 +697,8 @@ bool PowerLimiterClass::updateInverter()
                         newRelativeLimit, currentRelativeLimit);
             }
 
+            _responseModel.onLimitCommand(lastLimitCommandMillis, currentRelativeLimit * maxPower / 100);
+
             _oTargetPowerLimitWatts = std::nullopt;
             return false;
         }
@@ -677,8 +707,11 @@ bool PowerLimiterClass::updateInverter()
                 "(%.0f W respectively), max output is %d W\r\n",
                 newRelativeLimit, (newRelativeLimit * maxPower / 100), maxPower);
 
-        _inverter->sendActivePowerControlRequest(static_cast<float>(newRelativeLimit),
-                PowerLimitControlType::RelativNonPersistent);
+        if (_inverter->sendActivePowerControlRequest(static_cast<float>(newRelativeLimit),
+                PowerLimitControlType::RelativNonPersistent)) {
+            _oLimitCommandId = _inverter->SystemConfigPara()->getLastLimitCommandId();
+            BootStages.onLimitCommand();
+        }
 
         _lastRequestedPowerLimit = *_oTargetPowerLimitWatts;
         return true;
@@ -698,6 +731,30 @@ bool PowerLimiterClass::updateInverter()
     return reset();
 }
 
+/**
+ * feeds new inverter statistics into the model of the inverter's response to
+ * limit changes, which is used to predict the inverter's output.
+ */
+void PowerLimiterClass::updateResponseModel()
+{
+    auto lastStats = _inverter->Statistics()->getLastUpdate();
+    if (lastStats == _responseModelStatsMillis) { return; }
+    _responseModelStatsMillis = lastStats;
+
+    auto learnedSteps = _responseModel.getLearnedSteps();
+
+    _responseModel.onStatistics(lastStats,
+            _inverter->Statistics()->getChannelFieldValue(TYPE_AC, CH0, FLD_PAC));
+
+    if (_verboseLogging && learnedSteps != _responseModel.getLearnedSteps()) {
+        MessageOutput.printf("[DPL::updateResponseModel] learned from %u limit "
+                "changes: response delay %u ms, ramp %.0f W/s\r\n",
+                _responseModel.getLearnedSteps(),
+                _responseModel.getDelayMillis(),
+                _responseModel.getRampWattsPerSecond());
+    }
+}
+
 /**
  * scale the desired inverter limit such that the actual inverter AC output is
  * close to the desired power limit, even if some input channels are producing
@@ -889,11 +946,11 @@ int32_t PowerLimiterClass::getSolarPower()
 
     if (!config.PowerLimiter.SolarPassThroughEnabled
             || isBelowStopThreshold()
-            || !VictronMppt.isDataValid()) {
+            || !_telemetry.mppt.valid) {
         return 0;
     }
 
-    auto solarPower = VictronMppt.getPowerOutputWatts();
+    auto solarPower = _telemetry.mppt.powerOutputWatts;
     if (solarPower < 20) { return 0; } // too little to work with
 
     return solarPower;
@@ -901,7 +958,7 @@ int32_t PowerLimiterClass::getSolarPower()
 
 int32_t PowerLimiterClass::getBatteryDischargeLimit()
 {
-    auto currentLimit = Battery.getDischargeCurrentLimit();
+    auto currentLimit = _telemetry.battery.dischargeCurrentLimit;
 
     if (currentLimit == FLT_MAX) {
         // the returned value is arbitrary, as long as it's
@@ -945,13 +1002,13 @@ bool PowerLimiterClass::testThreshold(float socThreshold, float voltThreshold,
     CONFIG_T& config = Configuration.get();
 
     // prefer SoC provided through battery interface, unless disabled by user
-    auto stats = Battery.getStats();
+    auto const& battery = _telemetry.battery;
     if (!config.PowerLimiter.IgnoreSoc
             && config.Battery.Enabled
             && socThreshold > 0.0
-            && stats->isSoCValid()
-            && stats->getSoCAgeSeconds() < 60) {
-              return compare(stats->getSoC(), socThreshold);
+            && battery.socValid
+            && Telemetry.getAgeSeconds(battery.socLastUpdate) < 60) {
+              return compare(battery.soc, socThreshold);
     }
 
     // use voltage threshold as fallback
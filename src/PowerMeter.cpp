@@ -7,13 +7,15 @@
 #include "PowerMeterSerialSdm.h"
 #include "PowerMeterSerialSml.h"
 #include "PowerMeterUdpSmaHomeManager.h"
+#include "TaskMonitor.h"
+#include "Telemetry.h"
 
 PowerMeterClass PowerMeter;
 
 void PowerMeterClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback(std::bind(&PowerMeterClass::loop, this));
+    _loopTask.setCallback(TaskMonitor.wrap("Power meter", std::bind(&PowerMeterClass::loop, this)));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 
@@ -82,12 +84,31 @@ bool PowerMeterClass::isDataValid() const
     return _upProvider->isDataValid();
 }
 
+std::vector<PowerMeterProvider::TopicStats> PowerMeterClass::getTopicStats() const
+{
+    std::lock_guard<std::mutex> l(_mutex);
+    if (!_upProvider) { return {}; }
+    return _upProvider->getTopicStats();
+}
+
 void PowerMeterClass::loop()
 {
     std::lock_guard<std::mutex> lock(_mutex);
-    if (!_upProvider) { return; }
+
+    PowerMeterTelemetry telemetry = {};
+
+    if (!_upProvider) {
+        Telemetry.publish(telemetry);
+        return;
+    }
+
     _upProvider->loop();
 
+    telemetry.valid = _upProvider->isDataValid();
+    telemetry.powerTotal = _upProvider->getPowerTotal();
+    telemetry.lastUpdate = _upProvider->getLastUpdate();
+    Telemetry.publish(telemetry);
+
     auto const& pmcfg = Configuration.get().PowerMeter;
     if (pmcfg.Source == static_cast<uint8_t>(PowerMeterProvider::Type::MQTT)) { return; }
     _upProvider->mqttLoop();
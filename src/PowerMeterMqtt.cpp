@@ -2,27 +2,26 @@
 #include "PowerMeterMqtt.h"
 #include "MqttSettings.h"
 #include "MessageOutput.h"
-#include "ArduinoJson.h"
-#include "Utils.h"
 
 bool PowerMeterMqtt::init()
 {
-    auto subscribe = [this](PowerMeterMqttValue const& val, float* targetVariable) {
-        *targetVariable = 0;
+    _parsers.reserve(_powerValues.size());
+
+    for (size_t i = 0; i < _powerValues.size(); ++i) {
+        auto const& val = _cfg.Values[i];
+        _powerValues[i] = 0;
+        _parsers.emplace_back(val.JsonPath);
+        _stats[i] = { val.Topic, 0, 0, 0, 0, 0 };
+
         char const* topic = val.Topic;
-        if (strlen(topic) == 0) { return; }
+        if (strlen(topic) == 0) { continue; }
         MqttSettings.subscribe(topic, 0,
                 std::bind(&PowerMeterMqtt::onMessage,
                     this, std::placeholders::_1, std::placeholders::_2,
                     std::placeholders::_3, std::placeholders::_4,
-                    std::placeholders::_5, std::placeholders::_6,
-                    targetVariable, &val)
+                    std::placeholders::_5, std::placeholders::_6, i)
                 );
         _mqttSubscriptions.push_back(topic);
-    };
-
-    for (size_t i = 0; i < _powerValues.size(); ++i) {
-        subscribe(_cfg.Values[i], &_powerValues[i]);
     }
 
     return _mqttSubscriptions.size() > 0;
@@ -36,18 +35,34 @@ PowerMeterMqtt::~PowerMeterMqtt()
 
 void PowerMeterMqtt::onMessage(PowerMeterMqtt::MsgProperties const& properties,
         char const* topic, uint8_t const* payload, size_t len, size_t index,
-        size_t total, float* targetVariable, PowerMeterMqttValue const* cfg)
+        size_t total, size_t valueIdx)
 {
-    auto extracted = Utils::getNumericValueFromMqttPayload<float>("PowerMeterMqtt",
-            std::string(reinterpret_cast<const char*>(payload), len), topic,
-            cfg->JsonPath);
+    auto const& cfg = _cfg.Values[valueIdx];
 
-    if (!extracted.has_value()) { return; }
+    char error[128];
+    uint32_t start = micros();
+    auto extracted = _parsers[valueIdx].parse(payload, len, error, sizeof(error));
+    uint32_t duration = micros() - start;
+
+    {
+        std::lock_guard<std::mutex> l(_mutex);
+        auto& stats = _stats[valueIdx];
+        ++stats.messages;
+        if (!extracted.has_value()) { ++stats.errors; }
+        stats.lastMicros = duration;
+        stats.maxMicros = std::max(stats.maxMicros, duration);
+        stats.sumMicros += duration;
+    }
+
+    if (!extracted.has_value()) {
+        MessageOutput.printf("[PowerMeterMqtt] Topic '%s': %s\r\n", topic, error);
+        return;
+    }
 
     float newValue = *extracted;
 
     using Unit_t = PowerMeterMqttValue::Unit;
-    switch (cfg->PowerUnit) {
+    switch (cfg.PowerUnit) {
         case Unit_t::MilliWatts:
             newValue /= 1000;
             break;
@@ -58,11 +73,11 @@ void PowerMeterMqtt::onMessage(PowerMeterMqtt::MsgProperties const& properties,
             break;
     }
 
-    if (cfg->SignInverted) { newValue *= -1; }
+    if (cfg.SignInverted) { newValue *= -1; }
 
     {
         std::lock_guard<std::mutex> l(_mutex);
-        *targetVariable = newValue;
+        _powerValues[valueIdx] = newValue;
     }
 
     if (_verboseLogging) {
@@ -80,3 +95,14 @@ float PowerMeterMqtt::getPowerTotal() const
     for (auto v: _powerValues) { sum += v; }
     return sum;
 }
+
+std::vector<PowerMeterProvider::TopicStats> PowerMeterMqtt::getTopicStats() const
+{
+    std::vector<TopicStats> res;
+    std::lock_guard<std::mutex> l(_mutex);
+    for (auto const& stats : _stats) {
+        if (stats.topic.isEmpty()) { continue; }
+        res.push_back(stats);
+    }
+    return res;
+}
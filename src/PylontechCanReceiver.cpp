@@ -3,6 +3,7 @@
 #include "MessageOutput.h"
 #include "PinMapping.h"
 #include <driver/twai.h>
+#include <frozen/set.h>
 #include <ctime>
 
 bool PylontechCanReceiver::init(bool verboseLogging)
@@ -11,6 +12,15 @@ bool PylontechCanReceiver::init(bool verboseLogging)
 }
 
 
+bool PylontechCanReceiver::isKnownIdentifier(uint32_t identifier) const
+{
+    static constexpr frozen::set<uint32_t, 6> identifiers = {
+        0x351, 0x355, 0x356, 0x359, 0x35C, 0x35E
+    };
+
+    return identifiers.count(identifier) > 0;
+}
+
 void PylontechCanReceiver::onMessage(twai_message_t rx_message)
 {
     switch (rx_message.identifier) {
@@ -3,6 +3,7 @@
 #include "MessageOutput.h"
 #include "PinMapping.h"
 #include <driver/twai.h>
+#include <frozen/set.h>
 #include <ctime>
 
 bool PytesCanReceiver::init(bool verboseLogging)
@@ -10,6 +11,16 @@ bool PytesCanReceiver::init(bool verboseLogging)
     return BatteryCanReceiver::init(verboseLogging, "Pytes");
 }
 
+bool PytesCanReceiver::isKnownIdentifier(uint32_t identifier) const
+{
+    static constexpr frozen::set<uint32_t, 16> identifiers = {
+        0x351, 0x355, 0x356, 0x35A, 0x35E, 0x35F, 0x372, 0x373,
+        0x374, 0x375, 0x376, 0x377, 0x378, 0x379, 0x380, 0x381
+    };
+
+    return identifiers.count(identifier) > 0;
+}
+
 void PytesCanReceiver::onMessage(twai_message_t rx_message)
 {
     switch (rx_message.identifier) {
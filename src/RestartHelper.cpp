@@ -5,12 +5,13 @@
 #include "RestartHelper.h"
 #include "Display_Graphic.h"
 #include "Led_Single.h"
+#include "TaskMonitor.h"
 #include <Esp.h>
 
 RestartHelperClass RestartHelper;
 
 RestartHelperClass::RestartHelperClass()
-    : _rebootTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&RestartHelperClass::loop, this))
+    : _rebootTask(1 * TASK_SECOND, TASK_FOREVER, TaskMonitor.wrap("Restart helper", std::bind(&RestartHelperClass::loop, this)))
 {
 }
 
@@ -3,6 +3,7 @@
 #include "MessageOutput.h"
 #include "PinMapping.h"
 #include <driver/twai.h>
+#include <frozen/set.h>
 #include <ctime>
 
 bool SBSCanReceiver::init(bool verboseLogging)
@@ -12,6 +13,15 @@ bool SBSCanReceiver::init(bool verboseLogging)
 }
 
 
+bool SBSCanReceiver::isKnownIdentifier(uint32_t identifier) const
+{
+    static constexpr frozen::set<uint32_t, 6> identifiers = {
+        0x610, 0x630, 0x640, 0x650, 0x660, 0x670
+    };
+
+    return identifiers.count(identifier) > 0;
+}
+
 void SBSCanReceiver::onMessage(twai_message_t rx_message)
 {
     switch (rx_message.identifier) {
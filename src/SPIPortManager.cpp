@@ -13,6 +13,8 @@ void SPIPortManagerClass::init() {
 
 std::optional<uint8_t> SPIPortManagerClass::allocatePort(std::string const& owner)
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     for (size_t i = 0; i < _ports.size(); ++i) {
         if (_ports[i] != "") {
             MessageOutput.printf("%s SPI%d already in use by '%s'\r\n", TAG, i, _ports[i].c_str());
@@ -32,6 +34,8 @@ std::optional<uint8_t> SPIPortManagerClass::allocatePort(std::string const& owne
 
 void SPIPortManagerClass::freePort(std::string const& owner)
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     for (size_t i = 0; i < _ports.size(); ++i) {
         if (_ports[i] != owner) { continue; }
 
@@ -15,6 +15,8 @@ void SerialPortManagerClass::init()
 
 std::optional<uint8_t> SerialPortManagerClass::allocatePort(std::string const& owner)
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     for (size_t i = 0; i < _ports.size(); ++i) {
         if (_ports[i] != "") {
             MessageOutput.printf("[SerialPortManager] HW UART %d already "
@@ -37,6 +39,8 @@ std::optional<uint8_t> SerialPortManagerClass::allocatePort(std::string const& o
 
 void SerialPortManagerClass::freePort(std::string const& owner)
 {
+    std::lock_guard<std::mutex> lock(_mutex);
+
     for (size_t i = 0; i < _ports.size(); ++i) {
         if (_ports[i] != owner) { continue; }
 
@@ -4,13 +4,14 @@
  */
 #include "SunPosition.h"
 #include "Configuration.h"
+#include "TaskMonitor.h"
 #include "Utils.h"
 #include <Arduino.h>
 
 SunPositionClass SunPosition;
 
 SunPositionClass::SunPositionClass()
-    : _loopTask(5 * TASK_SECOND, TASK_FOREVER, std::bind(&SunPositionClass::loop, this))
+    : _loopTask(5 * TASK_SECOND, TASK_FOREVER, TaskMonitor.wrap("Sun position", std::bind(&SunPositionClass::loop, this)))
 {
 }
 
@@ -9,9 +9,10 @@
 #include "Configuration.h"
 #include "MessageOutput.h"
 #include "NetworkSettings.h"
+#include "TaskMonitor.h"
 
 SyslogLogger::SyslogLogger()
-    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, std::bind(&SyslogLogger::loop, this))
+    : _loopTask(TASK_IMMEDIATE, TASK_FOREVER, TaskMonitor.wrap("Syslog", std::bind(&SyslogLogger::loop, this)))
 {
 }
 
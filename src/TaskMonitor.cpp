@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "TaskMonitor.h"
+#include "Scheduler.h"
+#include <Arduino.h>
+#include <algorithm>
+#include <list>
+#include <mutex>
+
+TaskMonitorClass TaskMonitor;
+
+namespace {
+// the statistics are updated by the loop task without locking, such that
+// the monitored tasks are not slowed down. readers may see a call counted
+// before its runtime. the mutex protects the list itself.
+struct Registry {
+    std::mutex Mutex;
+    std::list<TaskMonitorClass::TaskStats> Tasks;
+    TaskMonitorClass::LoopStats Loop = {};
+};
+
+// function local, as wrap() is used during static initialization
+Registry& registry()
+{
+    static Registry r;
+    return r;
+}
+}
+
+TaskCallback TaskMonitorClass::wrap(char const* name, TaskCallback callback)
+{
+    auto& r = registry();
+
+    TaskStats* stats;
+    {
+        std::lock_guard<std::mutex> lock(r.Mutex);
+        r.Tasks.push_back({ name, 0, 0, 0, 0, 0, 0 });
+        stats = &r.Tasks.back();
+    }
+
+    return [stats, callback]() {
+        // only the main scheduler executes tasks
+        Task* task = scheduler.getCurrentTask();
+        if (task != nullptr) {
+            const uint32_t startDelay = std::max<long>(task->getStartDelay(), 0);
+            stats->StartDelayMs += startDelay;
+            stats->MaxStartDelayMs = std::max(stats->MaxStartDelayMs, startDelay);
+            if (task->getOverrun() < 0) {
+                ++stats->Overruns;
+            }
+        }
+
+        const uint32_t start = micros();
+        callback();
+        const uint32_t runtime = micros() - start;
+
+        ++stats->Calls;
+        stats->RuntimeUs += runtime;
+        stats->MaxRuntimeUs = std::max(stats->MaxRuntimeUs, runtime);
+    };
+}
+
+void TaskMonitorClass::onLoop(const uint32_t durationUs)
+{
+    auto& loop = registry().Loop;
+    ++loop.Passes;
+    loop.DurationUs += durationUs;
+    loop.MaxDurationUs = std::max(loop.MaxDurationUs, durationUs);
+}
+
+std::vector<TaskMonitorClass::TaskStats> TaskMonitorClass::getTaskStats()
+{
+    auto& r = registry();
+
+    std::vector<TaskStats> res;
+    {
+        std::lock_guard<std::mutex> lock(r.Mutex);
+        res.assign(r.Tasks.begin(), r.Tasks.end());
+    }
+
+    std::sort(res.begin(), res.end(), [](TaskStats const& a, TaskStats const& b) {
+        return a.RuntimeUs > b.RuntimeUs;
+    });
+
+    return res;
+}
+
+TaskMonitorClass::LoopStats TaskMonitorClass::getLoopStats()
+{
+    return registry().Loop;
+}
+
+void TaskMonitorClass::reset()
+{
+    auto& r = registry();
+
+    std::lock_guard<std::mutex> lock(r.Mutex);
+    for (auto& stats : r.Tasks) {
+        stats = { stats.Name, 0, 0, 0, 0, 0, 0 };
+    }
+    r.Loop = {};
+}
+
+void TaskMonitorClass::printStats(Print& out)
+{
+    auto loop = getLoopStats();
+    out.printf("Scheduler passes: %u, avg %u us, max %u us\r\n", loop.Passes,
+        loop.Passes > 0 ? static_cast<uint32_t>(loop.DurationUs / loop.Passes) : 0,
+        loop.MaxDurationUs);
+
+    out.printf("%-24s %10s %10s %8s %8s %10s %9s\r\n",
+        "Task", "Calls", "Total ms", "Avg us", "Max us", "Max delay", "Overruns");
+
+    for (auto const& stats : getTaskStats()) {
+        out.printf("%-24s %10u %10u %8u %8u %7u ms %9u\r\n",
+            stats.Name, stats.Calls,
+            static_cast<uint32_t>(stats.RuntimeUs / 1000),
+            stats.Calls > 0 ? static_cast<uint32_t>(stats.RuntimeUs / stats.Calls) : 0,
+            stats.MaxRuntimeUs, stats.MaxStartDelayMs, stats.Overruns);
+    }
+}
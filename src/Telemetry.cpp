@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "Telemetry.h"
+
+TelemetryClass Telemetry;
+
+TelemetryClass::TelemetryClass()
+{
+    // consumers must not apply a zero current limit before the battery
+    // was polled for the first time.
+    BatteryTelemetry battery = {};
+    battery.chargeCurrentLimitation = FLT_MAX;
+    battery.dischargeCurrentLimit = FLT_MAX;
+    _battery.publish(battery);
+}
+
+void TelemetryClass::getView(TelemetryView& view) const
+{
+    for (uint8_t attempt = 0; attempt < 3; ++attempt) {
+        view.generation = getGeneration();
+
+        get(view.powerMeter);
+        get(view.battery);
+        get(view.mppt);
+        get(view.huawei);
+        get(view.inverters);
+
+        if (getGeneration() == view.generation) { return; }
+    }
+}
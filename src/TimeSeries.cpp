@@ -0,0 +1,424 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "TimeSeries.h"
+#include "Configuration.h"
+#include "MessageOutput.h"
+#include "PowerLimiter.h"
+#include "TaskMonitor.h"
+#include "Telemetry.h"
+#include <LittleFS.h>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <vector>
+
+TimeSeriesClass TimeSeries;
+
+static constexpr char const* seriesNames[TimeSeriesClass::SeriesCount] = {
+    "ac_power",
+    "dc_power",
+    "solar_power",
+    "grid_power",
+    "battery_soc",
+    "battery_voltage",
+    "battery_current",
+    "dpl_limit",
+    "dpl_status"
+};
+
+// values are stored as integers, scaled by this factor
+static constexpr float seriesScale[TimeSeriesClass::SeriesCount] = {
+    1, // W
+    1, // W
+    1, // W
+    1, // W
+    10, // 0.1 %
+    100, // 10 mV
+    100, // 10 mA
+    1, // W
+    1 // status enum
+};
+
+static void writeVarint(std::vector<uint8_t>& buf, int64_t value)
+{
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (zigzag >= 0x80) {
+        buf.push_back(static_cast<uint8_t>(zigzag) | 0x80);
+        zigzag >>= 7;
+    }
+    buf.push_back(static_cast<uint8_t>(zigzag));
+}
+
+static bool readVarint(std::vector<uint8_t> const& buf, size_t& pos, int64_t& value)
+{
+    uint64_t zigzag = 0;
+    for (uint8_t shift = 0; shift < 64; shift += 7) {
+        if (pos >= buf.size()) {
+            return false;
+        }
+        uint8_t b = buf[pos++];
+        zigzag |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TimeSeriesClass::init(Scheduler& scheduler)
+{
+    scheduler.addTask(_loopTask);
+    _loopTask.setCallback(TaskMonitor.wrap("Time series", std::bind(&TimeSeriesClass::loop, this)));
+    _loopTask.setIterations(TASK_FOREVER);
+    _loopTask.setInterval(1 * TASK_SECOND);
+    _loopTask.enable();
+
+    scanFiles();
+}
+
+char const* TimeSeriesClass::getSeriesName(Series series)
+{
+    return seriesNames[static_cast<size_t>(series)];
+}
+
+std::optional<TimeSeriesClass::Series> TimeSeriesClass::getSeriesByName(String const& name)
+{
+    for (size_t i = 0; i < SeriesCount; ++i) {
+        if (name == seriesNames[i]) {
+            return static_cast<Series>(i);
+        }
+    }
+    return std::nullopt;
+}
+
+float TimeSeriesClass::toFloat(Series series, int32_t value)
+{
+    return value / seriesScale[static_cast<size_t>(series)];
+}
+
+void TimeSeriesClass::sample(std::array<int32_t, SeriesCount>& values) const
+{
+    auto set = [&values](Series series, bool valid, float value) {
+        size_t idx = static_cast<size_t>(series);
+        values[idx] = valid ? static_cast<int32_t>(std::lround(value * seriesScale[idx])) : NoValue;
+    };
+
+    TelemetryView telemetry;
+    Telemetry.getView(telemetry);
+
+    set(Series::AcPower, true, telemetry.inverters.totalAcPower);
+    set(Series::DcPower, true, telemetry.inverters.totalDcPower);
+    set(Series::SolarPower, telemetry.mppt.valid, telemetry.mppt.powerOutputWatts);
+    set(Series::GridPower, telemetry.powerMeter.valid, telemetry.powerMeter.powerTotal);
+
+    auto const& battery = telemetry.battery;
+    set(Series::BatterySoC, battery.socValid, battery.soc);
+    set(Series::BatteryVoltage, battery.voltageValid, battery.voltage);
+    set(Series::BatteryCurrent, battery.currentValid, battery.chargeCurrent);
+
+    bool dplEnabled = Configuration.get().PowerLimiter.Enabled;
+    set(Series::DplLimit, dplEnabled, PowerLimiter.getLastRequestedPowerLimit());
+    set(Series::DplStatus, true, static_cast<float>(PowerLimiter.getStatus()));
+}
+
+void TimeSeriesClass::loop()
+{
+    std::array<int32_t, SeriesCount> values;
+    sample(values);
+
+    struct tm timeinfo;
+    bool timeValid = getLocalTime(&timeinfo, 5);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _raw[_rawHead] = { millis(), values };
+        _rawHead = (_rawHead + 1) % RawSamples;
+        if (_rawCount < RawSamples) { ++_rawCount; }
+
+        // persisted samples need a valid wall clock time
+        if (!timeValid) { return; }
+
+        aggregate(time(nullptr), values);
+    }
+
+    writePendingBlock();
+}
+
+void TimeSeriesClass::aggregate(uint32_t now, std::array<int32_t, SeriesCount> const& values)
+{
+    uint32_t minute = now - (now % MinuteInterval);
+
+    if (minute != _aggMinute) {
+        if (_aggMinute != 0) {
+            appendMinute(_aggMinute);
+        }
+
+        _aggMinute = minute;
+        _aggSum.fill(0);
+        _aggCount.fill(0);
+    }
+
+    for (size_t i = 0; i < SeriesCount; ++i) {
+        if (values[i] == NoValue) { continue; }
+        _aggSum[i] += values[i];
+        _aggCount[i]++;
+    }
+}
+
+void TimeSeriesClass::appendMinute(uint32_t timestamp)
+{
+    // a block covers consecutive minutes only. start a new one on gaps
+    // (reboot, lost time sync) or when the clock was set backwards.
+    if (_block.count > 0 && timestamp != _block.start + _block.count * MinuteInterval) {
+        flushBlock();
+    }
+
+    if (_block.count == 0) {
+        _block.start = timestamp;
+    }
+
+    for (size_t i = 0; i < SeriesCount; ++i) {
+        _block.values[i][_block.count] = (_aggCount[i] > 0) ? static_cast<int32_t>(_aggSum[i] / _aggCount[i]) : NoValue;
+    }
+
+    if (++_block.count >= BlockSamples) {
+        flushBlock();
+    }
+}
+
+void TimeSeriesClass::flushBlock()
+{
+    if (_block.count == 0) { return; }
+
+    // at most one block is completed per loop, which writes it right away
+    _pendingBlock = _block;
+    _block.count = 0;
+}
+
+void TimeSeriesClass::writePendingBlock()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_pendingBlock.count == 0) { return; }
+    }
+
+    std::lock_guard<std::mutex> fileLock(_fileMutex);
+
+    // the block is taken while holding _fileMutex, such that queries
+    // either see it pending or in the files.
+    Block block;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        block = _pendingBlock;
+        _pendingBlock.count = 0;
+    }
+
+    if (!_fsReady) { return; }
+
+    // the first value of each series is stored as is, every following
+    // value is stored as the difference to its predecessor. both are
+    // zigzag-encoded varints, such that small changes need a single byte.
+    std::vector<uint8_t> payload;
+    payload.reserve(SeriesCount * block.count * 2);
+    for (size_t i = 0; i < SeriesCount; ++i) {
+        int64_t previous = 0;
+        for (size_t j = 0; j < block.count; ++j) {
+            writeVarint(payload, static_cast<int64_t>(block.values[i][j]) - previous);
+            previous = block.values[i][j];
+        }
+    }
+
+    BlockHeader header;
+    header.magic = BlockMagic;
+    header.seriesCount = SeriesCount;
+    header.count = block.count;
+    header.start = block.start;
+    header.interval = MinuteInterval;
+    header.length = payload.size();
+
+    String filename = getFilename(_lastSequence);
+    if (LittleFS.exists(filename)) {
+        File f = LittleFS.open(filename, "r", false);
+        size_t size = f.size();
+        f.close();
+
+        if (size + sizeof(header) + payload.size() > MaxFileSize) {
+            filename = getFilename(++_lastSequence);
+        }
+    }
+
+    while (_lastSequence - _firstSequence >= MaxFileCount) {
+        LittleFS.remove(getFilename(_firstSequence++));
+    }
+
+    File f = LittleFS.open(filename, "a");
+    if (!f) {
+        MessageOutput.printf("[TimeSeries] Cannot open %s for writing\r\n", filename.c_str());
+        return;
+    }
+
+    f.write(reinterpret_cast<uint8_t const*>(&header), sizeof(header));
+    f.write(payload.data(), payload.size());
+    f.close();
+}
+
+String TimeSeriesClass::getFilename(uint32_t sequence) const
+{
+    return String(TIMESERIES_DIRNAME) + "/" + String(sequence) + ".bin";
+}
+
+void TimeSeriesClass::scanFiles()
+{
+    std::lock_guard<std::mutex> fileLock(_fileMutex);
+
+    if (!LittleFS.exists(TIMESERIES_DIRNAME) && !LittleFS.mkdir(TIMESERIES_DIRNAME)) {
+        MessageOutput.println("[TimeSeries] Cannot create data directory");
+        return;
+    }
+
+    File dir = LittleFS.open(TIMESERIES_DIRNAME);
+    if (!dir || !dir.isDirectory()) {
+        return;
+    }
+
+    bool found = false;
+    File file = dir.openNextFile();
+    while (file) {
+        String name = file.name();
+        name = name.substring(name.lastIndexOf('/') + 1);
+        uint32_t sequence = name.toInt();
+
+        if (!found) {
+            _firstSequence = _lastSequence = sequence;
+            found = true;
+        } else {
+            _firstSequence = std::min(_firstSequence, sequence);
+            _lastSequence = std::max(_lastSequence, sequence);
+        }
+
+        file = dir.openNextFile();
+    }
+
+    _fsReady = true;
+}
+
+void TimeSeriesClass::queryFile(uint32_t sequence, size_t idx, uint32_t from, uint32_t to, PointCallback const& cb)
+{
+    String filename = getFilename(sequence);
+    if (!LittleFS.exists(filename)) { return; }
+
+    File f = LittleFS.open(filename, "r", false);
+    if (!f) { return; }
+
+    std::vector<uint8_t> payload;
+    BlockHeader header;
+
+    while (f.read(reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header)) {
+        if (header.magic != BlockMagic || header.count == 0) { break; }
+
+        uint32_t end = header.start + (header.count - 1) * header.interval;
+        if (end < from || header.start > to || idx >= header.seriesCount) {
+            if (!f.seek(header.length, SeekCur)) { break; }
+            continue;
+        }
+
+        payload.resize(header.length);
+        if (f.read(payload.data(), payload.size()) != payload.size()) { break; }
+
+        size_t pos = 0;
+        for (size_t i = 0; i <= idx; ++i) {
+            int64_t value = 0;
+            for (size_t j = 0; j < header.count; ++j) {
+                int64_t delta;
+                if (!readVarint(payload, pos, delta)) { return; }
+                value += delta;
+
+                if (i != idx || value == NoValue) { continue; }
+
+                uint32_t timestamp = header.start + j * header.interval;
+                if (timestamp < from || timestamp > to) { continue; }
+
+                if (!cb(timestamp, static_cast<int32_t>(value))) { return; }
+            }
+        }
+    }
+}
+
+bool TimeSeriesClass::query(Series series, Resolution resolution, uint32_t from, uint32_t to, size_t maxPoints, std::vector<Point>& points)
+{
+    size_t idx = static_cast<size_t>(series);
+    bool more = false;
+
+    points.clear();
+    auto add = [&](uint32_t timestamp, int32_t value) -> bool {
+        if (points.size() >= maxPoints) {
+            more = true;
+            return false;
+        }
+        points.push_back({ timestamp, toFloat(series, value) });
+        return true;
+    };
+
+    if (resolution == Resolution::Raw) {
+        // raw samples are timestamped using millis(). use uptime
+        // seconds instead of unix timestamps if the time is not synced.
+        struct tm timeinfo;
+        bool timeValid = getLocalTime(&timeinfo, 5);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        uint32_t nowMillis = millis();
+        uint32_t now = timeValid ? time(nullptr) : nowMillis / 1000;
+
+        for (size_t i = 0; i < _rawCount; ++i) {
+            RawSample const& sample = _raw[(_rawHead + RawSamples - _rawCount + i) % RawSamples];
+            if (sample.values[idx] == NoValue) { continue; }
+
+            uint32_t timestamp = now - (nowMillis - sample.millis) / 1000;
+            if (timestamp < from || timestamp > to) { continue; }
+
+            if (!add(timestamp, sample.values[idx])) { break; }
+        }
+
+        return more;
+    }
+
+    std::lock_guard<std::mutex> fileLock(_fileMutex);
+
+    // minutes not yet written to flash, copied such that the files are
+    // read without holding _mutex. the pending block is older than the
+    // current one.
+    struct {
+        uint32_t start;
+        uint8_t count;
+        std::array<int32_t, BlockSamples> values;
+    } blocks[2];
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        blocks[0] = { _pendingBlock.start, _pendingBlock.count, _pendingBlock.values[idx] };
+        blocks[1] = { _block.start, _block.count, _block.values[idx] };
+    }
+
+    if (_fsReady) {
+        for (uint32_t sequence = _firstSequence; sequence <= _lastSequence && !more; ++sequence) {
+            queryFile(sequence, idx, from, to, add);
+        }
+    }
+
+    for (auto const& block : blocks) {
+        for (size_t j = 0; j < block.count && !more; ++j) {
+            if (block.values[j] == NoValue) { continue; }
+
+            uint32_t timestamp = block.start + j * MinuteInterval;
+            if (timestamp < from || timestamp > to) { continue; }
+
+            add(timestamp, block.values[j]);
+        }
+    }
+
+    return more;
+}
@@ -4,13 +4,15 @@
 #include "PinMapping.h"
 #include "MessageOutput.h"
 #include "SerialPortManager.h"
+#include "TaskMonitor.h"
+#include "Telemetry.h"
 
 VictronMpptClass VictronMppt;
 
 void VictronMpptClass::init(Scheduler& scheduler)
 {
     scheduler.addTask(_loopTask);
-    _loopTask.setCallback([this] { loop(); });
+    _loopTask.setCallback(TaskMonitor.wrap("Victron MPPT", [this] { loop(); }));
     _loopTask.setIterations(TASK_FOREVER);
     _loopTask.enable();
 
@@ -22,6 +24,9 @@ void VictronMpptClass::updateSettings()
     std::lock_guard<std::mutex> lock(_mutex);
 
     _controllers.clear();
+    _aggregatedUpdates.clear();
+    Telemetry.publish(calculateAggregate());
+
     for (auto const& o: _serialPortOwners) {
         SerialPortManager.freePort(o.c_str());
     }
@@ -62,7 +67,9 @@ bool VictronMpptClass::initController(int8_t rx, int8_t tx, bool logging,
 
     auto upController = std::make_unique<VeDirectMpptController>();
     upController->init(rx, tx, &MessageOutput, logging, *oHwSerialPort);
+    upController->setFastPollInterval(Configuration.get().Vedirect.FastPollInterval);
     _controllers.push_back(std::move(upController));
+    _aggregatedUpdates.push_back(0);
     return true;
 }
 
@@ -70,9 +77,24 @@ void VictronMpptClass::loop()
 {
     std::lock_guard<std::mutex> lock(_mutex);
 
-    for (auto const& upController : _controllers) {
+    bool changed = false;
+
+    for (size_t i = 0; i < _controllers.size(); ++i) {
+        auto const& upController = _controllers[i];
         upController->loop();
+
+        // a new frame was processed or the controller's data became
+        // outdated, in which case it is excluded from the aggregate.
+        uint32_t lastUpdate = upController->isDataValid() ? upController->getLastUpdate() : 0;
+        if (lastUpdate == _aggregatedUpdates[i]) { continue; }
+
+        _aggregatedUpdates[i] = lastUpdate;
+        changed = true;
     }
+
+    if (!changed) { return; }
+
+    Telemetry.publish(calculateAggregate());
 }
 
 /*
@@ -81,13 +103,7 @@ void VictronMpptClass::loop()
  */
 bool VictronMpptClass::isDataValid() const
 {
-    std::lock_guard<std::mutex> lock(_mutex);
-
-    for (auto const& upController: _controllers) {
-        if (upController->isDataValid()) { return true; }
-    }
-
-    return false;
+    return getAggregate().valid;
 }
 
 bool VictronMpptClass::isDataValid(size_t idx) const
@@ -145,84 +161,84 @@ std::optional<VeDirectMpptController::data_t> VictronMpptClass::getData(size_t i
     return _controllers[idx]->getData();
 }
 
-int32_t VictronMpptClass::getPowerOutputWatts() const
+std::optional<VeDirectMpptController::FastPollStats> VictronMpptClass::getFastPollStats(size_t idx) const
 {
-    int32_t sum = 0;
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (idx >= _controllers.size()) { return std::nullopt; }
+
+    return _controllers[idx]->getFastPollStats();
+}
+
+MpptTelemetry VictronMpptClass::calculateAggregate() const
+{
+    MpptTelemetry aggregate = {};
+    aggregate.outputVoltage = -1;
 
-    for (const auto& upController : _controllers) {
-        if (!upController->isDataValid()) { continue; }
+    bool networkPowerFound = false;
+
+    for (size_t i = 0; i < _controllers.size(); ++i) {
+        if (_aggregatedUpdates[i] == 0) { continue; }
+
+        auto const& data = _controllers[i]->getData();
+        aggregate.valid = true;
 
         // if any charge controller is part of a VE.Smart network, and if the
         // charge controller is connected in a way that allows to send
         // requests, we should have the "network total DC input power"
         // available. if so, to estimate the output power, we multiply by
         // the calculated efficiency of the connected charge controller.
-        auto networkPower = upController->getData().NetworkTotalDcInputPowerMilliWatts;
-        if (networkPower.first > 0) {
-            return static_cast<int32_t>(networkPower.second / 1000.0 * upController->getData().mpptEfficiency_Percent / 100);
+        auto networkPower = data.NetworkTotalDcInputPowerMilliWatts;
+        if (!networkPowerFound && networkPower.first > 0) {
+            networkPowerFound = true;
+            aggregate.powerOutputWatts = static_cast<int32_t>(networkPower.second / 1000.0 * data.mpptEfficiency_Percent / 100);
+            aggregate.panelPowerWatts = static_cast<int32_t>(networkPower.second / 1000.0);
         }
 
-        sum += upController->getData().batteryOutputPower_W;
+        if (!networkPowerFound) {
+            aggregate.powerOutputWatts += data.batteryOutputPower_W;
+            aggregate.panelPowerWatts += data.panelPower_PPV_W;
+        }
+
+        aggregate.yieldTotal += data.yieldTotal_H19_Wh / 1000.0;
+        aggregate.yieldDay += data.yieldToday_H20_Wh / 1000.0;
+
+        float volts = data.batteryVoltage_V_mV / 1000.0;
+        if (aggregate.outputVoltage == -1) { aggregate.outputVoltage = volts; }
+        aggregate.outputVoltage = std::min(aggregate.outputVoltage, volts);
     }
 
-    return sum;
+    return aggregate;
 }
 
-int32_t VictronMpptClass::getPanelPowerWatts() const
+MpptTelemetry VictronMpptClass::getAggregate() const
 {
-    int32_t sum = 0;
-
-    for (const auto& upController : _controllers) {
-        if (!upController->isDataValid()) { continue; }
-
-        // if any charge controller is part of a VE.Smart network, and if the
-        // charge controller is connected in a way that allows to send
-        // requests, we should have the "network total DC input power" available.
-        auto networkPower = upController->getData().NetworkTotalDcInputPowerMilliWatts;
-        if (networkPower.first > 0) {
-            return static_cast<int32_t>(networkPower.second / 1000.0);
-        }
+    MpptTelemetry aggregate;
+    Telemetry.get(aggregate);
+    return aggregate;
+}
 
-        sum += upController->getData().panelPower_PPV_W;
-    }
+int32_t VictronMpptClass::getPowerOutputWatts() const
+{
+    return getAggregate().powerOutputWatts;
+}
 
-    return sum;
+int32_t VictronMpptClass::getPanelPowerWatts() const
+{
+    return getAggregate().panelPowerWatts;
 }
 
 float VictronMpptClass::getYieldTotal() const
 {
-    float sum = 0;
-
-    for (const auto& upController : _controllers) {
-        if (!upController->isDataValid()) { continue; }
-        sum += upController->getData().yieldTotal_H19_Wh / 1000.0;
-    }
-
-    return sum;
+    return getAggregate().yieldTotal;
 }
 
 float VictronMpptClass::getYieldDay() const
 {
-    float sum = 0;
-
-    for (const auto& upController : _controllers) {
-        if (!upController->isDataValid()) { continue; }
-        sum += upController->getData().yieldToday_H20_Wh / 1000.0;
-    }
-
-    return sum;
+    return getAggregate().yieldDay;
 }
 
 float VictronMpptClass::getOutputVoltage() const
 {
-    float min = -1;
-
-    for (const auto& upController : _controllers) {
-        if (!upController->isDataValid()) { continue; }
-        float volts = upController->getData().batteryVoltage_V_mV / 1000.0;
-        if (min == -1) { min = volts; }
-        min = std::min(min, volts);
-    }
-
-    return min;
+    return getAggregate().outputVoltage;
 }
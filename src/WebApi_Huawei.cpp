@@ -9,6 +9,7 @@
 #include "PinMapping.h"
 #include "WebApi.h"
 #include "WebApi_errors.h"
+#include "defaults.h"
 #include <AsyncJson.h>
 #include <Hoymiles.h>
 
@@ -167,6 +168,9 @@ void WebApiHuaweiClass::onAdminGet(AsyncWebServerRequest* request)
     root["upper_power_limit"] = config.Huawei.Auto_Power_Upper_Power_Limit;
     root["stop_batterysoc_threshold"] = config.Huawei.Auto_Power_Stop_BatterySoC_Threshold;
     root["target_power_consumption"] = config.Huawei.Auto_Power_Target_Power_Consumption;
+    root["auto_power_kp"] = config.Huawei.Auto_Power_Kp;
+    root["auto_power_ki"] = config.Huawei.Auto_Power_Ki;
+    root["auto_power_max_ramp"] = config.Huawei.Auto_Power_Max_Ramp;
 
     response->setLength();
     request->send(response);
@@ -213,6 +217,9 @@ void WebApiHuaweiClass::onAdminPost(AsyncWebServerRequest* request)
     config.Huawei.Auto_Power_Upper_Power_Limit = root["upper_power_limit"].as<float>();
     config.Huawei.Auto_Power_Stop_BatterySoC_Threshold = root["stop_batterysoc_threshold"];
     config.Huawei.Auto_Power_Target_Power_Consumption = root["target_power_consumption"];
+    config.Huawei.Auto_Power_Kp = root["auto_power_kp"] | HUAWEI_AUTO_POWER_KP;
+    config.Huawei.Auto_Power_Ki = root["auto_power_ki"] | HUAWEI_AUTO_POWER_KI;
+    config.Huawei.Auto_Power_Max_Ramp = root["auto_power_max_ramp"] | HUAWEI_AUTO_POWER_MAX_RAMP;
 
     WebApi.writeConfig(retMsg);
 
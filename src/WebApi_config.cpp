@@ -4,6 +4,7 @@
  */
 #include "WebApi_config.h"
 #include "Configuration.h"
+#include "ConfigSnapshot.h"
 #include "RestartHelper.h"
 #include "Utils.h"
 #include "WebApi.h"
@@ -100,6 +101,7 @@ void WebApiConfigClass::onConfigListGet(AsyncWebServerRequest* request)
     File file = rootfs.openNextFile();
     while (file) {
         if (file.isDirectory()) {
+            file = rootfs.openNextFile();
             continue;
         }
         JsonObject obj = data.add<JsonObject>();
@@ -142,6 +144,9 @@ void WebApiConfigClass::onConfigUpload(AsyncWebServerRequest* request, String fi
         }
         const String name = "/" + request->getParam("file")->value();
         request->_tempFile = LittleFS.open(name, "w");
+
+        // the uploaded file takes precedence over the binary snapshot
+        ConfigSnapshot.invalidate();
     }
 
     if (len) {
@@ -4,13 +4,14 @@
  */
 #include "WebApi_dtu.h"
 #include "Configuration.h"
+#include "TaskMonitor.h"
 #include "WebApi.h"
 #include "WebApi_errors.h"
 #include <AsyncJson.h>
 #include <Hoymiles.h>
 
 WebApiDtuClass::WebApiDtuClass()
-    : _applyDataTask(TASK_IMMEDIATE, TASK_ONCE, std::bind(&WebApiDtuClass::applyDataTaskCb, this))
+    : _applyDataTask(TASK_IMMEDIATE, TASK_ONCE, TaskMonitor.wrap("DTU apply settings", std::bind(&WebApiDtuClass::applyDataTaskCb, this)))
 {
 }
 
@@ -32,6 +33,9 @@ void WebApiDtuClass::applyDataTaskCb()
     Hoymiles.getRadioCmt()->setPALevel(config.Dtu.Cmt.PaLevel);
     Hoymiles.getRadioNrf()->setDtuSerial(config.Dtu.Serial);
     Hoymiles.getRadioCmt()->setDtuSerial(config.Dtu.Serial);
+#ifdef HOYMILES_RADIO_SIM
+    Hoymiles.getRadioSim()->setDtuSerial(config.Dtu.Serial);
+#endif
     Hoymiles.getRadioCmt()->setCountryMode(static_cast<CountryModeId_t>(config.Dtu.Cmt.CountryMode));
     Hoymiles.getRadioCmt()->setInverterTargetFrequency(config.Dtu.Cmt.Frequency);
     Hoymiles.setPollInterval(config.Dtu.PollInterval);
@@ -3,6 +3,7 @@
  * Copyright (C) 2022-2024 Thomas Basler and others
  */
 #include "WebApi_eventlog.h"
+#include "InverterEventLog.h"
 #include "WebApi.h"
 #include <AsyncJson.h>
 #include <Hoymiles.h>
@@ -39,21 +40,33 @@ void WebApiEventlogClass::onEventlogStatus(AsyncWebServerRequest* request)
     auto inv = Hoymiles.getInverterBySerial(serial);
 
     if (inv != nullptr) {
-        uint8_t logEntryCount = inv->EventLog()->getEntryCount();
+        // paged, newest events first
+        size_t offset = 0;
+        size_t limit = INVERTER_EVENTLOG_MAX_ENTRIES;
+        if (request->hasParam("offset")) {
+            offset = request->getParam("offset")->value().toInt();
+        }
+        if (request->hasParam("limit")) {
+            limit = request->getParam("limit")->value().toInt();
+        }
+
+        auto entries = InverterEventLog.getEntries(serial, offset, limit);
 
-        root["count"] = logEntryCount;
+        root["count"] = entries.size();
+        root["total"] = InverterEventLog.getEntryCount(serial);
+        root["offset"] = offset;
         JsonArray eventsArray = root["events"].to<JsonArray>();
 
-        for (uint8_t logEntry = 0; logEntry < logEntryCount; logEntry++) {
-            JsonObject eventsObject = eventsArray.add<JsonObject>();
+        // times are reported as local time, like the inverter reports them
+        const int timezoneOffset = AlarmLogParser::getTimezoneOffset();
 
-            AlarmLogEntry_t entry;
-            inv->EventLog()->getLogEntry(logEntry, entry, locale);
+        for (auto const& entry : entries) {
+            JsonObject eventsObject = eventsArray.add<JsonObject>();
 
             eventsObject["message_id"] = entry.MessageId;
-            eventsObject["message"] = entry.Message;
-            eventsObject["start_time"] = entry.StartTime;
-            eventsObject["end_time"] = entry.EndTime;
+            eventsObject["message"] = inv->EventLog()->getMessageText(entry.MessageId, locale);
+            eventsObject["start_time"] = entry.StartTime + timezoneOffset;
+            eventsObject["end_time"] = (entry.EndTime > 0) ? entry.EndTime + timezoneOffset : 0;
         }
     }
 
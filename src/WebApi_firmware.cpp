@@ -4,14 +4,32 @@
  */
 #include "WebApi_firmware.h"
 #include "Configuration.h"
+#include "FirmwareHealthCheck.h"
+#include "MessageOutput.h"
 #include "RestartHelper.h"
+#include "TaskMonitor.h"
 #include "Update.h"
 #include "Utils.h"
 #include "WebApi.h"
+#include "defaults.h"
 #include "helper.h"
 #include <AsyncJson.h>
+#include <algorithm>
+#include "esp_ota_ops.h"
 #include "esp_partition.h"
 
+// the request body contains the multipart headers and the MD5 field in
+// addition to the firmware image
+#define FIRMWARE_UPLOAD_OVERHEAD 4096
+
+#define FIRMWARE_PROGRESS_INTERVAL_MS 250
+
+WebApiFirmwareClass::WebApiFirmwareClass()
+    : _ws("/firmwareprogress")
+    , _wsCleanupTask(1 * TASK_SECOND, TASK_FOREVER, TaskMonitor.wrap("WS firmware cleanup", std::bind(&WebApiFirmwareClass::wsCleanupTaskCb, this)))
+{
+}
+
 void WebApiFirmwareClass::init(AsyncWebServer& server, Scheduler& scheduler)
 {
     using std::placeholders::_1;
@@ -26,6 +44,20 @@ void WebApiFirmwareClass::init(AsyncWebServer& server, Scheduler& scheduler)
         std::bind(&WebApiFirmwareClass::onFirmwareUpdateUpload, this, _1, _2, _3, _4, _5, _6));
 
     server.on("/api/firmware/status", HTTP_GET, std::bind(&WebApiFirmwareClass::onFirmwareStatus, this, _1));
+
+    server.addHandler(&_ws);
+
+    scheduler.addTask(_wsCleanupTask);
+    _wsCleanupTask.enable();
+}
+
+void WebApiFirmwareClass::wsCleanupTaskCb()
+{
+    // see: https://github.com/me-no-dev/ESPAsyncWebServer#limiting-the-number-of-web-socket-clients
+    _ws.cleanupClients();
+
+    // the upload itself always requires the credentials
+    _ws.setAuthentication(AUTH_USERNAME, Configuration.get().Security.Password);
 }
 
 bool WebApiFirmwareClass::otaSupported() const
@@ -44,11 +76,23 @@ void WebApiFirmwareClass::onFirmwareUpdateFinish(AsyncWebServerRequest* request)
     // the request handler is triggered after the upload has finished...
     // create the response, add header, and send response
 
-    AsyncWebServerResponse* response = request->beginResponse((Update.hasError()) ? 500 : 200, "text/plain", (Update.hasError()) ? "FAIL" : "OK");
+    bool success = !_failed && !Update.hasError();
+
+    String message = "OK";
+    if (!success) {
+        message = _error.isEmpty() ? "FAIL" : _error;
+    }
+
+    AsyncWebServerResponse* response = request->beginResponse(success ? 200 : 500, "text/plain", message);
     response->addHeader("Connection", "close");
     response->addHeader("Access-Control-Allow-Origin", "*");
     request->send(response);
-    RestartHelper.triggerRestart();
+
+    // a rejected image was never written, the current firmware keeps running
+    if (success) {
+        FirmwareHealthCheck.saveBaseline();
+        RestartHelper.triggerRestart();
+    }
 }
 
 void WebApiFirmwareClass::onFirmwareUpdateUpload(AsyncWebServerRequest* request, String filename, size_t index, uint8_t* data, size_t len, bool final)
@@ -62,36 +106,231 @@ void WebApiFirmwareClass::onFirmwareUpdateUpload(AsyncWebServerRequest* request,
     }
 
     // Upload handler chunks in data
-    if (!index) {
-        if (!request->hasParam("MD5", true)) {
-            return request->send(400, "text/plain", "MD5 parameter missing");
+    if (!index && !beginUpdate(request)) {
+        return;
+    }
+
+    // ignore the remainder of a rejected upload
+    if (_failed) {
+        return;
+    }
+
+    if (len && !writeData(data, len)) {
+        return fail(request, _error.c_str());
+    }
+
+    if (final) { // if the final flag is set then this is the last frame of data
+        if (!endUpdate()) {
+            return fail(request, _error.c_str());
+        }
+
+        sendProgress("done");
+        MessageOutput.printf("[Firmware] Update written: %u bytes in %u ms, SHA-256 %s\r\n",
+            _received, millis() - _startMillis, _sha256Result.c_str());
+        return;
+    }
+
+    if (millis() - _lastProgressMillis > FIRMWARE_PROGRESS_INTERVAL_MS) {
+        sendProgress("writing");
+    }
+}
+
+bool WebApiFirmwareClass::beginUpdate(AsyncWebServerRequest* request)
+{
+    _failed = false;
+    _error.clear();
+    _imageHeaderLen = 0;
+    _totalSize = request->contentLength();
+    _received = 0;
+    _startMillis = millis();
+    _lastProgressMillis = 0;
+    _sha256Result.clear();
+
+    if (!request->hasParam("MD5", true)) {
+        fail(request, "MD5 parameter missing");
+        return false;
+    }
+
+    if (!Update.setMD5(request->getParam("MD5", true)->value().c_str())) {
+        fail(request, "MD5 parameter invalid");
+        return false;
+    }
+
+    // optional, e.g. for scripted uploads. the web UI can only calculate
+    // SHA-256 hashes on pages served via HTTPS.
+    _expectedSha256.clear();
+    if (request->hasParam("SHA256", true)) {
+        _expectedSha256 = request->getParam("SHA256", true)->value();
+        _expectedSha256.toLowerCase();
+    }
+
+    const esp_partition_t* partition = esp_ota_get_next_update_partition(nullptr);
+    if (partition == nullptr) {
+        fail(request, "No OTA partition available");
+        return false;
+    }
+
+    if (_totalSize > partition->size + FIRMWARE_UPLOAD_OVERHEAD) {
+        _error = "Firmware too large for partition " + String(partition->label);
+        fail(request, _error.c_str());
+        return false;
+    }
+
+    if (!Update.begin(UPDATE_SIZE_UNKNOWN, U_FLASH)) { // Start with max available size
+        Update.printError(Serial);
+        fail(request, "OTA could not begin");
+        return false;
+    }
+
+    mbedtls_sha256_init(&_sha256);
+    mbedtls_sha256_starts(&_sha256, 0); // select SHA256
+
+    MessageOutput.printf("[Firmware] Receiving update (%u bytes) for partition %s\r\n",
+        _totalSize, partition->label);
+
+    sendProgress("writing");
+
+    return true;
+}
+
+bool WebApiFirmwareClass::validateImageHeader()
+{
+    auto const* header = reinterpret_cast<const esp_image_header_t*>(_imageHeader.data());
+    if (header->magic != ESP_IMAGE_HEADER_MAGIC) {
+        _error = "Not an ESP32 firmware image";
+        return false;
+    }
+
+    if (header->chip_id != CONFIG_IDF_FIRMWARE_CHIP_ID) {
+        _error = "Firmware was built for a different chip (ID " + String(static_cast<int>(header->chip_id))
+            + " instead of " + String(CONFIG_IDF_FIRMWARE_CHIP_ID) + ")";
+        return false;
+    }
+
+    auto const* desc = reinterpret_cast<const esp_app_desc_t*>(_imageHeader.data()
+        + sizeof(esp_image_header_t) + sizeof(esp_image_segment_header_t));
+    if (desc->magic_word != ESP_APP_DESC_MAGIC_WORD) {
+        _error = "Firmware image does not contain an application description";
+        return false;
+    }
+
+    MessageOutput.printf("[Firmware] Image header valid: %.*s %.*s\r\n",
+        static_cast<int>(sizeof(desc->project_name)), desc->project_name,
+        static_cast<int>(sizeof(desc->version)), desc->version);
+
+    return true;
+}
+
+bool WebApiFirmwareClass::writeData(const uint8_t* data, size_t len)
+{
+    // the hash is updated chunk by chunk (using the SHA accelerator), such
+    // that it is available as soon as the last chunk was written
+    mbedtls_sha256_update(&_sha256, data, len);
+    _received += len;
+
+    if (_imageHeaderLen < _imageHeader.size()) {
+        size_t n = std::min(len, _imageHeader.size() - _imageHeaderLen);
+        memcpy(_imageHeader.data() + _imageHeaderLen, data, n);
+        _imageHeaderLen += n;
+        data += n;
+        len -= n;
+
+        if (_imageHeaderLen < _imageHeader.size()) {
+            return true;
         }
 
-        if (!Update.setMD5(request->getParam("MD5", true)->value().c_str())) {
-            return request->send(400, "text/plain", "MD5 parameter invalid");
+        if (!validateImageHeader()) {
+            return false;
         }
 
-        if (!Update.begin(UPDATE_SIZE_UNKNOWN, U_FLASH)) { // Start with max available size
-            Update.printError(Serial);
-            return request->send(400, "text/plain", "OTA could not begin");
+        if (Update.write(_imageHeader.data(), _imageHeader.size()) != _imageHeader.size()) {
+            _error = "Could not write firmware to flash";
+            return false;
         }
     }
 
-    // Write chunked data to the free sketch space
-    if (len) {
-        if (Update.write(data, len) != len) {
-            return request->send(400, "text/plain", "OTA could not begin");
-        }
+    if (len && Update.write(const_cast<uint8_t*>(data), len) != len) {
+        _error = "Could not write firmware to flash";
+        return false;
     }
 
-    if (final) { // if the final flag is set then this is the last frame of data
-        if (!Update.end(true)) { // true to set the size to the current progress
-            Update.printError(Serial);
-            return request->send(400, "text/plain", "Could not end OTA");
-        }
-    } else {
+    return true;
+}
+
+bool WebApiFirmwareClass::endUpdate()
+{
+    uint8_t hash[32];
+    mbedtls_sha256_finish(&_sha256, hash);
+    mbedtls_sha256_free(&_sha256);
+
+    char hex[sizeof(hash) * 2 + 1];
+    for (size_t i = 0; i < sizeof(hash); ++i) {
+        snprintf(&hex[i * 2], 3, "%02x", hash[i]);
+    }
+    _sha256Result = hex;
+
+    if (_imageHeaderLen < _imageHeader.size()) {
+        _error = "File too small to be a firmware image";
+        return false;
+    }
+
+    if (!_expectedSha256.isEmpty() && _expectedSha256 != _sha256Result) {
+        _error = "SHA-256 mismatch, received " + _sha256Result;
+        return false;
+    }
+
+    if (!Update.end(true)) { // true to set the size to the current progress
+        Update.printError(Serial);
+        _error = "Could not end OTA";
+        return false;
+    }
+
+    return true;
+}
+
+void WebApiFirmwareClass::fail(AsyncWebServerRequest* request, const char* reason)
+{
+    String message = reason;
+
+    _failed = true;
+    _error = message;
+    if (Update.isRunning()) {
+        Update.abort();
+    }
+    mbedtls_sha256_free(&_sha256);
+
+    MessageOutput.printf("[Firmware] Update failed: %s\r\n", message.c_str());
+    sendProgress("error");
+
+    request->send(400, "text/plain", message);
+}
+
+void WebApiFirmwareClass::sendProgress(const char* state)
+{
+    _lastProgressMillis = millis();
+
+    if (_ws.count() == 0) {
         return;
     }
+
+    uint32_t elapsed = millis() - _startMillis;
+
+    JsonDocument root;
+    root["state"] = state;
+    root["received"] = _received;
+    root["total"] = _totalSize;
+    root["progress"] = (_totalSize > 0) ? std::min<size_t>(100, _received * 100 / _totalSize) : 0;
+    root["throughput"] = (elapsed > 0) ? static_cast<uint32_t>(static_cast<uint64_t>(_received) * 1000 / elapsed) : 0;
+    if (!_sha256Result.isEmpty()) {
+        root["sha256"] = _sha256Result;
+    }
+    if (!_error.isEmpty()) {
+        root["error"] = _error;
+    }
+
+    String buffer;
+    serializeJson(root, buffer);
+    _ws.textAll(buffer);
 }
 
 void WebApiFirmwareClass::onFirmwareStatus(AsyncWebServerRequest* request)
@@ -104,6 +343,7 @@ void WebApiFirmwareClass::onFirmwareStatus(AsyncWebServerRequest* request)
     auto& root = response->getRoot();
 
     root["ota_supported"] = otaSupported();
+    root["pending_verify"] = FirmwareHealthCheck.isPendingVerify();
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
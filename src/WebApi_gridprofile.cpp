@@ -3,6 +3,7 @@
  * Copyright (C) 2022-2024 Thomas Basler and others
  */
 #include "WebApi_gridprofile.h"
+#include "GridProfileCache.h"
 #include "WebApi.h"
 #include <AsyncJson.h>
 #include <Hoymiles.h>
@@ -13,6 +14,8 @@ void WebApiGridProfileClass::init(AsyncWebServer& server, Scheduler& scheduler)
 
     server.on("/api/gridprofile/status", HTTP_GET, std::bind(&WebApiGridProfileClass::onGridProfileStatus, this, _1));
     server.on("/api/gridprofile/rawdata", HTTP_GET, std::bind(&WebApiGridProfileClass::onGridProfileRawdata, this, _1));
+    server.on("/api/gridprofile/export", HTTP_GET, std::bind(&WebApiGridProfileClass::onGridProfileExport, this, _1));
+    server.on("/api/gridprofile/refresh", HTTP_POST, std::bind(&WebApiGridProfileClass::onGridProfileRefresh, this, _1));
 }
 
 void WebApiGridProfileClass::onGridProfileStatus(AsyncWebServerRequest* request)
@@ -33,7 +36,7 @@ void WebApiGridProfileClass::onGridProfileStatus(AsyncWebServerRequest* request)
         auto jsonSections = root["sections"].to<JsonArray>();
         auto profSections = inv->GridProfile()->getProfile();
 
-        for (auto &profSection : profSections) {
+        for (auto &profSection : *profSections) {
             auto jsonSection = jsonSections.add<JsonObject>();
             jsonSection["name"] = profSection.SectionName;
 
@@ -72,3 +75,101 @@ void WebApiGridProfileClass::onGridProfileRawdata(AsyncWebServerRequest* request
 
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
+
+void WebApiGridProfileClass::onGridProfileExport(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    auto serial = WebApi.parseSerialFromRequest(request);
+    auto inv = Hoymiles.getInverterBySerial(serial);
+
+    String format = "json";
+    if (request->hasParam("format")) {
+        format = request->getParam("format")->value();
+    }
+
+    if (format == "bin") {
+        auto data = GridProfileCache.exportBinary(serial);
+        if (data.empty()) {
+            request->send(404);
+            return;
+        }
+
+        auto stream = request->beginResponseStream("application/octet-stream", data.size());
+        stream->addHeader("Content-Disposition", "attachment; filename=\"gridprofile_" + inv->serialString() + ".bin\"");
+        stream->write(data.data(), data.size());
+        request->send(stream);
+        return;
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& root = response->getRoot();
+
+    if (inv != nullptr && inv->GridProfile()->containsValidData()) {
+        auto parser = inv->GridProfile();
+
+        // contains the section and item ids and the raw profile, such that
+        // profiles of different inverters can be compared
+        root["format_version"] = GRID_PROFILE_CACHE_VERSION;
+        root["serial"] = inv->serialString();
+        root["profile_id"] = parser->getProfileId();
+        root["name"] = parser->getProfileName();
+        root["version"] = parser->getProfileVersion();
+        root["checksum"] = parser->getChecksum();
+
+        auto raw = parser->getRawData();
+        String rawHex;
+        rawHex.reserve(raw.size() * 2);
+        for (auto b : raw) {
+            char buf[3];
+            snprintf(buf, sizeof(buf), "%02X", b);
+            rawHex += buf;
+        }
+        root["raw"] = rawHex;
+
+        auto jsonSections = root["sections"].to<JsonArray>();
+        for (auto& profSection : *parser->getProfile()) {
+            auto jsonSection = jsonSections.add<JsonObject>();
+            jsonSection["id"] = profSection.SectionId;
+            jsonSection["version"] = profSection.SectionVersion;
+            jsonSection["name"] = profSection.SectionName;
+
+            auto jsonItems = jsonSection["items"].to<JsonArray>();
+            for (auto& profItem : profSection.items) {
+                auto jsonItem = jsonItems.add<JsonObject>();
+                jsonItem["n"] = profItem.Name;
+                jsonItem["u"] = profItem.Unit;
+                jsonItem["v"] = profItem.Value;
+            }
+        }
+    }
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
+
+void WebApiGridProfileClass::onGridProfileRefresh(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentials(request)) {
+        return;
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& retMsg = response->getRoot();
+    auto serial = WebApi.parseSerialFromRequest(request);
+
+    if (Hoymiles.getInverterBySerial(serial) == nullptr) {
+        retMsg["type"] = "warning";
+        retMsg["message"] = "Invalid inverter specified!";
+        WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+        return;
+    }
+
+    GridProfileCache.refresh(serial);
+
+    retMsg["type"] = "success";
+    retMsg["message"] = "Grid profile will be requested again!";
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
@@ -5,8 +5,11 @@
  */
 #include "WebApi_prometheus.h"
 #include "Configuration.h"
+#include "HeapProfiler.h"
 #include "MessageOutput.h"
 #include "NetworkSettings.h"
+#include "PowerMeter.h"
+#include "TaskMonitor.h"
 #include "WebApi.h"
 #include <Hoymiles.h>
 #include "__compiled_constants.h"
@@ -64,6 +67,114 @@ void WebApiPrometheusClass::onPrometheusMetricsGet(AsyncWebServerRequest* reques
         stream->print("# TYPE wifi_station gauge\n");
         stream->printf("wifi_station{bssid=\"%s\"} 1\n", WiFi.BSSIDstr().c_str());
 
+        stream->print("# HELP opendtu_radio_rx_latency_seconds Time from radio RX interrupt to fragment read\n");
+        stream->print("# TYPE opendtu_radio_rx_latency_seconds histogram\n");
+        addRadioLatency(stream, "nrf", Hoymiles.getRadioNrf());
+        addRadioLatency(stream, "cmt", Hoymiles.getRadioCmt());
+
+        auto powerMeterTopicStats = PowerMeter.getTopicStats();
+        if (!powerMeterTopicStats.empty()) {
+            stream->print("# HELP opendtu_powermeter_mqtt_messages_total Power meter MQTT messages received per topic\n");
+            stream->print("# TYPE opendtu_powermeter_mqtt_messages_total counter\n");
+            for (auto const& stats : powerMeterTopicStats) {
+                stream->printf("opendtu_powermeter_mqtt_messages_total{topic=\"%s\"} %u\n",
+                    stats.topic.c_str(), stats.messages);
+            }
+
+            stream->print("# HELP opendtu_powermeter_mqtt_errors_total Power meter MQTT messages which could not be parsed\n");
+            stream->print("# TYPE opendtu_powermeter_mqtt_errors_total counter\n");
+            for (auto const& stats : powerMeterTopicStats) {
+                stream->printf("opendtu_powermeter_mqtt_errors_total{topic=\"%s\"} %u\n",
+                    stats.topic.c_str(), stats.errors);
+            }
+
+            stream->print("# HELP opendtu_powermeter_mqtt_parse_seconds Time spent parsing power meter MQTT messages\n");
+            stream->print("# TYPE opendtu_powermeter_mqtt_parse_seconds summary\n");
+            for (auto const& stats : powerMeterTopicStats) {
+                stream->printf("opendtu_powermeter_mqtt_parse_seconds_sum{topic=\"%s\"} %f\n",
+                    stats.topic.c_str(), stats.sumMicros / 1000000.0);
+                stream->printf("opendtu_powermeter_mqtt_parse_seconds_count{topic=\"%s\"} %u\n",
+                    stats.topic.c_str(), stats.messages);
+            }
+
+            stream->print("# HELP opendtu_powermeter_mqtt_parse_max_seconds Longest time spent parsing a power meter MQTT message\n");
+            stream->print("# TYPE opendtu_powermeter_mqtt_parse_max_seconds gauge\n");
+            for (auto const& stats : powerMeterTopicStats) {
+                stream->printf("opendtu_powermeter_mqtt_parse_max_seconds{topic=\"%s\"} %f\n",
+                    stats.topic.c_str(), stats.maxMicros / 1000000.0);
+            }
+        }
+
+        auto loopStats = TaskMonitor.getLoopStats();
+        stream->print("# HELP opendtu_scheduler_pass_seconds Duration of a pass through all scheduler tasks\n");
+        stream->print("# TYPE opendtu_scheduler_pass_seconds summary\n");
+        stream->printf("opendtu_scheduler_pass_seconds_sum %f\n", loopStats.DurationUs / 1000000.0);
+        stream->printf("opendtu_scheduler_pass_seconds_count %u\n", loopStats.Passes);
+
+        stream->print("# HELP opendtu_scheduler_pass_max_seconds Longest pass through all scheduler tasks\n");
+        stream->print("# TYPE opendtu_scheduler_pass_max_seconds gauge\n");
+        stream->printf("opendtu_scheduler_pass_max_seconds %f\n", loopStats.MaxDurationUs / 1000000.0);
+
+        auto taskStats = TaskMonitor.getTaskStats();
+        stream->print("# HELP opendtu_task_runtime_seconds Time spent in a scheduler task\n");
+        stream->print("# TYPE opendtu_task_runtime_seconds summary\n");
+        for (auto const& stats : taskStats) {
+            stream->printf("opendtu_task_runtime_seconds_sum{task=\"%s\"} %f\n", stats.Name, stats.RuntimeUs / 1000000.0);
+            stream->printf("opendtu_task_runtime_seconds_count{task=\"%s\"} %u\n", stats.Name, stats.Calls);
+        }
+
+        stream->print("# HELP opendtu_task_runtime_max_seconds Longest execution of a scheduler task\n");
+        stream->print("# TYPE opendtu_task_runtime_max_seconds gauge\n");
+        for (auto const& stats : taskStats) {
+            stream->printf("opendtu_task_runtime_max_seconds{task=\"%s\"} %f\n", stats.Name, stats.MaxRuntimeUs / 1000000.0);
+        }
+
+        stream->print("# HELP opendtu_task_start_delay_seconds Time a scheduler task was started later than scheduled\n");
+        stream->print("# TYPE opendtu_task_start_delay_seconds summary\n");
+        for (auto const& stats : taskStats) {
+            stream->printf("opendtu_task_start_delay_seconds_sum{task=\"%s\"} %f\n", stats.Name, stats.StartDelayMs / 1000.0);
+            stream->printf("opendtu_task_start_delay_seconds_count{task=\"%s\"} %u\n", stats.Name, stats.Calls);
+        }
+
+        stream->print("# HELP opendtu_task_start_delay_max_seconds Longest start delay of a scheduler task\n");
+        stream->print("# TYPE opendtu_task_start_delay_max_seconds gauge\n");
+        for (auto const& stats : taskStats) {
+            stream->printf("opendtu_task_start_delay_max_seconds{task=\"%s\"} %f\n", stats.Name, stats.MaxStartDelayMs / 1000.0);
+        }
+
+        stream->print("# HELP opendtu_task_overruns_total Executions of a scheduler task which started after its next iteration was due\n");
+        stream->print("# TYPE opendtu_task_overruns_total counter\n");
+        for (auto const& stats : taskStats) {
+            stream->printf("opendtu_task_overruns_total{task=\"%s\"} %u\n", stats.Name, stats.Overruns);
+        }
+
+        if (HeapProfiler.isEnabled()) {
+            auto heapStats = HeapProfiler.getStats();
+            stream->print("# HELP opendtu_heap_tag_live_bytes Heap memory currently allocated by a subsystem\n");
+            stream->print("# TYPE opendtu_heap_tag_live_bytes gauge\n");
+            for (auto const& stats : heapStats) {
+                stream->printf("opendtu_heap_tag_live_bytes{tag=\"%s\"} %u\n", stats.Name, stats.LiveBytes);
+            }
+
+            stream->print("# HELP opendtu_heap_tag_peak_bytes Highest heap memory allocated by a subsystem at a time\n");
+            stream->print("# TYPE opendtu_heap_tag_peak_bytes gauge\n");
+            for (auto const& stats : heapStats) {
+                stream->printf("opendtu_heap_tag_peak_bytes{tag=\"%s\"} %u\n", stats.Name, stats.PeakBytes);
+            }
+
+            stream->print("# HELP opendtu_heap_tag_allocations_total Heap allocations made by a subsystem\n");
+            stream->print("# TYPE opendtu_heap_tag_allocations_total counter\n");
+            for (auto const& stats : heapStats) {
+                stream->printf("opendtu_heap_tag_allocations_total{tag=\"%s\"} %u\n", stats.Name, stats.Allocations);
+            }
+
+            stream->print("# HELP opendtu_heap_tag_allocated_bytes_total Heap memory allocated by a subsystem\n");
+            stream->print("# TYPE opendtu_heap_tag_allocated_bytes_total counter\n");
+            for (auto const& stats : heapStats) {
+                stream->printf("opendtu_heap_tag_allocated_bytes_total{tag=\"%s\"} %llu\n", stats.Name, stats.AllocatedBytes);
+            }
+        }
+
         for (uint8_t i = 0; i < Hoymiles.getNumInverters(); i++) {
             auto inv = Hoymiles.getInverterByPos(i);
 
@@ -179,3 +290,24 @@ void WebApiPrometheusClass::addPanelInfo(AsyncResponseStream* stream, const Stri
         channel,
         config->channel[channel].YieldTotalOffset);
 }
+
+void WebApiPrometheusClass::addRadioLatency(AsyncResponseStream* stream, const char* radioName, const HoymilesRadio* radio)
+{
+    if (!radio->isInitialized()) {
+        return;
+    }
+
+    const auto histogram = radio->getRxLatencyHistogram();
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < HOY_RX_LATENCY_BUCKET_COUNT - 1; i++) {
+        cumulative += histogram[i];
+        stream->printf("opendtu_radio_rx_latency_seconds_bucket{radio=\"%s\",le=\"%f\"} %u\n",
+            radioName, (HOY_RX_LATENCY_BUCKET_BASE_US << i) / 1000000.0, cumulative);
+    }
+    stream->printf("opendtu_radio_rx_latency_seconds_bucket{radio=\"%s\",le=\"+Inf\"} %u\n",
+        radioName, radio->getRxLatencyCount());
+    stream->printf("opendtu_radio_rx_latency_seconds_sum{radio=\"%s\"} %f\n",
+        radioName, radio->getRxLatencySumUs() / 1000000.0);
+    stream->printf("opendtu_radio_rx_latency_seconds_count{radio=\"%s\"} %u\n",
+        radioName, radio->getRxLatencyCount());
+}
@@ -3,9 +3,12 @@
  * Copyright (C) 2022-2024 Thomas Basler and others
  */
 #include "WebApi_sysstatus.h"
+#include "BootStages.h"
 #include "Configuration.h"
+#include "HeapProfiler.h"
 #include "NetworkSettings.h"
 #include "PinMapping.h"
+#include "TaskMonitor.h"
 #include "WebApi.h"
 #include "__compiled_constants.h"
 #include <AsyncJson.h>
@@ -19,6 +22,7 @@ void WebApiSysstatusClass::init(AsyncWebServer& server, Scheduler& scheduler)
     using std::placeholders::_1;
 
     server.on("/api/system/status", HTTP_GET, std::bind(&WebApiSysstatusClass::onSystemStatus, this, _1));
+    server.on("/api/system/heap", HTTP_GET, std::bind(&WebApiSysstatusClass::onHeapStatus, this, _1));
 }
 
 void WebApiSysstatusClass::onSystemStatus(AsyncWebServerRequest* request)
@@ -77,5 +81,70 @@ void WebApiSysstatusClass::onSystemStatus(AsyncWebServerRequest* request)
     root["cmt_configured"] = PinMapping.isValidCmt2300Config();
     root["cmt_connected"] = Hoymiles.getRadioCmt()->isConnected();
 
+    auto loopStats = TaskMonitor.getLoopStats();
+    auto jsonScheduler = root["scheduler"].to<JsonObject>();
+    jsonScheduler["passes"] = loopStats.Passes;
+    jsonScheduler["pass_avg"] = loopStats.Passes > 0 ? static_cast<uint32_t>(loopStats.DurationUs / loopStats.Passes) : 0;
+    jsonScheduler["pass_max"] = loopStats.MaxDurationUs;
+
+    // runtimes in microseconds, delays in milliseconds
+    auto tasks = jsonScheduler["tasks"].to<JsonArray>();
+    for (auto const& stats : TaskMonitor.getTaskStats()) {
+        auto task = tasks.add<JsonObject>();
+        task["name"] = stats.Name;
+        task["calls"] = stats.Calls;
+        task["runtime"] = stats.RuntimeUs;
+        task["runtime_max"] = stats.MaxRuntimeUs;
+        task["delay_max"] = stats.MaxStartDelayMs;
+        task["overruns"] = stats.Overruns;
+    }
+
+    // times since reset in microseconds
+    auto boot = root["boot"].to<JsonObject>();
+    boot["setup_done"] = BootStages.getSetupDoneUs();
+    boot["first_limit"] = BootStages.getFirstLimitCommandUs();
+    auto stages = boot["stages"].to<JsonArray>();
+    for (auto const& timing : BootStages.getTimings()) {
+        auto stage = stages.add<JsonObject>();
+        stage["name"] = timing.Name;
+        stage["start"] = timing.StartUs;
+        stage["duration"] = timing.DurationUs;
+        stage["concurrent"] = timing.Concurrent;
+    }
+
+    WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
+}
+
+void WebApiSysstatusClass::onHeapStatus(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    AsyncJsonResponse* response = new AsyncJsonResponse();
+    auto& root = response->getRoot();
+
+    root["heap_total"] = ESP.getHeapSize();
+    root["heap_free"] = ESP.getFreeHeap();
+    root["heap_max_block"] = ESP.getMaxAllocHeap();
+    root["heap_min_free"] = ESP.getMinFreeHeap();
+
+    // per tag statistics are only available if built with HEAP_PROFILER
+    root["profiler_enabled"] = HeapProfiler.isEnabled();
+    root["dropped"] = HeapProfiler.getDroppedCount();
+
+    auto tags = root["tags"].to<JsonArray>();
+    for (auto const& stats : HeapProfiler.getStats()) {
+        auto tag = tags.add<JsonObject>();
+        tag["name"] = stats.Name;
+        tag["live_bytes"] = stats.LiveBytes;
+        tag["live_count"] = stats.LiveCount;
+        tag["peak_bytes"] = stats.PeakBytes;
+        tag["allocations"] = stats.Allocations;
+        tag["allocated_bytes"] = stats.AllocatedBytes;
+        tag["allocation_rate"] = stats.AllocationRate;
+        tag["byte_rate"] = stats.ByteRate;
+    }
+
     WebApi.sendJsonResponse(request, response, __FUNCTION__, __LINE__);
 }
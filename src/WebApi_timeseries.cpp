@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+#include "WebApi_timeseries.h"
+#include "TimeSeries.h"
+#include "WebApi.h"
+#include <algorithm>
+
+void WebApiTimeSeriesClass::init(AsyncWebServer& server, Scheduler& scheduler)
+{
+    using std::placeholders::_1;
+
+    server.on("/api/timeseries/data", HTTP_GET, std::bind(&WebApiTimeSeriesClass::onTimeSeriesData, this, _1));
+}
+
+void WebApiTimeSeriesClass::onTimeSeriesData(AsyncWebServerRequest* request)
+{
+    if (!WebApi.checkCredentialsReadonly(request)) {
+        return;
+    }
+
+    if (!request->hasParam("series")) {
+        request->send(400, "text/plain", "Parameter 'series' is missing");
+        return;
+    }
+
+    auto oSeries = TimeSeries.getSeriesByName(request->getParam("series")->value());
+    if (!oSeries.has_value()) {
+        request->send(404, "text/plain", "Unknown series");
+        return;
+    }
+
+    auto resolution = TimeSeriesClass::Resolution::Minute;
+    if (request->hasParam("resolution") && request->getParam("resolution")->value() == "raw") {
+        resolution = TimeSeriesClass::Resolution::Raw;
+    }
+
+    uint32_t from = 0;
+    if (request->hasParam("from")) {
+        from = strtoul(request->getParam("from")->value().c_str(), nullptr, 10);
+    }
+
+    uint32_t to = UINT32_MAX;
+    if (request->hasParam("to")) {
+        to = strtoul(request->getParam("to")->value().c_str(), nullptr, 10);
+    }
+
+    size_t limit = TIMESERIES_MAX_POINTS;
+    if (request->hasParam("limit")) {
+        limit = std::min<size_t>(limit, strtoul(request->getParam("limit")->value().c_str(), nullptr, 10));
+    }
+
+    // the points are copied out of the store, the JSON text is rendered
+    // piecewise while sending, such that it is never held in RAM as a whole.
+    auto state = std::make_shared<ChunkedState>();
+    bool more = TimeSeries.query(*oSeries, resolution, from, to, limit, state->points);
+
+    state->head = "{\"series\":\"";
+    state->head += TimeSeries.getSeriesName(*oSeries);
+    state->head += "\",\"resolution\":\"";
+    state->head += (resolution == TimeSeriesClass::Resolution::Raw) ? "raw" : "minute";
+    state->head += "\",\"more\":";
+    state->head += more ? "true" : "false";
+    if (more && !state->points.empty()) {
+        // continue with from=<next> to get the following page
+        state->head += ",\"next\":";
+        state->head += String(state->points.back().timestamp + 1);
+    }
+    state->head += ",\"points\":[";
+
+    auto response = request->beginChunkedResponse("application/json", [state](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+        return state->fill(buffer, maxLen);
+    });
+
+    request->send(response);
+}
+
+bool WebApiTimeSeriesClass::ChunkedState::nextPiece()
+{
+    const size_t count = points.size();
+
+    if (next == 0) {
+        piece = head.c_str();
+        pieceLen = head.length();
+    } else if (next <= count) {
+        auto const& point = points[next - 1];
+        pieceLen = snprintf(buffer, sizeof(buffer), "%s[%u,%g]", (next > 1) ? "," : "", point.timestamp, point.value);
+        piece = buffer;
+    } else if (next == count + 1) {
+        piece = "]}";
+        pieceLen = 2;
+    } else {
+        return false;
+    }
+
+    ++next;
+    pieceOffset = 0;
+    return true;
+}
+
+size_t WebApiTimeSeriesClass::ChunkedState::fill(uint8_t* out, size_t maxLen)
+{
+    size_t written = 0;
+
+    while (written < maxLen) {
+        if (pieceOffset == pieceLen && !nextPiece()) {
+            break;
+        }
+
+        size_t len = std::min(pieceLen - pieceOffset, maxLen - written);
+        memcpy(out + written, piece + pieceOffset, len);
+        pieceOffset += len;
+        written += len;
+    }
+
+    return written;
+}
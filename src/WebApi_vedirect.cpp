@@ -9,6 +9,7 @@
 #include "Configuration.h"
 #include "WebApi.h"
 #include "WebApi_errors.h"
+#include "defaults.h"
 #include "helper.h"
 #include "MqttHandlePowerLimiterHass.h"
 
@@ -36,6 +37,7 @@ void WebApiVedirectClass::onVedirectStatus(AsyncWebServerRequest* request)
     root["vedirect_enabled"] = config.Vedirect.Enabled;
     root["verbose_logging"] = config.Vedirect.VerboseLogging;
     root["vedirect_updatesonly"] = config.Vedirect.UpdatesOnly;
+    root["fast_poll_interval"] = config.Vedirect.FastPollInterval;
 
     response->setLength();
     request->send(response);
@@ -54,6 +56,7 @@ void WebApiVedirectClass::onVedirectAdminGet(AsyncWebServerRequest* request)
     root["vedirect_enabled"] = config.Vedirect.Enabled;
     root["verbose_logging"] = config.Vedirect.VerboseLogging;
     root["vedirect_updatesonly"] = config.Vedirect.UpdatesOnly;
+    root["fast_poll_interval"] = config.Vedirect.FastPollInterval;
 
     response->setLength();
     request->send(response);
@@ -87,6 +90,7 @@ void WebApiVedirectClass::onVedirectAdminPost(AsyncWebServerRequest* request)
     config.Vedirect.Enabled = root["vedirect_enabled"].as<bool>();
     config.Vedirect.VerboseLogging = root["verbose_logging"].as<bool>();
     config.Vedirect.UpdatesOnly = root["vedirect_updatesonly"].as<bool>();
+    config.Vedirect.FastPollInterval = root["fast_poll_interval"] | VEDIRECT_FAST_POLL_INTERVAL;
 
     WebApi.writeConfig(retMsg);
 
@@ -10,6 +10,7 @@ extern const uint8_t file_favicon_ico_start[] asm("_binary_webapp_dist_favicon_i
 extern const uint8_t file_favicon_png_start[] asm("_binary_webapp_dist_favicon_png_start");
 extern const uint8_t file_zones_json_start[] asm("_binary_webapp_dist_zones_json_gz_start");
 extern const uint8_t file_app_js_start[] asm("_binary_webapp_dist_js_app_js_gz_start");
+extern const uint8_t file_app_js_hash_start[] asm("_binary_webapp_dist_js_app_js_hash_start");
 extern const uint8_t file_site_webmanifest_start[] asm("_binary_webapp_dist_site_webmanifest_start");
 
 extern const uint8_t file_index_html_end[] asm("_binary_webapp_dist_index_html_gz_end");
@@ -17,19 +18,34 @@ extern const uint8_t file_favicon_ico_end[] asm("_binary_webapp_dist_favicon_ico
 extern const uint8_t file_favicon_png_end[] asm("_binary_webapp_dist_favicon_png_end");
 extern const uint8_t file_zones_json_end[] asm("_binary_webapp_dist_zones_json_gz_end");
 extern const uint8_t file_app_js_end[] asm("_binary_webapp_dist_js_app_js_gz_end");
+extern const uint8_t file_app_js_hash_end[] asm("_binary_webapp_dist_js_app_js_hash_end");
 extern const uint8_t file_site_webmanifest_end[] asm("_binary_webapp_dist_site_webmanifest_end");
 
-void WebApiWebappClass::responseBinaryDataWithETagCache(AsyncWebServerRequest *request, const String &contentType, const String &contentEncoding, const uint8_t *content, size_t len)
+const String& WebApiWebappClass::getETag(const uint8_t* content, size_t len)
 {
+    // the embedded data never changes, hence the hash is calculated only
+    // once per asset instead of on every request
+    auto it = _etags.find(content);
+    if (it != _etags.end()) {
+        return it->second;
+    }
+
     auto md5 = MD5Builder();
     md5.begin();
-    md5.add(const_cast<uint8_t *>(content), len);
+    md5.add(const_cast<uint8_t*>(content), len);
     md5.calculate();
 
-    String expectedEtag;
-    expectedEtag = "\"";
-    expectedEtag += md5.toString();
-    expectedEtag += "\"";
+    String etag;
+    etag = "\"";
+    etag += md5.toString();
+    etag += "\"";
+
+    return _etags.emplace(content, etag).first->second;
+}
+
+void WebApiWebappClass::responseBinaryDataWithETagCache(AsyncWebServerRequest *request, const String &contentType, const String &contentEncoding, const uint8_t *content, size_t len)
+{
+    const String& expectedEtag = getETag(content, len);
 
     bool eTagMatch = false;
     if (request->hasHeader("If-None-Match")) {
@@ -55,6 +71,18 @@ void WebApiWebappClass::responseBinaryDataWithETagCache(AsyncWebServerRequest *r
     request->send(response);
 }
 
+void WebApiWebappClass::responseImmutableData(AsyncWebServerRequest* request, const String& contentType, const String& contentEncoding, const uint8_t* content, size_t len)
+{
+    // the URL contains a hash of the content, so the browser never needs to revalidate
+    AsyncWebServerResponse* response = request->beginResponse(200, contentType, content, len);
+    if (contentEncoding.length() > 0) {
+        response->addHeader("Content-Encoding", contentEncoding);
+    }
+    response->addHeader("Cache-Control", "public, max-age=31536000, immutable");
+
+    request->send(response);
+}
+
 void WebApiWebappClass::init(AsyncWebServer& server, Scheduler& scheduler)
 {
     /*
@@ -90,6 +118,18 @@ void WebApiWebappClass::init(AsyncWebServer& server, Scheduler& scheduler)
         responseBinaryDataWithETagCache(request, "application/json", "", file_site_webmanifest_start, file_site_webmanifest_end - file_site_webmanifest_start);
     });
 
+    // index.html references the bundle by its content hashed name
+    String appJsHashed = "/js/app.";
+    for (const uint8_t* c = file_app_js_hash_start; c < file_app_js_hash_end; ++c) {
+        appJsHashed += static_cast<char>(*c);
+    }
+    appJsHashed += ".js";
+
+    server.on(appJsHashed.c_str(), HTTP_GET, [&](AsyncWebServerRequest* request) {
+        responseImmutableData(request, "text/javascript", "gzip", file_app_js_start, file_app_js_end - file_app_js_start);
+    });
+
+    // still used by pages loaded before the bundle was served by its hashed name
     server.on("/js/app.js", HTTP_GET, [&](AsyncWebServerRequest* request) {
         responseBinaryDataWithETagCache(request, "text/javascript", "gzip", file_app_js_start, file_app_js_end - file_app_js_start);
     });
@@ -7,6 +7,7 @@
 #include "Configuration.h"
 #include "Huawei_can.h"
 #include "MessageOutput.h"
+#include "TaskMonitor.h"
 #include "Utils.h"
 #include "WebApi.h"
 #include "defaults.h"
@@ -32,13 +33,13 @@ void WebApiWsHuaweiLiveClass::init(AsyncWebServer& server, Scheduler& scheduler)
     _ws.onEvent(std::bind(&WebApiWsHuaweiLiveClass::onWebsocketEvent, this, _1, _2, _3, _4, _5, _6));
 
     scheduler.addTask(_wsCleanupTask);
-    _wsCleanupTask.setCallback(std::bind(&WebApiWsHuaweiLiveClass::wsCleanupTaskCb, this));
+    _wsCleanupTask.setCallback(TaskMonitor.wrap("WS Huawei cleanup", std::bind(&WebApiWsHuaweiLiveClass::wsCleanupTaskCb, this)));
     _wsCleanupTask.setIterations(TASK_FOREVER);
     _wsCleanupTask.setInterval(1 * TASK_SECOND);
     _wsCleanupTask.enable();
 
     scheduler.addTask(_sendDataTask);
-    _sendDataTask.setCallback(std::bind(&WebApiWsHuaweiLiveClass::sendDataTaskCb, this));
+    _sendDataTask.setCallback(TaskMonitor.wrap("WS Huawei", std::bind(&WebApiWsHuaweiLiveClass::sendDataTaskCb, this)));
     _sendDataTask.setIterations(TASK_FOREVER);
     _sendDataTask.setInterval(1 * TASK_SECOND);
     _sendDataTask.enable();
@@ -7,6 +7,7 @@
 #include "Configuration.h"
 #include "Battery.h"
 #include "MessageOutput.h"
+#include "TaskMonitor.h"
 #include "WebApi.h"
 #include "defaults.h"
 #include "Utils.h"
@@ -32,13 +33,13 @@ void WebApiWsBatteryLiveClass::init(AsyncWebServer& server, Scheduler& scheduler
     _ws.onEvent(std::bind(&WebApiWsBatteryLiveClass::onWebsocketEvent, this, _1, _2, _3, _4, _5, _6));
 
     scheduler.addTask(_wsCleanupTask);
-    _wsCleanupTask.setCallback(std::bind(&WebApiWsBatteryLiveClass::wsCleanupTaskCb, this));
+    _wsCleanupTask.setCallback(TaskMonitor.wrap("WS battery cleanup", std::bind(&WebApiWsBatteryLiveClass::wsCleanupTaskCb, this)));
     _wsCleanupTask.setIterations(TASK_FOREVER);
     _wsCleanupTask.setInterval(1 * TASK_SECOND);
     _wsCleanupTask.enable();
 
     scheduler.addTask(_sendDataTask);
-    _sendDataTask.setCallback(std::bind(&WebApiWsBatteryLiveClass::sendDataTaskCb, this));
+    _sendDataTask.setCallback(TaskMonitor.wrap("WS battery", std::bind(&WebApiWsBatteryLiveClass::sendDataTaskCb, this)));
     _sendDataTask.setIterations(TASK_FOREVER);
     _sendDataTask.setInterval(1 * TASK_SECOND);
     _sendDataTask.enable();
@@ -4,19 +4,29 @@
  */
 #include "WebApi_ws_console.h"
 #include "Configuration.h"
+#include "ConsoleCommands.h"
 #include "MessageOutput.h"
+#include "TaskMonitor.h"
 #include "WebApi.h"
 #include "defaults.h"
 
 WebApiWsConsoleClass::WebApiWsConsoleClass()
     : _ws("/console")
-    , _wsCleanupTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&WebApiWsConsoleClass::wsCleanupTaskCb, this))
+    , _wsCleanupTask(1 * TASK_SECOND, TASK_FOREVER, TaskMonitor.wrap("WS console cleanup", std::bind(&WebApiWsConsoleClass::wsCleanupTaskCb, this)))
 {
 }
 
 void WebApiWsConsoleClass::init(AsyncWebServer& server, Scheduler& scheduler)
 {
+    using std::placeholders::_1;
+    using std::placeholders::_2;
+    using std::placeholders::_3;
+    using std::placeholders::_4;
+    using std::placeholders::_5;
+    using std::placeholders::_6;
+
     server.addHandler(&_ws);
+    _ws.onEvent(std::bind(&WebApiWsConsoleClass::onWebsocketEvent, this, _1, _2, _3, _4, _5, _6));
     MessageOutput.register_ws_output(&_ws);
 
     scheduler.addTask(_wsCleanupTask);
@@ -34,3 +44,51 @@ void WebApiWsConsoleClass::wsCleanupTaskCb()
         _ws.setAuthentication(AUTH_USERNAME, Configuration.get().Security.Password);
     }
 }
+
+void WebApiWsConsoleClass::onWebsocketEvent(AsyncWebSocket* server, AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len)
+{
+    if (type == WS_EVT_CONNECT) {
+        // the upgrade request is unauthenticated if read-only access is
+        // allowed, hence commands are only accepted from clients which
+        // presented the admin credentials nevertheless.
+        auto request = static_cast<AsyncWebServerRequest*>(arg);
+        if (request->authenticate(AUTH_USERNAME, Configuration.get().Security.Password)) {
+            _adminClients.insert(client->id());
+        }
+        return;
+    }
+
+    if (type == WS_EVT_DISCONNECT) {
+        _adminClients.erase(client->id());
+        return;
+    }
+
+    if (type != WS_EVT_DATA) {
+        return;
+    }
+
+    // commands are short and sent as a single text frame
+    auto info = static_cast<AwsFrameInfo*>(arg);
+    if (!info->final || info->index != 0 || info->len != len || info->opcode != WS_TEXT
+        || len > CONSOLE_COMMAND_MAX_LENGTH) {
+        return;
+    }
+
+    String line;
+    line.reserve(len);
+    for (size_t i = 0; i < len; i++) {
+        line += static_cast<char>(data[i]);
+    }
+
+    // the web console sends a heartbeat
+    if (line == "ping") {
+        return;
+    }
+
+    if (_adminClients.count(client->id()) == 0) {
+        client->text("Console commands require the admin credentials\r\n");
+        return;
+    }
+
+    ConsoleCommands.enqueue(line);
+}
@@ -4,7 +4,10 @@
  */
 #include "WebApi_ws_live.h"
 #include "Datastore.h"
+#include "HeapProfiler.h"
+#include "InverterEventLog.h"
 #include "MessageOutput.h"
+#include "TaskMonitor.h"
 #include "Utils.h"
 #include "WebApi.h"
 #include "Battery.h"
@@ -16,8 +19,8 @@
 
 WebApiWsLiveClass::WebApiWsLiveClass()
     : _ws("/livedata")
-    , _wsCleanupTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&WebApiWsLiveClass::wsCleanupTaskCb, this))
-    , _sendDataTask(1 * TASK_SECOND, TASK_FOREVER, std::bind(&WebApiWsLiveClass::sendDataTaskCb, this))
+    , _wsCleanupTask(1 * TASK_SECOND, TASK_FOREVER, TaskMonitor.wrap("WS live cleanup", std::bind(&WebApiWsLiveClass::wsCleanupTaskCb, this)))
+    , _sendDataTask(1 * TASK_SECOND, TASK_FOREVER, TaskMonitor.wrap("WS live", std::bind(&WebApiWsLiveClass::sendDataTaskCb, this)))
 {
 }
 
@@ -150,6 +153,8 @@ void WebApiWsLiveClass::sendDataTaskCb()
         return;
     }
 
+    HeapTagScope heapTag(HeapTag::Json);
+
     sendOnBatteryStats();
 
     // Loop all inverters
@@ -235,6 +240,29 @@ void WebApiWsLiveClass::generateInverterCommonJsonResponse(JsonObject& root, std
     root["radio_stats"]["rx_fail_nothing"] = inv->RadioStats.RxFailNoAnswer;
     root["radio_stats"]["rx_fail_partial"] = inv->RadioStats.RxFailPartialAnswer;
     root["radio_stats"]["rx_fail_corrupt"] = inv->RadioStats.RxFailCorruptData;
+    root["radio_stats"]["tx_superseded"] = inv->RadioStats.TxSuperseded;
+
+    auto linkObj = root["radio_stats"]["link_quality"].to<JsonObject>();
+    linkObj["rssi_last"] = inv->LinkQuality.LastRssi;
+    auto rssiArray = linkObj["rssi_histogram"].to<JsonArray>();
+    for (uint8_t i = 0; i < HOY_LINK_RSSI_BUCKET_COUNT; i++) {
+        auto bucketObj = rssiArray.add<JsonObject>();
+        if (i < HOY_LINK_RSSI_BUCKET_COUNT - 1) {
+            bucketObj["below_dbm"] = HOY_LINK_RSSI_BUCKET_BASE_DBM + i * HOY_LINK_RSSI_BUCKET_WIDTH_DBM;
+        }
+        bucketObj["count"] = inv->LinkQuality.RssiHistogram[i];
+    }
+    auto channelArray = linkObj["channels"].to<JsonArray>();
+    for (uint8_t i = 0; i < inv->LinkQuality.ChannelCount; i++) {
+        const auto& lq = inv->LinkQuality.Channels[i];
+        auto chanObj = channelArray.add<JsonObject>();
+        chanObj["channel"] = lq.Channel;
+        chanObj["tx"] = lq.TxCount;
+        chanObj["tx_answered"] = lq.TxAnswered;
+        chanObj["rx"] = lq.RxFragments;
+        chanObj["rssi_avg"] = lq.RxFragments > 0 ? lq.RssiSum / static_cast<int32_t>(lq.RxFragments) : 0;
+        chanObj["success_rate"] = lq.SuccessRate;
+    }
 }
 
 void WebApiWsLiveClass::generateInverterChannelJsonResponse(JsonObject& root, std::shared_ptr<InverterAbstract> inv)
@@ -276,7 +304,7 @@ void WebApiWsLiveClass::generateInverterChannelJsonResponse(JsonObject& root, st
     }
 
     if (inv->Statistics()->hasChannelFieldValue(TYPE_INV, CH0, FLD_EVT_LOG)) {
-        root["events"] = inv->EventLog()->getEntryCount();
+        root["events"] = InverterEventLog.getTodaysEntryCount(inv->serial());
     } else {
         root["events"] = -1;
     }
@@ -6,6 +6,7 @@
 #include "AsyncJson.h"
 #include "Configuration.h"
 #include "MessageOutput.h"
+#include "TaskMonitor.h"
 #include "Utils.h"
 #include "WebApi.h"
 #include "defaults.h"
@@ -34,13 +35,13 @@ void WebApiWsVedirectLiveClass::init(AsyncWebServer& server, Scheduler& schedule
 
 
     scheduler.addTask(_wsCleanupTask);
-    _wsCleanupTask.setCallback(std::bind(&WebApiWsVedirectLiveClass::wsCleanupTaskCb, this));
+    _wsCleanupTask.setCallback(TaskMonitor.wrap("WS VE.Direct cleanup", std::bind(&WebApiWsVedirectLiveClass::wsCleanupTaskCb, this)));
     _wsCleanupTask.setIterations(TASK_FOREVER);
     _wsCleanupTask.setInterval(1 * TASK_SECOND);
     _wsCleanupTask.enable();
 
     scheduler.addTask(_sendDataTask);
-    _sendDataTask.setCallback(std::bind(&WebApiWsVedirectLiveClass::sendDataTaskCb, this));
+    _sendDataTask.setCallback(TaskMonitor.wrap("WS VE.Direct", std::bind(&WebApiWsVedirectLiveClass::sendDataTaskCb, this)));
     _sendDataTask.setIterations(TASK_FOREVER);
     _sendDataTask.setInterval(500 * TASK_MILLISECOND);
     _sendDataTask.enable();
@@ -126,6 +127,24 @@ void WebApiWsVedirectLiveClass::generateCommonJsonResponse(JsonVariant& root, bo
         JsonObject nested = array[serial].to<JsonObject>();
         nested["data_age_ms"] = VictronMppt.getDataAgeMillis(idx);
         populateJson(nested, *optMpptData);
+
+        auto optFastPollStats = VictronMppt.getFastPollStats(idx);
+        if (Configuration.get().Vedirect.FastPollInterval > 0 && optFastPollStats) {
+            JsonObject fastPoll = nested["fast_poll"].to<JsonObject>();
+            fastPoll["requests"] = optFastPollStats->requests;
+            fastPoll["responses"] = optFastPollStats->responses;
+            fastPoll["timeouts"] = optFastPollStats->timeouts;
+            fastPoll["latency_ms"] = optFastPollStats->lastLatencyMs;
+            fastPoll["avg_latency_ms"] = static_cast<uint32_t>(optFastPollStats->avgLatencyMs);
+
+            // age of the fast-polled values, -1 if not available
+            auto age = [](auto const& pair) -> int32_t {
+                return pair.first > 0 ? static_cast<int32_t>(millis() - pair.first) : -1;
+            };
+            fastPoll["panel_power_age_ms"] = age(optMpptData->PanelPowerMilliWatts);
+            fastPoll["charger_current_age_ms"] = age(optMpptData->ChargerCurrentMilliAmps);
+            fastPoll["device_state_age_ms"] = age(optMpptData->DeviceState);
+        }
     }
 
     _lastPublish = millis();
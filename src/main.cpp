@@ -5,13 +5,19 @@
 #include "Configuration.h"
 #include "Datastore.h"
 #include "Display_Graphic.h"
+#include "FirmwareHealthCheck.h"
+#include "GridProfileCache.h"
+#include "HeapProfiler.h"
+#include "InverterEventLog.h"
 #include "InverterSettings.h"
 #include "Led_Single.h"
+#include "ConsoleCommands.h"
 #include "MessageOutput.h"
 #include "SerialPortManager.h"
 #include "SPIPortManager.h"
 #include "VictronMppt.h"
 #include "Battery.h"
+#include "BootStages.h"
 #include "Huawei_can.h"
 #include "MqttHandleDtu.h"
 #include "MqttHandleHass.h"
@@ -30,6 +36,8 @@
 #include "RestartHelper.h"
 #include "Scheduler.h"
 #include "SunPosition.h"
+#include "TaskMonitor.h"
+#include "TimeSeries.h"
 #include "Utils.h"
 #include "WebApi.h"
 #include "PowerMeter.h"
@@ -55,153 +63,198 @@ void setup()
         yield();
 #endif
     MessageOutput.init(scheduler);
+    ConsoleCommands.init(scheduler);
+    HeapProfiler.init(scheduler);
     MessageOutput.println();
     MessageOutput.println("Starting OpenDTU");
 
-    // Initialize file system
-    MessageOutput.print("Initialize FS... ");
-    if (!LittleFS.begin(false)) { // Do not format if mount failed
-        MessageOutput.print("failed... trying to format...");
-        if (!LittleFS.begin(true)) {
-            MessageOutput.print("success");
+    // Subsystems are initialized in stages, see BootStages.h. Stages which
+    // block on hardware and share no state with the following stages run
+    // concurrently.
+    BootStages.add("fs", {}, [](Scheduler&) {
+        MessageOutput.print("Initialize FS... ");
+        if (!LittleFS.begin(false)) { // Do not format if mount failed
+            MessageOutput.print("failed... trying to format...");
+            if (!LittleFS.begin(true)) {
+                MessageOutput.print("success");
+            } else {
+                MessageOutput.print("failed");
+            }
         } else {
-            MessageOutput.print("failed");
+            MessageOutput.println("done");
         }
-    } else {
+    });
+
+    BootStages.add("config", { "fs" }, [](Scheduler&) {
+        MessageOutput.print("Reading configuration... ");
+        if (!Configuration.read()) {
+            MessageOutput.print("initializing... ");
+            Configuration.init();
+            if (Configuration.write()) {
+                MessageOutput.print("written... ");
+            } else {
+                MessageOutput.print("failed... ");
+            }
+        }
+        if (Configuration.get().Cfg.Version != CONFIG_VERSION) {
+            MessageOutput.print("migrated... ");
+            Configuration.migrate();
+        }
+        MessageOutput.println("done");
+    });
+
+    BootStages.add("pinmapping", { "config" }, [](Scheduler&) {
+        MessageOutput.print("Reading PinMapping... ");
+        if (PinMapping.init(String(Configuration.get().Dev_PinMapping))) {
+            MessageOutput.print("found valid mapping ");
+        } else {
+            MessageOutput.print("using default config ");
+        }
+        MessageOutput.println("done");
+
+        // Initialize PortManagers
+        SerialPortManager.init();
+        SPIPortManager.init();
+    });
+
+    BootStages.add("network", { "pinmapping" }, [](Scheduler& scheduler) {
+        MessageOutput.print("Initialize Network... ");
+        NetworkSettings.init(scheduler);
+        MessageOutput.println("done");
+        NetworkSettings.applyConfig();
+
+        MessageOutput.print("Initialize NTP... ");
+        NtpSettings.init();
+        MessageOutput.println("done");
+    });
+
+    BootStages.add("sunposition", { "config" }, [](Scheduler& scheduler) {
+        MessageOutput.print("Initialize SunPosition... ");
+        SunPosition.init(scheduler);
+        MessageOutput.println("done");
+    });
+
+    BootStages.add("mqtt", { "network" }, [](Scheduler& scheduler) {
+        MessageOutput.print("Initialize MqTT... ");
+        MqttSettings.init();
+        MqttHandleDtu.init(scheduler);
+        MqttHandleInverter.init(scheduler);
+        MqttHandleInverterTotal.init(scheduler);
+        MqttHandleVedirect.init(scheduler);
+        MqttHandleHass.init(scheduler);
+        MqttHandleVedirectHass.init(scheduler);
+        MqttHandleBatteryHass.init(scheduler);
+        MqttHandleHuawei.init(scheduler);
+        MqttHandlePowerLimiter.init(scheduler);
+        MqttHandlePowerLimiterHass.init(scheduler);
         MessageOutput.println("done");
-    }
-
-    // Read configuration values
-    MessageOutput.print("Reading configuration... ");
-    if (!Configuration.read()) {
-        MessageOutput.print("initializing... ");
-        Configuration.init();
-        if (Configuration.write()) {
-            MessageOutput.print("written... ");
+    });
+
+    BootStages.add("webapi", { "network" }, [](Scheduler& scheduler) {
+        MessageOutput.print("Initialize WebApi... ");
+        WebApi.init(scheduler);
+        MessageOutput.println("done");
+    });
+
+    // the display controller is slow to initialize, especially via I2C
+    BootStages.add("display", { "pinmapping" }, [](Scheduler& scheduler) {
+        auto const& config = Configuration.get();
+        auto const& pin = PinMapping.get();
+        Display.init(
+            scheduler,
+            static_cast<DisplayType_t>(pin.display_type),
+            pin.display_data,
+            pin.display_clk,
+            pin.display_cs,
+            pin.display_reset);
+        Display.setDiagramMode(static_cast<DiagramMode_t>(config.Display.Diagram.Mode));
+        Display.setOrientation(config.Display.Rotation);
+        Display.enablePowerSafe = config.Display.PowerSafe;
+        Display.enableScreensaver = config.Display.ScreenSaver;
+        Display.setContrast(config.Display.Contrast);
+        Display.setLanguage(config.Display.Language);
+        Display.setStartupDisplay();
+        MessageOutput.println("Initialize Display... done");
+    }, true);
+
+    BootStages.add("leds", { "pinmapping" }, [](Scheduler& scheduler) {
+        MessageOutput.print("Initialize LEDs... ");
+        LedSingle.init(scheduler);
+        MessageOutput.println("done");
+    });
+
+    BootStages.add("inverters", { "pinmapping" }, [](Scheduler& scheduler) {
+        auto& config = Configuration.get();
+
+        // Check for default DTU serial
+        MessageOutput.print("Check for default DTU serial... ");
+        if (config.Dtu.Serial == DTU_SERIAL) {
+            MessageOutput.print("generate serial based on ESP chip id: ");
+            const uint64_t dtuId = Utils::generateDtuSerial();
+            MessageOutput.printf("%0x%08x... ",
+                ((uint32_t)((dtuId >> 32) & 0xFFFFFFFF)),
+                ((uint32_t)(dtuId & 0xFFFFFFFF)));
+            config.Dtu.Serial = dtuId;
+            Configuration.write();
+        }
+        MessageOutput.println("done");
+
+        InverterSettings.init(scheduler);
+        InverterEventLog.init(scheduler);
+        GridProfileCache.init(scheduler);
+    });
+
+    BootStages.add("datastore", { "inverters" }, [](Scheduler& scheduler) {
+        Datastore.init(scheduler);
+        RestartHelper.init(scheduler);
+    });
+
+    // the SPI ports of the radios are allocated first, such that the
+    // assignment of the ports does not depend on the timing. the MQTT
+    // battery provider subscribes to its topics.
+    BootStages.add("chargers", { "inverters", "mqtt" }, [](Scheduler& scheduler) {
+        VictronMppt.init(scheduler);
+
+        // Initialize Huawei AC-charger PSU / CAN bus
+        MessageOutput.println("Initialize Huawei AC charger interface... ");
+        if (PinMapping.isValidHuaweiConfig()) {
+            auto const& pin = PinMapping.get();
+            MessageOutput.printf("Huawei AC-charger miso = %d, mosi = %d, clk = %d, irq = %d, cs = %d, power_pin = %d\r\n", pin.huawei_miso, pin.huawei_mosi, pin.huawei_clk, pin.huawei_irq, pin.huawei_cs, pin.huawei_power);
+            HuaweiCan.init(scheduler, pin.huawei_miso, pin.huawei_mosi, pin.huawei_clk, pin.huawei_irq, pin.huawei_cs, pin.huawei_power);
+            MessageOutput.println("done");
         } else {
-            MessageOutput.print("failed... ");
+            MessageOutput.println("Invalid pin config");
         }
-    }
-    if (Configuration.get().Cfg.Version != CONFIG_VERSION) {
-        MessageOutput.print("migrated... ");
-        Configuration.migrate();
-    }
-    auto& config = Configuration.get();
-    MessageOutput.println("done");
-
-    // Load PinMapping
-    MessageOutput.print("Reading PinMapping... ");
-    if (PinMapping.init(String(Configuration.get().Dev_PinMapping))) {
-        MessageOutput.print("found valid mapping ");
-    } else {
-        MessageOutput.print("using default config ");
-    }
-    const auto& pin = PinMapping.get();
-    MessageOutput.println("done");
-
-    // Initialize PortManagers
-    SerialPortManager.init();
-    SPIPortManager.init();
-
-    // Initialize WiFi
-    MessageOutput.print("Initialize Network... ");
-    NetworkSettings.init(scheduler);
-    MessageOutput.println("done");
-    NetworkSettings.applyConfig();
-
-    // Initialize NTP
-    MessageOutput.print("Initialize NTP... ");
-    NtpSettings.init();
-    MessageOutput.println("done");
-
-    // Initialize SunPosition
-    MessageOutput.print("Initialize SunPosition... ");
-    SunPosition.init(scheduler);
-    MessageOutput.println("done");
-
-    // Initialize MqTT
-    MessageOutput.print("Initialize MqTT... ");
-    MqttSettings.init();
-    MqttHandleDtu.init(scheduler);
-    MqttHandleInverter.init(scheduler);
-    MqttHandleInverterTotal.init(scheduler);
-    MqttHandleVedirect.init(scheduler);
-    MqttHandleHass.init(scheduler);
-    MqttHandleVedirectHass.init(scheduler);
-    MqttHandleBatteryHass.init(scheduler);
-    MqttHandleHuawei.init(scheduler);
-    MqttHandlePowerLimiter.init(scheduler);
-    MqttHandlePowerLimiterHass.init(scheduler);
-    MessageOutput.println("done");
-
-    // Initialize WebApi
-    MessageOutput.print("Initialize WebApi... ");
-    WebApi.init(scheduler);
-    MessageOutput.println("done");
-
-    // Initialize Display
-    MessageOutput.print("Initialize Display... ");
-    Display.init(
-        scheduler,
-        static_cast<DisplayType_t>(pin.display_type),
-        pin.display_data,
-        pin.display_clk,
-        pin.display_cs,
-        pin.display_reset);
-    Display.setDiagramMode(static_cast<DiagramMode_t>(config.Display.Diagram.Mode));
-    Display.setOrientation(config.Display.Rotation);
-    Display.enablePowerSafe = config.Display.PowerSafe;
-    Display.enableScreensaver = config.Display.ScreenSaver;
-    Display.setContrast(config.Display.Contrast);
-    Display.setLanguage(config.Display.Language);
-    Display.setStartupDisplay();
-    MessageOutput.println("done");
-
-    // Initialize Single LEDs
-    MessageOutput.print("Initialize LEDs... ");
-    LedSingle.init(scheduler);
-    MessageOutput.println("done");
-
-    // Check for default DTU serial
-    MessageOutput.print("Check for default DTU serial... ");
-    if (config.Dtu.Serial == DTU_SERIAL) {
-        MessageOutput.print("generate serial based on ESP chip id: ");
-        const uint64_t dtuId = Utils::generateDtuSerial();
-        MessageOutput.printf("%0x%08x... ",
-            ((uint32_t)((dtuId >> 32) & 0xFFFFFFFF)),
-            ((uint32_t)(dtuId & 0xFFFFFFFF)));
-        config.Dtu.Serial = dtuId;
-        Configuration.write();
-    }
-    MessageOutput.println("done");
-
-    InverterSettings.init(scheduler);
-
-    Datastore.init(scheduler);
-    RestartHelper.init(scheduler);
-
-    VictronMppt.init(scheduler);
+
+        Battery.init(scheduler);
+    }, true);
 
     // Power meter
-    PowerMeter.init(scheduler);
+    BootStages.add("powermeter", { "mqtt" }, [](Scheduler& scheduler) {
+        PowerMeter.init(scheduler);
+    });
 
     // Dynamic power limiter
-    PowerLimiter.init(scheduler);
+    BootStages.add("powerlimiter", { "powermeter", "inverters" }, [](Scheduler& scheduler) {
+        PowerLimiter.init(scheduler);
+    });
 
-    // Initialize Huawei AC-charger PSU / CAN bus
-    MessageOutput.println("Initialize Huawei AC charger interface... ");
-    if (PinMapping.isValidHuaweiConfig()) {
-        MessageOutput.printf("Huawei AC-charger miso = %d, mosi = %d, clk = %d, irq = %d, cs = %d, power_pin = %d\r\n", pin.huawei_miso, pin.huawei_mosi, pin.huawei_clk, pin.huawei_irq, pin.huawei_cs, pin.huawei_power);
-        HuaweiCan.init(scheduler, pin.huawei_miso, pin.huawei_mosi, pin.huawei_clk, pin.huawei_irq, pin.huawei_cs, pin.huawei_power);
-        MessageOutput.println("done");
-    } else {
-        MessageOutput.println("Invalid pin config");
-    }
+    // History of power, battery and DPL values
+    BootStages.add("timeseries", { "fs" }, [](Scheduler& scheduler) {
+        TimeSeries.init(scheduler);
+    });
+
+    // Confirm or roll back a firmware update
+    BootStages.add("healthcheck", { "powerlimiter" }, [](Scheduler& scheduler) {
+        FirmwareHealthCheck.init(scheduler);
+    });
 
-    Battery.init(scheduler);
+    BootStages.run(scheduler);
 }
 
 void loop()
 {
+    const uint32_t start = micros();
     scheduler.execute();
+    TaskMonitor.onLoop(micros() - start);
 }
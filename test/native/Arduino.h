@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+
+// minimal Arduino API for the native unit tests. only what the libraries
+// under test use is provided.
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <string>
+#include "freertos/semphr.h"
+
+using std::max;
+using std::min;
+
+#define ARDUINO_ISR_ATTR
+#define HEX 16
+#define SERIAL_8N1 0x800001c
+
+// the tests advance the time explicitly
+extern uint32_t nativeMillis;
+inline uint32_t millis() { return nativeMillis; }
+inline void yield() { }
+inline void delay(uint32_t) { }
+
+inline bool getLocalTime(struct tm* info, uint32_t = 5000)
+{
+    time_t t = 1700000000;
+    localtime_r(&t, info);
+    return true;
+}
+
+class String : public std::string {
+public:
+    String(const char* s = "")
+        : std::string(s)
+    {
+    }
+    String(const std::string& s)
+        : std::string(s)
+    {
+    }
+    explicit String(char c)
+        : std::string(1, c)
+    {
+    }
+    String(int value, int base = 10)
+        : std::string(std::to_string(value))
+    {
+    }
+    bool startsWith(const String& prefix) const { return rfind(prefix, 0) == 0; }
+};
+
+class Print {
+public:
+    virtual ~Print() { }
+    virtual size_t write(uint8_t c) = 0;
+
+    size_t printf(const char* format, ...)
+    {
+        char buf[512];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(buf, sizeof(buf), format, args);
+        va_end(args);
+        return print(buf);
+    }
+
+    size_t print(const char* s)
+    {
+        size_t n = 0;
+        while (*s) {
+            n += write(*s++);
+        }
+        return n;
+    }
+    size_t print(const String& s) { return print(s.c_str()); }
+    size_t print(uint64_t value, int base = 10)
+    {
+        char buf[24];
+        snprintf(buf, sizeof(buf), (base == HEX) ? "%llx" : "%llu", static_cast<unsigned long long>(value));
+        return print(buf);
+    }
+    size_t println(const char* s = "") { return print(s) + print("\n"); }
+    size_t println(const String& s) { return println(s.c_str()); }
+    size_t println(uint64_t value, int base = 10) { return print(value, base) + print("\n"); }
+};
+
+class Stream : public Print {
+};
+
+// the data received and sent by each UART. the tests feed the input of
+// the libraries under test through rx and check their output in tx.
+struct NativeUart {
+    std::string rx;
+    size_t rxPos = 0;
+    std::string tx;
+};
+extern NativeUart nativeUart[3];
+
+class HardwareSerial : public Stream {
+public:
+    // the console, its output is discarded
+    HardwareSerial() { }
+
+    explicit HardwareSerial(uint8_t port)
+        : _uart(&nativeUart[port])
+    {
+    }
+
+    void begin(unsigned long, uint32_t = SERIAL_8N1, int8_t = -1, int8_t = -1) { }
+    void end() { }
+    void flush() { }
+    size_t setRxBufferSize(size_t size) { return size; }
+
+    int available() { return _uart ? _uart->rx.size() - _uart->rxPos : 0; }
+    int read() { return available() ? static_cast<uint8_t>(_uart->rx[_uart->rxPos++]) : -1; }
+    int availableForWrite() { return 128; }
+
+    size_t write(uint8_t c) override
+    {
+        if (_uart) { _uart->tx += static_cast<char>(c); }
+        return 1;
+    }
+    size_t write(const char* buffer, size_t size)
+    {
+        if (_uart) { _uart->tx.append(buffer, size); }
+        return size;
+    }
+
+private:
+    NativeUart* _uart = nullptr;
+};
+
+extern HardwareSerial Serial;
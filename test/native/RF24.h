@@ -0,0 +1,12 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+#include "SPI.h"
+
+typedef enum {
+    RF24_PA_MIN
+} rf24_pa_dbm_e;
+
+class RF24 {
+public:
+    RF24(int, int) { }
+};
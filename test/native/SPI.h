@@ -0,0 +1,8 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+#include "Arduino.h"
+
+class SPIClass {
+public:
+    int pinSS() { return 0; }
+};
@@ -0,0 +1,6 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef int spi_host_device_t;
+typedef int gpio_num_t;
@@ -0,0 +1,5 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+#include "Arduino.h"
+
+inline int64_t esp_timer_get_time() { return static_cast<int64_t>(millis()) * 1000; }
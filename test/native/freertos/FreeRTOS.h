@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#pragma once
+#include <cstdint>
+
+// the native tests run single threaded, tasks are never started
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffff
+#define pdMS_TO_TICKS(x) (x)
+#define portYIELD_FROM_ISR()
+
+inline void xTaskNotifyGive(TaskHandle_t) { }
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t*) { }
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+inline BaseType_t xTaskCreatePinnedToCore(void (*)(void*), const char*, uint32_t, void*, int, TaskHandle_t*, BaseType_t) { return 0; }
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return nullptr; }
+inline int xSemaphoreTake(SemaphoreHandle_t, uint32_t) { return pdTRUE; }
+inline int xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
@@ -0,0 +1,27 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+
+// definitions shared by all native unit tests
+
+#include <Arduino.h>
+#include <HoymilesRadio_CMT.h>
+#include <HoymilesRadio_NRF.h>
+
+uint32_t nativeMillis = 0;
+NativeUart nativeUart[3];
+HardwareSerial Serial;
+
+// the tests use the simulated radio, the radio modules are never initialized
+void HoymilesRadio_NRF::init(SPIClass*, const uint8_t, const uint8_t) { }
+void HoymilesRadio_NRF::loop() { }
+void HoymilesRadio_NRF::setDtuSerial(const uint64_t serial) { HoymilesRadio::setDtuSerial(serial); }
+void HoymilesRadio_NRF::sendEsbPacket(CommandAbstract&) { }
+
+void HoymilesRadio_CMT::init(const spi_host_device_t, const int8_t, const int8_t, const int8_t, const int8_t, const int8_t, const int8_t) { }
+void HoymilesRadio_CMT::loop() { }
+void HoymilesRadio_CMT::sendEsbPacket(CommandAbstract&) { }
+CountryModeId_t HoymilesRadio_CMT::getCountryMode() const { return MODE_EU; }
+uint8_t HoymilesRadio_CMT::getChannelFromFrequency(const uint32_t) const { return 0; }
+uint32_t HoymilesRadio_CMT::getInverterTargetFrequency() const { return 0; }
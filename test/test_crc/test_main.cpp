@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+
+// compares the table driven and slice-by-4 CRC implementations against the
+// bitwise reference. all of them are compiled into this test, each in its
+// own namespace, independent of the HOY_CRC_IMPL the library is built with.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <unity.h>
+#include <crc.h>
+
+#undef HOY_CRC_IMPL
+#define HOY_CRC_IMPL HOY_CRC_BITWISE
+namespace bitwise {
+#include <crc.cpp>
+}
+
+#undef HOY_CRC_IMPL
+#undef HOY_CRC_TABLE_COUNT
+#define HOY_CRC_IMPL HOY_CRC_TABLE
+namespace table {
+#include <crc.cpp>
+}
+
+#undef HOY_CRC_IMPL
+#undef HOY_CRC_TABLE_COUNT
+#define HOY_CRC_IMPL HOY_CRC_SLICE_BY_4
+namespace slice4 {
+#include <crc.cpp>
+}
+
+struct Implementation {
+    const char* name;
+    uint8_t (*crc8)(const uint8_t[], const uint8_t);
+    uint16_t (*crc16)(const uint8_t[], const uint8_t, const uint16_t);
+    uint16_t (*crc16nrf24)(const uint8_t[], const uint16_t, const uint16_t, const uint16_t);
+};
+
+static const std::array<Implementation, 3> implementations = { {
+    { "table", table::crc8, table::crc16, table::crc16nrf24 },
+    { "slice-by-4", slice4::crc8, slice4::crc16, slice4::crc16nrf24 },
+    { "library", ::crc8, ::crc16, ::crc16nrf24 }, // as configured by HOY_CRC_IMPL
+} };
+
+void setUp() { }
+void tearDown() { }
+
+static void test_crc8_all_short_inputs()
+{
+    uint8_t buf[2];
+    for (uint32_t v = 0; v < 0x10000; v++) {
+        buf[0] = v & 0xff;
+        buf[1] = v >> 8;
+
+        for (auto const& impl : implementations) {
+            TEST_ASSERT_EQUAL_HEX8_MESSAGE(bitwise::crc8(buf, 1), impl.crc8(buf, 1), impl.name);
+            TEST_ASSERT_EQUAL_HEX8_MESSAGE(bitwise::crc8(buf, 2), impl.crc8(buf, 2), impl.name);
+        }
+    }
+}
+
+static void test_crc16_all_bytes_and_start_values()
+{
+    for (uint32_t start = 0; start < 0x10000; start++) {
+        for (uint16_t b = 0; b < 256; b++) {
+            const uint8_t buf[1] = { static_cast<uint8_t>(b) };
+            const uint16_t expected = bitwise::crc16(buf, 1, start);
+
+            for (auto const& impl : implementations) {
+                TEST_ASSERT_EQUAL_HEX16_MESSAGE(expected, impl.crc16(buf, 1, start), impl.name);
+            }
+        }
+    }
+}
+
+static void test_crc16_all_two_byte_inputs()
+{
+    uint8_t buf[2];
+    for (uint32_t v = 0; v < 0x10000; v++) {
+        buf[0] = v & 0xff;
+        buf[1] = v >> 8;
+
+        for (auto const& impl : implementations) {
+            TEST_ASSERT_EQUAL_HEX16_MESSAGE(bitwise::crc16(buf, 2, 0xffff), impl.crc16(buf, 2, 0xffff), impl.name);
+        }
+    }
+}
+
+static void test_random_buffers_of_every_length()
+{
+    std::mt19937 rng(1);
+    uint8_t buf[255];
+
+    for (uint16_t len = 0; len <= sizeof(buf); len++) {
+        for (uint8_t round = 0; round < 64; round++) {
+            for (auto& b : buf) {
+                b = rng();
+            }
+            const uint16_t start = rng();
+
+            for (auto const& impl : implementations) {
+                TEST_ASSERT_EQUAL_HEX8_MESSAGE(bitwise::crc8(buf, len), impl.crc8(buf, len), impl.name);
+                TEST_ASSERT_EQUAL_HEX16_MESSAGE(bitwise::crc16(buf, len, start), impl.crc16(buf, len, start), impl.name);
+            }
+        }
+    }
+}
+
+static void test_crc16nrf24_every_bit_range()
+{
+    std::mt19937 rng(2);
+    uint8_t buf[40];
+
+    for (uint8_t round = 0; round < 8; round++) {
+        for (auto& b : buf) {
+            b = rng();
+        }
+        const uint16_t crcIn = (round == 0) ? 0xffff : rng();
+
+        for (uint16_t lenBits = 0; lenBits <= sizeof(buf) * 8; lenBits++) {
+            for (uint16_t startBit = 0; startBit < lenBits; startBit++) {
+                const uint16_t expected = bitwise::crc16nrf24(buf, lenBits, startBit, crcIn);
+
+                for (auto const& impl : implementations) {
+                    TEST_ASSERT_EQUAL_HEX16_MESSAGE(expected, impl.crc16nrf24(buf, lenBits, startBit, crcIn), impl.name);
+                }
+            }
+        }
+    }
+}
+
+// not an assertion, the timings are reported for comparison only
+static void benchmark_command_crc()
+{
+    // a command is protected by crc16 over its payload and crc8 over the frame
+    uint8_t buf[27];
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = i * 37;
+    }
+
+    constexpr uint32_t iterations = 1000000;
+    const Implementation all[] = {
+        { "bitwise", bitwise::crc8, bitwise::crc16, bitwise::crc16nrf24 },
+        implementations[0],
+        implementations[1],
+    };
+
+    for (auto const& impl : all) {
+        volatile uint32_t sink = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            buf[0] = i;
+            sink = sink + impl.crc16(buf, sizeof(buf) - 3, 0xffff) + impl.crc8(buf, sizeof(buf) - 1);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        char message[80];
+        snprintf(message, sizeof(message), "%s: %.1f ns per command",
+            impl.name, std::chrono::duration<double, std::nano>(end - begin).count() / iterations);
+        TEST_MESSAGE(message);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_crc8_all_short_inputs);
+    RUN_TEST(test_crc16_all_bytes_and_start_values);
+    RUN_TEST(test_crc16_all_two_byte_inputs);
+    RUN_TEST(test_random_buffers_of_every_length);
+    RUN_TEST(test_crc16nrf24_every_bit_range);
+    RUN_TEST(benchmark_command_crc);
+    return UNITY_END();
+}
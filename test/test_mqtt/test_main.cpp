@@ -0,0 +1,323 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+
+// compares the topic tree of MqttSubscribeParser against a straight forward
+// linear matcher written after the MQTT specification.
+
+#include <MqttSubscribeParser.h>
+#include <chrono>
+#include <cstdio>
+#include <list>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unity.h>
+#include <vector>
+
+namespace {
+// returns the next level of the topic and removes it, including the separator
+std::string_view nextLevel(std::string_view& topic, bool& last)
+{
+    const size_t pos = topic.find('/');
+    const std::string_view level = topic.substr(0, pos);
+    last = (pos == std::string_view::npos);
+    topic = last ? std::string_view() : topic.substr(pos + 1);
+    return level;
+}
+
+bool isValidFilter(std::string_view filter)
+{
+    if (filter.empty()) {
+        return false;
+    }
+
+    bool last = false;
+    while (!last) {
+        const auto level = nextLevel(filter, last);
+        if (level.find_first_of("+#") != std::string_view::npos && level != "+" && level != "#") {
+            return false;
+        }
+        if (level == "#" && !last) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the filter must be valid
+bool topicMatches(std::string_view filter, std::string_view topic)
+{
+    if (topic.empty() || topic.find_first_of("+#") != std::string_view::npos) {
+        return false;
+    }
+
+    if (topic[0] == '$' && (filter[0] == '+' || filter[0] == '#')) {
+        return false;
+    }
+
+    bool filterLast = false;
+    bool topicLast = false;
+    bool topicDone = false;
+    while (!filterLast) {
+        const auto f = nextLevel(filter, filterLast);
+        if (f == "#") {
+            return true;
+        }
+        if (topicDone) {
+            return false;
+        }
+        const auto t = nextLevel(topic, topicLast);
+        topicDone = topicLast;
+        if (f != "+" && f != t) {
+            return false;
+        }
+    }
+    return topicDone;
+}
+
+// the reference: every subscription is matched against every message
+class LinearParser {
+public:
+    void register_callback(const std::string& topic, const espMqttClientTypes::OnMessageCallback& cb)
+    {
+        _subscriptions.push_back({ { topic, 0, cb }, isValidFilter(topic) });
+    }
+
+    void unregister_callback(const std::string& topic)
+    {
+        _subscriptions.remove_if([&topic](const Subscription& sub) { return sub.filter.topic == topic; });
+    }
+
+    void handle_message(const char* topic)
+    {
+        for (const auto& sub : _subscriptions) {
+            if (sub.valid && topicMatches(sub.filter.topic, topic)) {
+                sub.filter.cb({}, topic, nullptr, 0, 0, 0);
+            }
+        }
+    }
+
+private:
+    struct Subscription {
+        cb_filter_t filter;
+        bool valid;
+    };
+
+    std::list<Subscription> _subscriptions;
+};
+
+std::string randomTopic(std::mt19937& rng, bool filter)
+{
+    static const char* const words[] = { "a", "b", "solar", "", "$SYS", "$", "+", "#", "a+", "#b" };
+    // topics are built from the words without wildcards only
+    const size_t count = filter ? 10 : 6;
+
+    std::string topic;
+    const size_t levels = 1 + rng() % 4;
+    for (size_t i = 0; i < levels; i++) {
+        if (i > 0) {
+            topic += '/';
+        }
+        topic += words[rng() % count];
+    }
+    return topic;
+}
+}
+
+void setUp() { }
+void tearDown() { }
+
+static void expectMatches(const std::vector<std::string>& filters, const char* topic, const std::vector<std::string>& expected)
+{
+    MqttSubscribeParser parser;
+    std::vector<std::string> matched;
+
+    for (const auto& filter : filters) {
+        parser.register_callback(filter, 0, [&matched, filter](auto&, auto, auto, auto, auto, auto) {
+            matched.push_back(filter);
+        });
+    }
+
+    parser.handle_message({}, topic, nullptr, 0, 0, 0);
+
+    std::string expectedList, matchedList;
+    for (const auto& s : expected) {
+        expectedList += "[" + s + "]";
+    }
+    for (const auto& s : matched) {
+        matchedList += "[" + s + "]";
+    }
+    TEST_ASSERT_EQUAL_STRING_MESSAGE(expectedList.c_str(), matchedList.c_str(), topic);
+}
+
+static void test_wildcards()
+{
+    const std::vector<std::string> filters = { "a/b", "a/+", "+/b", "a/#", "#", "+/+", "a/b/#", "+" };
+
+    expectMatches(filters, "a/b", { "a/b", "a/+", "+/b", "a/#", "#", "+/+", "a/b/#" });
+    expectMatches(filters, "a", { "a/#", "#", "+" });
+    expectMatches(filters, "a/c/d", { "a/#", "#" });
+    expectMatches(filters, "b", { "#", "+" });
+    // empty levels are levels too
+    expectMatches(filters, "a/", { "a/+", "a/#", "#", "+/+" });
+    expectMatches(filters, "/b", { "+/b", "#", "+/+" });
+    expectMatches(filters, "/", { "#", "+/+" });
+}
+
+static void test_dollar_topics()
+{
+    const std::vector<std::string> filters = { "#", "+/info", "$SYS/#", "$SYS/+", "$SYS/info", "+/+", "$SYS" };
+
+    // wildcards on the first level do not match topics starting with '$'
+    expectMatches(filters, "$SYS/info", { "$SYS/#", "$SYS/+", "$SYS/info" });
+    expectMatches(filters, "$SYS", { "$SYS/#", "$SYS" });
+    expectMatches(filters, "a/info", { "#", "+/info", "+/+" });
+    // ... but they do on the following levels
+    expectMatches({ "a/+", "a/#" }, "a/$SYS", { "a/+", "a/#" });
+}
+
+static void test_invalid_filters_and_topics()
+{
+    // invalid subscriptions never match
+    expectMatches({ "a/#/b", "a+", "a/b#", "", "#", "a/+" }, "a/b", { "#", "a/+" });
+    // topics must not be empty or contain wildcards
+    expectMatches({ "#", "+" }, "", {});
+    expectMatches({ "#", "+" }, "+", {});
+    expectMatches({ "#", "a/#" }, "a/#", {});
+}
+
+static void test_order_and_unregister()
+{
+    MqttSubscribeParser parser;
+    std::vector<int> matched;
+
+    const char* const filters[] = { "a/#", "a/b", "#", "a/b", "+/b" };
+    for (int i = 0; i < 5; i++) {
+        parser.register_callback(filters[i], 0, [&matched, i](auto&, auto, auto, auto, auto, auto) {
+            matched.push_back(i);
+        });
+    }
+
+    // callbacks are called in order of registration
+    parser.handle_message({}, "a/b", nullptr, 0, 0, 0);
+    TEST_ASSERT_TRUE(matched == std::vector<int>({ 0, 1, 2, 3, 4 }));
+
+    // unregistering removes all subscriptions of the topic
+    matched.clear();
+    parser.unregister_callback("a/b");
+    parser.handle_message({}, "a/b", nullptr, 0, 0, 0);
+    TEST_ASSERT_TRUE(matched == std::vector<int>({ 0, 2, 4 }));
+
+    size_t count = 0;
+    parser.for_each_subscription([&count](const std::string&, uint8_t) { count++; });
+    TEST_ASSERT_EQUAL(3, count);
+
+    // the tree is pruned and can be rebuilt
+    matched.clear();
+    parser.unregister_callback("a/#");
+    parser.unregister_callback("#");
+    parser.unregister_callback("+/b");
+    parser.handle_message({}, "a/b", nullptr, 0, 0, 0);
+    TEST_ASSERT_TRUE(matched.empty());
+
+    parser.register_callback("a/b", 0, [&matched](auto&, auto, auto, auto, auto, auto) { matched.push_back(5); });
+    parser.handle_message({}, "a/b", nullptr, 0, 0, 0);
+    TEST_ASSERT_TRUE(matched == std::vector<int>({ 5 }));
+}
+
+static void test_differential_random()
+{
+    std::mt19937 rng(1);
+    uint32_t matched = 0;
+
+    for (uint32_t round = 0; round < 500; round++) {
+        MqttSubscribeParser parser;
+        LinearParser reference;
+        std::vector<std::string> filters;
+        std::vector<size_t> got, expected;
+
+        for (size_t i = 0; i < 20; i++) {
+            const auto filter = randomTopic(rng, true);
+            filters.push_back(filter);
+            parser.register_callback(filter, 0, [i, &got](auto&, auto, auto, auto, auto, auto) { got.push_back(i); });
+            reference.register_callback(filter, [i, &expected](auto&, auto, auto, auto, auto, auto) { expected.push_back(i); });
+        }
+
+        for (size_t i = 0; i < 4; i++) {
+            const auto& filter = filters[rng() % filters.size()];
+            parser.unregister_callback(filter);
+            reference.unregister_callback(filter);
+        }
+
+        for (size_t i = 0; i < 200; i++) {
+            const auto topic = randomTopic(rng, false);
+            got.clear();
+            expected.clear();
+            parser.handle_message({}, topic.c_str(), nullptr, 0, 0, 0);
+            reference.handle_message(topic.c_str());
+
+            TEST_ASSERT_TRUE_MESSAGE(got == expected, topic.c_str());
+            matched += expected.size();
+        }
+    }
+
+    // make sure the random topics actually exercise the matching
+    TEST_ASSERT_GREATER_THAN(10000, matched);
+}
+
+// not an assertion, the timings are reported for comparison only
+static void benchmark_500_subscriptions()
+{
+    MqttSubscribeParser parser;
+    LinearParser reference;
+    volatile uint32_t hits = 0;
+    auto cb = [&hits](auto&, auto, auto, auto, auto, auto) { hits = hits + 1; };
+
+    // 100 inverters with 5 command topics each, as subscribed by MqttHandleInverter
+    const char* const commands[] = { "limit_persistent_relative", "limit_nonpersistent_absolute", "power", "restart", "mode" };
+    for (uint32_t i = 0; i < 500; i++) {
+        char topic[96];
+        snprintf(topic, sizeof(topic), "solar/%012u/cmd/%s", 100000 + i / 5, commands[i % 5]);
+        parser.register_callback(topic, 0, cb);
+        reference.register_callback(topic, cb);
+    }
+    parser.register_callback("meter/+/power", 0, cb);
+    reference.register_callback("meter/+/power", cb);
+    parser.register_callback("battery/#", 0, cb);
+    reference.register_callback("battery/#", cb);
+
+    const char* const topics[] = { "solar/000000100050/cmd/power", "meter/grid/power", "battery/soc", "other/topic" };
+    for (auto topic : topics) {
+        constexpr uint32_t iterations = 20000;
+
+        auto begin = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            reference.handle_message(topic);
+        }
+        auto middle = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < iterations; i++) {
+            parser.handle_message({}, topic, nullptr, 0, 0, 0);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        char message[128];
+        snprintf(message, sizeof(message), "%s: linear %.0f ns, tree %.0f ns per message", topic,
+            std::chrono::duration<double, std::nano>(middle - begin).count() / iterations,
+            std::chrono::duration<double, std::nano>(end - middle).count() / iterations);
+        TEST_MESSAGE(message);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_wildcards);
+    RUN_TEST(test_dollar_topics);
+    RUN_TEST(test_invalid_filters_and_topics);
+    RUN_TEST(test_order_and_unregister);
+    RUN_TEST(test_differential_random);
+    RUN_TEST(benchmark_500_subscriptions);
+    return UNITY_END();
+}
@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+
+// checks MqttValueParser against the results Utils::getJsonValueByPath and
+// Utils::getNumericValueFromMqttPayload produce for the same payloads, which
+// deserialize the payload using ArduinoJson first.
+
+#include <MqttValueParser.h>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <unity.h>
+
+namespace {
+struct Case {
+    const char* Payload;
+    const char* Path;
+    std::optional<float> Expected;
+};
+
+void expect(const Case* cases, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        const auto& c = cases[i];
+        MqttValueParser parser(c.Path);
+
+        char error[256] = "";
+        const auto res = parser.parse(reinterpret_cast<const uint8_t*>(c.Payload), strlen(c.Payload), error, sizeof(error));
+
+        const std::string message = std::string("'") + c.Payload + "' at '" + c.Path + "': " + error;
+        TEST_ASSERT_EQUAL_MESSAGE(c.Expected.has_value(), res.has_value(), message.c_str());
+        if (c.Expected.has_value()) {
+            TEST_ASSERT_TRUE_MESSAGE(*c.Expected == *res, message.c_str());
+        } else {
+            // failures are always explained
+            TEST_ASSERT_TRUE_MESSAGE(strlen(error) > 0, message.c_str());
+        }
+    }
+}
+}
+
+void setUp() { }
+void tearDown() { }
+
+static void test_nested_keys()
+{
+    const Case cases[] = {
+        { R"({"power":123.5})", "power", 123.5f },
+        { R"({"grid":{"power":{"total":-42}}})", "grid/power/total", -42.0f },
+        { R"({"a":1,"grid":{"x":[1,{"y":2}],"power":7,"z":"s"},"b":{}})", "grid/power", 7.0f },
+        { R"( { "grid" : { "power" : 1e3 } } )", "grid/power", 1000.0f },
+        // double, leading and trailing slashes are ignored
+        { R"({"grid":{"power":7}})", "/grid//power/", 7.0f },
+        // escaped keys and strings in skipped values
+        { R"({"a\"b":"x\"}","tab\t":1,"power":8})", "power", 8.0f },
+        { R"({"abc":9})", "abc", 9.0f },
+        // the value of a key is not searched in the keys of nested objects
+        { R"({"grid":{"total":1},"total":2})", "total", 2.0f },
+        { R"({"grid":{"total":1}})", "total", std::nullopt },
+        // keys are case sensitive
+        { R"({"Power":1})", "power", std::nullopt },
+    };
+    expect(cases, sizeof(cases) / sizeof(cases[0]));
+}
+
+static void test_array_indices()
+{
+    const Case cases[] = {
+        { "[10,20,30]", "[0]", 10.0f },
+        { "[10,20,30]", "[2]", 30.0f },
+        { R"({"phases":[{"p":1},{"p":2.5},{"p":3}]})", "phases/[1]/p", 2.5f },
+        { R"({"m":[[1,2],[3,[4,5]]]})", "m/[1]/[1]/[0]", 4.0f },
+        // out of range and negative indices
+        { "[10,20,30]", "[3]", std::nullopt },
+        { "[]", "[0]", std::nullopt },
+        { "[10,20,30]", "[-1]", std::nullopt },
+        // indices apply to arrays only, keys to objects only
+        { R"({"0":1})", "[0]", std::nullopt },
+        { R"([{"p":1}])", "p", std::nullopt },
+    };
+    expect(cases, sizeof(cases) / sizeof(cases[0]));
+}
+
+static void test_numbers_as_strings()
+{
+    const Case cases[] = {
+        { R"({"power":"42.5"})", "power", 42.5f },
+        { R"({"power":'-1'})", "power", -1.0f },
+        // std::stof() skips leading whitespace and ignores trailing characters
+        { R"({"power":" 12W"})", "power", 12.0f },
+        { R"({"power":"0x10"})", "power", 16.0f },
+        { R"({"power":"W12"})", "power", std::nullopt },
+        { R"({"power":""})", "power", std::nullopt },
+    };
+    expect(cases, sizeof(cases) / sizeof(cases[0]));
+}
+
+static void test_literals()
+{
+    const Case cases[] = {
+        { R"({"power":null})", "power", std::nullopt },
+        { R"({"power":null})", "power/total", std::nullopt },
+        { R"({"power":true})", "power", std::nullopt },
+        { R"({"power":false})", "power", std::nullopt },
+        { "[null,1]", "[0]", std::nullopt },
+        // objects and arrays are not numbers
+        { R"({"power":{"total":1}})", "power", std::nullopt },
+        { R"({"power":[1]})", "power", std::nullopt },
+        // JSON numbers are converted as a whole
+        { R"({"power":0x10})", "power", std::nullopt },
+        { R"({"power":1x})", "power", std::nullopt },
+        { R"({"power":1.2.3})", "power", std::nullopt },
+        { R"({"power":nan})", "power", std::nullopt },
+        { R"({"power":-})", "power", std::nullopt },
+    };
+    expect(cases, sizeof(cases) / sizeof(cases[0]));
+}
+
+static void test_missing_path()
+{
+    const Case cases[] = {
+        { R"({"power":1})", "current", std::nullopt },
+        { R"({"grid":{"power":1}})", "grid/current", std::nullopt },
+        { R"({"grid":{"power":1}})", "grid/power/total", std::nullopt },
+        { "{}", "power", std::nullopt },
+        { "42", "power", std::nullopt },
+    };
+    expect(cases, sizeof(cases) / sizeof(cases[0]));
+}
+
+static void test_truncated_and_malformed()
+{
+    const Case cases[] = {
+        { "", "power", std::nullopt },
+        { R"({"power":)", "power", std::nullopt },
+        { R"({"power":1)", "power", std::nullopt },
+        { R"({"power":1,)", "power", std::nullopt },
+        { R"({"power":1,"b":)", "power", std::nullopt },
+        { R"({"grid":{"power":1})", "grid/power", std::nullopt },
+        { R"({"power":"12)", "power", std::nullopt },
+        { "[1,2", "[0]", std::nullopt },
+        { R"({"power" 1})", "power", std::nullopt },
+        { R"({"power":1 "b":2})", "power", std::nullopt },
+        { R"({"a":[1,2},"power":1})", "power", std::nullopt },
+        { R"({power:1})", "power", std::nullopt },
+        { "power=1", "power", std::nullopt },
+        // malformed content after the value is rejected as well
+        { R"({"power":1,"b":[1,2})", "power", std::nullopt },
+        { R"({"phases":[1,2,{"p":}]})", "phases/[0]", std::nullopt },
+        // ArduinoJson stops reading at the end of the document
+        { R"({"power":1} trailing)", "power", 1.0f },
+    };
+    expect(cases, sizeof(cases) / sizeof(cases[0]));
+}
+
+static void test_plain_payloads()
+{
+    const Case cases[] = {
+        { "42", "", 42.0f },
+        { "-12.5", "", -12.5f },
+        { " 3e2 ", "", 300.0f },
+        // std::stof() ignores trailing characters
+        { "230V", "", 230.0f },
+        { "12,5", "", 12.0f },
+        { "V230", "", std::nullopt },
+        { "", "", std::nullopt },
+        // JSON payloads require a path
+        { R"({"power":1})", "", std::nullopt },
+    };
+    expect(cases, sizeof(cases) / sizeof(cases[0]));
+}
+
+static void test_payload_is_not_terminated()
+{
+    // MQTT payloads are not null-terminated, the value must not be read
+    // beyond the given length
+    const char payload[] = R"({"power":12345})";
+    MqttValueParser parser("power");
+    char error[256];
+
+    const auto full = parser.parse(reinterpret_cast<const uint8_t*>(payload), strlen(payload), error, sizeof(error));
+    TEST_ASSERT_TRUE(full.has_value() && *full == 12345.0f);
+
+    const auto truncated = parser.parse(reinterpret_cast<const uint8_t*>(payload), 12, error, sizeof(error));
+    TEST_ASSERT_FALSE(truncated.has_value());
+
+    MqttValueParser plain("");
+    const auto number = plain.parse(reinterpret_cast<const uint8_t*>("12345"), 3, error, sizeof(error));
+    TEST_ASSERT_TRUE(number.has_value() && *number == 123.0f);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_nested_keys);
+    RUN_TEST(test_array_indices);
+    RUN_TEST(test_numbers_as_strings);
+    RUN_TEST(test_literals);
+    RUN_TEST(test_missing_path);
+    RUN_TEST(test_truncated_and_malformed);
+    RUN_TEST(test_plain_payloads);
+    RUN_TEST(test_payload_is_not_terminated);
+    return UNITY_END();
+}
@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+
+// drives the Hoymiles library against the simulated radio with a simulated
+// clock, such that polling several inverters over a lossy link can be
+// measured reproducibly on the host.
+
+#include <Arduino.h>
+#include <Hoymiles.h>
+#include <chrono>
+#include <cstdio>
+#include <unity.h>
+#include <vector>
+
+namespace {
+constexpr uint64_t DtuSerial = 0x199980000000ULL;
+constexpr uint64_t FirstInverterSerial = 0x114172220001ULL;
+
+struct RunResult {
+    HoymilesRadio_SIM::Stats Stats;
+    uint32_t Updates; // received RealTimeRunData of all inverters
+    uint32_t MaxAge; // longest time an inverter went without new data
+    uint32_t RxFailNoAnswer;
+    bool AllDevInfoValid;
+    double WallMillis;
+};
+
+void reset(const uint8_t inverters, const uint8_t packetLoss, const uint32_t seed)
+{
+    while (Hoymiles.getNumInverters() > 0) {
+        Hoymiles.removeInverterBySerial(Hoymiles.getInverterByPos(0)->serial());
+    }
+
+    Hoymiles.init();
+    Hoymiles.setVerboseLogging(false);
+    // poll back to back, which is the worst case for the radio
+    Hoymiles.setPollInterval(0);
+
+    HoymilesRadio_SIM* sim = Hoymiles.getRadioSim();
+    sim->setDtuSerial(DtuSerial);
+    sim->setSeed(seed);
+    sim->setPacketLoss(packetLoss);
+
+    for (uint8_t i = 0; i < inverters; i++) {
+        auto inv = Hoymiles.addInverter("sim", FirstInverterSerial + i);
+        inv->setEnablePolling(true);
+        inv->setEnableCommands(true);
+    }
+}
+
+void loopFor(const uint32_t duration)
+{
+    const uint32_t start = millis();
+    while (millis() - start < duration) {
+        nativeMillis++;
+        Hoymiles.loop();
+    }
+}
+
+RunResult run(const uint8_t inverters, const uint8_t packetLoss, const uint32_t seed, const uint32_t duration)
+{
+    reset(inverters, packetLoss, seed);
+
+    RunResult res = {};
+    const uint32_t start = millis();
+    std::vector<uint32_t> lastUpdate(inverters, 0);
+    std::vector<uint32_t> lastData(inverters, start);
+
+    auto begin = std::chrono::steady_clock::now();
+    while (millis() - start < duration) {
+        nativeMillis++;
+        Hoymiles.loop();
+
+        for (uint8_t i = 0; i < inverters; i++) {
+            const uint32_t update = Hoymiles.getInverterByPos(i)->Statistics()->getLastUpdate();
+            if (update != lastUpdate[i]) {
+                res.MaxAge = std::max(res.MaxAge, millis() - lastData[i]);
+                lastUpdate[i] = update;
+                lastData[i] = millis();
+                res.Updates++;
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    res.AllDevInfoValid = true;
+    for (uint8_t i = 0; i < inverters; i++) {
+        auto inv = Hoymiles.getInverterByPos(i);
+        res.MaxAge = std::max(res.MaxAge, millis() - lastData[i]);
+        res.RxFailNoAnswer += inv->RadioStats.RxFailNoAnswer;
+        res.AllDevInfoValid &= inv->DevInfo()->containsValidData();
+    }
+
+    res.Stats = Hoymiles.getRadioSim()->getStats();
+    res.WallMillis = std::chrono::duration<double, std::milli>(end - begin).count();
+    return res;
+}
+}
+
+void setUp() { }
+void tearDown() { }
+
+static void test_lossless_link_serves_all_inverters()
+{
+    const auto res = run(5, 0, 1, 2 * 60 * 1000);
+
+    TEST_ASSERT_EQUAL(0, res.Stats.Dropped);
+    TEST_ASSERT_EQUAL(0, res.Stats.RetransmitRequests);
+    TEST_ASSERT_EQUAL(0, res.RxFailNoAnswer);
+    TEST_ASSERT_TRUE(res.AllDevInfoValid);
+    // every inverter is polled several times
+    TEST_ASSERT_GREATER_THAN(5 * 10, res.Updates);
+}
+
+static void test_lossy_link_is_reproducible()
+{
+    const auto a = run(3, 20, 42, 60 * 1000);
+    const auto b = run(3, 20, 42, 60 * 1000);
+    const auto c = run(3, 20, 43, 60 * 1000);
+
+    TEST_ASSERT_GREATER_THAN(0, a.Stats.Dropped);
+    TEST_ASSERT_GREATER_THAN(0, a.Stats.RetransmitRequests);
+
+    TEST_ASSERT_EQUAL(a.Stats.Requests, b.Stats.Requests);
+    TEST_ASSERT_EQUAL(a.Stats.Dropped, b.Stats.Dropped);
+    TEST_ASSERT_EQUAL(a.Stats.CommandMillisSum, b.Stats.CommandMillisSum);
+    TEST_ASSERT_EQUAL(a.Updates, b.Updates);
+
+    TEST_ASSERT_TRUE(a.Stats.Dropped != c.Stats.Dropped || a.Stats.CommandMillisSum != c.Stats.CommandMillisSum);
+}
+
+static void test_restart_is_not_superseded_by_power_state()
+{
+    reset(1, 0, 1);
+    auto inv = Hoymiles.getInverterByPos(0);
+    inv->setEnablePolling(false);
+
+    // the command at the front of the queue is never superseded
+    inv->sendPowerControlRequest(true);
+    inv->sendRestartControlRequest();
+    inv->sendPowerControlRequest(false);
+    loopFor(10 * 1000);
+
+    TEST_ASSERT_EQUAL(0, inv->RadioStats.TxSuperseded);
+    TEST_ASSERT_EQUAL(3, Hoymiles.getRadioSim()->getStats().Requests);
+
+    // turning on and off still supersede each other
+    inv->sendRestartControlRequest();
+    inv->sendPowerControlRequest(false);
+    inv->sendPowerControlRequest(true);
+    loopFor(10 * 1000);
+
+    TEST_ASSERT_EQUAL(1, inv->RadioStats.TxSuperseded);
+    TEST_ASSERT_EQUAL(5, Hoymiles.getRadioSim()->getStats().Requests);
+    TEST_ASSERT_EQUAL(CMD_OK, inv->PowerCommand()->getLastPowerCommandSuccess());
+}
+
+// not an assertion, the results are reported for comparison only
+static void benchmark_inverter_count()
+{
+    constexpr uint32_t duration = 10 * 60 * 1000;
+
+    for (uint8_t packetLoss : { 0, 10 }) {
+        for (uint8_t inverters = 1; inverters <= 10; inverters++) {
+            const auto res = run(inverters, packetLoss, 1, duration);
+            const auto& s = res.Stats;
+
+            char message[200];
+            snprintf(message, sizeof(message),
+                "%2u inverters, %2u%% loss: data every %5.0f ms (max %6u ms), %4u commands (avg %3u ms, max %4u ms), %.2f retransmits/command, %4.0f ms host time",
+                inverters, packetLoss,
+                res.Updates ? static_cast<double>(duration) * inverters / res.Updates : 0.0,
+                static_cast<unsigned>(res.MaxAge),
+                static_cast<unsigned>(s.Commands),
+                static_cast<unsigned>(s.Commands ? s.CommandMillisSum / s.Commands : 0),
+                static_cast<unsigned>(s.CommandMillisMax),
+                s.Commands ? static_cast<double>(s.RetransmitRequests) / s.Commands : 0.0,
+                res.WallMillis);
+            TEST_MESSAGE(message);
+        }
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_lossless_link_serves_all_inverters);
+    RUN_TEST(test_lossy_link_is_reproducible);
+    RUN_TEST(test_restart_is_not_superseded_by_power_state);
+    RUN_TEST(benchmark_inverter_count);
+    return UNITY_END();
+}
@@ -0,0 +1,311 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+
+// replays limit commands and the inverter statistics following them through
+// InverterResponseModel and checks the learned response delay and ramp rate.
+
+#include <InverterResponseModel.h>
+#include <cmath>
+#include <cstdio>
+#include <unity.h>
+
+namespace {
+struct TraceEvent {
+    uint32_t Millis;
+    bool IsLimit; // acknowledged limit command, otherwise statistics
+    float Watts;
+};
+
+void replay(InverterResponseModel& model, const TraceEvent* events, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (events[i].IsLimit) {
+            model.onLimitCommand(events[i].Millis, events[i].Watts);
+        } else {
+            model.onStatistics(events[i].Millis, events[i].Watts);
+        }
+    }
+}
+
+// an inverter following each limit after a fixed delay with a fixed ramp rate
+class SimulatedInverter {
+public:
+    SimulatedInverter(uint32_t delayMillis, float rampWattsPerSecond, float watts)
+        : _delayMillis(delayMillis)
+        , _ramp(rampWattsPerSecond)
+        , _fromWatts(watts)
+        , _toWatts(watts)
+    {
+    }
+
+    void setLimit(uint32_t millis, float watts)
+    {
+        _fromWatts = getOutput(millis);
+        _toWatts = watts;
+        _stepMillis = millis;
+    }
+
+    float getOutput(uint32_t millis) const
+    {
+        auto elapsed = static_cast<int32_t>(millis - _stepMillis - _delayMillis);
+        if (elapsed <= 0) {
+            return _fromWatts;
+        }
+
+        float moved = std::min(std::abs(_toWatts - _fromWatts), _ramp * elapsed / 1000);
+        return _fromWatts + std::copysign(moved, _toWatts - _fromWatts);
+    }
+
+private:
+    uint32_t _delayMillis;
+    float _ramp;
+    float _fromWatts;
+    float _toWatts;
+    uint32_t _stepMillis = 0;
+};
+
+struct SimulationResult {
+    uint32_t Steps;
+    float ModelError; // mean absolute error of the predicted output
+    float LastSampleError; // ... and of the last reported output
+};
+
+// steps between two limits every minute while the statistics are received
+// every pollMillis, with a varying phase relative to the steps. the reported
+// output deviates from the actual one by up to 5 W.
+SimulationResult simulate(InverterResponseModel& model, SimulatedInverter& inverter, uint32_t pollMillis, uint32_t minutes)
+{
+    SimulationResult res = {};
+    double modelError = 0;
+    double lastSampleError = 0;
+    uint32_t predictions = 0;
+
+    uint32_t nextPoll = 1000;
+    uint32_t random = 1;
+    float lastSample = 0;
+    for (uint32_t millis = 1000; millis < minutes * 60 * 1000; millis += 100) {
+        if (millis % (60 * 1000) == 0) {
+            inverter.setLimit(millis, (millis / (60 * 1000)) % 2 ? 1000 : 200);
+            model.onLimitCommand(millis, (millis / (60 * 1000)) % 2 ? 1000 : 200);
+            res.Steps++;
+        }
+
+        if (millis >= nextPoll) {
+            random = (random * 1103515245 + 12345) & 0x7fffffff;
+            lastSample = inverter.getOutput(millis) + static_cast<float>((random >> 8) % 1001) / 100 - 5;
+            model.onStatistics(millis, lastSample);
+
+            random = (random * 1103515245 + 12345) & 0x7fffffff;
+            nextPoll = millis + pollMillis + (random >> 8) % 1000;
+        }
+
+        // the power meter is read once per second
+        if (millis % 1000 == 0 && model.getLearnedSteps() > 0) {
+            const float actual = inverter.getOutput(millis);
+            modelError += std::abs(*model.predictOutput(millis) - actual);
+            lastSampleError += std::abs(lastSample - actual);
+            predictions++;
+        }
+    }
+
+    res.ModelError = predictions ? modelError / predictions : 0;
+    res.LastSampleError = predictions ? lastSampleError / predictions : 0;
+    return res;
+}
+}
+
+void setUp() { }
+void tearDown() { }
+
+static void test_steps_sampled_during_ramp()
+{
+    // statistics every second. the first step starts moving 2 s after the
+    // command and ramps with 100 W/s, the second one after 1 s with 150 W/s.
+    const TraceEvent trace[] = {
+        { 8500, false, 200 },
+        { 9500, false, 200 },
+        { 10000, true, 600 },
+        { 10500, false, 200 },
+        { 11500, false, 200 },
+        { 12500, false, 250 },
+        { 13500, false, 350 },
+        { 14500, false, 450 },
+        { 15500, false, 550 },
+        { 16500, false, 600 },
+        { 29500, false, 600 },
+        { 30000, true, 300 },
+        { 30500, false, 600 },
+        { 31500, false, 525 },
+        { 32500, false, 375 },
+        { 33500, false, 300 },
+    };
+
+    InverterResponseModel model;
+    TEST_ASSERT_FALSE(model.predictOutput(0).has_value());
+
+    replay(model, trace, 3);
+    // the output did not change yet
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 200, *model.predictOutput(10000));
+
+    replay(model, trace + 3, 7);
+    TEST_ASSERT_EQUAL(1, model.getLearnedSteps());
+    TEST_ASSERT_UINT32_WITHIN(10, 2000, model.getDelayMillis());
+    TEST_ASSERT_FLOAT_WITHIN(1, 100, model.getRampWattsPerSecond());
+
+    // the second step is smoothed into the learned values
+    replay(model, trace + 10, 6);
+    TEST_ASSERT_EQUAL(2, model.getLearnedSteps());
+    TEST_ASSERT_UINT32_WITHIN(10, 2000 + 0.3 * (1000 - 2000), model.getDelayMillis());
+    TEST_ASSERT_FLOAT_WITHIN(1, 100 + 0.3 * (150 - 100), model.getRampWattsPerSecond());
+}
+
+static void test_prediction_follows_the_ramp()
+{
+    const TraceEvent trace[] = {
+        { 9500, false, 200 },
+        { 10000, true, 600 },
+        { 10500, false, 200 },
+        { 11500, false, 200 },
+        { 12500, false, 250 },
+        { 13500, false, 350 },
+        { 49500, false, 300 },
+        { 50000, true, 800 },
+        { 50500, false, 300 },
+    };
+
+    InverterResponseModel model;
+    replay(model, trace, sizeof(trace) / sizeof(trace[0]));
+    TEST_ASSERT_EQUAL(1, model.getLearnedSteps());
+
+    // nothing happens before the delay elapsed
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 300, *model.predictOutput(51000));
+    // then the output ramps towards the limit ...
+    TEST_ASSERT_FLOAT_WITHIN(2, 400, *model.predictOutput(53000));
+    // ... and stops there
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 800, *model.predictOutput(60000));
+
+    // the ramp continues from the last sample
+    model.onStatistics(53500, 500);
+    TEST_ASSERT_FLOAT_WITHIN(2, 600, *model.predictOutput(54500));
+
+    // the inverter did not reach the limit in time, e.g., for lack of DC power
+    model.onStatistics(58000, 700);
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 700, *model.predictOutput(60000));
+}
+
+static void test_step_settled_between_samples()
+{
+    // statistics every 5 seconds, the output settled between two samples
+    const TraceEvent trace[] = {
+        { 7000, false, 200 },
+        { 10000, true, 600 },
+        { 12000, false, 200 },
+        { 17000, false, 600 },
+    };
+
+    InverterResponseModel model;
+    replay(model, trace, sizeof(trace) / sizeof(trace[0]));
+
+    // the delay is assumed to be half way between the samples,
+    // the ramp rate remains at its initial guess
+    TEST_ASSERT_EQUAL(1, model.getLearnedSteps());
+    TEST_ASSERT_EQUAL(4500, model.getDelayMillis());
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 100, model.getRampWattsPerSecond());
+}
+
+static void test_steps_not_learned()
+{
+    InverterResponseModel model;
+
+    // the output does not follow the limit
+    const TraceEvent limited[] = {
+        { 9500, false, 300 },
+        { 10000, true, 800 },
+        { 10500, false, 300 },
+        { 11500, false, 450 },
+        { 12500, false, 450 },
+        { 25500, false, 450 },
+        { 45500, false, 450 },
+        { 46500, false, 800 },
+    };
+    replay(model, limited, sizeof(limited) / sizeof(limited[0]));
+    TEST_ASSERT_EQUAL(0, model.getLearnedSteps());
+
+    // steps which are too small
+    const TraceEvent small[] = {
+        { 60000, true, 780 },
+        { 60500, false, 800 },
+        { 62500, false, 790 },
+        { 63500, false, 780 },
+    };
+    replay(model, small, sizeof(small) / sizeof(small[0]));
+    TEST_ASSERT_EQUAL(0, model.getLearnedSteps());
+
+    // the power state changed during the step
+    const TraceEvent aborted[] = {
+        { 70000, true, 200 },
+        { 70500, false, 780 },
+    };
+    replay(model, aborted, sizeof(aborted) / sizeof(aborted[0]));
+    model.abortStep();
+    model.onStatistics(72500, 0);
+    model.onStatistics(73500, 0);
+    TEST_ASSERT_EQUAL(0, model.getLearnedSteps());
+    TEST_ASSERT_FLOAT_WITHIN(0.1, 0, *model.predictOutput(75000));
+
+    // a step without a previous sample is not usable
+    model.reset();
+    model.onLimitCommand(80000, 800);
+    model.onStatistics(81500, 200);
+    model.onStatistics(82500, 400);
+    model.onStatistics(83500, 600);
+    TEST_ASSERT_EQUAL(0, model.getLearnedSteps());
+}
+
+static void test_simulated_inverter()
+{
+    for (uint32_t pollMillis : { 1000, 2000 }) {
+        InverterResponseModel model;
+        SimulatedInverter inverter(2500, 40, 200);
+        const auto res = simulate(model, inverter, pollMillis, 30);
+
+        char message[64];
+        snprintf(message, sizeof(message), "poll interval %u ms", pollMillis);
+        TEST_ASSERT_GREATER_THAN(10, model.getLearnedSteps());
+        TEST_ASSERT_UINT32_WITHIN_MESSAGE(500, 2500, model.getDelayMillis(), message);
+        TEST_ASSERT_FLOAT_WITHIN_MESSAGE(4, 40, model.getRampWattsPerSecond(), message);
+        // the prediction is closer to the actual output than the last sample
+        TEST_ASSERT_LESS_THAN(res.LastSampleError / 2, res.ModelError);
+    }
+}
+
+// not an assertion, the results are reported for comparison only
+static void benchmark_prediction_error()
+{
+    for (uint32_t pollMillis : { 1000, 2000, 5000, 10000 }) {
+        InverterResponseModel model;
+        SimulatedInverter inverter(2500, 40, 200);
+        const auto res = simulate(model, inverter, pollMillis, 60);
+
+        char message[160];
+        snprintf(message, sizeof(message),
+            "poll every %5u ms: learned %2u of %2u steps, delay %4u ms, ramp %5.1f W/s, error %5.1f W (last sample %5.1f W)",
+            pollMillis, model.getLearnedSteps(), res.Steps, model.getDelayMillis(),
+            model.getRampWattsPerSecond(), res.ModelError, res.LastSampleError);
+        TEST_MESSAGE(message);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_steps_sampled_during_ramp);
+    RUN_TEST(test_prediction_follows_the_ramp);
+    RUN_TEST(test_step_settled_between_samples);
+    RUN_TEST(test_steps_not_learned);
+    RUN_TEST(test_simulated_inverter);
+    RUN_TEST(benchmark_prediction_error);
+    return UNITY_END();
+}
@@ -0,0 +1,374 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Copyright (C) 2024 Thomas Basler and others
+ */
+
+// feeds text protocol streams recorded from a SmartSolar MPPT and a
+// SmartShunt through the VE.Direct frame handler and checks the decoded
+// values as well as the handling of invalid frames.
+
+#include <Arduino.h>
+#include <VeDirectMpptController.h>
+#include <VeDirectShuntController.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unity.h>
+
+namespace {
+constexpr uint8_t MpptPort = 1;
+constexpr uint8_t ShuntPort = 2;
+
+// the tail of a frame, as received when connecting in the middle of it
+const std::string MpptTail = "0"
+    "\r\nH23\t120"
+    "\r\nHSDS\t112"
+    "\r\nChecksum\t9";
+
+const std::string MpptFrame1 = ""
+    "\r\nPID\t0xA053"
+    "\r\nFW\t159"
+    "\r\nSER#\tHQ2132QY2KR"
+    "\r\nV\t13790"
+    "\r\nI\t4200"
+    "\r\nVPV\t35620"
+    "\r\nPPV\t61"
+    "\r\nCS\t3"
+    "\r\nMPPT\t2"
+    "\r\nOR\t0x00000000"
+    "\r\nERR\t0"
+    "\r\nLOAD\tON"
+    "\r\nIL\t300"
+    "\r\nH19\t3456"
+    "\r\nH20\t12"
+    "\r\nH21\t98"
+    "\r\nH22\t87"
+    "\r\nH23\t120"
+    "\r\nHSDS\t112"
+    "\r\nChecksum\t9";
+
+// contains the response to a request of the panel power (65.5 W) through
+// the HEX protocol, which does not count towards the checksum
+const std::string MpptFrame2 = ""
+    "\r\nPID\t0xA053"
+    "\r\nFW\t159"
+    "\r\nSER#\tHQ2132QY2KR"
+    "\r\nV\t13810"
+    "\r\nI\t4350"
+    "\r\nVPV\t35620"
+    "\r\nPPV\t64"
+    "\r\n:7BCED0096190000F6\n"
+    "CS\t3"
+    "\r\nMPPT\t2"
+    "\r\nOR\t0x00000000"
+    "\r\nERR\t0"
+    "\r\nLOAD\tON"
+    "\r\nIL\t300"
+    "\r\nH19\t3456"
+    "\r\nH20\t13"
+    "\r\nH21\t98"
+    "\r\nH22\t87"
+    "\r\nH23\t120"
+    "\r\nHSDS\t112"
+    "\r\nChecksum\t6";
+
+// the SmartShunt sends its values in two blocks with a checksum each
+const std::string ShuntBlock1 = ""
+    "\r\nPID\t0xA389"
+    "\r\nV\t26351"
+    "\r\nVM\t13170"
+    "\r\nDM\t2"
+    "\r\nI\t-2510"
+    "\r\nP\t-66"
+    "\r\nCE\t-36450"
+    "\r\nSOC\t823"
+    "\r\nTTG\t1263"
+    "\r\nAlarm\tOFF"
+    "\r\nAR\t0"
+    "\r\nBMV\tSmartShunt 500A/50mV"
+    "\r\nFW\t0415"
+    "\r\nSER#\tHQ2245A7XYZ"
+    "\r\nMON\t0"
+    "\r\nChecksum\tB";
+
+const std::string ShuntBlock2 = ""
+    "\r\nH1\t-102040"
+    "\r\nH2\t-36450"
+    "\r\nH3\t-51200"
+    "\r\nH4\t42"
+    "\r\nH5\t0"
+    "\r\nH6\t-2340000"
+    "\r\nH7\t21010"
+    "\r\nH8\t29120"
+    "\r\nH9\t86400"
+    "\r\nH10\t12"
+    "\r\nH11\t0"
+    "\r\nH12\t0"
+    "\r\nH15\t-20"
+    "\r\nH16\t31"
+    "\r\nH17\t2510"
+    "\r\nH18\t2780"
+    "\r\nChecksum\t\x85";
+
+class MessageLog : public Print {
+public:
+    size_t write(uint8_t c) override
+    {
+        _text += static_cast<char>(c);
+        return 1;
+    }
+
+    size_t count(const char* message) const
+    {
+        size_t n = 0;
+        for (size_t pos = _text.find(message); pos != std::string::npos; pos = _text.find(message, pos + 1)) {
+            n++;
+        }
+        return n;
+    }
+
+private:
+    std::string _text;
+};
+
+// passes the data to the controller in chunks, as read from the UART at 19200 baud
+template <typename T>
+void feed(T& controller, uint8_t port, const std::string& data)
+{
+    constexpr size_t chunkSize = 64;
+
+    for (size_t pos = 0; pos < data.size(); pos += chunkSize) {
+        nativeUart[port].rx.append(data, pos, chunkSize);
+        nativeMillis += 33;
+        controller.loop();
+    }
+}
+
+std::string corrupt(std::string frame, const std::string& from, const std::string& to)
+{
+    return frame.replace(frame.find(from), from.size(), to);
+}
+}
+
+void setUp()
+{
+    nativeMillis = 1000;
+    for (auto& uart : nativeUart) {
+        uart = {};
+    }
+}
+
+void tearDown() { }
+
+static void test_mppt_stream()
+{
+    MessageLog log;
+    // value-initialized, as the frame structure is not initialized otherwise
+    VeDirectMpptController mppt {};
+    mppt.init(MpptPort, -1, &log, false, MpptPort);
+    TEST_ASSERT_FALSE(mppt.isDataValid());
+
+    feed(mppt, MpptPort, MpptTail);
+    TEST_ASSERT_EQUAL(1, log.count("invalid frame"));
+    TEST_ASSERT_EQUAL(0, mppt.getLastUpdate());
+
+    feed(mppt, MpptPort, MpptFrame1);
+    TEST_ASSERT_EQUAL(1, log.count("invalid frame"));
+    TEST_ASSERT_EQUAL(nativeMillis, mppt.getLastUpdate());
+    TEST_ASSERT_TRUE(mppt.isDataValid());
+
+    const auto& data = mppt.getData();
+    TEST_ASSERT_EQUAL(0xA053, data.productID_PID);
+    TEST_ASSERT_EQUAL_STRING("HQ2132QY2KR", data.serialNr_SER);
+    TEST_ASSERT_EQUAL_STRING("159", data.firmwareVer_FW);
+    TEST_ASSERT_EQUAL(13790, data.batteryVoltage_V_mV);
+    TEST_ASSERT_EQUAL(4200, data.batteryCurrent_I_mA);
+    TEST_ASSERT_EQUAL(35620, data.panelVoltage_VPV_mV);
+    TEST_ASSERT_EQUAL(61, data.panelPower_PPV_W);
+    TEST_ASSERT_EQUAL(3, data.currentState_CS);
+    TEST_ASSERT_EQUAL(2, data.stateOfTracker_MPPT);
+    TEST_ASSERT_EQUAL(0, data.offReason_OR);
+    TEST_ASSERT_EQUAL(0, data.errorCode_ERR);
+    TEST_ASSERT_TRUE(data.loadOutputState_LOAD);
+    TEST_ASSERT_EQUAL(300, data.loadCurrent_IL_mA);
+    TEST_ASSERT_EQUAL(34560, data.yieldTotal_H19_Wh);
+    TEST_ASSERT_EQUAL(120, data.yieldToday_H20_Wh);
+    TEST_ASSERT_EQUAL(98, data.maxPowerToday_H21_W);
+    TEST_ASSERT_EQUAL(870, data.yieldYesterday_H22_Wh);
+    TEST_ASSERT_EQUAL(120, data.maxPowerYesterday_H23_W);
+    TEST_ASSERT_EQUAL(112, data.daySequenceNr_HSDS);
+
+    // calculated values
+    TEST_ASSERT_EQUAL(57, data.batteryOutputPower_W);
+    TEST_ASSERT_EQUAL(1712, data.panelCurrent_mA);
+
+    // the device can not be sent anything without a TX pin
+    TEST_ASSERT_TRUE(nativeUart[MpptPort].tx.empty());
+}
+
+static void test_mppt_hex_message_in_frame()
+{
+    MessageLog log;
+    VeDirectMpptController mppt {};
+    mppt.init(MpptPort, -1, &log, false, MpptPort);
+
+    feed(mppt, MpptPort, MpptFrame1 + MpptFrame2);
+    TEST_ASSERT_EQUAL(0, log.count("invalid frame"));
+
+    const auto& data = mppt.getData();
+    TEST_ASSERT_EQUAL(13810, data.batteryVoltage_V_mV);
+    TEST_ASSERT_EQUAL(4350, data.batteryCurrent_I_mA);
+    TEST_ASSERT_EQUAL(130, data.yieldToday_H20_Wh);
+
+    // the value received through the HEX protocol supersedes the text value
+    TEST_ASSERT_TRUE(data.PanelPowerMilliWatts.first > 0);
+    TEST_ASSERT_EQUAL(65500, data.PanelPowerMilliWatts.second);
+    TEST_ASSERT_EQUAL(65, data.panelPower_PPV_W);
+}
+
+static void test_shunt_stream()
+{
+    MessageLog log;
+    VeDirectShuntController shunt {};
+    shunt.init(ShuntPort, -1, &log, false, ShuntPort);
+
+    feed(shunt, ShuntPort, ShuntBlock1);
+    TEST_ASSERT_TRUE(shunt.isDataValid());
+
+    const auto& data = shunt.getData();
+    TEST_ASSERT_EQUAL(0xA389, data.productID_PID);
+    TEST_ASSERT_EQUAL_STRING("HQ2245A7XYZ", data.serialNr_SER);
+    TEST_ASSERT_EQUAL_STRING("4.15", data.getFwVersionFormatted().c_str());
+    TEST_ASSERT_EQUAL(26351, data.batteryVoltage_V_mV);
+    TEST_ASSERT_EQUAL(-2510, data.batteryCurrent_I_mA);
+    TEST_ASSERT_EQUAL(13170, data.VM);
+    TEST_ASSERT_EQUAL(2, data.DM);
+    TEST_ASSERT_EQUAL(-66, data.P);
+    TEST_ASSERT_EQUAL(-36450, data.CE);
+    TEST_ASSERT_EQUAL(823, data.SOC);
+    TEST_ASSERT_EQUAL(1263, data.TTG);
+    TEST_ASSERT_FALSE(data.ALARM);
+    TEST_ASSERT_EQUAL(0, data.alarmReason_AR);
+    TEST_ASSERT_EQUAL(0, data.dcMonitorMode_MON);
+    TEST_ASSERT_FALSE(data.tempPresent);
+    TEST_ASSERT_EQUAL(0, data.H4);
+
+    const uint32_t firstUpdate = shunt.getLastUpdate();
+    feed(shunt, ShuntPort, ShuntBlock2);
+    TEST_ASSERT_GREATER_THAN(firstUpdate, shunt.getLastUpdate());
+    TEST_ASSERT_EQUAL(0, log.count("invalid frame"));
+
+    TEST_ASSERT_EQUAL(-102040, data.H1);
+    TEST_ASSERT_EQUAL(-36450, data.H2);
+    TEST_ASSERT_EQUAL(-51200, data.H3);
+    TEST_ASSERT_EQUAL(42, data.H4);
+    TEST_ASSERT_EQUAL(0, data.H5);
+    TEST_ASSERT_EQUAL(-2340000, data.H6);
+    TEST_ASSERT_EQUAL(21010, data.H7);
+    TEST_ASSERT_EQUAL(29120, data.H8);
+    TEST_ASSERT_EQUAL(86400, data.H9);
+    TEST_ASSERT_EQUAL(12, data.H10);
+    TEST_ASSERT_EQUAL(-20, data.H15);
+    TEST_ASSERT_EQUAL(31, data.H16);
+    TEST_ASSERT_EQUAL(2510, data.H17);
+    TEST_ASSERT_EQUAL(2780, data.H18);
+}
+
+static void test_invalid_frames()
+{
+    MessageLog log;
+    VeDirectShuntController shunt {};
+    shunt.init(ShuntPort, -1, &log, false, ShuntPort);
+    const auto& data = shunt.getData();
+
+    feed(shunt, ShuntPort, ShuntBlock1);
+    const uint32_t lastUpdate = shunt.getLastUpdate();
+    TEST_ASSERT_EQUAL(823, data.SOC);
+
+    // a single corrupted digit ...
+    feed(shunt, ShuntPort, corrupt(ShuntBlock1, "SOC\t823", "SOC\t824"));
+    TEST_ASSERT_EQUAL(1, log.count("checksum 0x01 != 0x00, invalid frame"));
+    // ... a lost byte ...
+    feed(shunt, ShuntPort, corrupt(ShuntBlock1, "SOC\t823", "SOC\t23"));
+    TEST_ASSERT_EQUAL(2, log.count("invalid frame"));
+    // ... or a wrong checksum invalidate the whole frame
+    feed(shunt, ShuntPort, corrupt(ShuntBlock1, "\tB", "\tC"));
+    TEST_ASSERT_EQUAL(3, log.count("invalid frame"));
+
+    TEST_ASSERT_EQUAL(823, data.SOC);
+    TEST_ASSERT_EQUAL(lastUpdate, shunt.getLastUpdate());
+
+    // the next frame is valid again
+    feed(shunt, ShuntPort, corrupt(ShuntBlock1, "SOC\t823", "SOC\t822") + ShuntBlock2);
+    TEST_ASSERT_EQUAL(4, log.count("invalid frame"));
+    TEST_ASSERT_EQUAL(42, data.H4);
+
+    // the remainder of an interrupted frame is discarded after a pause
+    feed(shunt, ShuntPort, ShuntBlock1.substr(0, 50));
+    nativeMillis += 600;
+    shunt.loop();
+    TEST_ASSERT_EQUAL(1, log.count("Resetting state machine"));
+    feed(shunt, ShuntPort, ShuntBlock2);
+    TEST_ASSERT_EQUAL(4, log.count("invalid frame"));
+    TEST_ASSERT_EQUAL(nativeMillis, shunt.getLastUpdate());
+
+    // frames with too much text data are ignored. the checksum is valid.
+    std::string frame;
+    for (int i = 0; i < 50; i++) {
+        frame += "\r\nH4\t" + std::to_string(10000000 + i);
+    }
+    frame += "\r\nChecksum\t";
+    uint8_t checksum = 0;
+    for (char c : frame) {
+        checksum -= static_cast<uint8_t>(c);
+    }
+    frame += static_cast<char>(checksum);
+    feed(shunt, ShuntPort, frame);
+    TEST_ASSERT_EQUAL(1, log.count("frame ignored"));
+    TEST_ASSERT_EQUAL(42, data.H4);
+}
+
+// not an assertion, the results are reported for comparison only
+static void benchmark_throughput()
+{
+    constexpr size_t frames = 20000;
+
+    auto measure = [](auto& controller, uint8_t port, const std::string& stream, const char* name) {
+        MessageLog log;
+        controller.init(port, -1, &log, false, port);
+
+        nativeUart[port] = {};
+        for (size_t i = 0; i < frames; i++) {
+            nativeUart[port].rx += stream;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        controller.loop();
+        auto end = std::chrono::steady_clock::now();
+
+        const double seconds = std::chrono::duration<double>(end - begin).count();
+        const double bytesPerSecond = nativeUart[port].rx.size() / seconds;
+
+        char message[128];
+        snprintf(message, sizeof(message), "%s: %.0f bytes/s, %.0f times the line rate of 1920 bytes/s, %zu invalid frames",
+            name, bytesPerSecond, bytesPerSecond / 1920, log.count("invalid frame"));
+        TEST_MESSAGE(message);
+    };
+
+    VeDirectMpptController mppt {};
+    measure(mppt, MpptPort, MpptFrame1 + MpptFrame2, "MPPT");
+
+    VeDirectShuntController shunt {};
+    measure(shunt, ShuntPort, ShuntBlock1 + ShuntBlock2, "SmartShunt");
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_mppt_stream);
+    RUN_TEST(test_mppt_hex_message_in_frame);
+    RUN_TEST(test_shunt_stream);
+    RUN_TEST(test_invalid_frames);
+    RUN_TEST(benchmark_throughput);
+    return UNITY_END();
+}
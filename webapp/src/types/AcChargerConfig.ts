@@ -11,4 +11,7 @@ export interface AcChargerConfig {
     emergency_charge_enabled: boolean;
     stop_batterysoc_threshold: number;
     target_power_consumption: number;
+    auto_power_kp: number;
+    auto_power_ki: number;
+    auto_power_max_ramp: number;
 }
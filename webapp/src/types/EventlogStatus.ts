@@ -7,5 +7,7 @@ export interface EventlogItem {
 
 export interface EventlogItems {
     count: number;
+    total: number;
+    offset: number;
     events: Array<EventlogItem>;
 }
@@ -1,3 +1,14 @@
 export interface FirmwareStatus {
     ota_supported: boolean;
+    pending_verify: boolean;
+}
+
+export interface FirmwareProgress {
+    state: string;
+    received: number;
+    total: number;
+    progress: number;
+    throughput: number;
+    sha256?: string;
+    error?: string;
 }
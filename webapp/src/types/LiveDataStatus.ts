@@ -21,6 +21,26 @@ export interface InverterStatistics {
     Irradiation?: ValueObject;
 }
 
+export interface RssiHistogramBucket {
+    below_dbm?: number;
+    count: number;
+}
+
+export interface LinkQualityChannel {
+    channel: number;
+    tx: number;
+    tx_answered: number;
+    rx: number;
+    rssi_avg: number;
+    success_rate: number;
+}
+
+export interface LinkQuality {
+    rssi_last: number;
+    rssi_histogram: RssiHistogramBucket[];
+    channels: LinkQualityChannel[];
+}
+
 export interface RadioStatistics {
     tx_request: number;
     tx_re_request: number;
@@ -28,6 +48,8 @@ export interface RadioStatistics {
     rx_fail_nothing: number;
     rx_fail_partial: number;
     rx_fail_corrupt: number;
+    tx_superseded: number;
+    link_quality: LinkQuality;
 }
 
 export interface Inverter {
@@ -27,6 +27,7 @@ export interface PowerLimiterConfig {
     is_inverter_behind_powermeter: boolean;
     is_inverter_solar_powered: boolean;
     use_overscaling_to_compensate_shading: boolean;
+    predictive_control: boolean;
     inverter_serial: string;
     inverter_channel_id: number;
     target_power_consumption: number;
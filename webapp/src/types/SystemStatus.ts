@@ -1,3 +1,32 @@
+export interface BootStage {
+    name: string;
+    start: number;
+    duration: number;
+    concurrent: boolean;
+}
+
+export interface BootTimings {
+    setup_done: number;
+    first_limit: number;
+    stages: BootStage[];
+}
+
+export interface SchedulerTask {
+    name: string;
+    calls: number;
+    runtime: number;
+    runtime_max: number;
+    delay_max: number;
+    overruns: number;
+}
+
+export interface SchedulerStats {
+    passes: number;
+    pass_avg: number;
+    pass_max: number;
+    tasks: SchedulerTask[];
+}
+
 export interface SystemStatus {
     // HardwareInfo
     chipmodel: string;
@@ -38,4 +67,8 @@ export interface SystemStatus {
     nrf_pvariant: boolean;
     cmt_configured: boolean;
     cmt_connected: boolean;
+    // BootInfo
+    boot: BootTimings;
+    // TaskInfo
+    scheduler: SchedulerStats;
 }
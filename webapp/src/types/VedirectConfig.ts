@@ -2,4 +2,5 @@ export interface VedirectConfig {
     vedirect_enabled: boolean;
     verbose_logging: boolean;
     vedirect_updatesonly: boolean;
+    fast_poll_interval: number;
 }
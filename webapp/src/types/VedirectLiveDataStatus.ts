@@ -12,8 +12,20 @@ export interface Vedirect {
 
 type MpptData = (ValueObject | string)[];
 
+export interface VedirectFastPoll {
+    requests: number;
+    responses: number;
+    timeouts: number;
+    latency_ms: number;
+    avg_latency_ms: number;
+    panel_power_age_ms: number;
+    charger_current_age_ms: number;
+    device_state_age_ms: number;
+}
+
 export interface VedirectInstance {
     data_age_ms: number;
+    fast_poll?: VedirectFastPoll;
     product_id: string;
     firmware_version: string;
     values: { [key: string]: MpptData };
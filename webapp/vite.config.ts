@@ -1,6 +1,6 @@
 import { fileURLToPath, URL } from 'node:url'
 
-import { defineConfig } from 'vite'
+import { defineConfig, type Plugin } from 'vite'
 import vue from '@vitejs/plugin-vue'
 
 import viteCompression from 'vite-plugin-compression';
@@ -8,6 +8,7 @@ import cssInjectedByJsPlugin from 'vite-plugin-css-injected-by-js'
 import VueI18nPlugin from '@intlify/unplugin-vue-i18n/vite'
 
 import path from 'path'
+import crypto from 'crypto'
 
 // example 'vite.user.ts': export const proxy_target = '192.168.16.107'
 let proxy_target;
@@ -18,12 +19,33 @@ try {
     proxy_target = '192.168.20.110';
 }
 
+// The firmware embeds the build output using fixed file names, hence the
+// bundle keeps the name js/app.js on disk. index.html references it by a
+// content hashed name instead (the hash is written to js/app.js.hash), which
+// the firmware serves with a long-lived immutable cache policy.
+function hashedAppJs(): Plugin {
+  return {
+    name: 'opendtu-hashed-app-js',
+    enforce: 'post',
+    generateBundle(_options, bundle) {
+      const app = bundle['js/app.js'];
+      const html = bundle['index.html'];
+      if (app?.type !== 'chunk' || html?.type !== 'asset') { return; }
+
+      const hash = crypto.createHash('sha256').update(app.code).digest('hex').substring(0, 16);
+      html.source = html.source.toString().replace('/js/app.js', `/js/app.${hash}.js`);
+      this.emitFile({ type: 'asset', fileName: 'js/app.js.hash', source: hash });
+    },
+  };
+}
+
 // https://vitejs.dev/config/
 export default defineConfig({
   plugins: [
     vue(),
     viteCompression({ deleteOriginFile: true, threshold: 0 }),
     cssInjectedByJsPlugin(),
+    hashedAppJs(),
     VueI18nPlugin({
         /* options */
         include: path.resolve(path.dirname(fileURLToPath(import.meta.url)), './src/locales/**.json'),
@@ -50,7 +72,7 @@ export default defineConfig({
       output: {
         // Only create one js file
         inlineDynamicImports: true,
-        // Get rid of hash on js file
+        // Get rid of hash on js file, see hashedAppJs()
         entryFileNames: 'js/app.js',
         // Get rid of hash on css file
         assetFileNames: "assets/[name].[ext]",
@@ -80,6 +102,11 @@ export default defineConfig({
         ws: true,
         changeOrigin: true
       },
+      '^/firmwareprogress': {
+        target: 'ws://' + proxy_target,
+        ws: true,
+        changeOrigin: true
+      },
       '^/console': {
         target: 'ws://' + proxy_target,
         ws: true,